@@ -19,6 +19,10 @@ namespace RT64 {
         return Timer::deltaMicroseconds(startTime, Timer::current());
     }
 
+    int64_t ElapsedTimer::elapsedNanoseconds() const {
+        return Timer::deltaNanoseconds(startTime, Timer::current());
+    }
+
     double ElapsedTimer::elapsedMilliseconds() const {
         return static_cast<double>(elapsedMicroseconds()) / 1000.0;
     }
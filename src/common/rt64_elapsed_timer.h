@@ -13,6 +13,7 @@ namespace RT64 {
         ElapsedTimer();
         void reset();
         int64_t elapsedMicroseconds() const;
+        int64_t elapsedNanoseconds() const;
         double elapsedMilliseconds() const;
         double elapsedSeconds() const;
     };
@@ -15,6 +15,7 @@ namespace RT64 {
         struct Framebuffer {
             bool renderToRAM;
             bool copyWithGPU;
+            bool asyncWriteback;
         };
 
         Dither dither;
@@ -43,6 +43,9 @@ namespace RT64 {
         virtual bool exists(const std::string &path) const = 0;
         virtual std::string makeCanonical(const std::string &path) const = 0;
 
+        // Hints that the file will be loaded soon. File systems that can read it ahead of time in the background should do so.
+        virtual void prefetch(const std::string &path) const {}
+
         // Concrete implementation shortcut.
         bool load(const std::string &path, std::vector<uint8_t> &fileData) {
             size_t fileDataSize = getSize(path);
@@ -82,6 +82,13 @@ namespace RT64 {
             return pathFileSystemMap.find(path) != pathFileSystemMap.end();
         }
 
+        void prefetch(const std::string &path) const override {
+            auto it = pathFileSystemMap.find(path);
+            if (it != pathFileSystemMap.end()) {
+                fileSystems[it->second]->prefetch(path);
+            }
+        }
+
         std::string makeCanonical(const std::string &path) const override {
             auto it = pathFileSystemMap.find(path);
             if (it != pathFileSystemMap.end()) {
@@ -0,0 +1,252 @@
+//
+// RT64
+//
+
+#include "rt64_filesystem_indexed_pack.h"
+
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+#include <miniz/miniz.h>
+
+#include "rt64_zstd_decompressor.h"
+
+namespace RT64 {
+    static bool isRangeValid(uint64_t offset, uint64_t size, uint64_t fileSize) {
+        return (offset <= fileSize) && (size <= (fileSize - offset));
+    }
+
+    // FileSystemIndexedPack
+
+    FileSystemIndexedPack::FileSystemIndexedPack(const std::filesystem::path &packPath) {
+        endIterator = std::make_shared<FileSystemIndexedPackIterator>(this, 0);
+
+        if (!mappedFile.open(packPath)) {
+            return;
+        }
+
+        const uint64_t fileSize = mappedFile.size();
+        if (fileSize < sizeof(Header)) {
+            return;
+        }
+
+        header = reinterpret_cast<const Header *>(mappedFile.data());
+        if ((memcmp(header->magic, Magic, sizeof(Magic)) != 0) || (header->version != Version)) {
+            return;
+        }
+
+        if (!isRangeValid(header->fileTableOffset, uint64_t(header->fileCount) * sizeof(FileEntry), fileSize) ||
+            !isRangeValid(header->hashTableOffset, uint64_t(header->hashCount) * sizeof(HashEntry), fileSize) ||
+            !isRangeValid(header->preloadTableOffset, uint64_t(header->preloadCount) * sizeof(uint64_t), fileSize) ||
+            !isRangeValid(header->stringTableOffset, header->stringTableSize, fileSize))
+        {
+            fprintf(stderr, "Indexed pack has tables outside of the file.\n");
+            return;
+        }
+
+        // The tables are accessed in place, so they must be aligned to their entries.
+        if (((header->fileTableOffset % alignof(FileEntry)) != 0) || ((header->hashTableOffset % alignof(HashEntry)) != 0) || ((header->preloadTableOffset % alignof(uint64_t)) != 0)) {
+            fprintf(stderr, "Indexed pack has misaligned tables.\n");
+            return;
+        }
+
+        fileEntries = reinterpret_cast<const FileEntry *>(mappedFile.data() + header->fileTableOffset);
+        hashEntries = reinterpret_cast<const HashEntry *>(mappedFile.data() + header->hashTableOffset);
+        preloadHashes = reinterpret_cast<const uint64_t *>(mappedFile.data() + header->preloadTableOffset);
+        stringTable = reinterpret_cast<const char *>(mappedFile.data() + header->stringTableOffset);
+        endIterator->fileIndex = header->fileCount;
+        packOpen = true;
+        dictionary = ZstdDecompressor::loadDictionary(this);
+    }
+
+    FileSystemIndexedPack::~FileSystemIndexedPack() {
+        ZstdDecompressor::freeDictionary(dictionary);
+    }
+
+    FileSystem::Iterator FileSystemIndexedPack::begin() const {
+        return { std::make_shared<FileSystemIndexedPackIterator>(this, 0) };
+    }
+
+    FileSystem::Iterator FileSystemIndexedPack::end() const {
+        return { endIterator };
+    }
+
+    bool FileSystemIndexedPack::load(const std::string &path, uint8_t *fileData, size_t fileDataMaxByteCount) const {
+        assert(packOpen);
+
+        const FileEntry *fileEntry = findFile(path);
+        if (fileEntry == nullptr) {
+            return false;
+        }
+
+        // Must have enough bytes to read the entire file.
+        if (fileDataMaxByteCount < fileEntry->uncompressedSize) {
+            return false;
+        }
+
+        if (!isRangeValid(fileEntry->dataOffset, fileEntry->compressedSize, mappedFile.size())) {
+            return false;
+        }
+
+        const uint8_t *packFileData = mappedFile.data() + fileEntry->dataOffset;
+        if (fileEntry->compression == Compression::Zstd) {
+            if (!ZstdDecompressor::get().decompress(packFileData, fileEntry->compressedSize, fileData, fileEntry->uncompressedSize, dictionary)) {
+                return false;
+            }
+        }
+        else if (fileEntry->compression == Compression::Deflate) {
+            if (tinfl_decompress_mem_to_mem(fileData, fileEntry->uncompressedSize, packFileData, fileEntry->compressedSize, TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF) == TINFL_DECOMPRESS_MEM_TO_MEM_FAILED) {
+                return false;
+            }
+        }
+        else if (fileEntry->compression == Compression::None) {
+            // Stored files are copied directly, so the size must match the range that was validated.
+            if (fileEntry->compressedSize != fileEntry->uncompressedSize) {
+                return false;
+            }
+
+            memcpy(fileData, packFileData, fileEntry->uncompressedSize);
+        }
+        else {
+            return false;
+        }
+
+        return true;
+    }
+
+    size_t FileSystemIndexedPack::getSize(const std::string &path) const {
+        assert(packOpen);
+
+        const FileEntry *fileEntry = findFile(path);
+        return (fileEntry != nullptr) ? fileEntry->uncompressedSize : 0;
+    }
+
+    bool FileSystemIndexedPack::exists(const std::string &path) const {
+        assert(packOpen);
+
+        return (findFile(path) != nullptr);
+    }
+
+    std::string FileSystemIndexedPack::makeCanonical(const std::string &path) const {
+        // Paths were already validated for case sensitivity when the pack was created.
+        return path;
+    }
+
+    void FileSystemIndexedPack::prefetch(const std::string &path) const {
+        assert(packOpen);
+
+        const FileEntry *fileEntry = findFile(path);
+        if (fileEntry != nullptr) {
+            mappedFile.prefetch(fileEntry->dataOffset, fileEntry->compressedSize);
+        }
+    }
+
+    bool FileSystemIndexedPack::isOpen() const {
+        return packOpen;
+    }
+
+    uint32_t FileSystemIndexedPack::getHashVersion() const {
+        return header->hashVersion;
+    }
+
+    uint32_t FileSystemIndexedPack::getPreloadCount() const {
+        return header->preloadCount;
+    }
+
+    uint64_t FileSystemIndexedPack::getPreloadHash(uint32_t index) const {
+        assert(index < header->preloadCount);
+        return preloadHashes[index];
+    }
+
+    std::string FileSystemIndexedPack::getPath(uint32_t fileIndex) const {
+        assert(fileIndex < header->fileCount);
+
+        const FileEntry &fileEntry = fileEntries[fileIndex];
+        if (!isRangeValid(fileEntry.pathOffset, fileEntry.pathLength, header->stringTableSize)) {
+            return std::string();
+        }
+
+        return std::string(stringTable + fileEntry.pathOffset, fileEntry.pathLength);
+    }
+
+    const FileSystemIndexedPack::HashEntry *FileSystemIndexedPack::findHash(uint64_t hash) const {
+        const HashEntry *hashEntriesEnd = hashEntries + header->hashCount;
+        const HashEntry *it = std::lower_bound(hashEntries, hashEntriesEnd, hash, [](const HashEntry &entry, uint64_t hash) {
+            return entry.hash < hash;
+        });
+
+        if ((it != hashEntriesEnd) && (it->hash == hash) && (it->fileIndex < header->fileCount)) {
+            return it;
+        }
+        else {
+            return nullptr;
+        }
+    }
+
+    const FileSystemIndexedPack::FileEntry *FileSystemIndexedPack::findFile(const std::string &path) const {
+        // Compare the paths as they're stored in the string table without copying them.
+        auto entryPath = [this](const FileEntry &entry) {
+            if (!isRangeValid(entry.pathOffset, entry.pathLength, header->stringTableSize)) {
+                return std::string_view();
+            }
+
+            return std::string_view(stringTable + entry.pathOffset, entry.pathLength);
+        };
+
+        const std::string_view pathView(path);
+        const FileEntry *fileEntriesEnd = fileEntries + header->fileCount;
+        const FileEntry *it = std::lower_bound(fileEntries, fileEntriesEnd, pathView, [&](const FileEntry &entry, std::string_view pathView) {
+            return entryPath(entry) < pathView;
+        });
+
+        if ((it != fileEntriesEnd) && (entryPath(*it) == pathView)) {
+            return it;
+        }
+        else {
+            return nullptr;
+        }
+    }
+
+    bool FileSystemIndexedPack::isIndexedPack(const std::filesystem::path &packPath) {
+        std::ifstream packStream(packPath, std::ios::binary);
+        char magic[sizeof(Magic)] = {};
+        packStream.read(magic, sizeof(magic));
+        return (packStream.gcount() == sizeof(magic)) && (memcmp(magic, Magic, sizeof(Magic)) == 0);
+    }
+
+    std::unique_ptr<FileSystemIndexedPack> FileSystemIndexedPack::create(const std::filesystem::path &packPath) {
+        std::unique_ptr<FileSystemIndexedPack> packFileSystem = std::make_unique<FileSystemIndexedPack>(packPath);
+        if (!packFileSystem->isOpen()) {
+            packFileSystem.reset();
+        }
+
+        return packFileSystem;
+    }
+
+    // FileSystemIndexedPackIterator
+
+    FileSystemIndexedPackIterator::FileSystemIndexedPackIterator(const FileSystemIndexedPack *fileSystem, uint32_t fileIndex) {
+        this->fileSystem = fileSystem;
+        this->fileIndex = fileIndex;
+    }
+
+    const std::string &FileSystemIndexedPackIterator::value() {
+        if (!pathStrValid) {
+            pathStr = fileSystem->getPath(fileIndex);
+            pathStrValid = true;
+        }
+
+        return pathStr;
+    }
+
+    void FileSystemIndexedPackIterator::increment() {
+        fileIndex++;
+        pathStrValid = false;
+    }
+
+    bool FileSystemIndexedPackIterator::compare(const FileSystemIteratorImplementation *other) const {
+        const FileSystemIndexedPackIterator *otherPackIt = static_cast<const FileSystemIndexedPackIterator *>(other);
+        return (fileIndex == otherPackIt->fileIndex);
+    }
+};
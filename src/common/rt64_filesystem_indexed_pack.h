@@ -0,0 +1,112 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include "rt64_filesystem.h"
+
+#include <filesystem>
+
+#include "rt64_mapped_file.h"
+
+struct ZSTD_DDict_s;
+
+namespace RT64 {
+    struct FileSystemIndexedPackIterator;
+
+    // Replacement pack that carries the resolved replacement database as a prebuilt index. Unlike the zip packs, opening one only
+    // requires mapping the file and checking the header, as the file entries are sorted by path and the replacements by hash.
+    //
+    // Layout: Header, file data, file table, hash table, preload table and the path string table. All offsets are absolute.
+    struct FileSystemIndexedPack : FileSystem {
+        static constexpr char Magic[8] = { 'R', 'T', '6', '4', 'I', 'P', 'A', 'K' };
+        static constexpr uint32_t Version = 1;
+
+        enum class Compression : uint32_t {
+            None,
+            Deflate,
+            Zstd
+        };
+
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t hashVersion;
+            uint32_t fileCount;
+            uint32_t hashCount;
+            uint32_t preloadCount;
+            uint32_t reserved;
+            uint64_t fileTableOffset;
+            uint64_t hashTableOffset;
+            uint64_t preloadTableOffset;
+            uint64_t stringTableOffset;
+            uint64_t stringTableSize;
+        };
+
+        // Sorted by path.
+        struct FileEntry {
+            uint64_t dataOffset;
+            uint64_t compressedSize;
+            uint64_t uncompressedSize;
+            uint32_t pathOffset;
+            uint32_t pathLength;
+            Compression compression;
+            uint32_t checksumCRC32;
+        };
+
+        // Sorted by hash. The operation is stored as a ReplacementOperation.
+        struct HashEntry {
+            uint64_t hash;
+            uint32_t fileIndex;
+            uint32_t operation;
+        };
+
+        // The preload table is a list of uint64_t hashes that use the preload operation.
+
+        MappedFile mappedFile;
+        const Header *header = nullptr;
+        const FileEntry *fileEntries = nullptr;
+        const HashEntry *hashEntries = nullptr;
+        const uint64_t *preloadHashes = nullptr;
+        const char *stringTable = nullptr;
+        ZSTD_DDict_s *dictionary = nullptr;
+        std::shared_ptr<FileSystemIndexedPackIterator> endIterator;
+        bool packOpen = false;
+
+        using FileSystem::load;
+
+        FileSystemIndexedPack(const std::filesystem::path &packPath);
+        ~FileSystemIndexedPack() override;
+        Iterator begin() const override;
+        Iterator end() const override;
+        bool load(const std::string &path, uint8_t *fileData, size_t fileDataMaxByteCount) const override;
+        size_t getSize(const std::string &path) const override;
+        bool exists(const std::string &path) const override;
+        std::string makeCanonical(const std::string &path) const override;
+        void prefetch(const std::string &path) const override;
+        bool isOpen() const;
+        uint32_t getHashVersion() const;
+        uint32_t getPreloadCount() const;
+        uint64_t getPreloadHash(uint32_t index) const;
+        std::string getPath(uint32_t fileIndex) const;
+
+        // Returns nullptr if the pack doesn't have a replacement for the hash.
+        const HashEntry *findHash(uint64_t hash) const;
+        const FileEntry *findFile(const std::string &path) const;
+        static bool isIndexedPack(const std::filesystem::path &packPath);
+        static std::unique_ptr<FileSystemIndexedPack> create(const std::filesystem::path &packPath);
+    };
+
+    struct FileSystemIndexedPackIterator : FileSystemIteratorImplementation {
+        const FileSystemIndexedPack *fileSystem = nullptr;
+        uint32_t fileIndex = 0;
+        std::string pathStr;
+        bool pathStrValid = false;
+
+        FileSystemIndexedPackIterator(const FileSystemIndexedPack *fileSystem, uint32_t fileIndex);
+        const std::string &value() override;
+        void increment() override;
+        bool compare(const FileSystemIteratorImplementation *other) const override;
+    };
+};
@@ -5,9 +5,9 @@
 #include "rt64_filesystem_zip.h"
 
 #include <miniz/miniz.h>
-#include <zstd.h>
 
 #include "rt64_mapped_file.h"
+#include "rt64_zstd_decompressor.h"
 
 namespace RT64 {
     enum {
@@ -18,6 +18,10 @@ namespace RT64 {
         MZ_ZSTD = 93,
     };
 
+    // The size of the extra field in the local header is only known after reading it. The prefetched range assumes it's no larger
+    // than this, as reading the header would defeat the purpose of prefetching.
+    static const size_t PrefetchExtraFieldSize = 1024;
+
     static bool startsWith(const std::string &str, const std::string &start) {
         if (str.length() >= start.length()) {
             return (str.compare(0, start.length(), start) == 0);
@@ -35,6 +39,7 @@ namespace RT64 {
         std::filesystem::path zipPath;
         MappedFile zipMappedFile;
         std::string basePath;
+        ZSTD_DDict_s *dictionary = nullptr;
         bool archiveOpen = false;
     };
 
@@ -107,10 +112,15 @@ namespace RT64 {
             mz_zip_reader_end(&zipArchive);
         }
 
+        if (impl->archiveOpen) {
+            impl->dictionary = ZstdDecompressor::loadDictionary(this);
+        }
+
         impl->endIterator = { std::make_shared<FileSystemZipIterator>(impl->fileInfoMap.end()) };
     }
 
     FileSystemZip::~FileSystemZip() {
+        ZstdDecompressor::freeDictionary(impl->dictionary);
         delete impl;
     }
 
@@ -149,7 +159,7 @@ namespace RT64 {
         // Make sure output vector has enough bytes to hold the data.
         const uint8_t *zipFileData = reinterpret_cast<const uint8_t *>(&impl->zipMappedFile.data()[dataAddress]);
         if (it->second.compression == FileSystemZipInfo::Compression::Zstd) {
-            if (ZSTD_decompress(fileData, it->second.uncompressedSize, zipFileData, it->second.compressedSize) != it->second.uncompressedSize) {
+            if (!ZstdDecompressor::get().decompress(zipFileData, it->second.compressedSize, fileData, it->second.uncompressedSize, impl->dictionary)) {
                 return false;
             }
         }
@@ -188,6 +198,19 @@ namespace RT64 {
         return path;
     }
 
+    void FileSystemZip::prefetch(const std::string &path) const {
+        assert(impl->archiveOpen);
+
+        auto it = impl->fileInfoMap.find(path);
+        if (it == impl->fileInfoMap.end()) {
+            return;
+        }
+
+        // The file name stored in the local header also includes the base path.
+        const size_t fileNameLength = impl->basePath.size() + path.size();
+        impl->zipMappedFile.prefetch(it->second.localHeaderOffset, MZ_ZIP_LOCAL_DIR_HEADER_SIZE + fileNameLength + PrefetchExtraFieldSize + it->second.compressedSize);
+    }
+
     bool FileSystemZip::isOpen() const {
         return impl->archiveOpen;
     }
@@ -38,6 +38,7 @@ namespace RT64 {
         size_t getSize(const std::string &path) const override;
         bool exists(const std::string &path) const override;
         std::string makeCanonical(const std::string &path) const override;
+        void prefetch(const std::string &path) const override;
         bool isOpen() const;
         static std::unique_ptr<FileSystem> create(const std::filesystem::path &zipPath, const std::string &basePath);
     };
@@ -0,0 +1,200 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace RT64 {
+    // Open addressing hash map for keys that are already hashes. Uses linear probing and backward shift deletion,
+    // so no tombstones are left behind and all entries live in a single contiguous allocation.
+    template<typename T>
+    struct FlatHashMap {
+        struct Slot {
+            uint64_t key = 0;
+            T value = T();
+            bool occupied = false;
+        };
+
+        std::vector<Slot> slots;
+        size_t count = 0;
+        size_t mask = 0;
+
+        FlatHashMap() {
+            // Default constructor.
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        void clear() {
+            slots.clear();
+            count = 0;
+            mask = 0;
+        }
+
+        T *find(uint64_t key) {
+            if (count == 0) {
+                return nullptr;
+            }
+
+            size_t index = slotIndex(key);
+            while (slots[index].occupied) {
+                if (slots[index].key == key) {
+                    return &slots[index].value;
+                }
+
+                index = (index + 1) & mask;
+            }
+
+            return nullptr;
+        }
+
+        const T *find(uint64_t key) const {
+            return const_cast<FlatHashMap *>(this)->find(key);
+        }
+
+        bool contains(uint64_t key) const {
+            return find(key) != nullptr;
+        }
+
+        // Returns true if the key was inserted. The value is always assigned.
+        bool insert(uint64_t key, const T &value) {
+            if ((count + 1) * 4 > slots.size() * 3) {
+                rehash((slots.size() > 0) ? (slots.size() * 2) : 16);
+            }
+
+            size_t index = slotIndex(key);
+            while (slots[index].occupied) {
+                if (slots[index].key == key) {
+                    slots[index].value = value;
+                    return false;
+                }
+
+                index = (index + 1) & mask;
+            }
+
+            slots[index].key = key;
+            slots[index].value = value;
+            slots[index].occupied = true;
+            count++;
+            return true;
+        }
+
+        bool erase(uint64_t key) {
+            if (count == 0) {
+                return false;
+            }
+
+            size_t index = slotIndex(key);
+            while (slots[index].occupied && (slots[index].key != key)) {
+                index = (index + 1) & mask;
+            }
+
+            if (!slots[index].occupied) {
+                return false;
+            }
+
+            // Shift back any entries in the same cluster that would become unreachable after removing this slot.
+            size_t holeIndex = index;
+            size_t nextIndex = (index + 1) & mask;
+            while (slots[nextIndex].occupied) {
+                const size_t idealIndex = slotIndex(slots[nextIndex].key);
+                const size_t distanceToHole = (nextIndex - holeIndex) & mask;
+                const size_t distanceToIdeal = (nextIndex - idealIndex) & mask;
+                if (distanceToIdeal >= distanceToHole) {
+                    slots[holeIndex] = slots[nextIndex];
+                    holeIndex = nextIndex;
+                }
+
+                nextIndex = (nextIndex + 1) & mask;
+            }
+
+            slots[holeIndex] = Slot();
+            count--;
+            return true;
+        }
+
+        void reserve(size_t entryCount) {
+            size_t newSize = 16;
+            while (newSize * 3 < entryCount * 4) {
+                newSize *= 2;
+            }
+
+            if (newSize > slots.size()) {
+                rehash(newSize);
+            }
+        }
+
+        template<typename F>
+        void forEach(const F &callback) const {
+            for (const Slot &slot : slots) {
+                if (slot.occupied) {
+                    callback(slot.key, slot.value);
+                }
+            }
+        }
+
+    private:
+        size_t slotIndex(uint64_t key) const {
+            // Fibonacci hashing spreads keys whose entropy isn't concentrated in the lower bits.
+            return size_t((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+        }
+
+        void rehash(size_t newSize) {
+            assert((newSize & (newSize - 1)) == 0);
+            std::vector<Slot> oldSlots = std::move(slots);
+            slots.clear();
+            slots.resize(newSize);
+            mask = newSize - 1;
+            count = 0;
+            for (const Slot &slot : oldSlots) {
+                if (slot.occupied) {
+                    insert(slot.key, slot.value);
+                }
+            }
+        }
+    };
+
+    // Set of keys that are already hashes, built on the same open addressing scheme as the map.
+    struct FlatHashSet {
+        FlatHashMap<uint8_t> map;
+
+        size_t size() const {
+            return map.size();
+        }
+
+        bool empty() const {
+            return map.empty();
+        }
+
+        void clear() {
+            map.clear();
+        }
+
+        bool contains(uint64_t key) const {
+            return map.contains(key);
+        }
+
+        // Returns true if the key was inserted.
+        bool insert(uint64_t key) {
+            return map.insert(key, 0);
+        }
+
+        bool erase(uint64_t key) {
+            return map.erase(key);
+        }
+
+        void reserve(size_t entryCount) {
+            map.reserve(entryCount);
+        }
+    };
+};
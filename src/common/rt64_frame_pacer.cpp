@@ -0,0 +1,150 @@
+//
+// RT64
+//
+
+#include "rt64_frame_pacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "rt64_thread.h"
+
+namespace RT64 {
+    // The time left before the deadline that is always spent spinning, on top of the recent oversleep of the OS timer.
+    static const int64_t MinimumSpinMicroseconds = 200;
+    static const double MaximumOversleepMicroseconds = 4000.0;
+    static const double OversleepDecay = 0.95;
+    static const double PredictionWeight = 0.1;
+
+    static double updatePrediction(double prediction, double sample) {
+        return (prediction > 0.0) ? (prediction + (sample - prediction) * PredictionWeight) : sample;
+    }
+
+    // FramePacer
+
+    void FramePacer::reset() {
+        targetTimestamp = Timestamp();
+    }
+
+    void FramePacer::waitForPresent(int64_t intervalMicroseconds, int64_t latencyTargetMicroseconds) {
+        assert(intervalMicroseconds > 0);
+
+        double predictedGPU, predictedPresent;
+        {
+            const std::scoped_lock<std::mutex> reportLock(reportMutex);
+            this->intervalMicroseconds = intervalMicroseconds;
+            predictedGPU = predictedGPUMicroseconds;
+            predictedPresent = predictedPresentMicroseconds;
+        }
+
+        if (lastPresentTimestamp == Timestamp()) {
+            return;
+        }
+
+        // Targets are normally placed one interval after the previous target instead of the previous present, so any error in
+        // when the thread wakes up doesn't accumulate. If the last present was too late or the GPU and the present can't keep up
+        // with the target rate, the pacer resynchronizes to the last present instead of trying to catch up with a burst of frames.
+        const std::chrono::microseconds interval(intervalMicroseconds);
+        const bool keepsUp = (predictedGPU + predictedPresent) < double(intervalMicroseconds);
+        const bool onTime = (targetTimestamp != Timestamp()) && (Timer::deltaMicroseconds(targetTimestamp, lastPresentTimestamp) < (intervalMicroseconds / 2));
+        if (keepsUp && onTime) {
+            targetTimestamp += interval;
+        }
+        else {
+            targetTimestamp = lastPresentTimestamp + interval;
+        }
+
+        // The present call can block until the next vertical blank when the swap chain is synchronized, so the prediction is
+        // capped to avoid pacing the frame a whole interval early.
+        const double presentLeadMicroseconds = std::min(predictedPresent, double(intervalMicroseconds / 2));
+        const std::chrono::microseconds presentLead(int64_t(presentLeadMicroseconds) + std::max<int64_t>(latencyTargetMicroseconds, 0));
+        waitUntil(targetTimestamp - presentLead);
+    }
+
+    void FramePacer::logGPU(Timestamp beginTimestamp, Timestamp endTimestamp) {
+        const std::scoped_lock<std::mutex> reportLock(reportMutex);
+        predictedGPUMicroseconds = updatePrediction(predictedGPUMicroseconds, double(Timer::deltaMicroseconds(beginTimestamp, endTimestamp)));
+    }
+
+    void FramePacer::logPresent(Timestamp beginTimestamp, Timestamp endTimestamp) {
+        const std::scoped_lock<std::mutex> reportLock(reportMutex);
+        predictedPresentMicroseconds = updatePrediction(predictedPresentMicroseconds, double(Timer::deltaMicroseconds(beginTimestamp, endTimestamp)));
+
+        // Only the intervals of presents that were paced are recorded.
+        if ((targetTimestamp != Timestamp()) && (lastPresentTimestamp != Timestamp())) {
+            const int64_t frameMicroseconds = Timer::deltaMicroseconds(lastPresentTimestamp, endTimestamp);
+            intervalHistory[historyIndex] = float(frameMicroseconds / 1000.0);
+            historyIndex = (historyIndex + 1) % HistorySize;
+            historyCount = std::min(historyCount + 1, HistorySize);
+            if ((frameMicroseconds * 2) > (intervalMicroseconds * 3)) {
+                missedCount++;
+            }
+        }
+
+        lastPresentTimestamp = endTimestamp;
+    }
+
+    void FramePacer::copyReport(Report &report) {
+        std::vector<float> intervals;
+        {
+            const std::scoped_lock<std::mutex> reportLock(reportMutex);
+            intervals.assign(intervalHistory.begin(), intervalHistory.begin() + historyCount);
+            report.targetMilliseconds = intervalMicroseconds / 1000.0;
+            report.predictedGPUMilliseconds = predictedGPUMicroseconds / 1000.0;
+            report.predictedPresentMilliseconds = predictedPresentMicroseconds / 1000.0;
+            report.spinThresholdMilliseconds = (MinimumSpinMicroseconds + oversleepMicroseconds) / 1000.0;
+            report.missedCount = missedCount;
+        }
+
+        report.sampleCount = uint32_t(intervals.size());
+        report.histogram.fill(0);
+        report.histogramBinMilliseconds = (report.targetMilliseconds * 2.0) / HistogramBinCount;
+        report.averageMilliseconds = 0.0;
+        if (intervals.empty() || (report.histogramBinMilliseconds <= 0.0)) {
+            report.jitterP50Milliseconds = report.jitterP90Milliseconds = report.jitterP99Milliseconds = report.jitterP999Milliseconds = 0.0;
+            return;
+        }
+
+        std::vector<double> jitter;
+        jitter.reserve(intervals.size());
+        for (float interval : intervals) {
+            const uint32_t binIndex = std::min(uint32_t(interval / report.histogramBinMilliseconds), HistogramBinCount - 1);
+            report.histogram[binIndex]++;
+            report.averageMilliseconds += interval;
+            jitter.emplace_back(std::abs(interval - report.targetMilliseconds));
+        }
+
+        report.averageMilliseconds /= intervals.size();
+
+        std::sort(jitter.begin(), jitter.end());
+        auto percentile = [&](double p) {
+            return jitter[std::min(size_t(p * jitter.size()), jitter.size() - 1)];
+        };
+
+        report.jitterP50Milliseconds = percentile(0.5);
+        report.jitterP90Milliseconds = percentile(0.9);
+        report.jitterP99Milliseconds = percentile(0.99);
+        report.jitterP999Milliseconds = percentile(0.999);
+    }
+
+    void FramePacer::waitUntil(Timestamp deadline) {
+        const int64_t remainingMicroseconds = Timer::deltaMicroseconds(Timer::current(), deadline);
+        const int64_t spinMicroseconds = MinimumSpinMicroseconds + int64_t(oversleepMicroseconds);
+        if (remainingMicroseconds > spinMicroseconds) {
+            const int64_t sleepMicroseconds = remainingMicroseconds - spinMicroseconds;
+            const Timestamp sleepTimestamp = Timer::current();
+            Thread::sleepMicroseconds(uint32_t(sleepMicroseconds));
+
+            // Track the worst recent oversleep. It rises immediately when the OS wakes the thread up late and decays slowly.
+            const int64_t oversleptMicroseconds = Timer::deltaMicroseconds(sleepTimestamp, Timer::current()) - sleepMicroseconds;
+            const double oversleep = std::clamp(double(oversleptMicroseconds), 0.0, MaximumOversleepMicroseconds);
+            const std::scoped_lock<std::mutex> reportLock(reportMutex);
+            oversleepMicroseconds = std::max(oversleep, oversleepMicroseconds * OversleepDecay);
+        }
+
+        while (Timer::current() < deadline) {
+            std::this_thread::yield();
+        }
+    }
+};
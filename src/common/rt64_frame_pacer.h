@@ -0,0 +1,70 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <vector>
+
+#include "rt64_timer.h"
+
+namespace RT64 {
+    // Paces presents to a target interval. The thread sleeps with the highest resolution timer available until it's close enough
+    // to the deadline and spins for the remainder. The deadline is moved earlier by the predicted duration of the present call
+    // and by the latency target, so the frame is handed to the OS as close as possible to when it should be displayed.
+    struct FramePacer {
+        static constexpr uint32_t HistorySize = 1024;
+        static constexpr uint32_t HistogramBinCount = 64;
+
+        struct Report {
+            // Frame intervals from zero to twice the target interval. The last bin also counts any slower frames.
+            std::array<uint32_t, HistogramBinCount> histogram = {};
+            double histogramBinMilliseconds = 0.0;
+            double targetMilliseconds = 0.0;
+            double averageMilliseconds = 0.0;
+
+            // Percentiles of the absolute difference between each frame interval and the target interval.
+            double jitterP50Milliseconds = 0.0;
+            double jitterP90Milliseconds = 0.0;
+            double jitterP99Milliseconds = 0.0;
+            double jitterP999Milliseconds = 0.0;
+
+            double predictedGPUMilliseconds = 0.0;
+            double predictedPresentMilliseconds = 0.0;
+            double spinThresholdMilliseconds = 0.0;
+            uint32_t sampleCount = 0;
+            uint64_t missedCount = 0;
+        };
+
+        Timestamp targetTimestamp;
+        Timestamp lastPresentTimestamp;
+        int64_t intervalMicroseconds = 0;
+        double predictedGPUMicroseconds = 0.0;
+        double predictedPresentMicroseconds = 0.0;
+        double oversleepMicroseconds = 0.0;
+        std::array<float, HistorySize> intervalHistory = {};
+        uint32_t historyIndex = 0;
+        uint32_t historyCount = 0;
+        uint64_t missedCount = 0;
+        std::mutex reportMutex;
+
+        // Must be called when the presents stop being paced so the next deadline isn't based on an old present.
+        void reset();
+
+        // Waits until the present for the current frame should be issued. Returns immediately if the deadline was already missed.
+        void waitForPresent(int64_t intervalMicroseconds, int64_t latencyTargetMicroseconds);
+
+        // Time spent waiting for the GPU to finish the command list that the present depends on.
+        void logGPU(Timestamp beginTimestamp, Timestamp endTimestamp);
+
+        // Time spent in the present call. The end of the present is used as the time the frame was presented.
+        void logPresent(Timestamp beginTimestamp, Timestamp endTimestamp);
+
+        void copyReport(Report &report);
+
+        // Sleeps for as long as it's safe to do so and spins until the deadline.
+        void waitUntil(Timestamp deadline);
+    };
+};
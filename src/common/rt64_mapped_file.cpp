@@ -4,6 +4,8 @@
 
 #include "rt64_mapped_file.h"
 
+#include <algorithm>
+
 #if !defined(_WIN32)
 #   include <cstring>
 #   include <cstdio>
@@ -124,6 +126,26 @@ namespace RT64 {
         return fileSize.QuadPart;
 #   else
         return static_cast<size_t>(fileSize);
+#   endif
+    }
+
+    void MappedFile::prefetch(size_t offset, size_t size) const {
+        if (!isOpen() || (offset >= this->size())) {
+            return;
+        }
+
+        size = std::min(size, this->size() - offset);
+
+#   if defined(_WIN32)
+        WIN32_MEMORY_RANGE_ENTRY rangeEntry;
+        rangeEntry.VirtualAddress = data() + offset;
+        rangeEntry.NumberOfBytes = size;
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &rangeEntry, 0);
+#   else
+        // The range must start at the beginning of a page.
+        const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+        const size_t alignedOffset = offset - (offset % pageSize);
+        madvise(data() + alignedOffset, size + (offset - alignedOffset), MADV_WILLNEED);
 #   endif
     }
 };
@@ -32,5 +32,8 @@ namespace RT64 {
         bool isOpen() const;
         uint8_t *data() const;
         size_t size() const;
+
+        // Asks the OS to start reading the range into memory in the background so accessing it later doesn't stall on page faults.
+        void prefetch(size_t offset, size_t size) const;
     };
 };
\ No newline at end of file
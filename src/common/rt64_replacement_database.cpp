@@ -4,17 +4,23 @@
 
 #include "rt64_replacement_database.h"
 
+#include <algorithm>
 #include <cinttypes>
 
+#include "xxHash/xxh3.h"
+
 #include "rt64_filesystem_directory.h"
 
 namespace RT64 {
     const std::string ReplacementDatabaseFilename = "rt64.json";
+    const std::string ReplacementDatabaseBinaryFilename = "rt64-database.bin";
     const std::string ReplacementLowMipCacheFilename = "rt64-low-mip-cache.bin";
     const std::string ReplacementPackExtension = ".rtz";
     const std::string ReplacementKnownExtensions[] = { ".dds", ".png" };
     const uint32_t ReplacementMipmapCacheHeaderMagic = 0x434D4F4CU;
     const uint32_t ReplacementMipmapCacheHeaderVersion = 3U;
+    const uint32_t ReplacementDatabaseBinaryHeaderMagic = 0x42444452U;
+    const uint32_t ReplacementDatabaseBinaryHeaderVersion = 1U;
     
     static bool checkWildcard(const std::string &str, const std::string &pat) {
         size_t strIndex = 0;
@@ -58,6 +64,8 @@ namespace RT64 {
     // ReplacementDatabase
 
     uint32_t ReplacementDatabase::addReplacement(const ReplacementTexture &texture) {
+        buildHashMapsIfSorted();
+
         const uint64_t rt64 = stringToHash(texture.hashes.rt64);
         auto it = tmemHashToReplaceMap.find(rt64);
         if (it != tmemHashToReplaceMap.end()) {
@@ -73,6 +81,8 @@ namespace RT64 {
     }
 
     void ReplacementDatabase::fixReplacement(const std::string &hash, const ReplacementTexture &texture) {
+        buildHashMapsIfSorted();
+
         const uint64_t rt64Old = stringToHash(hash);
         const uint64_t rt64New = stringToHash(texture.hashes.rt64);
         auto it = tmemHashToReplaceMap.find(rt64Old);
@@ -84,6 +94,22 @@ namespace RT64 {
     }
 
     ReplacementTexture ReplacementDatabase::getReplacement(uint64_t hash) const {
+        if (sortedByHash) {
+            // When several textures share the hash, the last one is used, same as the hash map.
+            auto it = std::upper_bound(textures.begin(), textures.end(), hash, [](uint64_t hash, const ReplacementTexture &texture) {
+                return hash < stringToHash(texture.hashes.rt64);
+            });
+
+            while ((it != textures.begin()) && (stringToHash((it - 1)->hashes.rt64) == hash)) {
+                it--;
+                if (!it->isEmpty()) {
+                    return *it;
+                }
+            }
+
+            return ReplacementTexture();
+        }
+
         auto it = tmemHashToReplaceMap.find(hash);
         if (it != tmemHashToReplaceMap.end()) {
             return textures[it->second];
@@ -109,6 +135,13 @@ namespace RT64 {
         }
     }
 
+    void ReplacementDatabase::buildHashMapsIfSorted() {
+        if (sortedByHash) {
+            buildHashMaps();
+            sortedByHash = false;
+        }
+    }
+
     ReplacementOperation ReplacementDatabase::resolveOperation(const std::string &relativePath, const std::vector<ReplacementOperationFilter> &filters) {
         ReplacementOperation resolution = ReplacementOperation::Stream;
 
@@ -122,6 +155,121 @@ namespace RT64 {
         return resolution;
     }
     
+    void ReplacementDatabase::toBinary(uint64_t sourceHash, std::vector<uint8_t> &bytes) const {
+        std::string stringTable;
+        auto addString = [&](const std::string &str) {
+            ReplacementDatabaseBinaryString binaryString;
+            binaryString.offset = uint32_t(stringTable.size());
+            binaryString.length = uint32_t(str.size());
+            stringTable += str;
+            return binaryString;
+        };
+
+        // The sort is stable so textures that share a hash keep their relative order, which decides the one that gets resolved.
+        std::vector<ReplacementDatabaseBinaryTexture> binaryTextures;
+        for (const ReplacementTexture &texture : textures) {
+            ReplacementDatabaseBinaryTexture binaryTexture;
+            binaryTexture.rt64Hash = stringToHash(texture.hashes.rt64);
+            binaryTexture.path = addString(texture.path);
+            binaryTexture.rt64 = addString(texture.hashes.rt64);
+            binaryTexture.rice = addString(texture.hashes.rice);
+            binaryTextures.emplace_back(binaryTexture);
+        }
+
+        std::stable_sort(binaryTextures.begin(), binaryTextures.end(), [](const ReplacementDatabaseBinaryTexture &a, const ReplacementDatabaseBinaryTexture &b) {
+            return a.rt64Hash < b.rt64Hash;
+        });
+
+        std::vector<ReplacementDatabaseBinaryOperationFilter> binaryFilters;
+        for (const ReplacementOperationFilter &filter : operationFilters) {
+            ReplacementDatabaseBinaryOperationFilter binaryFilter;
+            binaryFilter.wildcard = addString(filter.wildcard);
+            binaryFilter.operation = uint32_t(filter.operation);
+            binaryFilters.emplace_back(binaryFilter);
+        }
+
+        ReplacementDatabaseBinaryHeader header;
+        header.sourceHash = sourceHash;
+        header.autoPath = uint32_t(config.autoPath);
+        header.configurationVersion = config.configurationVersion;
+        header.hashVersion = config.hashVersion;
+        header.textureCount = uint32_t(binaryTextures.size());
+        header.operationFilterCount = uint32_t(binaryFilters.size());
+        header.stringTableSize = uint32_t(stringTable.size());
+
+        const size_t texturesSize = sizeof(ReplacementDatabaseBinaryTexture) * binaryTextures.size();
+        const size_t filtersSize = sizeof(ReplacementDatabaseBinaryOperationFilter) * binaryFilters.size();
+        bytes.resize(sizeof(ReplacementDatabaseBinaryHeader) + texturesSize + filtersSize + stringTable.size());
+
+        uint8_t *cursor = bytes.data();
+        memcpy(cursor, &header, sizeof(ReplacementDatabaseBinaryHeader));
+        cursor += sizeof(ReplacementDatabaseBinaryHeader);
+        memcpy(cursor, binaryTextures.data(), texturesSize);
+        cursor += texturesSize;
+        memcpy(cursor, binaryFilters.data(), filtersSize);
+        cursor += filtersSize;
+        memcpy(cursor, stringTable.data(), stringTable.size());
+    }
+
+    bool ReplacementDatabase::fromBinary(const uint8_t *bytes, size_t byteCount, uint64_t sourceHash) {
+        if (byteCount < sizeof(ReplacementDatabaseBinaryHeader)) {
+            return false;
+        }
+
+        ReplacementDatabaseBinaryHeader header;
+        memcpy(&header, bytes, sizeof(ReplacementDatabaseBinaryHeader));
+        if ((header.magic != ReplacementDatabaseBinaryHeaderMagic) || (header.version != ReplacementDatabaseBinaryHeaderVersion) || (header.sourceHash != sourceHash)) {
+            return false;
+        }
+
+        const size_t texturesSize = sizeof(ReplacementDatabaseBinaryTexture) * size_t(header.textureCount);
+        const size_t filtersSize = sizeof(ReplacementDatabaseBinaryOperationFilter) * size_t(header.operationFilterCount);
+        if ((sizeof(ReplacementDatabaseBinaryHeader) + texturesSize + filtersSize + header.stringTableSize) > byteCount) {
+            return false;
+        }
+
+        const ReplacementDatabaseBinaryTexture *binaryTextures = reinterpret_cast<const ReplacementDatabaseBinaryTexture *>(bytes + sizeof(ReplacementDatabaseBinaryHeader));
+        const ReplacementDatabaseBinaryOperationFilter *binaryFilters = reinterpret_cast<const ReplacementDatabaseBinaryOperationFilter *>(bytes + sizeof(ReplacementDatabaseBinaryHeader) + texturesSize);
+        const char *stringTable = reinterpret_cast<const char *>(bytes + sizeof(ReplacementDatabaseBinaryHeader) + texturesSize + filtersSize);
+        bool stringsValid = true;
+        auto getString = [&](const ReplacementDatabaseBinaryString &binaryString) {
+            if ((binaryString.offset > header.stringTableSize) || (binaryString.length > (header.stringTableSize - binaryString.offset))) {
+                stringsValid = false;
+                return std::string();
+            }
+
+            return std::string(stringTable + binaryString.offset, binaryString.length);
+        };
+
+        config.autoPath = ReplacementAutoPath(header.autoPath);
+        config.configurationVersion = header.configurationVersion;
+        config.hashVersion = header.hashVersion;
+
+        textures.resize(header.textureCount);
+        for (uint32_t i = 0; i < header.textureCount; i++) {
+            textures[i].path = getString(binaryTextures[i].path);
+            textures[i].hashes.rt64 = getString(binaryTextures[i].rt64);
+            textures[i].hashes.rice = getString(binaryTextures[i].rice);
+        }
+
+        operationFilters.resize(header.operationFilterCount);
+        for (uint32_t i = 0; i < header.operationFilterCount; i++) {
+            operationFilters[i].wildcard = getString(binaryFilters[i].wildcard);
+            operationFilters[i].operation = ReplacementOperation(binaryFilters[i].operation);
+        }
+
+        if (!stringsValid) {
+            textures.clear();
+            operationFilters.clear();
+            return false;
+        }
+
+        // The textures are already sorted by hash, so they're searched directly instead of building the hash map.
+        tmemHashToReplaceMap.clear();
+        sortedByHash = true;
+        return true;
+    }
+
     void ReplacementDatabase::resolvePaths(const FileSystem *fileSystem, std::unordered_map<uint64_t, ReplacementResolvedPath> &resolvedPathMap, bool onlyDDS, std::vector<uint64_t> *hashesMissing, std::unordered_set<uint64_t> *hashesToPreload) {
         std::unordered_map<std::string, std::string> autoPathMap;
         for (const std::string &relativePath : *fileSystem) {
@@ -219,6 +367,10 @@ namespace RT64 {
         }
     }
 
+    uint64_t ReplacementDatabase::hashSource(const uint8_t *bytes, size_t byteCount) {
+        return XXH3_64bits(bytes, byteCount);
+    }
+
     uint64_t ReplacementDatabase::stringToHash(const std::string &str) {
         return strtoull(str.c_str(), nullptr, 16);
     }
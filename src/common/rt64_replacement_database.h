@@ -13,11 +13,14 @@ using json = nlohmann::json;
 
 namespace RT64 {
     extern const std::string ReplacementDatabaseFilename;
+    extern const std::string ReplacementDatabaseBinaryFilename;
     extern const std::string ReplacementLowMipCacheFilename;
     extern const std::string ReplacementPackExtension;
     extern const std::string ReplacementKnownExtensions[];
     extern const uint32_t ReplacementMipmapCacheHeaderMagic;
     extern const uint32_t ReplacementMipmapCacheHeaderVersion;
+    extern const uint32_t ReplacementDatabaseBinaryHeaderMagic;
+    extern const uint32_t ReplacementDatabaseBinaryHeaderVersion;
 
     enum class ReplacementOperation {
         Preload,
@@ -81,19 +84,61 @@ namespace RT64 {
         uint32_t pathLength = 0;
     };
 
+    // Compiled form of the database. The header is followed by the textures sorted by their RT64 hash, the operation filters in
+    // their original order and a string table. The source hash is the hash of the JSON it was compiled from, so a binary database
+    // that is out of date with its JSON can be detected and ignored. Loading it skips parsing the JSON, but the strings are still
+    // copied into the database and its paths are resolved against the file system like any other database.
+    struct ReplacementDatabaseBinaryHeader {
+        uint32_t magic = ReplacementDatabaseBinaryHeaderMagic;
+        uint32_t version = ReplacementDatabaseBinaryHeaderVersion;
+        uint64_t sourceHash = 0;
+        uint32_t autoPath = 0;
+        uint32_t configurationVersion = 0;
+        uint32_t hashVersion = 0;
+        uint32_t textureCount = 0;
+        uint32_t operationFilterCount = 0;
+        uint32_t stringTableSize = 0;
+    };
+
+    struct ReplacementDatabaseBinaryString {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+
+    struct ReplacementDatabaseBinaryTexture {
+        uint64_t rt64Hash = 0;
+        ReplacementDatabaseBinaryString path;
+        ReplacementDatabaseBinaryString rt64;
+        ReplacementDatabaseBinaryString rice;
+    };
+
+    struct ReplacementDatabaseBinaryOperationFilter {
+        ReplacementDatabaseBinaryString wildcard;
+        uint32_t operation = 0;
+        uint32_t reserved = 0;
+    };
+
     struct ReplacementDatabase {
         ReplacementConfiguration config;
         std::vector<ReplacementTexture> textures;
         std::vector<ReplacementOperationFilter> operationFilters;
         std::unordered_map<uint64_t, uint32_t> tmemHashToReplaceMap;
 
+        // Set when the textures were loaded from the compiled database. They're looked up by searching the sorted textures until the
+        // database is modified, which builds the hash map instead.
+        bool sortedByHash = false;
+
         uint32_t addReplacement(const ReplacementTexture &texture);
         void fixReplacement(const std::string &hash, const ReplacementTexture &texture);
         ReplacementTexture getReplacement(uint64_t hash) const;
         ReplacementTexture getReplacement(const std::string &hash) const;
         void buildHashMaps();
+        void buildHashMapsIfSorted();
         ReplacementOperation resolveOperation(const std::string &relativePath, const std::vector<ReplacementOperationFilter> &filters);
+        void toBinary(uint64_t sourceHash, std::vector<uint8_t> &bytes) const;
+        bool fromBinary(const uint8_t *bytes, size_t byteCount, uint64_t sourceHash);
         void resolvePaths(const FileSystem *fileSystem, std::unordered_map<uint64_t, ReplacementResolvedPath> &resolvedPathMap, bool onlyDDS, std::vector<uint64_t> *hashesMissing = nullptr, std::unordered_set<uint64_t> *hashesToPreload = nullptr);
+        static uint64_t hashSource(const uint8_t *bytes, size_t byteCount);
         static uint64_t stringToHash(const std::string &str);
         static std::string hashToString(uint32_t hash);
         static std::string hashToString(uint64_t hash);
@@ -0,0 +1,131 @@
+//
+// RT64
+//
+
+#include "rt64_task_pool.h"
+
+#include <cassert>
+
+#include "rt64_thread.h"
+
+namespace RT64 {
+    // TaskPool
+
+    TaskPool::TaskPool(uint32_t threadCount, const std::string &threadName) {
+        this->threadName = threadName;
+        taskCursor = 0;
+        tasksRemaining = 0;
+        threadsRunning = true;
+        threads.resize(threadCount);
+        for (std::unique_ptr<std::thread> &thread : threads) {
+            thread = std::make_unique<std::thread>(&TaskPool::threadLoop, this);
+        }
+    }
+
+    TaskPool::~TaskPool() {
+        {
+            std::unique_lock<std::mutex> taskLock(taskMutex);
+            threadsRunning = false;
+        }
+
+        taskCondition.notify_all();
+
+        for (std::unique_ptr<std::thread> &thread : threads) {
+            thread->join();
+        }
+
+        threads.clear();
+    }
+
+    void TaskPool::parallelFor(uint32_t count, const std::function<void(uint32_t)> &function) {
+        if (count == 0) {
+            return;
+        }
+
+        // Not worth waking up the threads for a single task.
+        if (threads.empty() || (count == 1)) {
+            for (uint32_t i = 0; i < count; i++) {
+                function(i);
+            }
+
+            return;
+        }
+
+        {
+            // A thread that was too late to take part in the previous loop could still be holding on to its state.
+            std::unique_lock<std::mutex> taskLock(taskMutex);
+            doneCondition.wait(taskLock, [this]() {
+                return activeThreads == 0;
+            });
+
+            taskFunction = &function;
+            taskCount = count;
+            taskCursor = 0;
+            tasksRemaining = count;
+            taskGeneration++;
+        }
+
+        taskCondition.notify_all();
+        runTasks(function, count);
+
+        std::unique_lock<std::mutex> taskLock(taskMutex);
+        doneCondition.wait(taskLock, [this]() {
+            return (tasksRemaining == 0) && (activeThreads == 0);
+        });
+
+        taskFunction = nullptr;
+    }
+
+    uint32_t TaskPool::getThreadCount() const {
+        return uint32_t(threads.size());
+    }
+
+    void TaskPool::runTasks(const std::function<void(uint32_t)> &function, uint32_t count) {
+        uint32_t taskIndex = taskCursor++;
+        while (taskIndex < count) {
+            function(taskIndex);
+
+            if (--tasksRemaining == 0) {
+                std::unique_lock<std::mutex> taskLock(taskMutex);
+                doneCondition.notify_all();
+            }
+
+            taskIndex = taskCursor++;
+        }
+    }
+
+    void TaskPool::threadLoop() {
+        Thread::setCurrentThreadName(threadName);
+
+        uint64_t threadGeneration = 0;
+        while (true) {
+            const std::function<void(uint32_t)> *function = nullptr;
+            uint32_t count = 0;
+            {
+                std::unique_lock<std::mutex> taskLock(taskMutex);
+                taskCondition.wait(taskLock, [&]() {
+                    return !threadsRunning || ((taskGeneration != threadGeneration) && (taskFunction != nullptr));
+                });
+
+                if (!threadsRunning) {
+                    break;
+                }
+
+                threadGeneration = taskGeneration;
+                function = taskFunction;
+                count = taskCount;
+                activeThreads++;
+            }
+
+            assert(function != nullptr);
+            runTasks(*function, count);
+
+            {
+                std::unique_lock<std::mutex> taskLock(taskMutex);
+                activeThreads--;
+            }
+
+            doneCondition.notify_all();
+        }
+    }
+};
@@ -0,0 +1,43 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace RT64 {
+    // Runs the iterations of a loop across a fixed set of threads. The calling thread also takes iterations, so a pool created
+    // without threads is valid and just runs everything inline.
+    struct TaskPool {
+        std::vector<std::unique_ptr<std::thread>> threads;
+        std::mutex taskMutex;
+        std::condition_variable taskCondition;
+        std::condition_variable doneCondition;
+        const std::function<void(uint32_t)> *taskFunction = nullptr;
+        uint32_t taskCount = 0;
+        std::atomic<uint32_t> taskCursor;
+        std::atomic<uint32_t> tasksRemaining;
+        uint32_t activeThreads = 0;
+        uint64_t taskGeneration = 0;
+        bool threadsRunning = false;
+        std::string threadName;
+
+        TaskPool(uint32_t threadCount, const std::string &threadName);
+        ~TaskPool();
+
+        // Calls the function once for every index lower than the count and returns when all the calls are done. The order the
+        // indices are processed in is not guaranteed, so the function should write its results into a slot of the index.
+        void parallelFor(uint32_t count, const std::function<void(uint32_t)> &function);
+        uint32_t getThreadCount() const;
+        void runTasks(const std::function<void(uint32_t)> &function, uint32_t count);
+        void threadLoop();
+    };
+};
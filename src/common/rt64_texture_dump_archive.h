@@ -0,0 +1,82 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace RT64 {
+    // Append-only archive that stores the files generated by the texture dumper in a single file. The archive is a header followed
+    // by any number of entries, each one made of a name, the size of the data and the data itself. Entries are never rewritten, so
+    // an archive that was interrupted while writing can still be read up to the last complete entry.
+    struct TextureDumpArchive {
+        static constexpr char Magic[] = "RT64DUMP";
+        static constexpr uint32_t MagicSize = 8;
+        static constexpr uint32_t Version = 1;
+        static constexpr uint32_t MaxNameSize = 256;
+
+        struct EntryHeader {
+            uint32_t nameSize;
+            uint32_t reserved;
+            uint64_t dataSize;
+        };
+
+        static bool writeHeader(std::ofstream &stream) {
+            stream.write(Magic, MagicSize);
+            stream.write(reinterpret_cast<const char *>(&Version), sizeof(Version));
+            return !stream.bad();
+        }
+
+        static bool writeEntry(std::ofstream &stream, const std::string &name, const void *data, uint64_t dataSize) {
+            EntryHeader entryHeader;
+            entryHeader.nameSize = uint32_t(name.size());
+            entryHeader.reserved = 0;
+            entryHeader.dataSize = dataSize;
+            stream.write(reinterpret_cast<const char *>(&entryHeader), sizeof(entryHeader));
+            stream.write(name.data(), name.size());
+            stream.write(reinterpret_cast<const char *>(data), dataSize);
+            return !stream.bad();
+        }
+
+        static bool readHeader(std::ifstream &stream) {
+            char magic[MagicSize];
+            uint32_t version = 0;
+            stream.read(magic, MagicSize);
+            stream.read(reinterpret_cast<char *>(&version), sizeof(version));
+            return !stream.fail() && (memcmp(magic, Magic, MagicSize) == 0) && (version == Version);
+        }
+
+        // Returns false once there are no more complete entries left in the archive.
+        static bool readEntry(std::ifstream &stream, std::string &name, std::vector<uint8_t> &data) {
+            EntryHeader entryHeader;
+            stream.read(reinterpret_cast<char *>(&entryHeader), sizeof(entryHeader));
+            if (stream.fail() || (entryHeader.nameSize == 0) || (entryHeader.nameSize > MaxNameSize)) {
+                return false;
+            }
+
+            name.resize(entryHeader.nameSize);
+            stream.read(name.data(), entryHeader.nameSize);
+            if (stream.fail()) {
+                return false;
+            }
+
+            // Reject sizes that go past the end of the file before allocating, as an interrupted or corrupted entry can hold any value.
+            const std::streampos dataPosition = stream.tellg();
+            stream.seekg(0, std::ios::end);
+            const std::streampos endPosition = stream.tellg();
+            stream.seekg(dataPosition);
+            if (stream.fail() || (dataPosition < 0) || (endPosition < dataPosition) || (entryHeader.dataSize > uint64_t(endPosition - dataPosition))) {
+                return false;
+            }
+
+            data.resize(entryHeader.dataSize);
+            stream.read(reinterpret_cast<char *>(data.data()), entryHeader.dataSize);
+            return !stream.fail();
+        }
+    };
+};
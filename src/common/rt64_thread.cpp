@@ -11,7 +11,12 @@
 #   include <Windows.h>
 #   include "utf8conv/utf8conv.h"
 #elif defined(__linux__)
+#   include <cerrno>
 #   include <pthread.h>
+#   include <time.h>
+#elif defined(__APPLE__)
+#   include <cerrno>
+#   include <time.h>
 #endif
 
 namespace RT64 {
@@ -35,6 +40,24 @@ namespace RT64 {
             return THREAD_PRIORITY_NORMAL;
         }
     }
+
+    // Waitable timers created with the high resolution flag aren't bound to the system timer resolution of about one millisecond.
+    // The flag is only available on Windows 10 1803 and newer, so Sleep is used as a fallback if the timer can't be created.
+    struct HighResolutionTimer {
+        HANDLE handle = nullptr;
+
+        HighResolutionTimer() {
+#       if defined(CREATE_WAITABLE_TIMER_HIGH_RESOLUTION)
+            handle = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#       endif
+        }
+
+        ~HighResolutionTimer() {
+            if (handle != nullptr) {
+                CloseHandle(handle);
+            }
+        }
+    };
 #   endif
 
     // Thread
@@ -73,6 +96,41 @@ namespace RT64 {
         Sleep(millis);
 #   else
         std::this_thread::sleep_for(std::chrono::milliseconds(millis));
+#   endif
+    }
+
+    void Thread::sleepMicroseconds(uint32_t micros) {
+#   if defined(_WIN32)
+        thread_local HighResolutionTimer timer;
+        if (timer.handle != nullptr) {
+            // Negative due times are relative and expressed in 100 nanosecond intervals.
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -int64_t(micros) * 10;
+            if (SetWaitableTimer(timer.handle, &dueTime, 0, nullptr, nullptr, FALSE)) {
+                WaitForSingleObject(timer.handle, INFINITE);
+                return;
+            }
+        }
+
+        Sleep(micros / 1000);
+#   elif defined(__linux__) || defined(__APPLE__)
+        timespec request;
+        request.tv_sec = micros / 1000000;
+        request.tv_nsec = long(micros % 1000000) * 1000;
+
+        // Resume the sleep with the remaining time if it was interrupted by a signal.
+        timespec remaining;
+#       if defined(__linux__)
+        while (clock_nanosleep(CLOCK_MONOTONIC, 0, &request, &remaining) == EINTR) {
+            request = remaining;
+        }
+#       else
+        while ((nanosleep(&request, &remaining) != 0) && (errno == EINTR)) {
+            request = remaining;
+        }
+#       endif
+#   else
+        std::this_thread::sleep_for(std::chrono::microseconds(micros));
 #   endif
     }
 };
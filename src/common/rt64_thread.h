@@ -21,5 +21,8 @@ namespace RT64 {
         static void setCurrentThreadName(const std::string &str);
         static void setCurrentThreadPriority(Priority priority);
         static void sleepMilliseconds(uint32_t millis);
+
+        // Uses the highest resolution timer the OS provides. The thread can still wake up later than requested due to scheduling.
+        static void sleepMicroseconds(uint32_t micros);
     };
 };
\ No newline at end of file
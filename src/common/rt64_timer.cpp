@@ -17,4 +17,8 @@ namespace RT64 {
     int64_t Timer::deltaMicroseconds(const Timestamp t1, const Timestamp t2) {
         return std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
     }
+
+    int64_t Timer::deltaNanoseconds(const Timestamp t1, const Timestamp t2) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+    }
 };
@@ -15,5 +15,6 @@ namespace RT64 {
         static void initialize();
         static Timestamp current();
         static int64_t deltaMicroseconds(const Timestamp t1, const Timestamp t2);
+        static int64_t deltaNanoseconds(const Timestamp t1, const Timestamp t2);
     };
 };
\ No newline at end of file
@@ -28,6 +28,8 @@ namespace RT64 {
         j["threePointFiltering"] = cfg.threePointFiltering;
         j["refreshRate"] = cfg.refreshRate;
         j["refreshRateTarget"] = cfg.refreshRateTarget;
+        j["presentLatencyTarget"] = cfg.presentLatencyTarget;
+        j["renderTargetBudget"] = cfg.renderTargetBudget;
         j["internalColorFormat"] = cfg.internalColorFormat;
         j["idleWorkActive"] = cfg.idleWorkActive;
         j["developerMode"] = cfg.developerMode;
@@ -49,6 +51,8 @@ namespace RT64 {
         cfg.threePointFiltering = j.value("threePointFiltering", defaultCfg.threePointFiltering);
         cfg.refreshRate = j.value("refreshRate", defaultCfg.refreshRate);
         cfg.refreshRateTarget = j.value("refreshRateTarget", defaultCfg.refreshRateTarget);
+        cfg.presentLatencyTarget = j.value("presentLatencyTarget", defaultCfg.presentLatencyTarget);
+        cfg.renderTargetBudget = j.value("renderTargetBudget", defaultCfg.renderTargetBudget);
         cfg.internalColorFormat = j.value("internalColorFormat", defaultCfg.internalColorFormat);
         cfg.idleWorkActive = j.value("idleWorkActive", defaultCfg.idleWorkActive);
         cfg.developerMode = j.value("developerMode", defaultCfg.developerMode);
@@ -78,6 +82,8 @@ namespace RT64 {
         threePointFiltering = true;
         refreshRate = RefreshRate::Original;
         refreshRateTarget = 60;
+        presentLatencyTarget = 500;
+        renderTargetBudget = 2048;
         internalColorFormat = InternalColorFormat::Automatic;
         idleWorkActive = true;
         developerMode = false;
@@ -98,6 +104,8 @@ namespace RT64 {
         aspectTarget = std::clamp<double>(aspectTarget, 0.1f, 100.0f);
         extAspectTarget = std::clamp<double>(extAspectTarget, 0.1f, 100.0f);
         refreshRateTarget = std::clamp<int>(refreshRateTarget, 10, 1000);
+        presentLatencyTarget = std::clamp<int>(presentLatencyTarget, 0, 10000);
+        renderTargetBudget = std::clamp<int>(renderTargetBudget, 0, 65536);
     }
 
     uint32_t UserConfiguration::msaaSampleCount() const {
@@ -84,6 +84,8 @@ namespace RT64 {
         bool threePointFiltering;
         RefreshRate refreshRate;
         int refreshRateTarget;
+        int presentLatencyTarget;
+        int renderTargetBudget;
         InternalColorFormat internalColorFormat;
         bool idleWorkActive;
         bool developerMode;
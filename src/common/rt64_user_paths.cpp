@@ -15,6 +15,7 @@ namespace RT64 {
     // UserPaths
 
     const std::filesystem::path GamesDirectory = "games";
+    const std::filesystem::path CacheDirectory = "cache";
     const std::filesystem::path ConfigurationFile = "rt64.json";
     const std::filesystem::path ImGuiFile = "rt64-imgui.ini";
     const std::filesystem::path LogFile = "rt64.log";
@@ -58,6 +59,7 @@ namespace RT64 {
 
         if (!dataPath.empty()) {
             gamesPath = dataPath / GamesDirectory;
+            cachePath = dataPath / CacheDirectory;
             configurationPath = dataPath / ConfigurationFile;
             imguiPath = dataPath / ImGuiFile;
             logPath = dataPath / LogFile;
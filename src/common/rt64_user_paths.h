@@ -11,6 +11,7 @@ namespace RT64 {
     struct UserPaths {
         std::filesystem::path dataPath;
         std::filesystem::path gamesPath;
+        std::filesystem::path cachePath;
         std::filesystem::path configurationPath;
         std::filesystem::path imguiPath;
         std::filesystem::path logPath;
@@ -0,0 +1,146 @@
+//
+// RT64
+//
+
+#include "rt64_zstd_decompressor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+#include <zstd.h>
+
+namespace RT64 {
+    struct ZstdFrame {
+        size_t srcOffset;
+        size_t srcSize;
+        size_t dstOffset;
+        size_t dstSize;
+    };
+
+    struct ZstdThreadState {
+        ZSTD_DCtx *context = nullptr;
+        std::vector<ZstdFrame> frames;
+
+        ~ZstdThreadState() {
+            ZSTD_freeDCtx(context);
+        }
+    };
+
+    static thread_local ZstdThreadState threadState;
+
+    // Splits the data into its frames. Fails if the size of any frame is not stored in its header or they don't add up to the size
+    // of the destination.
+    static bool findFrames(const uint8_t *srcData, size_t srcSize, size_t dstSize, std::vector<ZstdFrame> &frames) {
+        frames.clear();
+
+        size_t srcOffset = 0;
+        size_t dstOffset = 0;
+        while (srcOffset < srcSize) {
+            const size_t frameSrcSize = ZSTD_findFrameCompressedSize(srcData + srcOffset, srcSize - srcOffset);
+            if (ZSTD_isError(frameSrcSize)) {
+                return false;
+            }
+
+            const unsigned long long frameDstSize = ZSTD_getFrameContentSize(srcData + srcOffset, srcSize - srcOffset);
+            if ((frameDstSize == ZSTD_CONTENTSIZE_UNKNOWN) || (frameDstSize == ZSTD_CONTENTSIZE_ERROR) || (frameDstSize > (dstSize - dstOffset))) {
+                return false;
+            }
+
+            frames.emplace_back(ZstdFrame{ srcOffset, frameSrcSize, dstOffset, size_t(frameDstSize) });
+            srcOffset += frameSrcSize;
+            dstOffset += size_t(frameDstSize);
+        }
+
+        return (dstOffset == dstSize);
+    }
+
+    // ZstdDecompressor
+
+    const size_t ZstdDecompressor::ParallelMinimumSize = 2 * 1024 * 1024;
+    const std::string ZstdDecompressor::DictionaryFilename = "rt64-zstd-dictionary.bin";
+
+    ZstdDecompressor::ZstdDecompressor(uint32_t threadCount) {
+        taskPool = std::make_unique<TaskPool>(threadCount, "RT64 Decompression");
+    }
+
+    ZstdDecompressor::~ZstdDecompressor() { }
+
+    bool ZstdDecompressor::decompress(const uint8_t *srcData, size_t srcSize, uint8_t *dstData, size_t dstSize, const ZSTD_DDict *dictionary) {
+        ZSTD_DCtx *context = getThreadContext();
+        if (context == nullptr) {
+            return false;
+        }
+
+        // Frames compressed without a dictionary must not be decompressed with one, as it'd change the initial state of the decoder.
+        if ((dictionary != nullptr) && (ZSTD_getDictID_fromFrame(srcData, srcSize) == 0)) {
+            dictionary = nullptr;
+        }
+
+        auto decompressWithContext = [dictionary](ZSTD_DCtx *frameContext, uint8_t *frameDstData, size_t frameDstSize, const uint8_t *frameSrcData, size_t frameSrcSize) {
+            if (dictionary != nullptr) {
+                return ZSTD_decompress_usingDDict(frameContext, frameDstData, frameDstSize, frameSrcData, frameSrcSize, dictionary);
+            }
+            else {
+                return ZSTD_decompressDCtx(frameContext, frameDstData, frameDstSize, frameSrcData, frameSrcSize);
+            }
+        };
+
+        // Small files aren't worth the cost of finding the frames and waking up the pool.
+        std::vector<ZstdFrame> &frames = threadState.frames;
+        std::unique_lock<std::mutex> taskPoolLock(taskPoolMutex, std::defer_lock);
+        const bool useTaskPool = (dstSize >= ParallelMinimumSize) && (taskPool->getThreadCount() > 0) && findFrames(srcData, srcSize, dstSize, frames) && (frames.size() > 1) && taskPoolLock.try_lock();
+        if (!useTaskPool) {
+            return decompressWithContext(context, dstData, dstSize, srcData, srcSize) == dstSize;
+        }
+
+        std::atomic<bool> framesFailed(false);
+        taskPool->parallelFor(uint32_t(frames.size()), [&](uint32_t i) {
+            const ZstdFrame &frame = frames[i];
+            ZSTD_DCtx *frameContext = getThreadContext();
+            if ((frameContext == nullptr) || (decompressWithContext(frameContext, dstData + frame.dstOffset, frame.dstSize, srcData + frame.srcOffset, frame.srcSize) != frame.dstSize)) {
+                framesFailed = true;
+            }
+        });
+
+        return !framesFailed;
+    }
+
+    ZstdDecompressor &ZstdDecompressor::get() {
+        // The calling thread takes part in the decompression, so the pool doesn't need a thread for it.
+        static ZstdDecompressor decompressor(std::min(std::max(std::thread::hardware_concurrency(), 2U) / 2U, 4U) - 1U);
+        return decompressor;
+    }
+
+    ZSTD_DCtx *ZstdDecompressor::getThreadContext() {
+        if (threadState.context == nullptr) {
+            threadState.context = ZSTD_createDCtx();
+        }
+
+        return threadState.context;
+    }
+
+    ZSTD_DDict *ZstdDecompressor::loadDictionary(FileSystem *fileSystem) {
+        assert(fileSystem != nullptr);
+
+        std::vector<uint8_t> dictionaryBytes;
+        if (!fileSystem->exists(DictionaryFilename) || !fileSystem->load(DictionaryFilename, dictionaryBytes)) {
+            return nullptr;
+        }
+
+        ZSTD_DDict *dictionary = ZSTD_createDDict(dictionaryBytes.data(), dictionaryBytes.size());
+        if ((dictionary != nullptr) && (ZSTD_getDictID_fromDDict(dictionary) == 0)) {
+            fprintf(stderr, "The zstd dictionary of the pack is invalid.\n");
+            ZSTD_freeDDict(dictionary);
+            dictionary = nullptr;
+        }
+
+        return dictionary;
+    }
+
+    void ZstdDecompressor::freeDictionary(ZSTD_DDict *dictionary) {
+        ZSTD_freeDDict(dictionary);
+    }
+};
@@ -0,0 +1,45 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "rt64_filesystem.h"
+#include "rt64_task_pool.h"
+
+struct ZSTD_DCtx_s;
+struct ZSTD_DDict_s;
+
+namespace RT64 {
+    // Decompresses the zstd data stored in the replacement packs. Every thread reuses its own decompression context, and data made
+    // out of multiple independent frames is decompressed in parallel by a shared task pool. Only one thread can use the pool at a
+    // time, so the others decompress their frames serially instead of waiting for it.
+    //
+    // Packs can also store a dictionary that was used to compress their smallest files. The file system digests it once when it's
+    // opened and all the threads share it, as digested dictionaries are read-only.
+    struct ZstdDecompressor {
+        static const size_t ParallelMinimumSize;
+        static const std::string DictionaryFilename;
+
+        std::unique_ptr<TaskPool> taskPool;
+        std::mutex taskPoolMutex;
+
+        ZstdDecompressor(uint32_t threadCount);
+        ~ZstdDecompressor();
+
+        // Returns false unless the data decompresses to exactly the size of the destination. The dictionary is only used if the data
+        // was compressed with one.
+        bool decompress(const uint8_t *srcData, size_t srcSize, uint8_t *dstData, size_t dstSize, const ZSTD_DDict_s *dictionary = nullptr);
+        static ZstdDecompressor &get();
+        static ZSTD_DCtx_s *getThreadContext();
+
+        // Returns nullptr if the file system doesn't have a dictionary or it's invalid.
+        static ZSTD_DDict_s *loadDictionary(FileSystem *fileSystem);
+        static void freeDictionary(ZSTD_DDict_s *dictionary);
+    };
+};
@@ -1881,6 +1881,20 @@ namespace RT64 {
         d3d->BuildRaytracingAccelerationStructure(&buildDesc, 0, nullptr);
     }
 
+    void D3D12CommandList::resetQueryPool(const RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) {
+        // Query heaps don't need to be reset in D3D12.
+    }
+
+    void D3D12CommandList::writeTimestamp(const RenderQueryPool *queryPool, uint32_t queryIndex) {
+        assert(queryPool != nullptr);
+
+        // Resolve each query as soon as it's written so the readback buffer holds every result once the command list is done.
+        const D3D12QueryPool *interfaceQueryPool = static_cast<const D3D12QueryPool *>(queryPool);
+        const D3D12Buffer *interfaceReadbackBuffer = static_cast<const D3D12Buffer *>(interfaceQueryPool->readbackBuffer.get());
+        d3d->EndQuery(interfaceQueryPool->d3d, D3D12_QUERY_TYPE_TIMESTAMP, queryIndex);
+        d3d->ResolveQueryData(interfaceQueryPool->d3d, D3D12_QUERY_TYPE_TIMESTAMP, queryIndex, 1, interfaceReadbackBuffer->d3d, sizeof(uint64_t) * queryIndex);
+    }
+
     void D3D12CommandList::checkDescriptorHeaps() {
         if (!descriptorHeapsSet) {
             d3d->SetDescriptorHeaps(1, &device->descriptorHeapAllocator->shaderHeap);
@@ -2049,6 +2063,14 @@ namespace RT64 {
             fprintf(stderr, "CreateCommandQueue failed with error code 0x%lX.\n", res);
             return;
         }
+
+        // Timestamp frequency is only exposed through the queues. Store the one from the first direct queue for converting query results.
+        if ((type == RenderCommandListType::DIRECT) && (device->timestampFrequency == 0)) {
+            UINT64 frequency = 0;
+            if (SUCCEEDED(d3d->GetTimestampFrequency(&frequency))) {
+                device->timestampFrequency = frequency;
+            }
+        }
     }
 
     D3D12CommandQueue::~D3D12CommandQueue() {
@@ -2435,6 +2457,139 @@ namespace RT64 {
         return std::make_unique<D3D12Texture>(device, this, desc);
     }
 
+    // D3D12QueryPool
+
+    D3D12QueryPool::D3D12QueryPool(D3D12Device *device, uint32_t queryCount) {
+        assert(device != nullptr);
+        assert(queryCount > 0);
+
+        this->device = device;
+
+        D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+        queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+        queryHeapDesc.Count = queryCount;
+
+        HRESULT res = device->d3d->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&d3d));
+        if (FAILED(res)) {
+            fprintf(stderr, "CreateQueryHeap failed with error code 0x%lX.\n", res);
+            return;
+        }
+
+        readbackBuffer = device->createBuffer(RenderBufferDesc::ReadbackBuffer(sizeof(uint64_t) * queryCount));
+        results.resize(queryCount, 0);
+    }
+
+    D3D12QueryPool::~D3D12QueryPool() {
+        if (d3d != nullptr) {
+            d3d->Release();
+        }
+    }
+
+    void D3D12QueryPool::queryResults() {
+        if ((d3d == nullptr) || (device->timestampFrequency == 0)) {
+            return;
+        }
+
+        const RenderRange readRange(0, sizeof(uint64_t) * results.size());
+        const uint64_t *readbackData = reinterpret_cast<const uint64_t *>(readbackBuffer->map(0, &readRange));
+        if (readbackData == nullptr) {
+            return;
+        }
+
+        const double nanosecondsPerTick = 1000000000.0 / double(device->timestampFrequency);
+        for (size_t i = 0; i < results.size(); i++) {
+            results[i] = uint64_t(double(readbackData[i]) * nanosecondsPerTick);
+        }
+
+        const RenderRange writtenRange(0, 0);
+        readbackBuffer->unmap(0, &writtenRange);
+    }
+
+    const uint64_t *D3D12QueryPool::getResults() const {
+        return results.data();
+    }
+
+    uint32_t D3D12QueryPool::getCount() const {
+        return uint32_t(results.size());
+    }
+
+    // D3D12PipelineCache
+
+    D3D12PipelineCache::D3D12PipelineCache(D3D12Device *device, const void *data, uint64_t size) {
+        assert(device != nullptr);
+
+        this->device = device;
+
+        // The library references the serialized data directly, so it must be kept alive for as long as the library exists.
+        if ((data != nullptr) && (size > 0)) {
+            const uint8_t *dataBytes = reinterpret_cast<const uint8_t *>(data);
+            libraryData = std::vector<uint8_t>(dataBytes, dataBytes + size);
+        }
+
+        HRESULT res = device->d3d->CreatePipelineLibrary(libraryData.data(), libraryData.size(), IID_PPV_ARGS(&d3d));
+        if (FAILED(res) && !libraryData.empty()) {
+            // The data was created by a different adapter or driver version. Start with an empty library instead.
+            libraryData.clear();
+            res = device->d3d->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&d3d));
+        }
+
+        if (FAILED(res)) {
+            fprintf(stderr, "CreatePipelineLibrary failed with error code 0x%lX.\n", res);
+            return;
+        }
+    }
+
+    D3D12PipelineCache::~D3D12PipelineCache() {
+        if (d3d != nullptr) {
+            d3d->Release();
+        }
+    }
+
+    bool D3D12PipelineCache::getData(std::vector<uint8_t> &data) {
+        if (d3d == nullptr) {
+            return false;
+        }
+
+        const std::scoped_lock<std::mutex> libraryLock(libraryMutex);
+        data.resize(d3d->GetSerializedSize());
+        HRESULT res = d3d->Serialize(data.data(), data.size());
+        if (FAILED(res)) {
+            fprintf(stderr, "ID3D12PipelineLibrary::Serialize failed with error code 0x%lX.\n", res);
+            return false;
+        }
+
+        return true;
+    }
+
+    ID3D12PipelineState *D3D12PipelineCache::loadGraphicsPipeline(uint64_t key, const D3D12_GRAPHICS_PIPELINE_STATE_DESC &psoDesc) {
+        if (d3d == nullptr) {
+            return nullptr;
+        }
+
+        // Loading fails with E_INVALIDARG if the name is not in the library or the description doesn't match the stored one.
+        ID3D12PipelineState *pipelineState = nullptr;
+        const std::wstring name = keyToName(key);
+        HRESULT res = d3d->LoadGraphicsPipeline(name.c_str(), &psoDesc, IID_PPV_ARGS(&pipelineState));
+        return SUCCEEDED(res) ? pipelineState : nullptr;
+    }
+
+    void D3D12PipelineCache::storePipeline(uint64_t key, ID3D12PipelineState *pipelineState) {
+        if ((d3d == nullptr) || (pipelineState == nullptr)) {
+            return;
+        }
+
+        // Storing can fail if another thread stored the same name first, which is not an error.
+        const std::scoped_lock<std::mutex> libraryLock(libraryMutex);
+        const std::wstring name = keyToName(key);
+        d3d->StorePipeline(name.c_str(), pipelineState);
+    }
+
+    std::wstring D3D12PipelineCache::keyToName(uint64_t key) {
+        wchar_t name[17];
+        swprintf(name, std::size(name), L"%016llX", (unsigned long long)(key));
+        return std::wstring(name);
+    }
+
     // D3D12Shader
 
     D3D12Shader::D3D12Shader(D3D12Device *device, const void *data, uint64_t size, const char *entryPointName, RenderShaderFormat format) {
@@ -2636,7 +2791,20 @@ namespace RT64 {
 
         psoDesc.InputLayout = { inputElements.data(), UINT(inputElements.size()) };
 
+        // Try to load the pipeline from the cache first and store it if it wasn't found.
+        D3D12PipelineCache *pipelineCache = static_cast<D3D12PipelineCache *>(desc.pipelineCache);
+        if (pipelineCache != nullptr) {
+            d3d = pipelineCache->loadGraphicsPipeline(desc.pipelineCacheKey, psoDesc);
+            if (d3d != nullptr) {
+                return;
+            }
+        }
+
         device->d3d->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&d3d));
+
+        if (pipelineCache != nullptr) {
+            pipelineCache->storePipeline(desc.pipelineCacheKey, d3d);
+        }
     }
 
     D3D12GraphicsPipeline::~D3D12GraphicsPipeline() {
@@ -3086,8 +3254,15 @@ namespace RT64 {
                 capabilities.raytracingStateUpdate = rtStateUpdateSupportOption;
                 capabilities.sampleLocations = samplePositionsOption;
                 description.name = win32::Utf16ToUtf8(adapterDesc.Description);
+                description.vendorId = adapterDesc.VendorId;
+                description.deviceId = adapterDesc.DeviceId;
                 description.dedicatedVideoMemory = adapterDesc.DedicatedVideoMemory;
 
+                LARGE_INTEGER umdVersion = {};
+                if (SUCCEEDED(adapterOption->CheckInterfaceSupport(__uuidof(IDXGIDevice), &umdVersion))) {
+                    description.driverVersion = uint64_t(umdVersion.QuadPart);
+                }
+
                 if (preferUserChoice) {
                     break;
                 }
@@ -3163,6 +3338,7 @@ namespace RT64 {
         capabilities.scalarBlockLayout = true;
         capabilities.presentWait = true;
         capabilities.preferHDR = description.dedicatedVideoMemory > (512 * 1024 * 1024);
+        capabilities.timestampQueries = true;
 
         // Create descriptor heaps allocator.
         descriptorHeapAllocator = std::make_unique<D3D12DescriptorHeapAllocator>(this, ShaderDescriptorHeapSize, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
@@ -3241,6 +3417,14 @@ namespace RT64 {
         return std::make_unique<D3D12Framebuffer>(this, desc);
     }
 
+    std::unique_ptr<RenderQueryPool> D3D12Device::createQueryPool(uint32_t queryCount) {
+        return std::make_unique<D3D12QueryPool>(this, queryCount);
+    }
+
+    std::unique_ptr<RenderPipelineCache> D3D12Device::createPipelineCache(const void *data, uint64_t size) {
+        return std::make_unique<D3D12PipelineCache>(this, data, size);
+    }
+
     void D3D12Device::setBottomLevelASBuildInfo(RenderBottomLevelASBuildInfo &buildInfo, const RenderBottomLevelASMesh *meshes, uint32_t meshCount, bool preferFastBuild, bool preferFastTrace) {
         assert(meshes != nullptr);
         assert(meshCount > 0);
@@ -6,6 +6,7 @@
 
 #include "rhi/rt64_render_interface.h"
 
+#include <atomic>
 #include <map>
 #include <mutex>
 #include <unordered_map>
@@ -184,6 +185,8 @@ namespace RT64 {
         void resolveTextureRegion(const RenderTexture *dstTexture, uint32_t dstX, uint32_t dstY, const RenderTexture *srcTexture, const RenderRect *srcRect) override;
         void buildBottomLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, const RenderBottomLevelASBuildInfo &buildInfo) override;
         void buildTopLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, RenderBufferReference instancesBuffer, const RenderTopLevelASBuildInfo &buildInfo) override;
+        void resetQueryPool(const RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) override;
+        void writeTimestamp(const RenderQueryPool *queryPool, uint32_t queryIndex) override;
         void checkDescriptorHeaps();
         void notifyDescriptorHeapWasChangedExternally();
         void checkTopology();
@@ -304,6 +307,33 @@ namespace RT64 {
         std::unique_ptr<RenderTexture> createTexture(const RenderTextureDesc &desc) override;
     };
 
+    struct D3D12PipelineCache : RenderPipelineCache {
+        ID3D12PipelineLibrary *d3d = nullptr;
+        std::vector<uint8_t> libraryData;
+        std::mutex libraryMutex;
+        D3D12Device *device = nullptr;
+
+        D3D12PipelineCache(D3D12Device *device, const void *data, uint64_t size);
+        ~D3D12PipelineCache() override;
+        bool getData(std::vector<uint8_t> &data) override;
+        ID3D12PipelineState *loadGraphicsPipeline(uint64_t key, const D3D12_GRAPHICS_PIPELINE_STATE_DESC &psoDesc);
+        void storePipeline(uint64_t key, ID3D12PipelineState *pipelineState);
+        static std::wstring keyToName(uint64_t key);
+    };
+
+    struct D3D12QueryPool : RenderQueryPool {
+        ID3D12QueryHeap *d3d = nullptr;
+        D3D12Device *device = nullptr;
+        std::unique_ptr<RenderBuffer> readbackBuffer;
+        std::vector<uint64_t> results;
+
+        D3D12QueryPool(D3D12Device *device, uint32_t queryCount);
+        ~D3D12QueryPool() override;
+        void queryResults() override;
+        const uint64_t *getResults() const override;
+        uint32_t getCount() const override;
+    };
+
     struct D3D12Shader : RenderShader {
         std::vector<uint8_t> d3d;
         std::string entryPointName;
@@ -392,6 +422,7 @@ namespace RT64 {
         std::unique_ptr<D3D12DescriptorHeapAllocator> depthTargetHeapAllocator;
         RenderDeviceCapabilities capabilities;
         RenderDeviceDescription description;
+        std::atomic<uint64_t> timestampFrequency = 0;
 
         D3D12Device(D3D12Interface *renderInterface);
         ~D3D12Device() override;
@@ -411,6 +442,8 @@ namespace RT64 {
         std::unique_ptr<RenderCommandFence> createCommandFence() override;
         std::unique_ptr<RenderCommandSemaphore> createCommandSemaphore() override;
         std::unique_ptr<RenderFramebuffer> createFramebuffer(const RenderFramebufferDesc &desc) override;
+        std::unique_ptr<RenderPipelineCache> createPipelineCache(const void *data, uint64_t size) override;
+        std::unique_ptr<RenderQueryPool> createQueryPool(uint32_t queryCount) override;
         void setBottomLevelASBuildInfo(RenderBottomLevelASBuildInfo &buildInfo, const RenderBottomLevelASMesh *meshes, uint32_t meshCount, bool preferFastBuild, bool preferFastTrace) override;
         void setTopLevelASBuildInfo(RenderTopLevelASBuildInfo &buildInfo, const RenderTopLevelASInstance *instances, uint32_t instanceCount, bool preferFastBuild, bool preferFastTrace) override;
         void setShaderBindingTableInfo(RenderShaderBindingTableInfo &tableInfo, const RenderShaderBindingGroups &groups, const RenderPipeline *pipeline, RenderDescriptorSet **descriptorSets, uint32_t descriptorSetCount) override;
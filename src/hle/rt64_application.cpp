@@ -23,6 +23,7 @@ namespace RT64 {
 
     extern std::unique_ptr<RenderInterface> CreateD3D12Interface();
     extern std::unique_ptr<RenderInterface> CreateVulkanInterface();
+    extern std::unique_ptr<RenderInterface> CreateNullInterface();
 
     // Application::Core
 
@@ -111,13 +112,14 @@ namespace RT64 {
         }
 #   endif
 
-        // Create the application window.
+        // Create the application window. The null render interface doesn't need one unless the core provides it,
+        // so the window is left without a handle and the null swap chain provides the refresh rate instead.
         const char *windowTitle = "RT64";
         appWindow = std::make_unique<ApplicationWindow>();
         if (core.window != RenderWindow{}) {
             appWindow->setup(core.window, this, threadId);
         }
-        else {
+        else if (!appConfig.useNullRenderInterface) {
             appWindow->setup(windowTitle, this);
         }
 
@@ -125,21 +127,26 @@ namespace RT64 {
         appWindow->detectRefreshRate();
         
         // Create a render interface with the preferred backend.
-        switch (userConfig.graphicsAPI) {
-        case UserConfiguration::GraphicsAPI::D3D12:
-#       ifdef _WIN64
-            renderInterface = CreateD3D12Interface();
-            break;
-#       else
-            fprintf(stderr, "D3D12 is not supported on this platform. Please select a different Graphics API.\n");
-            return SetupResult::InvalidGraphicsAPI;
-#       endif
-        case UserConfiguration::GraphicsAPI::Vulkan:
-            renderInterface = CreateVulkanInterface();
-            break;
-        default:
-            fprintf(stderr, "Unknown Graphics API specified in configuration.\n");
-            return SetupResult::InvalidGraphicsAPI;
+        if (appConfig.useNullRenderInterface) {
+            renderInterface = CreateNullInterface();
+        }
+        else {
+            switch (userConfig.graphicsAPI) {
+            case UserConfiguration::GraphicsAPI::D3D12:
+#           ifdef _WIN64
+                renderInterface = CreateD3D12Interface();
+                break;
+#           else
+                fprintf(stderr, "D3D12 is not supported on this platform. Please select a different Graphics API.\n");
+                return SetupResult::InvalidGraphicsAPI;
+#           endif
+            case UserConfiguration::GraphicsAPI::Vulkan:
+                renderInterface = CreateVulkanInterface();
+                break;
+            default:
+                fprintf(stderr, "Unknown Graphics API specified in configuration.\n");
+                return SetupResult::InvalidGraphicsAPI;
+            }
         }
 
         if (renderInterface == nullptr) {
@@ -160,7 +167,7 @@ namespace RT64 {
         //
         // Wireframe artifacts have been reported when using a high-precision color format on RDNA3 GPUs in D3D12. The workaround is to switch to Vulkan if this is the case.
         bool isRDNA3 = device->getDescription().name.find("AMD Radeon RX 7") != std::string::npos;
-        bool useHDRinD3D12 = (userConfig.graphicsAPI == UserConfiguration::GraphicsAPI::D3D12) && (userConfig.internalColorFormat == UserConfiguration::InternalColorFormat::Automatic) && device->getCapabilities().preferHDR;
+        bool useHDRinD3D12 = !appConfig.useNullRenderInterface && (userConfig.graphicsAPI == UserConfiguration::GraphicsAPI::D3D12) && (userConfig.internalColorFormat == UserConfiguration::InternalColorFormat::Automatic) && device->getCapabilities().preferHDR;
         if (isRDNA3 && useHDRinD3D12) {
             device.reset();
             renderInterface.reset();
@@ -197,7 +204,18 @@ namespace RT64 {
         textureCopyWorker = std::make_unique<RenderWorker>(device.get(), "Texture Copy", RenderCommandListType::COPY);
         workloadGraphicsWorker = std::make_unique<RenderWorker>(device.get(), "Workload Graphics", RenderCommandListType::DIRECT);
         presentGraphicsWorker = std::make_unique<RenderWorker>(device.get(), "Present Graphics", RenderCommandListType::DIRECT);
+
+        // Measure the GPU time of the passes recorded by the workers that support it.
+        gpuProfiler = std::make_unique<GPUProfiler>();
+        framebufferGraphicsWorker->setProfiler(gpuProfiler.get());
+        textureDirectWorker->setProfiler(gpuProfiler.get());
+        workloadGraphicsWorker->setProfiler(gpuProfiler.get());
+        presentGraphicsWorker->setProfiler(gpuProfiler.get());
+
         swapChain = presentGraphicsWorker->commandQueue->createSwapChain(appWindow->windowHandle, 2, RenderFormat::B8G8R8A8_UNORM);
+        if (!appWindow->hasWindow()) {
+            appWindow->refreshRate = swapChain->getRefreshRate();
+        }
 
         // Detect if the application should use HDR framebuffers or not.
         bool usesHDR;
@@ -228,10 +246,16 @@ namespace RT64 {
         shaderLibrary->setupCommonShaders(renderInterface.get(), device.get());
         shaderLibrary->setupMultisamplingShaders(renderInterface.get(), device.get(), multisampling);
         
+        // Pipelines created by the driver are persisted in the cache directory so they don't need to be recompiled in the next session.
+        std::filesystem::path pipelineStorePath;
+        if (!userPaths.isEmpty() && checkDirectoryCreated(userPaths.cachePath)) {
+            pipelineStorePath = userPaths.cachePath / ((createdGraphicsAPI == UserConfiguration::GraphicsAPI::D3D12) ? "pipelines-d3d12.bin" : "pipelines-vulkan.bin");
+        }
+
         // Create the shader caches. Estimate the amount of shader compiler threads by trying to use about half of the system's available threads.
         const uint32_t rasterShaderThreads = std::max(threadsAvailable / 2U, 1U);
         rasterShaderCache = std::make_unique<RasterShaderCache>(rasterShaderThreads);
-        rasterShaderCache->setup(device.get(), renderInterface->getCapabilities().shaderFormat, shaderLibrary.get(), multisampling);
+        rasterShaderCache->setup(device.get(), renderInterface->getCapabilities().shaderFormat, shaderLibrary.get(), multisampling, pipelineStorePath);
 
 #   if RT_ENABLED
         if (device->getCapabilities().raytracing) {
@@ -323,6 +347,7 @@ namespace RT64 {
         stateExt.userConfig = &userConfig;
         stateExt.dlApiProfiler = &dlApiProfiler;
         stateExt.screenApiProfiler = &screenApiProfiler;
+        stateExt.gpuProfiler = gpuProfiler.get();
         stateExt.createdGraphicsAPI = createdGraphicsAPI;
 #   if RT_ENABLED
         stateExt.rtConfig = &rtConfig;
@@ -355,6 +380,17 @@ namespace RT64 {
             DisplayList *dlStart = reinterpret_cast<DisplayList *>(&memory[dlStartAddress]);
             DisplayList *dlEnd = (dlEndAddress > 0) ? reinterpret_cast<RT64::DisplayList *>(&memory[dlEndAddress]) : nullptr;
 
+            // The writer is kept in a local as the inspector can only queue the capture to stop after the display lists are done.
+            DisplayListCapture::Writer *activeCaptureWriter = captureWriter.get();
+            if (activeCaptureWriter != nullptr) {
+                DisplayListCapture::DisplayListsEvent captureEvent = {};
+                captureEvent.dlStartAddress = dlStartAddress;
+                captureEvent.dlEndAddress = dlEndAddress;
+                captureEvent.isHLE = isHLE;
+                captureEvent.fromDMEM = (memory == core.DMEM);
+                activeCaptureWriter->beginDisplayLists(core.RDRAM, core.DMEM, captureEvent);
+            }
+
 #       if SCRIPT_ENABLED
             if (currentScript != nullptr) {
                 currentScript->processDisplayLists(reinterpret_cast<uint64_t *>(dlStart), reinterpret_cast<uint64_t *>(dlEnd));
@@ -367,6 +403,10 @@ namespace RT64 {
             else {
                 interpreter->processRDPLists(dlStartAddress, dlStart, dlEnd);
             }
+
+            if (activeCaptureWriter != nullptr) {
+                activeCaptureWriter->endDisplayLists();
+            }
         }
 
         if (isHLE) {
@@ -384,17 +424,115 @@ namespace RT64 {
             saveConfiguration();
             state->configurationSaveQueued = false;
         }
+
+        if (state->captureToggleQueued) {
+            if (captureWriter != nullptr) {
+                stopCapture();
+            }
+            else {
+                startCapture(state->captureQueuedPath);
+            }
+
+            state->captureToggleQueued = false;
+        }
     }
     
     void Application::updateScreen() {
         screenApiProfiler.logAndRestart();
+
+        if (captureWriter != nullptr) {
+            DisplayListCapture::UpdateScreenEvent captureEvent;
+            captureEvent.status = *core.VI_STATUS_REG;
+            captureEvent.origin = *core.VI_ORIGIN_REG;
+            captureEvent.width = *core.VI_WIDTH_REG;
+            captureEvent.intr = *core.VI_INTR_REG;
+            captureEvent.vCurrentLine = *core.VI_V_CURRENT_LINE_REG;
+            captureEvent.timing = *core.VI_TIMING_REG;
+            captureEvent.vSync = *core.VI_V_SYNC_REG;
+            captureEvent.hSync = *core.VI_H_SYNC_REG;
+            captureEvent.leap = *core.VI_LEAP_REG;
+            captureEvent.hStart = *core.VI_H_START_REG;
+            captureEvent.vStart = *core.VI_V_START_REG;
+            captureEvent.vBurst = *core.VI_V_BURST_REG;
+            captureEvent.xScale = *core.VI_X_SCALE_REG;
+            captureEvent.yScale = *core.VI_Y_SCALE_REG;
+            captureWriter->recordUpdateScreen(core.RDRAM, captureEvent);
+        }
+
         state->updateScreen(core.decodeVI(), false);
+        rasterShaderCache->advanceFrame();
     }
 
     bool Application::loadOfflineShaderCache(std::istream &stream) {
         return rasterShaderCache->loadOfflineList(stream);
     }
 
+    bool Application::loadOfflineShaderUsage(std::istream &stream) {
+        return rasterShaderCache->loadOfflineUsage(stream);
+    }
+
+    bool Application::loadOfflineShaderCache(const std::filesystem::path &path) {
+        // The usage recorded while the cache was dumped is stored next to it. It's loaded first so the list is sorted as soon as it's loaded.
+        std::filesystem::path usagePath = path;
+        usagePath.replace_extension(".usage");
+        std::ifstream usageStream(usagePath, std::ios::binary);
+        if (usageStream.is_open() && !loadOfflineShaderUsage(usageStream)) {
+            const std::string usagePathStr = usagePath.u8string();
+            fprintf(stderr, "Failed to load the shader usage from %s.\n", usagePathStr.c_str());
+        }
+
+        std::ifstream listStream(path, std::ios::binary);
+        if (!listStream.is_open()) {
+            const std::string pathStr = path.u8string();
+            fprintf(stderr, "Failed to open the offline shader cache %s.\n", pathStr.c_str());
+            return false;
+        }
+
+        return loadOfflineShaderCache(listStream);
+    }
+
+    bool Application::startCapture(const std::filesystem::path &path) {
+        stopCapture();
+
+        captureWriter = std::make_unique<DisplayListCapture::Writer>();
+        if (!captureWriter->open(path)) {
+            captureWriter.reset();
+            return false;
+        }
+
+        // Store the microcode that is currently loaded so the replay can start from it.
+        if (interpreter->hleGBI != nullptr) {
+            captureWriter->recordLoadUCode(interpreter->UCode.textAddress, interpreter->UCode.dataAddress, true);
+        }
+
+        interpreter->captureWriter = captureWriter.get();
+        return true;
+    }
+
+    void Application::stopCapture() {
+        if (interpreter != nullptr) {
+            interpreter->captureWriter = nullptr;
+        }
+
+        captureWriter.reset();
+    }
+
+    void Application::setRDRAMWriteTracking(bool enabled) {
+        state->framebufferManager.setRAMWriteTracking(enabled);
+    }
+
+    void Application::notifyRDRAMWrite(uint32_t address, uint32_t size) {
+        // Must be called from the same thread that processes the display lists. All writes the emulator does to RDRAM must be reported
+        // while tracking is enabled, as framebuffer contents that aren't reported as written won't be hashed again.
+        state->framebufferManager.trackRAMWrite(address, size);
+    }
+
+    void Application::flushRDRAMWriteback(uint32_t address, uint32_t size) {
+        // Must be called from the same thread that processes the display lists before the emulator reads from RDRAM
+        // while asynchronous writeback is enabled, as the results of render to RAM might not be written back yet.
+        state->flushRDRAMWriteback(address, address + size);
+    }
+
     void Application::destroyShaderCache() {
         workloadQueue->waitForWorkloadId(state->workloadId);
         presentQueue->waitForPresentId(state->presentId);
@@ -496,12 +634,19 @@ namespace RT64 {
 #endif
 
     void Application::end() {
+        stopCapture();
+
 #   if SCRIPT_ENABLED
         if (currentScript != nullptr) {
             currentScript->finalize();
         }
 #   endif
 
+        // Any GPU work of a deferred writeback must be finished before the resources it uses are destroyed.
+        if (workloadQueue != nullptr) {
+            workloadQueue->rdramWriteback.waitForGPU();
+        }
+
         state.reset();
         workloadQueue.reset();
         presentQueue.reset();
@@ -531,6 +676,7 @@ namespace RT64 {
         swapChain.reset();
         workloadGraphicsWorker.reset();
         presentGraphicsWorker.reset();
+        gpuProfiler.reset();
         shaderLibrary.reset();
         device.reset();
         renderInterface.reset();
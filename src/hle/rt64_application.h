@@ -23,6 +23,7 @@
 #include "rhi/rt64_render_interface.h"
 
 #include "rt64_application_window.h"
+#include "rt64_display_list_capture.h"
 #include "rt64_interpreter.h"
 #include "rt64_shared_queue_resources.h"
 
@@ -40,6 +41,10 @@ namespace RT64 {
         std::filesystem::path dataPath;
         bool detectDataPath = true;
         bool useConfigurationFile = true;
+
+        // Skips the configured graphics API and uses a backend that doesn't submit anything to a GPU. Only useful for profiling
+        // the CPU side of the renderer.
+        bool useNullRenderInterface = false;
     };
 
     struct Application : public ApplicationWindow::Listener {
@@ -131,6 +136,8 @@ namespace RT64 {
         uint32_t threadsAvailable;
         ProfilingTimer dlApiProfiler = ProfilingTimer(120);
         ProfilingTimer screenApiProfiler = ProfilingTimer(120);
+        std::unique_ptr<GPUProfiler> gpuProfiler;
+        std::unique_ptr<DisplayListCapture::Writer> captureWriter;
         bool wineDetected;
 
 #   if RT_ENABLED
@@ -151,6 +158,13 @@ namespace RT64 {
         void processDisplayLists(uint8_t *memory, uint32_t dlStartAddress, uint32_t dlEndAddress, bool isHLE);
         void updateScreen();
         bool loadOfflineShaderCache(std::istream &stream);
+        bool loadOfflineShaderUsage(std::istream &stream);
+        bool loadOfflineShaderCache(const std::filesystem::path &path);
+        void setRDRAMWriteTracking(bool enabled);
+        void notifyRDRAMWrite(uint32_t address, uint32_t size);
+        void flushRDRAMWriteback(uint32_t address, uint32_t size);
+        bool startCapture(const std::filesystem::path &path);
+        void stopCapture();
         void destroyShaderCache();
         void updateMultisampling();
         void end();
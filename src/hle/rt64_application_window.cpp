@@ -145,7 +145,7 @@ namespace RT64 {
     }
 
     void ApplicationWindow::setFullScreen(bool newFullScreen) {
-        if (newFullScreen == fullScreen) {
+        if ((newFullScreen == fullScreen) || !hasWindow()) {
             return;
         }
 
@@ -204,6 +204,10 @@ namespace RT64 {
     }
     
     void ApplicationWindow::makeResizable() {
+        if (!hasWindow()) {
+            return;
+        }
+
 #   ifdef _WIN32
         LONG_PTR lStyle = GetWindowLongPtr(windowHandle, GWL_STYLE);
         windowMenu = GetMenu(windowHandle);
@@ -213,6 +217,10 @@ namespace RT64 {
     }
 
     void ApplicationWindow::detectRefreshRate() {
+        if (!hasWindow()) {
+            return;
+        }
+
 #   if defined(_WIN32)
         HMONITOR monitor = MonitorFromWindow(windowHandle, MONITOR_DEFAULTTONEAREST);
         MONITORINFOEX info = {};
@@ -280,6 +288,10 @@ namespace RT64 {
     }
 
     bool ApplicationWindow::detectWindowMoved() {
+        if (!hasWindow()) {
+            return false;
+        }
+
         int32_t newWindowLeft = INT32_MAX;
         int32_t newWindowTop = INT32_MAX;
 
@@ -305,6 +317,10 @@ namespace RT64 {
         }
     }
 
+    bool ApplicationWindow::hasWindow() const {
+        return windowHandle != RenderWindow{};
+    }
+
 #   ifdef _WIN32
     void ApplicationWindow::windowMessage(UINT message, WPARAM wParam, LPARAM lParam) {
         if (listener->windowMessageFilter(message, wParam, lParam)) {
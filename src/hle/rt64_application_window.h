@@ -54,6 +54,7 @@ namespace RT64 {
         void detectRefreshRate();
         uint32_t getRefreshRate() const;
         bool detectWindowMoved();
+        bool hasWindow() const;
 
 #   ifdef _WIN32
         void windowMessage(UINT message, WPARAM wParam, LPARAM lParam);
@@ -0,0 +1,307 @@
+//
+// RT64
+//
+
+#include "rt64_display_list_capture.h"
+
+#include <cassert>
+#include <cstring>
+
+#include <zstd.h>
+
+namespace RT64 {
+    // DisplayListCapture::Writer
+
+    const int DisplayListCapture::Writer::CompressionLevel = 3;
+    const size_t DisplayListCapture::Writer::FlushThreshold = 4 * 1024 * 1024;
+
+    DisplayListCapture::Writer::Writer() { }
+
+    DisplayListCapture::Writer::~Writer() {
+        close();
+    }
+
+    bool DisplayListCapture::Writer::open(const std::filesystem::path &path) {
+        close();
+
+        stream.open(path, std::ios::binary);
+        if (!stream.is_open()) {
+            const std::string u8string = path.u8string();
+            fprintf(stderr, "Failed to open display list capture at %s.\n", u8string.c_str());
+            return false;
+        }
+
+        FileHeader header = {};
+        memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        header.rdramSize = RDRAMSize;
+        header.pageSize = PageSize;
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        context = ZSTD_createCCtx();
+        ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, CompressionLevel);
+        compressedBytes.resize(ZSTD_CStreamOutSize());
+
+        // The shadow copy starts out empty, so the first event will store every page that isn't zero.
+        shadowRDRAM.clear();
+        shadowRDRAM.resize(RDRAMSize, 0);
+        pendingBytes.clear();
+        nestingDepth = 0;
+        eventCount = 0;
+        pageCount = 0;
+        uncompressedSize = 0;
+        compressedSize = sizeof(header);
+        return true;
+    }
+
+    void DisplayListCapture::Writer::close() {
+        if (!stream.is_open()) {
+            return;
+        }
+
+        compressPending(true);
+        ZSTD_freeCCtx(context);
+        context = nullptr;
+        stream.close();
+        shadowRDRAM.clear();
+        shadowRDRAM.shrink_to_fit();
+    }
+
+    bool DisplayListCapture::Writer::isOpen() const {
+        return stream.is_open();
+    }
+
+    void DisplayListCapture::Writer::recordLoadUCode(uint32_t textAddress, uint32_t dataAddress, bool resetFromTask) {
+        assert(isOpen());
+
+        LoadUCodeEvent event = {};
+        event.textAddress = textAddress;
+        event.dataAddress = dataAddress;
+        event.resetFromTask = resetFromTask;
+        event.nested = (nestingDepth > 0);
+        writeEventHeader(EventType::LoadUCode, sizeof(event));
+        writeBytes(&event, sizeof(event));
+        finishEvent();
+    }
+
+    void DisplayListCapture::Writer::beginDisplayLists(const uint8_t *RDRAM, const uint8_t *DMEM, const DisplayListsEvent &event) {
+        assert(isOpen());
+        assert(!event.fromDMEM || (DMEM != nullptr));
+
+        recordRDRAM(RDRAM);
+
+        const uint32_t dmemSize = event.fromDMEM ? DMEMSize : 0;
+        writeEventHeader(EventType::DisplayLists, sizeof(event) + dmemSize);
+        writeBytes(&event, sizeof(event));
+        writeBytes(DMEM, dmemSize);
+        finishEvent();
+        nestingDepth++;
+    }
+
+    void DisplayListCapture::Writer::endDisplayLists() {
+        if (nestingDepth > 0) {
+            nestingDepth--;
+        }
+    }
+
+    void DisplayListCapture::Writer::recordUpdateScreen(const uint8_t *RDRAM, const UpdateScreenEvent &event) {
+        assert(isOpen());
+
+        recordRDRAM(RDRAM);
+        writeEventHeader(EventType::UpdateScreen, sizeof(event));
+        writeBytes(&event, sizeof(event));
+        finishEvent();
+    }
+
+    void DisplayListCapture::Writer::recordRDRAM(const uint8_t *RDRAM) {
+        assert(RDRAM != nullptr);
+
+        dirtyPages.clear();
+        for (uint32_t p = 0; p < (RDRAMSize / PageSize); p++) {
+            const uint32_t pageOffset = p * PageSize;
+            if (memcmp(&shadowRDRAM[pageOffset], &RDRAM[pageOffset], PageSize) != 0) {
+                memcpy(&shadowRDRAM[pageOffset], &RDRAM[pageOffset], PageSize);
+                dirtyPages.emplace_back(p);
+            }
+        }
+
+        if (dirtyPages.empty()) {
+            return;
+        }
+
+        writeEventHeader(EventType::RDRAMPages, uint32_t(dirtyPages.size() * (sizeof(uint32_t) + PageSize)));
+        for (uint32_t p : dirtyPages) {
+            writeBytes(&p, sizeof(uint32_t));
+            writeBytes(&shadowRDRAM[p * PageSize], PageSize);
+        }
+
+        pageCount += dirtyPages.size();
+        finishEvent();
+    }
+
+    void DisplayListCapture::Writer::writeEventHeader(EventType type, uint32_t size) {
+        EventHeader eventHeader;
+        eventHeader.type = type;
+        eventHeader.size = size;
+        writeBytes(&eventHeader, sizeof(eventHeader));
+    }
+
+    void DisplayListCapture::Writer::writeBytes(const void *data, size_t size) {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+        pendingBytes.insert(pendingBytes.end(), bytes, bytes + size);
+        uncompressedSize += size;
+    }
+
+    void DisplayListCapture::Writer::finishEvent() {
+        eventCount++;
+
+        if (pendingBytes.size() >= FlushThreshold) {
+            compressPending(false);
+        }
+    }
+
+    bool DisplayListCapture::Writer::compressPending(bool endFrame) {
+        const ZSTD_EndDirective endDirective = endFrame ? ZSTD_e_end : ZSTD_e_continue;
+        ZSTD_inBuffer inBuffer = { pendingBytes.data(), pendingBytes.size(), 0 };
+        bool finished = false;
+        while (!finished) {
+            ZSTD_outBuffer outBuffer = { compressedBytes.data(), compressedBytes.size(), 0 };
+            const size_t remaining = ZSTD_compressStream2(context, &outBuffer, &inBuffer, endDirective);
+            if (ZSTD_isError(remaining)) {
+                fprintf(stderr, "Failed to compress display list capture: %s.\n", ZSTD_getErrorName(remaining));
+                pendingBytes.clear();
+                return false;
+            }
+
+            stream.write(reinterpret_cast<const char *>(compressedBytes.data()), outBuffer.pos);
+            compressedSize += outBuffer.pos;
+            finished = endFrame ? (remaining == 0) : (inBuffer.pos == inBuffer.size);
+        }
+
+        pendingBytes.clear();
+        return true;
+    }
+
+    // DisplayListCapture::Reader
+
+    DisplayListCapture::Reader::Reader() { }
+
+    DisplayListCapture::Reader::~Reader() {
+        close();
+    }
+
+    bool DisplayListCapture::Reader::open(const std::filesystem::path &path) {
+        close();
+
+        stream.open(path, std::ios::binary);
+        if (!stream.is_open()) {
+            const std::string u8string = path.u8string();
+            fprintf(stderr, "Failed to open display list capture at %s.\n", u8string.c_str());
+            return false;
+        }
+
+        stream.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (stream.gcount() != sizeof(header)) {
+            fprintf(stderr, "Display list capture is too small.\n");
+            close();
+            return false;
+        }
+
+        if (memcmp(header.magic, Magic, sizeof(Magic)) != 0) {
+            fprintf(stderr, "Display list capture has an invalid magic.\n");
+            close();
+            return false;
+        }
+
+        if ((header.version != Version) || (header.rdramSize != RDRAMSize) || (header.pageSize != PageSize)) {
+            fprintf(stderr, "Display list capture version %u is not supported.\n", header.version);
+            close();
+            return false;
+        }
+
+        context = ZSTD_createDCtx();
+        compressedBytes.resize(ZSTD_DStreamInSize());
+        compressedCursor = 0;
+        compressedEnd = 0;
+        decompressedBytes.clear();
+        decompressedCursor = 0;
+        return true;
+    }
+
+    void DisplayListCapture::Reader::close() {
+        if (context != nullptr) {
+            ZSTD_freeDCtx(context);
+            context = nullptr;
+        }
+
+        if (stream.is_open()) {
+            stream.close();
+        }
+    }
+
+    bool DisplayListCapture::Reader::nextEvent(EventType &type, std::vector<uint8_t> &payload) {
+        EventHeader eventHeader;
+        if (!readDecompressed(&eventHeader, sizeof(eventHeader))) {
+            return false;
+        }
+
+        payload.resize(eventHeader.size);
+        if (!readDecompressed(payload.data(), payload.size())) {
+            fprintf(stderr, "Display list capture ended in the middle of an event.\n");
+            return false;
+        }
+
+        type = eventHeader.type;
+        return true;
+    }
+
+    bool DisplayListCapture::Reader::readDecompressed(void *dst, size_t size) {
+        while ((decompressedBytes.size() - decompressedCursor) < size) {
+            if (!fillDecompressed()) {
+                return false;
+            }
+        }
+
+        memcpy(dst, &decompressedBytes[decompressedCursor], size);
+        decompressedCursor += size;
+        return true;
+    }
+
+    bool DisplayListCapture::Reader::fillDecompressed() {
+        if (context == nullptr) {
+            return false;
+        }
+
+        // Discard the bytes that were already consumed.
+        if (decompressedCursor > 0) {
+            decompressedBytes.erase(decompressedBytes.begin(), decompressedBytes.begin() + decompressedCursor);
+            decompressedCursor = 0;
+        }
+
+        if (compressedCursor == compressedEnd) {
+            stream.read(reinterpret_cast<char *>(compressedBytes.data()), compressedBytes.size());
+            compressedEnd = size_t(stream.gcount());
+            compressedCursor = 0;
+            if (compressedEnd == 0) {
+                return false;
+            }
+        }
+
+        const size_t outSize = ZSTD_DStreamOutSize();
+        const size_t previousSize = decompressedBytes.size();
+        decompressedBytes.resize(previousSize + outSize);
+
+        ZSTD_inBuffer inBuffer = { compressedBytes.data(), compressedEnd, compressedCursor };
+        ZSTD_outBuffer outBuffer = { &decompressedBytes[previousSize], outSize, 0 };
+        const size_t result = ZSTD_decompressStream(context, &outBuffer, &inBuffer);
+        if (ZSTD_isError(result)) {
+            fprintf(stderr, "Failed to decompress display list capture: %s.\n", ZSTD_getErrorName(result));
+            decompressedBytes.resize(previousSize);
+            return false;
+        }
+
+        compressedCursor = inBuffer.pos;
+        decompressedBytes.resize(previousSize + outBuffer.pos);
+        return true;
+    }
+};
@@ -0,0 +1,137 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
+namespace RT64 {
+    // Records every call made into the renderer by the emulator so it can be replayed later without one. The file starts with an
+    // uncompressed header and is followed by a single zstd stream of events. RDRAM is stored as the pages that changed since the
+    // previous event, so replaying the events in order reproduces the exact memory the renderer saw on every call.
+    struct DisplayListCapture {
+        static constexpr char Magic[8] = { 'R', 'T', '6', '4', 'C', 'A', 'P', 'T' };
+        static constexpr uint32_t Version = 1;
+        static constexpr uint32_t PageSize = 4096;
+        static constexpr uint32_t RDRAMSize = 0x800000;
+        static constexpr uint32_t DMEMSize = 0x1000;
+
+        enum class EventType : uint32_t {
+            RDRAMPages = 1,
+            LoadUCode = 2,
+            DisplayLists = 3,
+            UpdateScreen = 4
+        };
+
+        struct FileHeader {
+            char magic[8];
+            uint32_t version;
+            uint32_t rdramSize;
+            uint32_t pageSize;
+            uint32_t reserved;
+        };
+
+        struct EventHeader {
+            EventType type;
+            uint32_t size;
+        };
+
+        // RDRAMPages is a sequence of page indices each followed by the contents of the page.
+
+        struct LoadUCodeEvent {
+            uint32_t textAddress;
+            uint32_t dataAddress;
+            uint8_t resetFromTask;
+
+            // Loads issued by the display lists themselves are recorded for reference but are not meant to be replayed.
+            uint8_t nested;
+            uint8_t reserved[2];
+        };
+
+        // Followed by the contents of DMEM if the display lists were read from it.
+        struct DisplayListsEvent {
+            uint32_t dlStartAddress;
+            uint32_t dlEndAddress;
+            uint8_t isHLE;
+            uint8_t fromDMEM;
+            uint8_t reserved[2];
+        };
+
+        struct UpdateScreenEvent {
+            uint32_t status;
+            uint32_t origin;
+            uint32_t width;
+            uint32_t intr;
+            uint32_t vCurrentLine;
+            uint32_t timing;
+            uint32_t vSync;
+            uint32_t hSync;
+            uint32_t leap;
+            uint32_t hStart;
+            uint32_t vStart;
+            uint32_t vBurst;
+            uint32_t xScale;
+            uint32_t yScale;
+        };
+
+        struct Writer {
+            static const int CompressionLevel;
+            static const size_t FlushThreshold;
+
+            std::ofstream stream;
+            ZSTD_CCtx_s *context = nullptr;
+            std::vector<uint8_t> pendingBytes;
+            std::vector<uint8_t> compressedBytes;
+            std::vector<uint8_t> shadowRDRAM;
+            std::vector<uint32_t> dirtyPages;
+            uint32_t nestingDepth = 0;
+            uint64_t eventCount = 0;
+            uint64_t pageCount = 0;
+            uint64_t uncompressedSize = 0;
+            uint64_t compressedSize = 0;
+
+            Writer();
+            ~Writer();
+            bool open(const std::filesystem::path &path);
+            void close();
+            bool isOpen() const;
+            void recordLoadUCode(uint32_t textAddress, uint32_t dataAddress, bool resetFromTask);
+            void beginDisplayLists(const uint8_t *RDRAM, const uint8_t *DMEM, const DisplayListsEvent &event);
+            void endDisplayLists();
+            void recordUpdateScreen(const uint8_t *RDRAM, const UpdateScreenEvent &event);
+            void recordRDRAM(const uint8_t *RDRAM);
+            void writeEventHeader(EventType type, uint32_t size);
+            void writeBytes(const void *data, size_t size);
+            void finishEvent();
+            bool compressPending(bool endFrame);
+        };
+
+        struct Reader {
+            std::ifstream stream;
+            ZSTD_DCtx_s *context = nullptr;
+            std::vector<uint8_t> compressedBytes;
+            size_t compressedCursor = 0;
+            size_t compressedEnd = 0;
+            std::vector<uint8_t> decompressedBytes;
+            size_t decompressedCursor = 0;
+            FileHeader header = {};
+
+            Reader();
+            ~Reader();
+            bool open(const std::filesystem::path &path);
+            void close();
+
+            // Returns false once there's no events left or the stream is corrupted.
+            bool nextEvent(EventType &type, std::vector<uint8_t> &payload);
+            bool readDecompressed(void *dst, size_t size);
+            bool fillDecompressed();
+        };
+    };
+};
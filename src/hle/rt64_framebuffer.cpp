@@ -37,6 +37,9 @@ namespace RT64 {
         modifiedBytes = 0;
         RAMBytes = 0;
         RAMHash = 0;
+        RAMDirtyStart = 0;
+        RAMDirtyEnd = 0;
+        nativeSwappedRAMValid = false;
         ditherPatterns.fill(0);
         lastWriteType = Type::None;
         lastWriteFmt = 0;
@@ -71,7 +74,7 @@ namespace RT64 {
         return (lastWriteType != Type::None) && (lastWriteType != newType);
     }
 
-    uint32_t Framebuffer::copyRAMToNativeAndChanges(RenderWorker *worker, FramebufferChange &fbChange, const uint8_t *src, uint32_t rowStart, uint32_t rowCount, uint8_t fmt, bool invalidateTargets, const ShaderLibrary *shaderLibrary) {
+    uint32_t Framebuffer::copyRAMToNativeAndChanges(RenderWorker *worker, FramebufferChange &fbChange, const uint8_t *src, uint32_t rowStart, uint32_t rowCount, uint8_t fmt, bool invalidateTargets, const ShaderLibrary *shaderLibrary, bool onlyDirtyRAM) {
         assert(worker != nullptr);
         assert(src != nullptr);
 
@@ -79,11 +82,22 @@ namespace RT64 {
         const uint32_t nativeSize = NativeTarget::getNativeSize(width, rowCount, siz);
         if (nativeSwappedRAM.size() < nativeSize) {
             nativeSwappedRAM.resize(nativeSize);
+            nativeSwappedRAMValid = false;
         }
 
-        const uint32_t *srcWords = reinterpret_cast<const uint32_t *>(src);
-        uint32_t *dstWords = reinterpret_cast<uint32_t *>(nativeSwappedRAM.data());
-        uint32_t wordsToSwap = nativeSize / sizeof(uint32_t);
+        // When the swapped copy still holds the contents of the RAM from the last upload, only the range that was detected as dirty must be swapped again.
+        uint32_t wordStart = 0;
+        uint32_t wordEnd = nativeSize / sizeof(uint32_t);
+        if (onlyDirtyRAM && nativeSwappedRAMValid && (rowStart == 0) && (nativeSize <= RAMBytes)) {
+            wordStart = std::min(RAMDirtyStart / uint32_t(sizeof(uint32_t)), wordEnd);
+            wordEnd = std::min((RAMDirtyEnd + uint32_t(sizeof(uint32_t)) - 1) / uint32_t(sizeof(uint32_t)), wordEnd);
+        }
+
+        nativeSwappedRAMValid = onlyDirtyRAM && (rowStart == 0);
+
+        const uint32_t *srcWords = reinterpret_cast<const uint32_t *>(src) + wordStart;
+        uint32_t *dstWords = reinterpret_cast<uint32_t *>(nativeSwappedRAM.data()) + wordStart;
+        uint32_t wordsToSwap = (wordEnd > wordStart) ? (wordEnd - wordStart) : 0;
         while (wordsToSwap > 0) {
             *dstWords = _byteswap_ulong(*srcWords);
             wordsToSwap--;
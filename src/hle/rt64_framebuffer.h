@@ -31,6 +31,7 @@ namespace RT64 {
         uint32_t readHeight;
         NativeTarget nativeTarget;
         std::vector<uint8_t> nativeSwappedRAM;
+        bool nativeSwappedRAMValid;
         FixedRect lastWriteRect;
         uint8_t lastWriteFmt;
         Type lastWriteType;
@@ -38,6 +39,11 @@ namespace RT64 {
         uint32_t modifiedBytes;
         uint32_t RAMBytes;
         uint64_t RAMHash;
+        std::vector<uint64_t> RAMBlockHashes;
+        std::vector<uint64_t> RAMBlockHashesPending;
+        std::vector<uint8_t> RAMBlockWritten;
+        uint32_t RAMDirtyStart;
+        uint32_t RAMDirtyEnd;
         std::array<uint32_t, 4> ditherPatterns;
         bool widthChanged;
         bool sizChanged;
@@ -52,7 +58,7 @@ namespace RT64 {
         bool overlaps(uint32_t start, uint32_t end) const;
         void discardLastWrite();
         bool isLastWriteDifferent(Framebuffer::Type newType) const;
-        uint32_t copyRAMToNativeAndChanges(RenderWorker *worker, FramebufferChange &fbChange, const uint8_t *src, uint32_t rowStart, uint32_t rowCount, uint8_t fmt, bool invalidateTargets, const ShaderLibrary *shaderLibrary);
+        uint32_t copyRAMToNativeAndChanges(RenderWorker *worker, FramebufferChange &fbChange, const uint8_t *src, uint32_t rowStart, uint32_t rowCount, uint8_t fmt, bool invalidateTargets, const ShaderLibrary *shaderLibrary, bool onlyDirtyRAM = false);
         FramebufferChange *readChangeFromBytes(RenderWorker *worker, FramebufferChangePool &fbChangePool, Type type, uint8_t fmt, const uint8_t *src, uint32_t rowStart, uint32_t rowCount, const ShaderLibrary *shaderLibrary);
         FramebufferChange *readChangeFromStorage(RenderWorker *worker, const FramebufferStorage &fbStorage, FramebufferChangePool &fbChangePool, Type type, uint8_t fmt,
             uint32_t maxFbPairIndex, uint32_t rowStart, uint32_t rowCount, const ShaderLibrary *shaderLibrary);
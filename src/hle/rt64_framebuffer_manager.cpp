@@ -10,6 +10,7 @@
 #include "xxHash/xxh3.h"
 
 #include "common/rt64_common.h"
+#include "common/rt64_elapsed_timer.h"
 #include "gbi/rt64_f3d.h"
 #include "hle/rt64_rdp.h"
 #include "render/rt64_render_target.h"
@@ -779,16 +780,28 @@ namespace RT64 {
     void FramebufferManager::checkRAM(const uint8_t *RDRAM, std::vector<Framebuffer *> &differentFbs, bool updateHashes) {
         assert(RDRAM != nullptr);
 
+        if (!RAMStatisticsEnabled) {
+            compareRAMHashes(RDRAM, differentFbs, updateHashes);
+            return;
+        }
+
+        ElapsedTimer checkTimer;
+        compareRAMHashes(RDRAM, differentFbs, updateHashes);
+        RAMStats.checkNanoseconds += uint64_t(checkTimer.elapsedNanoseconds());
+        RAMStats.checkCount++;
+        RAMStats.differentCount += differentFbs.size();
+    }
+
+    void FramebufferManager::compareRAMHashes(const uint8_t *RDRAM, std::vector<Framebuffer *> &differentFbs, bool updateHashes) {
         differentFbs.clear();
         auto it = framebuffers.begin();
         while (it != framebuffers.end()) {
-            const uint8_t *fbRAM = &RDRAM[it->first];
-            uint64_t currentHash = XXH3_64bits(fbRAM, it->second.RAMBytes);
+            uint64_t currentHash = hashRAM(it->second, RDRAM, RAMWriteTracking);
             if (currentHash != it->second.RAMHash) {
                 differentFbs.push_back(&it->second);
 
                 if (updateHashes) {
-                    it->second.RAMHash = currentHash;
+                    commitRAMHash(it->second, currentHash);
                 }
             }
 
@@ -796,6 +809,87 @@ namespace RT64 {
         }
     }
 
+    // Size of the blocks the contents of the framebuffer in RAM are hashed in.
+    static const uint32_t RAMBlockSize = 4096;
+
+    uint64_t FramebufferManager::hashRAM(Framebuffer &fb, const uint8_t *RDRAM, bool useWriteTracking) {
+        assert(RDRAM != nullptr);
+
+        // Hash the RAM in blocks so the range that changed can be determined. If the emulator reports the writes it does to RAM,
+        // only the blocks that were written to need to be hashed again.
+        const uint8_t *fbRAM = &RDRAM[fb.addressStart];
+        const uint32_t blockCount = (fb.RAMBytes + RAMBlockSize - 1) / RAMBlockSize;
+        const bool blocksValid = (fb.RAMBlockHashes.size() == blockCount) && (fb.RAMBlockWritten.size() == blockCount);
+        fb.RAMBlockHashesPending.resize(blockCount);
+        fb.RAMDirtyStart = fb.RAMBytes;
+        fb.RAMDirtyEnd = 0;
+        uint64_t hashedBytes = 0;
+        uint64_t skippedBytes = 0;
+        for (uint32_t i = 0; i < blockCount; i++) {
+            const uint32_t blockStart = i * RAMBlockSize;
+            const uint32_t blockEnd = std::min(blockStart + RAMBlockSize, fb.RAMBytes);
+            if (useWriteTracking && blocksValid && !fb.RAMBlockWritten[i]) {
+                fb.RAMBlockHashesPending[i] = fb.RAMBlockHashes[i];
+                skippedBytes += blockEnd - blockStart;
+                continue;
+            }
+
+            fb.RAMBlockHashesPending[i] = XXH3_64bits(&fbRAM[blockStart], blockEnd - blockStart);
+            hashedBytes += blockEnd - blockStart;
+            if (!blocksValid || (fb.RAMBlockHashesPending[i] != fb.RAMBlockHashes[i])) {
+                fb.RAMDirtyStart = std::min(fb.RAMDirtyStart, blockStart);
+                fb.RAMDirtyEnd = std::max(fb.RAMDirtyEnd, blockEnd);
+            }
+        }
+
+        if (RAMStatisticsEnabled) {
+            RAMStats.hashedBytes += hashedBytes;
+            RAMStats.skippedBytes += skippedBytes;
+        }
+
+        if (fb.RAMBlockHashesPending.empty()) {
+            return 0;
+        }
+
+        return XXH3_64bits(fb.RAMBlockHashesPending.data(), fb.RAMBlockHashesPending.size() * sizeof(uint64_t));
+    }
+
+    void FramebufferManager::commitRAMHash(Framebuffer &fb, uint64_t hash) {
+        std::swap(fb.RAMBlockHashes, fb.RAMBlockHashesPending);
+        fb.RAMBlockWritten.assign(fb.RAMBlockHashes.size(), 0);
+        fb.RAMHash = hash;
+    }
+
+    void FramebufferManager::setRAMWriteTracking(bool enabled) {
+        RAMWriteTracking = enabled;
+
+        // Force all blocks to be hashed again the next time they're checked.
+        for (auto &it : framebuffers) {
+            it.second.RAMBlockWritten.clear();
+        }
+    }
+
+    void FramebufferManager::trackRAMWrite(uint32_t address, uint32_t size) {
+        if (!RAMWriteTracking || (size == 0)) {
+            return;
+        }
+
+        const uint32_t writeEnd = address + size;
+        for (auto &it : framebuffers) {
+            Framebuffer &fb = it.second;
+            const uint32_t fbEnd = fb.addressStart + fb.RAMBytes;
+            if ((address >= fbEnd) || (writeEnd <= fb.addressStart) || fb.RAMBlockWritten.empty()) {
+                continue;
+            }
+
+            const uint32_t startBlock = (std::max(address, fb.addressStart) - fb.addressStart) / RAMBlockSize;
+            const uint32_t endBlock = std::min((std::min(writeEnd, fbEnd) - fb.addressStart + RAMBlockSize - 1) / RAMBlockSize, uint32_t(fb.RAMBlockWritten.size()));
+            for (uint32_t i = startBlock; i < endBlock; i++) {
+                fb.RAMBlockWritten[i] = 1;
+            }
+        }
+    }
+
     void FramebufferManager::uploadRAM(RenderWorker *renderWorker, Framebuffer **differentFbs, size_t differentFbsCount, FramebufferChangePool &fbChangePool,
         const uint8_t *RDRAM, bool canDiscard, std::vector<FramebufferOperation> &fbOps, std::vector<uint32_t> &fbDiscards, const ShaderLibrary *shaderLibrary)
     {
@@ -812,7 +906,13 @@ namespace RT64 {
             FramebufferChange &fbChange = fbChangePool.use(renderWorker, fbChangeType, fb->width, fb->height, shaderLibrary->usesHDR);
             const uint32_t DifferenceFractionNum = 1;
             const uint32_t DifferenceFractionDiv = 4;
-            const uint32_t differentPixels = fb->copyRAMToNativeAndChanges(renderWorker, fbChange, fbRAM, 0, fb->height, fb->lastWriteFmt, false, shaderLibrary);
+            if (RAMStatisticsEnabled) {
+                RAMStats.uploadCount++;
+                RAMStats.uploadDirtyBytes += (fb->RAMDirtyEnd > fb->RAMDirtyStart) ? (fb->RAMDirtyEnd - fb->RAMDirtyStart) : 0;
+                RAMStats.uploadTotalBytes += fb->RAMBytes;
+            }
+
+            const uint32_t differentPixels = fb->copyRAMToNativeAndChanges(renderWorker, fbChange, fbRAM, 0, fb->height, fb->lastWriteFmt, false, shaderLibrary, true);
             const uint32_t differentBytes = differentPixels << fb->siz >> 1;
             fb->modifiedBytes += differentBytes;
 
@@ -842,11 +942,21 @@ namespace RT64 {
         }
     }
     
-    void FramebufferManager::hashTracking(const uint8_t *RDRAM) {
+    void FramebufferManager::hashTracking(const uint8_t *RDRAM, const std::vector<Framebuffer *> &skippedFbs) {
         auto it = framebuffers.begin();
         while (it != framebuffers.end()) {
             if ((it->second.maxHeight > 0) && (it->second.RAMBytes > 0)) {
-                it->second.RAMHash = XXH3_64bits(&RDRAM[it->first], it->second.RAMBytes);
+                // If the CPU wrote over some of the rows before they could be written back, RAM no longer matches the native target.
+                // The hashes are left as they were and every block is hashed again so the next check uploads the CPU's changes.
+                if (std::find(skippedFbs.begin(), skippedFbs.end(), &it->second) != skippedFbs.end()) {
+                    it->second.RAMBlockWritten.clear();
+                }
+                else {
+                    commitRAMHash(it->second, hashRAM(it->second, RDRAM, false));
+                }
+
+                // The contents were written by the renderer, so the swapped copy from the last upload no longer matches RAM.
+                it->second.nativeSwappedRAMValid = false;
             }
 
             it++;
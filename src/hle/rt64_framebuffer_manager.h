@@ -150,6 +150,17 @@ namespace RT64 {
             }
         };
 
+        struct RAMStatistics {
+            uint64_t checkCount = 0;
+            uint64_t checkNanoseconds = 0;
+            uint64_t hashedBytes = 0;
+            uint64_t skippedBytes = 0;
+            uint64_t differentCount = 0;
+            uint64_t uploadCount = 0;
+            uint64_t uploadDirtyBytes = 0;
+            uint64_t uploadTotalBytes = 0;
+        };
+
         std::unordered_map<uint32_t, Framebuffer> framebuffers;
         std::unordered_map<uint64_t, TileCopy> tileCopies;
         std::unique_ptr<RenderTexture> dummyTLUTTexture;
@@ -159,6 +170,11 @@ namespace RT64 {
         FramebufferChangePool scratchChangePool;
         uint64_t usedTimestamp = 0;
         uint64_t writeTimestamp = 0;
+        bool RAMWriteTracking = false;
+        RAMStatistics RAMStats;
+
+        // Checks run every time the display lists are processed, so they're only timed and counted for the tools that report them.
+        bool RAMStatisticsEnabled = false;
 
         typedef std::list<RegionTMEM>::iterator RegionIterator;
 
@@ -190,11 +206,16 @@ namespace RT64 {
         void discardRegionsTMEM(uint32_t tmemStart, uint32_t tmemWords, uint32_t tmemMask);
         void storeRAM(FramebufferStorage &fbStorage, const uint8_t *RDRAM, uint32_t fbPairIndex);
         void checkRAM(const uint8_t *RDRAM, std::vector<Framebuffer *> &differentFbs, bool updateHashes);
+        void compareRAMHashes(const uint8_t *RDRAM, std::vector<Framebuffer *> &differentFbs, bool updateHashes);
+        uint64_t hashRAM(Framebuffer &fb, const uint8_t *RDRAM, bool useWriteTracking);
+        void commitRAMHash(Framebuffer &fb, uint64_t hash);
+        void setRAMWriteTracking(bool enabled);
+        void trackRAMWrite(uint32_t address, uint32_t size);
         void uploadRAM(RenderWorker *renderWorker, Framebuffer **differentFbs, size_t differentFbsCount, FramebufferChangePool &fbChangePool, const uint8_t *RDRAM, bool canDiscard, std::vector<FramebufferOperation> &fbOps,
             std::vector<uint32_t> &fbDiscards, const ShaderLibrary *shaderLibrary);
 
         void resetTracking();
-        void hashTracking(const uint8_t *RDRAM);
+        void hashTracking(const uint8_t *RDRAM, const std::vector<Framebuffer *> &skippedFbs = {});
         void changeRAM(Framebuffer *changedFb, uint32_t addressStart, uint32_t addressEnd);
 
         void resetOperations();
@@ -2,7 +2,11 @@
 // RT64
 //
 
+#include <algorithm>
+#include <functional>
+
 #include "common/rt64_math.h"
+#include "common/rt64_task_pool.h"
 
 #include "rt64_game_frame.h"
 #include "rt64_workload_queue.h"
@@ -184,6 +188,27 @@ namespace RT64 {
         return lhs.difference < rhs.difference;
     }
 
+    // Matching below this amount of calls is faster on a single thread than the cost of waking up the pool.
+    static const uint32_t ParallelMatchingMinimumCallCount = 1024;
+
+    struct CallHashTask {
+        uint32_t sceneMatchIndex;
+        uint32_t projectionIndex;
+        bool previous;
+    };
+
+    struct GameSceneMatches {
+        const GameScene *curScene = nullptr;
+        const GameScene *prevScene = nullptr;
+        std::vector<std::vector<GameCallHash>> curProjectionHashes;
+        std::vector<std::vector<GameCallHash>> prevProjectionHashes;
+        std::vector<GameCallHash> curCallHashes;
+        std::vector<GameCallHash> prevCallHashes;
+        std::vector<IndexPair> transformChecks;
+        std::vector<IndexPair> tileChecks;
+        std::vector<MatchCandidate> transformCandidates;
+    };
+
     struct TransformMatchResult {
         float positionDifference = FLT_MAX;
         float orientationDifference = FLT_MAX;
@@ -252,7 +277,7 @@ namespace RT64 {
         return matchResult;
     }
 
-    void GameFrame::match(RenderWorker *worker, WorkloadQueue &workloadQueue, const GameFrame &prevFrame, BufferUploader *velocityUploader, bool &velocityUploaderUsed, bool &tileInterpolationUsed) {
+    void GameFrame::match(RenderWorker *worker, WorkloadQueue &workloadQueue, const GameFrame &prevFrame, BufferUploader *velocityUploader, TaskPool *taskPool, bool &velocityUploaderUsed, bool &tileInterpolationUsed) {
         tileInterpolationUsed = false;
         matched = true;
 
@@ -322,11 +347,13 @@ namespace RT64 {
             }
         }
 
+        // Pair up the scenes that are the closest match possible. This only depends on the view and projection transforms.
         thread_local std::vector<MatchCandidate> matchCandidates;
         thread_local std::vector<bool> curScenesMatched;
         thread_local std::vector<bool> prevScenesMatched;
-        auto matchScenes = [&](const std::vector<GameScene> &curScenes, const std::vector<GameScene> &prevScenes) {
-            // Find the scenes that are the closest match possible.
+        thread_local std::vector<GameSceneMatches> sceneMatchesStorage;
+        uint32_t sceneMatchCount = 0;
+        auto pairScenes = [&](const std::vector<GameScene> &curScenes, const std::vector<GameScene> &prevScenes) {
             matchCandidates.clear();
             for (uint32_t i = 0; i < curScenes.size(); i++) {
                 const GameIndices::Projection curFirstProj = curScenes[i].projections[0];
@@ -360,14 +387,77 @@ namespace RT64 {
                     continue;
                 }
 
-                matchScene(workloadQueue, prevFrame, curScenes[candidate.curIndex], prevScenes[candidate.prevIndex], workloadsModified, tileInterpolationUsed);
+                if (sceneMatchCount >= sceneMatchesStorage.size()) {
+                    sceneMatchesStorage.emplace_back();
+                }
+
+                GameSceneMatches &sceneMatches = sceneMatchesStorage[sceneMatchCount++];
+                sceneMatches.curScene = &curScenes[candidate.curIndex];
+                sceneMatches.prevScene = &prevScenes[candidate.prevIndex];
                 curScenesMatched[candidate.curIndex] = true;
                 prevScenesMatched[candidate.prevIndex] = true;
             }
         };
 
-        matchScenes(perspectiveScenes, prevFrame.perspectiveScenes);
-        matchScenes(orthographicScenes, prevFrame.orthographicScenes);
+        pairScenes(perspectiveScenes, prevFrame.perspectiveScenes);
+        pairScenes(orthographicScenes, prevFrame.orthographicScenes);
+
+        // Every projection of the paired scenes is hashed on its own task.
+        thread_local std::vector<CallHashTask> callHashTasksStorage;
+        callHashTasksStorage.clear();
+
+        uint32_t totalCallCount = 0;
+        auto addCallHashTasks = [&](uint32_t sceneMatchIndex, const GameScene &scene, std::vector<std::vector<GameCallHash>> &projectionHashes, bool previous) {
+            projectionHashes.resize(scene.projections.size());
+            for (uint32_t p = 0; p < scene.projections.size(); p++) {
+                const GameIndices::Projection &projIndices = scene.projections[p];
+                const Workload &workload = workloadQueue.workloads[projIndices.workloadIndex];
+                totalCallCount += workload.fbPairs[projIndices.fbPairIndex].projections[projIndices.projectionIndex].gameCallCount;
+                callHashTasksStorage.emplace_back(CallHashTask{ sceneMatchIndex, p, previous });
+            }
+        };
+
+        for (uint32_t s = 0; s < sceneMatchCount; s++) {
+            GameSceneMatches &sceneMatches = sceneMatchesStorage[s];
+            addCallHashTasks(s, *sceneMatches.curScene, sceneMatches.curProjectionHashes, false);
+            addCallHashTasks(s, *sceneMatches.prevScene, sceneMatches.prevProjectionHashes, true);
+        }
+
+        // The tasks can run on other threads, so they must reach the thread local storage of this thread through these references.
+        std::vector<GameSceneMatches> &sceneMatchesRef = sceneMatchesStorage;
+        std::vector<CallHashTask> &callHashTasksRef = callHashTasksStorage;
+        const bool runInParallel = (taskPool != nullptr) && (totalCallCount >= ParallelMatchingMinimumCallCount);
+        auto runTasks = [&](uint32_t taskCount, const std::function<void(uint32_t)> &taskFunction) {
+            if (runInParallel) {
+                taskPool->parallelFor(taskCount, taskFunction);
+            }
+            else {
+                for (uint32_t i = 0; i < taskCount; i++) {
+                    taskFunction(i);
+                }
+            }
+        };
+
+        runTasks(uint32_t(callHashTasksRef.size()), [&](uint32_t t) {
+            const CallHashTask &task = callHashTasksRef[t];
+            GameSceneMatches &sceneMatches = sceneMatchesRef[task.sceneMatchIndex];
+            const GameScene &scene = task.previous ? *sceneMatches.prevScene : *sceneMatches.curScene;
+            std::vector<GameCallHash> &callHashes = task.previous ? sceneMatches.prevProjectionHashes[task.projectionIndex] : sceneMatches.curProjectionHashes[task.projectionIndex];
+            const GameIndices::Projection &projIndices = scene.projections[task.projectionIndex];
+            const Workload &workload = workloadQueue.workloads[projIndices.workloadIndex];
+            const Projection &proj = workload.fbPairs[projIndices.fbPairIndex].projections[projIndices.projectionIndex];
+            buildCallHashes(task.projectionIndex, workload, proj, callHashes);
+        });
+
+        // Find all the transforms and tiles that could be matched between each pair of scenes.
+        runTasks(sceneMatchCount, [&](uint32_t s) {
+            findSceneMatches(workloadQueue, prevFrame, sceneMatchesRef[s]);
+        });
+
+        // The results are applied in the order the scenes were paired in, so the outcome is the same no matter how the tasks were scheduled.
+        for (uint32_t s = 0; s < sceneMatchCount; s++) {
+            matchScene(workloadQueue, prevFrame, sceneMatchesStorage[s], workloadsModified, tileInterpolationUsed);
+        }
 
         if (!workloadsModified.empty()) {
             thread_local std::vector<BufferUploader::Upload> uploads;
@@ -386,21 +476,112 @@ namespace RT64 {
         }
     }
 
-    void GameFrame::matchScene(WorkloadQueue &workloadQueue, const GameFrame &prevFrame, const GameScene &curScene, const GameScene &prevScene, std::set<uint32_t> &workloadsModified, bool &tileInterpolationUsed) {
+    void GameFrame::findSceneMatches(const WorkloadQueue &workloadQueue, const GameFrame &prevFrame, GameSceneMatches &sceneMatches) const {
+        sceneMatches.curCallHashes.clear();
+        sceneMatches.prevCallHashes.clear();
+        sceneMatches.transformChecks.clear();
+        sceneMatches.tileChecks.clear();
+        sceneMatches.transformCandidates.clear();
+
+        const GameScene &curScene = *sceneMatches.curScene;
+        const GameScene &prevScene = *sceneMatches.prevScene;
         if (curScene.projections.empty() || prevScene.projections.empty()) {
             return;
         }
 
-        thread_local std::multimap<uint64_t, GameCallMap> curCallHashMap;
-        thread_local std::multimap<uint64_t, GameCallMap> prevCallHashMap;
-        curCallHashMap.clear();
-        prevCallHashMap.clear();
+        // Merge the hashes of every projection into a single sorted vector. Calls with the same hash are sorted by projection and
+        // call index, so they're visited in the same order they were submitted in.
+        auto mergeCallHashes = [](const std::vector<std::vector<GameCallHash>> &projectionHashes, std::vector<GameCallHash> &callHashes) {
+            for (const std::vector<GameCallHash> &hashes : projectionHashes) {
+                const size_t previousSize = callHashes.size();
+                callHashes.insert(callHashes.end(), hashes.begin(), hashes.end());
+                std::inplace_merge(callHashes.begin(), callHashes.begin() + previousSize, callHashes.end());
+            }
+        };
+
+        mergeCallHashes(sceneMatches.curProjectionHashes, sceneMatches.curCallHashes);
+        mergeCallHashes(sceneMatches.prevProjectionHashes, sceneMatches.prevCallHashes);
 
-        // Pick the first projection for reference of the scene.
+        // Traverse both vectors and find all the combinations of transforms and tiles to check between calls with the same hash.
+        auto prevIt = sceneMatches.prevCallHashes.begin();
+        auto curIt = sceneMatches.curCallHashes.begin();
+        while ((curIt != sceneMatches.curCallHashes.end()) && (prevIt != sceneMatches.prevCallHashes.end())) {
+            if (curIt->hash < prevIt->hash) {
+                curIt++;
+                continue;
+            }
+            else if (curIt->hash > prevIt->hash) {
+                prevIt++;
+                continue;
+            }
+
+            auto prevRangeEnd = prevIt;
+            while ((prevRangeEnd != sceneMatches.prevCallHashes.end()) && (prevRangeEnd->hash == curIt->hash)) {
+                prevRangeEnd++;
+            }
+
+            const uint64_t rangeHash = curIt->hash;
+            for (; (curIt != sceneMatches.curCallHashes.end()) && (curIt->hash == rangeHash); curIt++) {
+                for (auto prevRangeIt = prevIt; prevRangeIt != prevRangeEnd; prevRangeIt++) {
+                    const GameCallMap &curCallMap = curIt->callMap;
+                    const GameCallMap &prevCallMap = prevRangeIt->callMap;
+                    const GameIndices::Projection &curProjIndices = curScene.projections[curCallMap.sceneProjIndex];
+                    const Workload &curWorkload = workloadQueue.workloads[curProjIndices.workloadIndex];
+                    const FramebufferPair &curFbPair = curWorkload.fbPairs[curProjIndices.fbPairIndex];
+                    const Projection &curProj = curFbPair.projections[curProjIndices.projectionIndex];
+                    const GameCall &curCall = curProj.gameCalls[curCallMap.callIndex];
+                    const GameIndices::Projection &prevProjIndices = prevScene.projections[prevCallMap.sceneProjIndex];
+                    const Workload &prevWorkload = workloadQueue.workloads[prevProjIndices.workloadIndex];
+                    const FramebufferPair &prevFbPair = prevWorkload.fbPairs[prevProjIndices.fbPairIndex];
+                    const Projection &prevProj = prevFbPair.projections[prevProjIndices.projectionIndex];
+                    const GameCall &prevCall = prevProj.gameCalls[prevCallMap.callIndex];
+                    const uint32_t curWorldMatrixCount = (curCall.callDesc.maxWorldMatrix - curCall.callDesc.minWorldMatrix) + 1;
+                    const uint32_t prevWorldMatrixCount = (prevCall.callDesc.maxWorldMatrix - prevCall.callDesc.minWorldMatrix) + 1;
+                    if ((curWorldMatrixCount == prevWorldMatrixCount) && curCallMap.doTransformMatching && prevCallMap.doTransformMatching) {
+                        for (uint32_t w = 0; w < curWorldMatrixCount; w++) {
+                            const uint32_t curWorldMatrix = curCall.callDesc.minWorldMatrix + w;
+                            const uint32_t curGroupIndex = curWorkload.drawData.worldTransformGroups[curWorldMatrix];
+                            const TransformGroup &curGroup = curWorkload.drawData.transformGroups[curGroupIndex];
+                            const uint32_t prevWorldMatrix = prevCall.callDesc.minWorldMatrix + w;
+                            const uint32_t prevGroupIndex = prevWorkload.drawData.worldTransformGroups[prevWorldMatrix];
+                            const TransformGroup &prevGroup = prevWorkload.drawData.transformGroups[prevGroupIndex];
+                            if ((curGroup.matrixId == prevGroup.matrixId) && ((curGroup.matrixId == G_EX_ID_AUTO) || ((curGroup.matrixId != G_EX_ID_IGNORE) && (curGroup.ordering == G_EX_ORDER_AUTO)))) {
+                                sceneMatches.transformChecks.emplace_back(curWorldMatrix, prevWorldMatrix);
+                            }
+                        }
+                    }
+
+                    if ((curCall.callDesc.tileCount == prevCall.callDesc.tileCount) && (curCallMap.doTileMatching && prevCallMap.doTileMatching)) {
+                        for (uint32_t t = 0; t < curCall.callDesc.tileCount; t++) {
+                            const DrawCallTile &curCallTile = curWorkload.drawData.callTiles[curCall.callDesc.tileIndex + t];
+                            const DrawCallTile &prevCallTile = prevWorkload.drawData.callTiles[prevCall.callDesc.tileIndex + t];
+                            if (curCallTile.tmemHashOrID != prevCallTile.tmemHashOrID) {
+                                continue;
+                            }
+
+                            sceneMatches.tileChecks.emplace_back(curCall.callDesc.tileIndex + t, prevCall.callDesc.tileIndex + t);
+                        }
+                    }
+                }
+            }
+
+            prevIt = prevRangeEnd;
+        }
+
+        // Remove the duplicates. The pairs end up in the same order a set would've stored them in.
+        // FIXME: Transform set needs to be done per unique workload detected.
+        auto sortUnique = [](std::vector<IndexPair> &indexPairs) {
+            std::sort(indexPairs.begin(), indexPairs.end());
+            indexPairs.erase(std::unique(indexPairs.begin(), indexPairs.end()), indexPairs.end());
+        };
+
+        sortUnique(sceneMatches.transformChecks);
+        sortUnique(sceneMatches.tileChecks);
+
+        // Compute all the differences between transforms and insert them into a vector that will be sorted according to the differences.
         const GameIndices::Projection &firstCurProjIndices = curScene.projections[0];
         const GameIndices::Projection &firstPrevProjIndices = prevScene.projections[0];
-        GameFrameMap::WorkloadMap &firstCurWorkloadMap = frameMap.workloads[firstCurProjIndices.workloadIndex];
-        Workload &firstCurWorkload = workloadQueue.workloads[firstCurProjIndices.workloadIndex];
+        const Workload &firstCurWorkload = workloadQueue.workloads[firstCurProjIndices.workloadIndex];
         const FramebufferPair &firstCurFbPair = firstCurWorkload.fbPairs[firstCurProjIndices.fbPairIndex];
         const Projection &firstCurProj = firstCurFbPair.projections[firstCurProjIndices.projectionIndex];
         const Workload &firstPrevWorkload = workloadQueue.workloads[firstPrevProjIndices.workloadIndex];
@@ -411,14 +592,48 @@ namespace RT64 {
             firstPrevWorkloadMap = &prevFrame.frameMap.workloads[firstPrevProjIndices.workloadIndex];
         }
 
-        // Build a multimap with all potential compatibilities between draw calls in the projections.
+        const RigidBody *prevRigidBody;
+        const hlslpp::float4x4 &firstCurViewProj = firstCurWorkload.drawData.viewProjTransforms[firstCurProj.transformsIndex];
+        const hlslpp::float4x4 &firstPrevViewProj = firstPrevWorkload.drawData.viewProjTransforms[firstPrevProj.transformsIndex];
+        for (const IndexPair &indices : sceneMatches.transformChecks) {
+            const hlslpp::float4x4 &curTransform = firstCurWorkload.drawData.worldTransforms[indices.first];
+            const hlslpp::float4x4 &prevTransform = firstPrevWorkload.drawData.worldTransforms[indices.second];
+            prevRigidBody = (firstPrevWorkloadMap != nullptr) ? &firstPrevWorkloadMap->transforms[indices.second].rigidBody : nullptr;
+
+            TransformMatchResult matchResult = computeTransformMatch(curTransform, firstCurViewProj, prevTransform, firstPrevViewProj, prevRigidBody);
+            if (matchResult.valid) {
+                sceneMatches.transformCandidates.emplace_back(indices.first, indices.second, matchResult.computeDifference());
+            }
+        }
+
+        std::stable_sort(sceneMatches.transformCandidates.begin(), sceneMatches.transformCandidates.end());
+    }
+
+    void GameFrame::matchScene(WorkloadQueue &workloadQueue, const GameFrame &prevFrame, const GameSceneMatches &sceneMatches, std::set<uint32_t> &workloadsModified, bool &tileInterpolationUsed) {
+        const GameScene &curScene = *sceneMatches.curScene;
+        const GameScene &prevScene = *sceneMatches.prevScene;
+        if (curScene.projections.empty() || prevScene.projections.empty()) {
+            return;
+        }
+
+        // Pick the first projection for reference of the scene.
+        const GameIndices::Projection &firstCurProjIndices = curScene.projections[0];
+        const GameIndices::Projection &firstPrevProjIndices = prevScene.projections[0];
+        GameFrameMap::WorkloadMap &firstCurWorkloadMap = frameMap.workloads[firstCurProjIndices.workloadIndex];
+        Workload &firstCurWorkload = workloadQueue.workloads[firstCurProjIndices.workloadIndex];
+        const Workload &firstPrevWorkload = workloadQueue.workloads[firstPrevProjIndices.workloadIndex];
+        const GameFrameMap::WorkloadMap *firstPrevWorkloadMap = nullptr;
+        if (prevFrame.matched && prevFrame.frameMap.workloads[firstPrevProjIndices.workloadIndex].mapped) {
+            firstPrevWorkloadMap = &prevFrame.frameMap.workloads[firstPrevProjIndices.workloadIndex];
+        }
+
+        // Map the view projections of the scene.
         uint32_t mappedViewProjIndex = UINT32_MAX;
         for (uint32_t p = 0; p < curScene.projections.size(); p++) {
             const GameIndices::Projection &curProjIndices = curScene.projections[p];
             Workload &curWorkload = workloadQueue.workloads[curProjIndices.workloadIndex];
             const FramebufferPair &curFbPair = curWorkload.fbPairs[curProjIndices.fbPairIndex];
             const Projection &curProj = curFbPair.projections[curProjIndices.projectionIndex];
-            buildCallHashMap(p, curWorkload, curProj, curCallHashMap);
 
             // Projection for the entire scene has been matched already, copy the mapping.
             if (mappedViewProjIndex < UINT32_MAX) {
@@ -489,85 +704,8 @@ namespace RT64 {
             }
         }
 
-        for (uint32_t p = 0; p < prevScene.projections.size(); p++) {
-            const GameIndices::Projection &prevProjIndices = prevScene.projections[p];
-            const Workload &prevWorkload = workloadQueue.workloads[prevProjIndices.workloadIndex];
-            const FramebufferPair &prevFbPair = prevWorkload.fbPairs[prevProjIndices.fbPairIndex];
-            const Projection &prevProj = prevFbPair.projections[prevProjIndices.projectionIndex];
-            buildCallHashMap(p, prevWorkload, prevProj, prevCallHashMap);
-        }
-
-        // FIXME: Transform set needs to be done per unique workload detected.
-        thread_local std::set<IndexPair> transformCheckSet;
-        thread_local std::set<IndexPair> tileCheckSet;
-        transformCheckSet.clear();
-        tileCheckSet.clear();
-
-        // Traverse the map and fill the set with all the combinations of transforms to check.
-        for (std::pair<uint64_t, GameCallMap> curIt : curCallHashMap) {
-            auto prevRange = prevCallHashMap.equal_range(curIt.first);
-            for (auto prevIt = prevRange.first; prevIt != prevRange.second; prevIt++) {
-                const GameIndices::Projection &curProjIndices = curScene.projections[curIt.second.sceneProjIndex];
-                const Workload &curWorkload = workloadQueue.workloads[curProjIndices.workloadIndex];
-                const FramebufferPair &curFbPair = curWorkload.fbPairs[curProjIndices.fbPairIndex];
-                const Projection &curProj = curFbPair.projections[curProjIndices.projectionIndex];
-                const GameCall &curCall = curProj.gameCalls[curIt.second.callIndex];
-                const GameIndices::Projection &prevProjIndices = prevScene.projections[prevIt->second.sceneProjIndex];
-                const Workload &prevWorkload = workloadQueue.workloads[prevProjIndices.workloadIndex];
-                const FramebufferPair &prevFbPair = prevWorkload.fbPairs[prevProjIndices.fbPairIndex];
-                const Projection &prevProj = prevFbPair.projections[prevProjIndices.projectionIndex];
-                const GameCall &prevCall = prevProj.gameCalls[prevIt->second.callIndex];
-                const uint32_t curWorldMatrixCount = (curCall.callDesc.maxWorldMatrix - curCall.callDesc.minWorldMatrix) + 1;
-                const uint32_t prevWorldMatrixCount = (prevCall.callDesc.maxWorldMatrix - prevCall.callDesc.minWorldMatrix) + 1;
-                if ((curWorldMatrixCount == prevWorldMatrixCount) && curIt.second.doTransformMatching && prevIt->second.doTransformMatching) {
-                    for (uint32_t w = 0; w < curWorldMatrixCount; w++) {
-                        const uint32_t curWorldMatrix = curCall.callDesc.minWorldMatrix + w;
-                        const uint32_t curGroupIndex = curWorkload.drawData.worldTransformGroups[curWorldMatrix];
-                        const TransformGroup &curGroup = curWorkload.drawData.transformGroups[curGroupIndex];
-                        const uint32_t prevWorldMatrix = prevCall.callDesc.minWorldMatrix + w;
-                        const uint32_t prevGroupIndex = prevWorkload.drawData.worldTransformGroups[prevWorldMatrix];
-                        const TransformGroup &prevGroup = prevWorkload.drawData.transformGroups[prevGroupIndex];
-                        if ((curGroup.matrixId == prevGroup.matrixId) && ((curGroup.matrixId == G_EX_ID_AUTO) || ((curGroup.matrixId != G_EX_ID_IGNORE) && (curGroup.ordering == G_EX_ORDER_AUTO)))) {
-                            transformCheckSet.emplace(curWorldMatrix, prevWorldMatrix);
-                        }
-                    }
-                }
-
-                if ((curCall.callDesc.tileCount == prevCall.callDesc.tileCount) && (curIt.second.doTileMatching && prevIt->second.doTileMatching)) {
-                    for (uint32_t t = 0; t < curCall.callDesc.tileCount; t++) {
-                        const DrawCallTile &curCallTile = curWorkload.drawData.callTiles[curCall.callDesc.tileIndex + t];
-                        const DrawCallTile &prevCallTile = prevWorkload.drawData.callTiles[prevCall.callDesc.tileIndex + t];
-                        if (curCallTile.tmemHashOrID != prevCallTile.tmemHashOrID) {
-                            continue;
-                        }
-
-                        tileCheckSet.emplace(curCall.callDesc.tileIndex + t, prevCall.callDesc.tileIndex + t);
-                    }
-                }
-            }
-        }
-
-        // Compute all the differences between transforms and insert them into a vector that will be sorted according to the differences.
-        thread_local std::vector<MatchCandidate> matchCandidates;
-        matchCandidates.clear();
-
-        const RigidBody *prevRigidBody;
-        const hlslpp::float4x4 &firstCurViewProj = firstCurWorkload.drawData.viewProjTransforms[firstCurProj.transformsIndex];
-        const hlslpp::float4x4 &firstPrevViewProj = firstPrevWorkload.drawData.viewProjTransforms[firstPrevProj.transformsIndex];
-        for (const IndexPair &indices : transformCheckSet) {
-            const hlslpp::float4x4 &curTransform = firstCurWorkload.drawData.worldTransforms[indices.first];
-            const hlslpp::float4x4 &prevTransform = firstPrevWorkload.drawData.worldTransforms[indices.second];
-            prevRigidBody = (firstPrevWorkloadMap != nullptr) ? &firstPrevWorkloadMap->transforms[indices.second].rigidBody : nullptr;
-
-            TransformMatchResult matchResult = computeTransformMatch(curTransform, firstCurViewProj, prevTransform, firstPrevViewProj, prevRigidBody);
-            if (matchResult.valid) {
-                matchCandidates.emplace_back(indices.first, indices.second, matchResult.computeDifference());
-            }
-        }
-
         bool modifiedVelocityBuffer = false;
-        std::stable_sort(matchCandidates.begin(), matchCandidates.end());
-        for (const MatchCandidate candidate : matchCandidates) {
+        for (const MatchCandidate &candidate : sceneMatches.transformCandidates) {
             if (firstCurWorkloadMap.transforms[candidate.curIndex].mapped) {
                 continue;
             }
@@ -584,7 +722,7 @@ namespace RT64 {
         }
 
         // Check for tile matches.
-        for (const IndexPair &indices : tileCheckSet) {
+        for (const IndexPair &indices : sceneMatches.tileChecks) {
             if (firstCurWorkloadMap.tiles[indices.first].mapped) {
                 continue;
             }
@@ -699,7 +837,8 @@ namespace RT64 {
         }
     }
     
-    void GameFrame::buildCallHashMap(uint32_t sceneProjIndex, const Workload &workload, const Projection &proj, std::multimap<uint64_t, GameCallMap> &hashMap) const {
+    void GameFrame::buildCallHashes(uint32_t sceneProjIndex, const Workload &workload, const Projection &proj, std::vector<GameCallHash> &callHashes) const {
+        callHashes.clear();
         for (uint32_t c = 0; c < proj.gameCallCount; c++) {
             const GameCall &call = proj.gameCalls[c];
             uint32_t matrixIdHash = 0;
@@ -715,11 +854,16 @@ namespace RT64 {
                 doTileMatching = doTileMatching || (group.tileInterpolation != G_EX_COMPONENT_SKIP);
             }
 
-            hashMap.emplace(hashFromCall(call, matrixIdHash), GameCallMap{ sceneProjIndex, c, doTransformMatching, doTileMatching });
+            callHashes.emplace_back(GameCallHash{ hashFromCall(call, matrixIdHash), GameCallMap{ sceneProjIndex, c, doTransformMatching, doTileMatching } });
         }
+
+        // Calls with the same hash keep the order they were submitted in.
+        std::stable_sort(callHashes.begin(), callHashes.end(), [](const GameCallHash &lhs, const GameCallHash &rhs) {
+            return lhs.hash < rhs.hash;
+        });
     }
 
-    void GameFrame::buildTransformIdMap(const Workload &workload, std::multimap<uint32_t, uint32_t> &idMap, std::vector<uint32_t> &ignoredIdVector) const {
+    void GameFrame::buildTransformIdMap(const Workload &workload, std::vector<std::pair<uint32_t, uint32_t>> &idMap, std::vector<uint32_t> &ignoredIdVector) const {
         idMap.clear();
         ignoredIdVector.clear();
 
@@ -734,9 +878,14 @@ namespace RT64 {
                 ignoredIdVector.emplace_back(i);
             }
             else if (group.ordering == G_EX_ORDER_LINEAR) {
-                idMap.emplace(group.matrixId, i);
+                idMap.emplace_back(group.matrixId, i);
             }
         }
+
+        // Transforms with the same ID keep the order they were submitted in.
+        std::stable_sort(idMap.begin(), idMap.end(), [](const std::pair<uint32_t, uint32_t> &lhs, const std::pair<uint32_t, uint32_t> &rhs) {
+            return lhs.first < rhs.first;
+        });
     }
 
     uint64_t GameFrame::hashFromCall(const GameCall &call, uint32_t matrixIdHash) const {
@@ -11,6 +11,8 @@
 #include "rt64_rigid_body.h"
 
 namespace RT64 {
+    struct GameSceneMatches;
+    struct TaskPool;
     struct Workload;
     struct WorkloadQueue;
 
@@ -91,6 +93,15 @@ namespace RT64 {
         uint32_t doTileMatching : 1;
     };
 
+    struct GameCallHash {
+        uint64_t hash;
+        GameCallMap callMap;
+    };
+
+    inline bool operator<(const GameCallHash &lhs, const GameCallHash &rhs) {
+        return lhs.hash < rhs.hash;
+    }
+
     struct GameFrame {
         PresetScene presetScene;
         GameFrameMap frameMap;
@@ -102,11 +113,12 @@ namespace RT64 {
         bool areFramebufferPairsCompatible(const WorkloadQueue &workloadQueue, const GameIndices::FramebufferPair &first, const GameIndices::FramebufferPair &second);
         bool isSceneCompatible(const WorkloadQueue &workloadQueue, const GameScene &scene, const GameIndices::Projection &proj);
         void set(WorkloadQueue &workloadQueue, const uint32_t *workloadIndices, uint32_t indicesCount);
-        void match(RenderWorker *worker, WorkloadQueue &workloadQueue, const GameFrame &prevFrame, BufferUploader *velocityUploader, bool &velocityUploaderUsed, bool &tileInterpolationUsed);
-        void matchScene(WorkloadQueue &workloadQueue, const GameFrame &prevFrame, const GameScene &curScene, const GameScene &prevScene, std::set<uint32_t> &workloadsModified, bool &tileInterpolationUsed);
+        void match(RenderWorker *worker, WorkloadQueue &workloadQueue, const GameFrame &prevFrame, BufferUploader *velocityUploader, TaskPool *taskPool, bool &velocityUploaderUsed, bool &tileInterpolationUsed);
+        void findSceneMatches(const WorkloadQueue &workloadQueue, const GameFrame &prevFrame, GameSceneMatches &sceneMatches) const;
+        void matchScene(WorkloadQueue &workloadQueue, const GameFrame &prevFrame, const GameSceneMatches &sceneMatches, std::set<uint32_t> &workloadsModified, bool &tileInterpolationUsed);
         void matchTransform(Workload &curWorkload, const Workload &prevWorkload, GameFrameMap::WorkloadMap &curWorkloadMap, const GameFrameMap::WorkloadMap *prevWorkloadMap, uint32_t curTransformIndex, uint32_t prevTransformIndex, bool &modifiedVelocityBuffer);
-        void buildCallHashMap(uint32_t sceneProjIndex, const Workload &workload, const Projection &proj, std::multimap<uint64_t, GameCallMap> &hashMap) const;
-        void buildTransformIdMap(const Workload &workload, std::multimap<uint32_t, uint32_t> &idMap, std::vector<uint32_t> &ignoredIdVector) const;
+        void buildCallHashes(uint32_t sceneProjIndex, const Workload &workload, const Projection &proj, std::vector<GameCallHash> &callHashes) const;
+        void buildTransformIdMap(const Workload &workload, std::vector<std::pair<uint32_t, uint32_t>> &idMap, std::vector<uint32_t> &ignoredIdVector) const;
         uint64_t hashFromCall(const GameCall &call, uint32_t matrixIdHash) const;
         bool isDebuggerCameraEnabled(const WorkloadQueue &workloadQueue);
     };
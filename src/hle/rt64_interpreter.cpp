@@ -24,6 +24,10 @@ namespace RT64 {
     }
 
     void Interpreter::loadUCodeGBI(uint32_t textAddress, uint32_t dataAddress, bool resetFromTask) {
+        if (captureWriter != nullptr) {
+            captureWriter->recordLoadUCode(textAddress, dataAddress, resetFromTask);
+        }
+
         if (!resetFromTask) {
             state->flush();
         }
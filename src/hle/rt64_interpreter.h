@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "rt64_display_list_capture.h"
 #include "rt64_state.h"
 
 #include "gbi/rt64_f3d.h"
@@ -16,6 +17,7 @@ namespace RT64 {
         GBI *hleGBI;
         uint8_t extendedOpCode = 0;
         GBIFunction extendedFunction = nullptr;
+        DisplayListCapture::Writer *captureWriter = nullptr;
 
         struct {
             uint32_t textAddress = 0;
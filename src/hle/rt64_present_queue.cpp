@@ -102,6 +102,7 @@ namespace RT64 {
         UserConfiguration::Filtering filtering;
         uint32_t viOriginalRate;
         uint32_t targetRate;
+        int presentLatencyTarget;
         {
             std::scoped_lock<std::mutex> configurationLock(ext.sharedResources->configurationMutex);
             resolutionScale = ext.sharedResources->resolutionScale;
@@ -110,18 +111,19 @@ namespace RT64 {
             filtering = ext.sharedResources->userConfig.filtering;
             viOriginalRate = ext.sharedResources->viOriginalRate;
             targetRate = ext.sharedResources->targetRate;
+            presentLatencyTarget = ext.sharedResources->userConfig.presentLatencyTarget;
         }
 
         RenderTarget *colorTarget = nullptr;
+        RenderTarget *referencedTarget = nullptr;
         int32_t framesToPresent = 1;
         bool lockedWorkloadMutex = false;
         InterpolatedFrameCounters &frameCounters = ext.sharedResources->interpolatedFrames[ext.sharedResources->interpolatedFramesIndex];
 
         // TODO: There's a possible race condition interactions that can happen while the workload
         // queue is rendering extra frames and the present event is processed while it's generating
-        // interpolated frames. When the framebuffer manager or the render target manager maps are
-        // modified while the present queue is retrieving the framebuffer or the target. These can
-        // likely be solved by locking the access to the managers during modification.
+        // interpolated frames. When the framebuffer manager map is modified while the present queue
+        // is retrieving the framebuffer. The render target is always retrieved with the lock.
         
         // Perform any external write operations indicated by the event.
         if (!present.fbOperations.empty()) {
@@ -184,12 +186,15 @@ namespace RT64 {
                     }
                 }
 
+                // The workload thread can modify the render target map at any time, so the target is always retrieved with the lock.
+                // When interpolating, the lock is only held while retrieving the target and the target is referenced instead so it
+                // can't be evicted while it's being presented.
+                ext.sharedResources->workloadMutex.lock();
                 if (presentFb->interpolationEnabled) {
                     framesToPresent = frameCounters.count;
                 }
                 else {
                     lockedWorkloadMutex = true;
-                    ext.sharedResources->workloadMutex.lock();
                 }
 
                 RenderTargetKey colorTargetKey(presentFb->addressStart, presentFb->width, presentFb->siz, Framebuffer::Type::Color);
@@ -210,6 +215,15 @@ namespace RT64 {
                     colorTarget = nullptr;
                 }
 
+                if (!lockedWorkloadMutex) {
+                    if (colorTarget != nullptr) {
+                        referencedTarget = colorTarget;
+                        referencedTarget->presentReferences++;
+                    }
+
+                    ext.sharedResources->workloadMutex.unlock();
+                }
+
                 if (!present.paused && (viHistory.top().vi != present.screenVI)) {
                     viHistory.pushVI(present.screenVI, viFb->width);
                 }
@@ -339,6 +353,8 @@ namespace RT64 {
                     }
 
                     commandList->barriers(RenderBarrierStage::GRAPHICS, RenderTextureBarrier(renderParams.texture, RenderTextureLayout::SHADER_READ));
+
+                    GPUProfiler::Scope profilerScope(ext.presentGraphicsWorker, GPUProfiler::Section::VIRenderer);
                     viRenderer->render(renderParams);
                 }
 
@@ -360,8 +376,10 @@ namespace RT64 {
                     const RenderCommandList *commandList = ext.presentGraphicsWorker->commandList.get();
                     RenderCommandSemaphore *waitSemaphore = acquiredSemaphore.get();
                     RenderCommandSemaphore *signalSemaphore = drawSemaphore.get();
+                    const Timestamp submitTimestamp = Timer::current();
                     ext.presentGraphicsWorker->commandQueue->executeCommandLists(&commandList, 1, &waitSemaphore, 1, &signalSemaphore, 1, ext.presentGraphicsWorker->commandFence.get());
                     ext.presentGraphicsWorker->wait();
+                    framePacer.logGPU(submitTimestamp, Timer::current());
                 }
             }
 
@@ -369,6 +387,11 @@ namespace RT64 {
                 ext.sharedResources->workloadMutex.unlock();
                 lockedWorkloadMutex = false;
             }
+
+            if (referencedTarget != nullptr) {
+                referencedTarget->presentReferences--;
+                referencedTarget = nullptr;
+            }
             
             if (frameCountersNextPresented > 0) {
                 {
@@ -385,27 +408,27 @@ namespace RT64 {
             }
 
             if (presentFrame && swapChainValid) {
-                // Wait until the approximate time the next present should be at the current intended rate.
-                if ((presentTimestamp != Timestamp()) && (targetRate > 0) && (targetRate > viOriginalRate)) {
-                    Timestamp currentTimestamp = Timer::current();
-                    int64_t deltaMicro = Timer::deltaMicroseconds(presentTimestamp, currentTimestamp);
-                    int64_t targetRateMicro = 1000000 / targetRate;
-
-                    // The OS only provides about one millisecond of accuracy by default. Since we also
-                    // want to wait slightly less than the target time, we substract from it and wait 1
-                    // millisecond less than the floor of the micrseconds value.
-                    int64_t msToWait = (targetRateMicro - deltaMicro - 500) / 1000;
-                    if (msToWait > 1) {
-                        Thread::sleepMilliseconds(msToWait - 1);
-                    }
+                // Wait until the time the next present should be issued at the current intended rate.
+                if ((targetRate > 0) && (targetRate > viOriginalRate)) {
+                    framePacer.waitForPresent(1000000 / targetRate, presentLatencyTarget);
+                }
+                else {
+                    framePacer.reset();
                 }
 
                 RenderCommandSemaphore *waitSemaphore = drawSemaphore.get();
+                const Timestamp presentBeginTimestamp = Timer::current();
                 swapChainValid = ext.swapChain->present(swapChainIndex, &waitSemaphore, 1);
                 presentProfiler.logAndRestart();
                 presentTimestamp = Timer::current();
+                framePacer.logPresent(presentBeginTimestamp, presentTimestamp);
             }
         }
+
+        // Release the target in case no frames were presented.
+        if (referencedTarget != nullptr) {
+            referencedTarget->presentReferences--;
+        }
     }
 
     void PresentQueue::skipInterpolation() {
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "common/rt64_frame_pacer.h"
 #include "common/rt64_profiling_timer.h"
 #include "gui/rt64_inspector.h"
 #include "render/rt64_vi_renderer.h"
@@ -54,6 +55,7 @@ namespace RT64 {
         std::unique_ptr<Inspector> inspector;
         ProfilingTimer presentProfiler = ProfilingTimer(120);
         Timestamp presentTimestamp;
+        FramePacer framePacer;
         VIHistory viHistory;
 
         PresentQueue();
@@ -4,16 +4,226 @@
 
 #include "rt64_rdp_tmem.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cinttypes>
+#include <cstdio>
 
 #include "xxHash/xxh3.h"
 
+#include "common/rt64_elapsed_timer.h"
 #include "common/rt64_tmem_hasher.h"
 
 #include "rt64_state.h"
 
 namespace RT64 {
+    // TextureManager::HashMemo
+
+    const uint32_t TextureManager::HashMemo::MaxLoadRecords = 64;
+    const size_t TextureManager::HashMemo::MaxEntries = 0x10000;
+
+    void TextureManager::HashMemo::recordLoad(const LoadOperation &loadOp, const uint8_t *RDRAM) {
+        if (!enabled) {
+            loadRecords.clear();
+            return;
+        }
+
+        ElapsedTimer overheadTimer;
+        const LoadTile &loadTile = loadOp.tile;
+        const LoadTexture &loadTexture = loadOp.texture;
+        const bool RGBA32 = (loadTile.siz == G_IM_SIZ_32b) && (loadTile.fmt == G_IM_FMT_RGBA);
+        const uint32_t bytesPerRow = loadTexture.width << loadTexture.siz >> 1;
+        uint32_t textureStart = 0;
+        uint32_t textureEnd = 0;
+        uint32_t tmemBytes = 0;
+        bool contiguous = false;
+
+        // Mirror the parameters the RDP uses for each type of load to find out which regions of RDRAM and TMEM are involved.
+        switch (loadOp.type) {
+        case LoadOperation::Type::Tile: {
+            const uint32_t rowCount = 1 + ((loadTile.lrt >> 2) - (loadTile.ult >> 2));
+            const uint32_t wordsPerRow = (((loadTile.lrs >> 2) - (loadTile.uls >> 2)) >> (4 - loadTile.siz)) + 1;
+            const uint32_t tmemRowBytes = wordsPerRow << (RGBA32 ? 2 : 3);
+            const uint32_t tmemStride = loadTile.line << 3;
+            textureStart = loadTexture.address + ((loadTile.uls >> 2) << loadTexture.siz >> 1) + bytesPerRow * (loadTile.ult >> 2);
+            textureEnd = textureStart + (rowCount - 1) * bytesPerRow + (wordsPerRow << 3);
+            tmemBytes = (rowCount - 1) * tmemStride + tmemRowBytes;
+            contiguous = ((rowCount == 1) || (tmemStride == tmemRowBytes)) && ((tmemRowBytes & 0x7) == 0);
+            break;
+        }
+        case LoadOperation::Type::Block: {
+            // The TMEM address only jumps between rows of a block if the load tile has a line.
+            const uint32_t wordCount = ((loadTile.lrs - loadTile.uls) >> (4 - loadTile.siz)) + 1;
+            textureStart = loadTexture.address + (loadTile.uls << loadTexture.siz >> 1) + bytesPerRow * loadTile.ult;
+            textureEnd = textureStart + (wordCount << 3);
+            tmemBytes = wordCount << (RGBA32 ? 2 : 3);
+            contiguous = (loadTile.line == 0) && ((tmemBytes & 0x7) == 0);
+            break;
+        }
+        case LoadOperation::Type::TLUT: {
+            const uint32_t rowCount = 1 + ((loadTile.lrt >> 2) - (loadTile.ult >> 2));
+            const uint32_t wordsPerRow = ((loadTile.lrs >> 2) - (loadTile.uls >> 2)) + 1;
+            textureStart = loadTexture.address + ((loadTile.uls >> 2) << loadTexture.siz >> 1) + bytesPerRow * (loadTile.ult >> 2);
+            textureEnd = textureStart + (wordsPerRow << 1);
+            tmemBytes = wordsPerRow << 3;
+            contiguous = (rowCount == 1) && !RGBA32;
+            break;
+        }
+        }
+
+        // Any load that wraps around TMEM or RDRAM or doesn't write a contiguous range is not tracked. Rows that end in the middle of
+        // a TMEM word are not considered contiguous either, as odd rows swap the halves of each word. All previous records are
+        // discarded instead, as it's not known which of them were overwritten.
+        const uint32_t tmemLimit = RGBA32 ? (RDP_TMEM_BYTES >> 1) : RDP_TMEM_BYTES;
+        const uint32_t tmemStart = (loadTile.tmem << 3) & (tmemLimit - 1);
+        const uint32_t rdramStart = textureStart & ~0x7U;
+        const uint32_t rdramEnd = (textureEnd + 10) & ~0x7U;
+        const bool tracked = contiguous && (tmemBytes > 0) && ((tmemStart + tmemBytes) <= tmemLimit) && (textureEnd > textureStart) && (rdramEnd <= (RDRAMSize + 1));
+        if (!tracked) {
+            loadRecords.clear();
+            overheadNanoseconds += uint64_t(overheadTimer.elapsedNanoseconds());
+            return;
+        }
+
+        // The contents written to TMEM only depend on the bytes read from RDRAM and the parameters of the load, so the same
+        // texture loaded at a different TMEM address produces the same key.
+        const uint32_t loadType = uint32_t(loadOp.type);
+        const uint32_t alignment = textureStart - rdramStart;
+        XXH3_state_t xxh3;
+        XXH3_64bits_reset(&xxh3);
+        XXH3_64bits_update(&xxh3, &loadType, sizeof(loadType));
+        XXH3_64bits_update(&xxh3, &alignment, sizeof(alignment));
+        XXH3_64bits_update(&xxh3, &loadTile.fmt, sizeof(loadTile.fmt));
+        XXH3_64bits_update(&xxh3, &loadTile.siz, sizeof(loadTile.siz));
+        XXH3_64bits_update(&xxh3, &loadTile.line, sizeof(loadTile.line));
+        XXH3_64bits_update(&xxh3, &loadTile.uls, sizeof(loadTile.uls));
+        XXH3_64bits_update(&xxh3, &loadTile.ult, sizeof(loadTile.ult));
+        XXH3_64bits_update(&xxh3, &loadTile.lrs, sizeof(loadTile.lrs));
+        XXH3_64bits_update(&xxh3, &loadTile.lrt, sizeof(loadTile.lrt));
+        XXH3_64bits_update(&xxh3, &loadTexture.siz, sizeof(loadTexture.siz));
+        XXH3_64bits_update(&xxh3, &loadTexture.width, sizeof(loadTexture.width));
+        XXH3_64bits_update(&xxh3, &RDRAM[rdramStart], rdramEnd - rdramStart);
+
+        LoadRecord record;
+        record.tmemStart = tmemStart;
+        record.tmemEnd = tmemStart + tmemBytes;
+        record.splitHalves = RGBA32;
+        record.contentKey = XXH3_64bits_digest(&xxh3);
+
+        // Discard the older records that were completely overwritten by this load.
+        const uint32_t UpperTMEM = (RDP_TMEM_BYTES >> 1);
+        auto overwritten = [&](uint32_t start, uint32_t end) {
+            const bool lowerCovered = (start >= record.tmemStart) && (end <= record.tmemEnd);
+            const bool upperCovered = record.splitHalves && (start >= (record.tmemStart + UpperTMEM)) && (end <= (record.tmemEnd + UpperTMEM));
+            return lowerCovered || upperCovered;
+        };
+
+        auto recordIt = std::remove_if(loadRecords.begin(), loadRecords.end(), [&](const LoadRecord &olderRecord) {
+            return overwritten(olderRecord.tmemStart, olderRecord.tmemEnd) && (!olderRecord.splitHalves || overwritten(olderRecord.tmemStart + UpperTMEM, olderRecord.tmemEnd + UpperTMEM));
+        });
+
+        loadRecords.erase(recordIt, loadRecords.end());
+
+        // Forgetting about the oldest record only makes the regions it covered unknown, so it's always safe to do.
+        if (loadRecords.size() >= MaxLoadRecords) {
+            loadRecords.erase(loadRecords.begin());
+        }
+
+        loadRecords.emplace_back(record);
+        overheadNanoseconds += uint64_t(overheadTimer.elapsedNanoseconds());
+    }
+
+    bool TextureManager::HashMemo::findContentKey(uint32_t tmemStart, uint32_t tmemEnd, uint64_t &contentKey, uint32_t &relativeOffset) const {
+        const uint32_t UpperTMEM = (RDP_TMEM_BYTES >> 1);
+        for (auto it = loadRecords.rbegin(); it != loadRecords.rend(); it++) {
+            const LoadRecord &record = *it;
+            for (uint32_t half = 0; half < (record.splitHalves ? 2U : 1U); half++) {
+                const uint32_t recordStart = record.tmemStart + half * UpperTMEM;
+                const uint32_t recordEnd = record.tmemEnd + half * UpperTMEM;
+                if ((tmemStart >= recordStart) && (tmemEnd <= recordEnd)) {
+                    contentKey = record.contentKey;
+                    relativeOffset = (tmemStart - recordStart) | (half << 16);
+                    return true;
+                }
+                // The most recent load that touches the range doesn't cover it entirely, so its contents are a mix of several loads.
+                else if ((tmemStart < recordEnd) && (tmemEnd > recordStart)) {
+                    return false;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    bool TextureManager::HashMemo::memoKey(const LoadTile &loadTile, uint16_t width, uint16_t height, uint32_t tlut, uint64_t &key) const {
+        if ((width == 0) || (height == 0)) {
+            return false;
+        }
+
+        // Find the same regions of TMEM that TMEMHasher reads from.
+        const bool RGBA32 = (loadTile.siz == G_IM_SIZ_32b) && (loadTile.fmt == G_IM_FMT_RGBA);
+        const uint32_t tmemSize = RGBA32 ? (RDP_TMEM_BYTES >> 1) : RDP_TMEM_BYTES;
+        const uint32_t drawBytesPerRow = std::max(uint32_t(width) << (RGBA32 ? G_IM_SIZ_16b : loadTile.siz) >> 1U, 1U);
+        const uint32_t drawBytesTotal = (loadTile.line << 3) * (height - 1) + drawBytesPerRow;
+        const uint32_t tmemAddress = (loadTile.tmem << 3) & (tmemSize - 1);
+        if ((tmemAddress + drawBytesTotal) > tmemSize) {
+            return false;
+        }
+
+        uint64_t contentKeys[3] = {};
+        uint32_t relativeOffsets[3] = {};
+        if (!findContentKey(tmemAddress, tmemAddress + drawBytesTotal, contentKeys[0], relativeOffsets[0])) {
+            return false;
+        }
+
+        if (RGBA32 && !findContentKey(tmemAddress + tmemSize, tmemAddress + tmemSize + drawBytesTotal, contentKeys[1], relativeOffsets[1])) {
+            return false;
+        }
+
+        if (tlut > 0) {
+            const bool CI4 = (loadTile.siz == G_IM_SIZ_4b);
+            const uint32_t paletteAddress = (RDP_TMEM_BYTES >> 1) + (CI4 ? (loadTile.palette << 7) : 0);
+            const uint32_t paletteBytes = CI4 ? 0x80 : 0x800;
+            if (!findContentKey(paletteAddress, paletteAddress + paletteBytes, contentKeys[2], relativeOffsets[2])) {
+                return false;
+            }
+        }
+
+        const uint32_t hashVersion = TMEMHasher::CurrentHashVersion;
+        XXH3_state_t xxh3;
+        XXH3_64bits_reset(&xxh3);
+        XXH3_64bits_update(&xxh3, contentKeys, sizeof(contentKeys));
+        XXH3_64bits_update(&xxh3, relativeOffsets, sizeof(relativeOffsets));
+        XXH3_64bits_update(&xxh3, &hashVersion, sizeof(hashVersion));
+        XXH3_64bits_update(&xxh3, &width, sizeof(width));
+        XXH3_64bits_update(&xxh3, &height, sizeof(height));
+        XXH3_64bits_update(&xxh3, &tlut, sizeof(tlut));
+        XXH3_64bits_update(&xxh3, &loadTile.line, sizeof(loadTile.line));
+        XXH3_64bits_update(&xxh3, &loadTile.siz, sizeof(loadTile.siz));
+        XXH3_64bits_update(&xxh3, &loadTile.fmt, sizeof(loadTile.fmt));
+        key = XXH3_64bits_digest(&xxh3);
+        return true;
+    }
+
+    void TextureManager::HashMemo::reset() {
+        loadRecords.clear();
+        hashMap.clear();
+    }
+
+    double TextureManager::HashMemo::hitRate() const {
+        const uint64_t totalCount = hitCount + missCount + uncachedCount;
+        return (totalCount > 0) ? (double(hitCount) / double(totalCount)) : 0.0;
+    }
+
+    double TextureManager::HashMemo::savedMilliseconds() const {
+        if (hashedCount == 0) {
+            return 0.0;
+        }
+
+        const double averageHashNanoseconds = double(hashNanoseconds) / double(hashedCount);
+        return (double(hitCount) * averageHashNanoseconds - double(overheadNanoseconds)) / 1000000.0;
+    }
+
     // TextureManager
 
     uint64_t TextureManager::uploadTMEM(State *state, const LoadTile &loadTile, TextureCache *textureCache, uint64_t creationFrame, uint16_t byteOffset, uint16_t byteCount, uint16_t width, uint16_t height, uint32_t tlut) {
@@ -24,8 +234,7 @@ namespace RT64 {
         XXH3_64bits_update(&xxh3, &byteOffset, sizeof(byteOffset));
         XXH3_64bits_update(&xxh3, &byteCount, sizeof(byteCount));
         const uint64_t hash = XXH3_64bits_digest(&xxh3);
-        if (hashSet.find(hash) == hashSet.end()) {
-            hashSet.insert(hash);
+        if (hashSet.insert(hash)) {
             textureCache->queueGPUUploadTMEM(hash, creationFrame, TMEM, RDP_TMEM_BYTES, width, height, 0, LoadTile(), false);
         }
         
@@ -44,9 +253,52 @@ namespace RT64 {
 
     uint64_t TextureManager::uploadTexture(State *state, const LoadTile &loadTile, TextureCache *textureCache, uint64_t creationFrame, uint16_t width, uint16_t height, uint32_t tlut) {
         const uint8_t *TMEM = reinterpret_cast<const uint8_t *>(state->rdp->TMEM);
-        uint64_t hash = TMEMHasher::hash(TMEM, loadTile, width, height, tlut, TMEMHasher::CurrentHashVersion);
-        if (hashSet.find(hash) == hashSet.end()) {
-            hashSet.insert(hash);
+        uint64_t hash = 0;
+        uint64_t memoKey = 0;
+        bool memoKeyValid = false;
+        const uint64_t *memoHash = nullptr;
+        if (hashMemo.enabled) {
+            ElapsedTimer memoTimer;
+            memoKeyValid = hashMemo.memoKey(loadTile, width, height, tlut, memoKey);
+            memoHash = memoKeyValid ? hashMemo.hashMap.find(memoKey) : nullptr;
+            hashMemo.overheadNanoseconds += uint64_t(memoTimer.elapsedNanoseconds());
+        }
+
+        if (memoHash != nullptr) {
+            hash = *memoHash;
+            hashMemo.hitCount++;
+
+            // A mismatch means the content key failed to capture something the TMEM contents depend on. The hash of the contents
+            // is used instead so the texture is still correct while validating.
+            if (hashMemo.validate) {
+                const uint64_t validHash = TMEMHasher::hash(TMEM, loadTile, width, height, tlut, TMEMHasher::CurrentHashVersion);
+                if (validHash != hash) {
+                    fprintf(stderr, "TMEM hash memo mismatch for key 0x%016" PRIX64 ": memoized 0x%016" PRIX64 ", hashed 0x%016" PRIX64 ".\n", memoKey, hash, validHash);
+                    hashMemo.mismatchCount++;
+                    hash = validHash;
+                }
+            }
+        }
+        else {
+            ElapsedTimer hashTimer;
+            hash = TMEMHasher::hash(TMEM, loadTile, width, height, tlut, TMEMHasher::CurrentHashVersion);
+            hashMemo.hashNanoseconds += uint64_t(hashTimer.elapsedNanoseconds());
+            hashMemo.hashedCount++;
+
+            if (memoKeyValid) {
+                if (hashMemo.hashMap.size() >= HashMemo::MaxEntries) {
+                    hashMemo.hashMap.clear();
+                }
+
+                hashMemo.hashMap.insert(memoKey, hash);
+                hashMemo.missCount++;
+            }
+            else {
+                hashMemo.uncachedCount++;
+            }
+        }
+
+        if (hashSet.insert(hash)) {
             textureCache->queueGPUUploadTMEM(hash, creationFrame, TMEM, RDP_TMEM_BYTES, width, height, tlut, loadTile, true);
         }
 
@@ -63,20 +315,20 @@ namespace RT64 {
             return;
         }
 
-        // Insert into set regardless of whether the dump is successful or not.
-        dumpedSet.insert(hash);
-        
-        // Dump the entirety of TMEM.
-        char baseName[64];
-        snprintf(baseName, sizeof(baseName), "%016" PRIx64 ".v%u", hash, TMEMHasher::CurrentHashVersion);
-        std::filesystem::path dumpTmemPath = state->dumpingTexturesDirectory / (std::string(baseName) + ".tmem");
-        std::ofstream dumpTmemStream(dumpTmemPath, std::ios::binary);
-        if (dumpTmemStream.is_open()) {
-            const char *TMEM = reinterpret_cast<const char *>(state->rdp->TMEM);
-            dumpTmemStream.write(TMEM, RDP_TMEM_BYTES);
-            dumpTmemStream.close();
+        if (dumper == nullptr) {
+            dumper = std::make_unique<TextureDumper>();
         }
 
+        TextureDumper::Dump dump;
+        dump.hash = hash;
+        dump.directory = state->dumpingTexturesDirectory;
+        dump.archive = state->dumpingTexturesArchive;
+        dump.loadTile = loadTile;
+        dump.width = width;
+        dump.height = height;
+        dump.tlut = tlut;
+        dump.tmemSize = RDP_TMEM_BYTES;
+
         // Dump the RDRAM last loaded into the TMEM address pointed to by the tile. Required for generating hashes used by Rice.
         const LoadOperation &loadOp = state->rdp->rice.lastLoadOpByTMEM[loadTile.tmem];
         uint32_t rdramStart = loadOp.texture.address;
@@ -93,8 +345,6 @@ namespace RT64 {
         }
         else if (loadOp.type == LoadOperation::Type::Tile) {
             uint32_t rowCount = 1 + ((loadOp.tile.lrt >> 2) - (loadOp.tile.ult >> 2));
-            uint32_t tileWidth = ((loadOp.tile.lrs >> 2) - (loadOp.tile.uls >> 2));
-            uint32_t wordsPerRow = (tileWidth >> (4 - loadOp.tile.siz)) + 1;
             rdramStart = loadOp.texture.address + commonBytesOffset + commonBytesPerRow * (loadOp.tile.ult >> 2);
             rdramCount = rowCount * commonBytesPerRow;
         }
@@ -102,29 +352,11 @@ namespace RT64 {
         // Dump more RDRAM if necessary if it doesn't cover what the tile could possibly sample.
         uint32_t loadTileBpr = width << loadTile.siz >> 1;
         rdramCount = std::max(rdramCount, std::max(loadTileBpr, commonBytesPerRow) * height);
+        dump.loadOp = loadOp;
+        dump.rdramSize = rdramCount;
 
-        if (rdramCount > 0) {
-            std::filesystem::path dumpRdramPath = state->dumpingTexturesDirectory / (std::string(baseName) + ".rice.rdram");
-            std::ofstream dumpRdramStream(dumpRdramPath, std::ios::binary);
-            if (dumpRdramStream.is_open()) {
-                const char *RDRAM = reinterpret_cast<const char *>(state->RDRAM);
-                dumpRdramStream.write(&RDRAM[rdramStart], rdramCount);
-                dumpRdramStream.close();
-            }
-
-            std::filesystem::path dumpRdramInfoPath = state->dumpingTexturesDirectory / (std::string(baseName) + ".rice.json");
-            std::ofstream dumpRdramInfoStream(dumpRdramInfoPath);
-            if (dumpRdramInfoStream.is_open()) {
-                json jroot;
-                jroot["tile"] = loadOp.tile;
-                jroot["type"] = loadOp.type;
-                jroot["texture"] = loadOp.texture;
-                dumpRdramInfoStream << std::setw(4) << jroot << std::endl;
-                dumpRdramInfoStream.close();
-            }
-        }
-        
         // Repeat a similar process for dumping the palette.
+        uint32_t paletteRdramStart = 0;
         if (tlut > 0) {
             const bool CI4 = (loadTile.siz == G_IM_SIZ_4b);
             const int32_t paletteTMEM = (RDP_TMEM_WORDS >> 1) + (CI4 ? (loadTile.palette << 4) : 0);
@@ -133,52 +365,16 @@ namespace RT64 {
             uint32_t paletteBytesPerRow = paletteLoadOp.texture.width << paletteLoadOp.texture.siz >> 1;
             const uint32_t rowCount = 1 + ((paletteLoadOp.tile.lrt >> 2) - (paletteLoadOp.tile.ult >> 2));
             const uint32_t wordsPerRow = ((paletteLoadOp.tile.lrs >> 2) - (paletteLoadOp.tile.uls >> 2)) + 1;
-            uint32_t paletteRdramStart = paletteLoadOp.texture.address + paletteBytesOffset + paletteBytesPerRow * (paletteLoadOp.tile.ult >> 2);
-            uint32_t paletteRdramCount = (rowCount - 1) * paletteBytesPerRow + (wordsPerRow << 3);
-            if (paletteRdramCount > 0) {
-                std::filesystem::path dumpPaletteRdramPath = state->dumpingTexturesDirectory / (std::string(baseName) + ".rice.palette.rdram");
-                std::ofstream dumpPaletteRdramStream(dumpPaletteRdramPath, std::ios::binary);
-                if (dumpPaletteRdramStream.is_open()) {
-                    const char *RDRAM = reinterpret_cast<const char *>(state->RDRAM);
-                    dumpPaletteRdramStream.write(&RDRAM[paletteRdramStart], paletteRdramCount);
-                    dumpPaletteRdramStream.close();
-                }
-            }
-
-            std::filesystem::path dumpPaletteRdramInfoPath = state->dumpingTexturesDirectory / (std::string(baseName) + ".rice.palette.json");
-            std::ofstream dumpPaletteRdramInfoStream(dumpPaletteRdramInfoPath);
-            if (dumpPaletteRdramInfoStream.is_open()) {
-                json jroot;
-                jroot["tile"] = paletteLoadOp.tile;
-                jroot["type"] = paletteLoadOp.type;
-                jroot["texture"] = paletteLoadOp.texture;
-                dumpPaletteRdramInfoStream << std::setw(4) << jroot << std::endl;
-                dumpPaletteRdramInfoStream.close();
-            }
+            paletteRdramStart = paletteLoadOp.texture.address + paletteBytesOffset + paletteBytesPerRow * (paletteLoadOp.tile.ult >> 2);
+            dump.paletteLoadOp = paletteLoadOp;
+            dump.paletteRdramSize = (rowCount - 1) * paletteBytesPerRow + (wordsPerRow << 3);
         }
 
-        // Dump the parameters of the tile into a JSON file.
-        std::filesystem::path dumpTilePath = state->dumpingTexturesDirectory / (std::string(baseName) + ".tile.json");
-        std::ofstream dumpTileStream(dumpTilePath);
-        if (dumpTileStream.is_open()) {
-            json jroot;
-            jroot["tile"] = loadTile;
-            jroot["width"] = width;
-            jroot["height"] = height;
-
-            // Serialize the TLUT into an enum instead.
-            if (tlut == G_TT_RGBA16) {
-                jroot["tlut"] = LoadTLUT::RGBA16;
-            }
-            else if (tlut == G_TT_IA16) {
-                jroot["tlut"] = LoadTLUT::IA16;
-            }
-            else {
-                jroot["tlut"] = LoadTLUT::None;
-            }
-
-            dumpTileStream << std::setw(4) << jroot << std::endl;
-            dumpTileStream.close();
+        // The files are written by the dumper's thread. Only mark the hash as dumped if the dump wasn't dropped so it's tried again
+        // the next time the texture is uploaded.
+        const uint8_t *TMEM = reinterpret_cast<const uint8_t *>(state->rdp->TMEM);
+        if (dumper->queue(dump, TMEM, &state->RDRAM[rdramStart], &state->RDRAM[paletteRdramStart])) {
+            dumpedSet.insert(hash);
         }
     }
 
@@ -6,19 +6,63 @@
 
 #include <set>
 
+#include "common/rt64_flat_hash_map.h"
 #include "hle/rt64_draw_call.h"
+#include "hle/rt64_texture_dumper.h"
 #include "render/rt64_texture_cache.h"
 
 namespace RT64 {
     struct State;
 
     struct TextureManager {
-        std::set<uint64_t> hashSet;
+        // TMEM region written by a load operation along with a key that identifies the contents it wrote.
+        struct LoadRecord {
+            uint32_t tmemStart = 0;
+            uint32_t tmemEnd = 0;
+
+            // RGBA32 loads write the same range on the lower and the upper half of TMEM.
+            bool splitHalves = false;
+            uint64_t contentKey = 0;
+        };
+
+        // Maps the content keys of the loads that fully cover the TMEM regions sampled by a tile, along with the parameters of the
+        // tile, to the TMEM hash that was computed for it. Repeated loads of the same RDRAM contents can skip hashing TMEM.
+        struct HashMemo {
+            static const uint32_t MaxLoadRecords;
+            static const size_t MaxEntries;
+
+            std::vector<LoadRecord> loadRecords;
+            FlatHashMap<uint64_t> hashMap;
+            uint64_t hitCount = 0;
+            uint64_t missCount = 0;
+            uint64_t uncachedCount = 0;
+            uint64_t hashedCount = 0;
+            uint64_t hashNanoseconds = 0;
+            uint64_t overheadNanoseconds = 0;
+            uint64_t mismatchCount = 0;
+            bool enabled = true;
+
+            // Hashes TMEM again on every hit to verify the memoized hash matches it.
+            bool validate = false;
+
+            void recordLoad(const LoadOperation &loadOp, const uint8_t *RDRAM);
+            bool findContentKey(uint32_t tmemStart, uint32_t tmemEnd, uint64_t &contentKey, uint32_t &relativeOffset) const;
+            bool memoKey(const LoadTile &loadTile, uint16_t width, uint16_t height, uint32_t tlut, uint64_t &key) const;
+            void reset();
+            double hitRate() const;
+
+            // Estimated from the average time it took to hash TMEM on every miss, minus the time spent on the memo itself.
+            double savedMilliseconds() const;
+        };
+
+        FlatHashSet hashSet;
         std::set<uint64_t> dumpedSet;
+        std::unique_ptr<TextureDumper> dumper;
+        HashMemo hashMemo;
 
         uint64_t uploadTMEM(State *state, const LoadTile &loadTile, TextureCache *textureCache, uint64_t creationFrame, uint16_t byteOffset, uint16_t byteCount, uint16_t width, uint16_t height, uint32_t tlut);
         uint64_t uploadTexture(State *state, const LoadTile &loadTile, TextureCache *textureCache, uint64_t creationFrame, uint16_t width, uint16_t height, uint32_t tlut);
         void dumpTexture(uint64_t hash, State *state, const LoadTile &loadTile, uint16_t width, uint16_t height, uint32_t tlut);
         void removeHashes(const std::vector<uint64_t> &hashes);
     };
-};
\ No newline at end of file
+};
@@ -0,0 +1,158 @@
+//
+// RT64
+//
+
+#include "rt64_rdram_writeback.h"
+
+#include <algorithm>
+
+#include "xxHash/xxh3.h"
+
+namespace RT64 {
+    // RDRAMWriteback
+
+    void RDRAMWriteback::addCopy(Framebuffer *framebuffer, uint32_t rowWidth, uint32_t rowStart, uint32_t rowEnd) {
+        assert(framebuffer != nullptr);
+
+        Copy copy;
+        copy.framebuffer = framebuffer;
+        copy.rowWidth = rowWidth;
+        copy.rowStart = rowStart;
+        copy.rowEnd = rowEnd;
+        copies.emplace_back(copy);
+
+        addressStart = std::min(addressStart, framebuffer->addressStart);
+        addressEnd = std::max(addressEnd, framebuffer->addressStart + framebuffer->imageRowBytes(rowWidth) * rowEnd);
+    }
+
+    void RDRAMWriteback::submit(RenderWorker *worker, int workloadCursor, const uint8_t *RDRAM) {
+        assert(worker != nullptr);
+        assert(RDRAM != nullptr);
+
+        for (Copy &copy : copies) {
+            const Framebuffer *fb = copy.framebuffer;
+            const uint32_t rowBytes = fb->imageRowBytes(copy.rowWidth);
+            const uint32_t rowEnd = std::min(copy.rowEnd, fb->height);
+            const uint8_t *fbRAM = &RDRAM[fb->addressStart];
+            copy.rowHashes.resize((rowEnd > copy.rowStart) ? (rowEnd - copy.rowStart) : 0);
+            for (uint32_t i = 0; i < copy.rowHashes.size(); i++) {
+                copy.rowHashes[i] = XXH3_64bits(&fbRAM[(copy.rowStart + i) * rowBytes], rowBytes);
+            }
+        }
+
+        const std::scoped_lock<std::mutex> gpuLock(gpuMutex);
+        assert(!gpuPending && "The previous writeback must be flushed before submitting a new one.");
+        this->worker = worker;
+        this->workloadCursor = workloadCursor;
+        worker->execute();
+        submissionTimestamp = Timer::current();
+        gpuPending = true;
+        deferred = true;
+        deferredCount++;
+    }
+
+    void RDRAMWriteback::waitForGPU() {
+        const std::scoped_lock<std::mutex> gpuLock(gpuMutex);
+        if (gpuPending) {
+            worker->wait();
+            completionTimestamp = Timer::current();
+            gpuPending = false;
+        }
+    }
+
+    void RDRAMWriteback::waitForWorkload(int workloadCursor) {
+        const std::scoped_lock<std::mutex> gpuLock(gpuMutex);
+        if (gpuPending && (this->workloadCursor == workloadCursor)) {
+            worker->wait();
+            completionTimestamp = Timer::current();
+            gpuPending = false;
+        }
+    }
+
+    bool RDRAMWriteback::pending() const {
+        return !copies.empty();
+    }
+
+    bool RDRAMWriteback::isDeferred() const {
+        return deferred;
+    }
+
+    bool RDRAMWriteback::overlaps(uint32_t addressStart, uint32_t addressEnd) const {
+        return pending() && (addressStart < this->addressEnd) && (addressEnd > this->addressStart);
+    }
+
+    bool RDRAMWriteback::writeToRAM(uint8_t *RDRAM) {
+        assert(RDRAM != nullptr);
+
+        if (!pending()) {
+            return false;
+        }
+
+        if (deferred) {
+            ElapsedTimer blockedTimer;
+            waitForGPU();
+
+            // The synchronous path would've blocked for the whole time the GPU took to finish the work, so only the time that was
+            // spent blocked here was not saved. The GPU might've finished earlier than the completion time if another thread waited.
+            const double blockedMilliseconds = blockedTimer.elapsedMilliseconds();
+            const double gpuMilliseconds = Timer::deltaMicroseconds(submissionTimestamp, completionTimestamp) / 1000.0;
+            stallBlockedProfiler.accumulation = blockedMilliseconds;
+            stallBlockedProfiler.log();
+            stallSavedProfiler.accumulation = std::max(gpuMilliseconds - blockedMilliseconds, 0.0);
+            stallSavedProfiler.log();
+            if (blockedMilliseconds >= 0.1) {
+                blockedCount++;
+            }
+
+            deferred = false;
+        }
+
+        // Rows written by the CPU are detected for all copies before writing any of them, as multiple copies can target the same rows.
+        skippedFramebuffers.clear();
+        for (Copy &copy : copies) {
+            Framebuffer *fb = copy.framebuffer;
+            const uint8_t *fbRAM = &RDRAM[fb->addressStart];
+            const uint32_t rowBytes = fb->imageRowBytes(copy.rowWidth);
+            copy.rowsSkipped.assign(copy.rowHashes.size(), 0);
+            for (uint32_t i = 0; i < copy.rowHashes.size(); i++) {
+                copy.rowsSkipped[i] = XXH3_64bits(&fbRAM[(copy.rowStart + i) * rowBytes], rowBytes) != copy.rowHashes[i];
+                if (copy.rowsSkipped[i] && (std::find(skippedFramebuffers.begin(), skippedFramebuffers.end(), fb) == skippedFramebuffers.end())) {
+                    skippedFramebuffers.emplace_back(fb);
+                }
+            }
+        }
+
+        for (const Copy &copy : copies) {
+            Framebuffer *fb = copy.framebuffer;
+            uint8_t *fbRAM = &RDRAM[fb->addressStart];
+            const uint32_t rowEnd = std::min(copy.rowEnd, fb->height);
+            if (copy.rowHashes.empty()) {
+                fb->copyNativeToRAM(fbRAM, copy.rowWidth, copy.rowStart, rowEnd);
+                continue;
+            }
+
+            // Only copy the ranges of rows that still hold the same contents they had when the writeback was submitted.
+            const uint32_t hashedRowEnd = std::min(rowEnd, copy.rowStart + uint32_t(copy.rowHashes.size()));
+            uint32_t rangeStart = copy.rowStart;
+            for (uint32_t row = copy.rowStart; row < hashedRowEnd; row++) {
+                if (copy.rowsSkipped[row - copy.rowStart]) {
+                    if (row > rangeStart) {
+                        fb->copyNativeToRAM(fbRAM, copy.rowWidth, rangeStart, row);
+                    }
+
+                    rangeStart = row + 1;
+                }
+            }
+
+            if (hashedRowEnd > rangeStart) {
+                fb->copyNativeToRAM(fbRAM, copy.rowWidth, rangeStart, hashedRowEnd);
+            }
+        }
+
+        copies.clear();
+        addressStart = UINT32_MAX;
+        addressEnd = 0;
+        workloadCursor = -1;
+        return true;
+    }
+};
@@ -0,0 +1,68 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "common/rt64_profiling_timer.h"
+#include "render/rt64_render_worker.h"
+
+#include "rt64_framebuffer.h"
+
+namespace RT64 {
+    // Render to RAM results that were submitted to the GPU but haven't been written back to RDRAM yet. The GPU work can be
+    // waited on from any thread, but the copies to RDRAM must be done by the thread that processes the display lists.
+    struct RDRAMWriteback {
+        struct Copy {
+            Framebuffer *framebuffer = nullptr;
+            uint32_t rowWidth = 0;
+            uint32_t rowStart = 0;
+            uint32_t rowEnd = 0;
+
+            // Hashes of the rows in RDRAM at the time the writeback was deferred. Rows the CPU wrote to before the flush are
+            // detected through these and are not overwritten, as the CPU's writes are the most recent ones.
+            std::vector<uint64_t> rowHashes;
+            std::vector<uint8_t> rowsSkipped;
+        };
+
+        std::vector<Copy> copies;
+        std::vector<Framebuffer *> skippedFramebuffers;
+        uint32_t addressStart = UINT32_MAX;
+        uint32_t addressEnd = 0;
+        RenderWorker *worker = nullptr;
+        int workloadCursor = -1;
+        std::mutex gpuMutex;
+        bool gpuPending = false;
+        bool deferred = false;
+        Timestamp submissionTimestamp;
+        Timestamp completionTimestamp;
+        ProfilingTimer stallSavedProfiler = ProfilingTimer(120);
+        ProfilingTimer stallBlockedProfiler = ProfilingTimer(120);
+        uint64_t deferredCount = 0;
+        uint64_t blockedCount = 0;
+
+        void addCopy(Framebuffer *framebuffer, uint32_t rowWidth, uint32_t rowStart, uint32_t rowEnd);
+
+        // Executes the worker's command list without waiting for it. The worker must not be used again until the writeback is flushed.
+        // The current contents of RDRAM are hashed so any writes done by the CPU before the flush can be preserved.
+        void submit(RenderWorker *worker, int workloadCursor, const uint8_t *RDRAM);
+
+        // Thread-safe. Does nothing if there's no GPU work pending.
+        void waitForGPU();
+
+        // Thread-safe. Only waits if the pending GPU work was recorded with the buffers of the workload.
+        void waitForWorkload(int workloadCursor);
+
+        bool pending() const;
+        bool isDeferred() const;
+        bool overlaps(uint32_t addressStart, uint32_t addressEnd) const;
+
+        // Performs all the pending copies to RDRAM, waiting for the GPU first if they were submitted with a deferred writeback.
+        // Rows written by the CPU since the submission are skipped and their framebuffers are stored in skippedFramebuffers.
+        // Returns false if there was nothing to write.
+        bool writeToRAM(uint8_t *RDRAM);
+    };
+};
@@ -14,6 +14,7 @@
 
 #include "rt64_interpreter.h"
 #include "rt64_state.h"
+#include "rt64_vertex_ingest.h"
 
 //#define LOG_SPECIAL_MATRIX_OPERATIONS
 
@@ -330,10 +331,11 @@ namespace RT64 {
 
         const uint32_t rdramAddress = fromSegmentedMaskedPD(address);
         const VertexPD *dlVerts = reinterpret_cast<const VertexPD *>(state->fromRDRAM(rdramAddress));
+        const uint8_t *palette = state->fromRDRAM(vertexColorPDAddress);
         for (uint32_t i = 0; i < vtxCount; i++) {
             Vertex &dst = vertices[dstIndex + i];
             const VertexPD &src = dlVerts[i];
-            const uint8_t *col = state->fromRDRAM(vertexColorPDAddress + (src.ci & 0xFFU));
+            const uint8_t *col = palette + (src.ci & 0xFFU);
             dst.x = src.x;
             dst.y = src.y;
             dst.z = src.z;
@@ -416,7 +418,9 @@ namespace RT64 {
     }
 
     template<bool addEmptyVelocity>
-    void RSP::setVertexCommon(uint8_t dstIndex, uint8_t dstMax) {
+    void RSP::setVertexCommon(uint32_t dstIndex, uint32_t dstMax) {
+        assert((dstIndex <= dstMax) && (dstMax <= RSP_MAX_VERTICES));
+
         const int workloadCursor = state->ext.workloadQueue->writeCursor;
         Workload &workload = state->ext.workloadQueue->workloads[workloadCursor];
 
@@ -585,55 +589,50 @@ namespace RT64 {
         auto &posScreen = workload.drawData.posScreen;
         const auto &mvp = modelViewProjMatrix;
         const uint32_t globalIndex = workload.drawData.vertexCount();
+        const uint32_t vertexCount = dstMax - dstIndex;
+        const size_t posStart = posShorts.size();
+        const size_t normColStart = normColBytes.size();
+        posShorts.resize(posStart + vertexCount * 3);
+        normColBytes.resize(normColStart + vertexCount * 4);
+        VertexIngest::convertPositionsColors(&vertices[dstIndex], vertexCount, posShorts.data() + posStart, normColBytes.data() + normColStart);
+        viewProjIndices.insert(viewProjIndices.end(), vertexCount, curViewProjIndex);
+        worldIndices.insert(worldIndices.end(), vertexCount, curTransformIndex);
+        fogIndices.insert(fogIndices.end(), vertexCount, curFogIndex);
+        lightIndices.insert(lightIndices.end(), vertexCount, curLightIndex);
+        lightCounts.insert(lightCounts.end(), vertexCount, curLightCount);
+        lookAtIndices.insert(lookAtIndices.end(), vertexCount, curLookAtIndex);
+        if constexpr (addEmptyVelocity) {
+            velShorts.insert(velShorts.end(), vertexCount * 3, int16_t(0));
+        }
+
         for (uint32_t i = dstIndex; i < dstMax; i++) {
-            auto &v = vertices[i];
-            posShorts.emplace_back(v.x);
-            posShorts.emplace_back(v.y);
-            posShorts.emplace_back(v.z);
-            normColBytes.emplace_back(v.color.r);
-            normColBytes.emplace_back(v.color.g);
-            normColBytes.emplace_back(v.color.b);
-            normColBytes.emplace_back(v.color.a);
-            viewProjIndices.emplace_back(curViewProjIndex);
-            worldIndices.emplace_back(curTransformIndex);
-            fogIndices.emplace_back(curFogIndex);
-            lightIndices.emplace_back(curLightIndex);
-            lightCounts.emplace_back(curLightCount);
-            lookAtIndices.emplace_back(curLookAtIndex);
             indices[i] = uint32_t(globalIndex) + (i - dstIndex);
             used[i] = false;
-
-            if constexpr (addEmptyVelocity) {
-                velShorts.emplace_back(0);
-                velShorts.emplace_back(0);
-                velShorts.emplace_back(0);
-            }
         }
 
-        for (uint32_t i = dstIndex; i < dstMax; i++) {
-            auto &v = vertices[i];
-            const hlslpp::float4 tfPos = hlslpp::mul(hlslpp::float4(v.x, v.y, v.z, 1.0f), mvp);
-            const interop::RSPViewport &viewport = viewportStack[viewportStackSize - 1];
-            posTransformed.emplace_back(tfPos);
-            posScreen.emplace_back((tfPos.xyz / hlslpp::float3(tfPos.w, -tfPos.w, tfPos.w)) * viewport.scale + viewport.translate);
+        const interop::RSPViewport &viewport = viewportStack[viewportStackSize - 1];
+        float transformedFloats[RSP_MAX_VERTICES * 4];
+        float screenFloats[RSP_MAX_VERTICES * 4];
+        VertexIngest::transformPositions(&vertices[dstIndex], vertexCount, mvp, viewport, transformedFloats, screenFloats);
+        for (uint32_t i = 0; i < vertexCount; i++) {
+            const float *tf = &transformedFloats[i * 4];
+            const float *sc = &screenFloats[i * 4];
+            posTransformed.emplace_back(tf[0], tf[1], tf[2], tf[3]);
+            posScreen.emplace_back(sc[0], sc[1], sc[2]);
         }
 
+        const size_t tcStart = tcFloats.size();
+        tcFloats.resize(tcStart + vertexCount * 2);
         if (usesTextureGen) {
             const float TextureSc = static_cast<float>(textureState.sc);
             const float TextureTc = static_cast<float>(textureState.tc);
-            for (uint32_t i = dstIndex; i < dstMax; i++) {
-                tcFloats.emplace_back(TextureSc);
-                tcFloats.emplace_back(TextureTc);
+            for (uint32_t i = 0; i < vertexCount; i++) {
+                tcFloats[tcStart + i * 2 + 0] = TextureSc;
+                tcFloats[tcStart + i * 2 + 1] = TextureTc;
             }
         }
         else {
-            const int32_t TextureSc = (int32_t)(textureState.sc);
-            const int32_t TextureTc = (int32_t)(textureState.tc);
-            const double Divisor = 65536.0f * 32.0f;
-            for (uint32_t i = dstIndex; i < dstMax; i++) {
-                tcFloats.emplace_back((float)((double)((vertices[i].s) * TextureSc) / Divisor));
-                tcFloats.emplace_back((float)((double)((vertices[i].t) * TextureTc) / Divisor));
-            }
+            VertexIngest::convertTexcoords(&vertices[dstIndex], vertexCount, textureState.sc, textureState.tc, tcFloats.data() + tcStart);
         }
     }
 
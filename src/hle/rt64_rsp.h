@@ -240,7 +240,7 @@ namespace RT64 {
         void setVertexEXV1(uint32_t address, uint8_t vtxCount, uint32_t dstIndex);
         void setVertexColorPD(uint32_t address);
         template<bool addEmptyVelocity>
-        void setVertexCommon(uint8_t dstIndex, uint8_t dstMax);
+        void setVertexCommon(uint32_t dstIndex, uint32_t dstMax);
         void modifyVertex(uint16_t dstIndex, uint16_t dstAttribute, uint32_t value);
         void setGeometryMode(uint32_t mask);
         void pushGeometryMode();
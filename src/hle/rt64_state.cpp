@@ -89,6 +89,10 @@ namespace RT64 {
 
         rsp->reset();
         rdp->reset();
+
+        // The loads recorded by the memo no longer describe the contents of TMEM.
+        textureManager.hashMemo.reset();
+
         resetDrawCall();
     }
 
@@ -561,6 +565,9 @@ namespace RT64 {
     }
     
     void State::checkRDRAM() {
+        // Any render to RAM results that were deferred must be in RDRAM before the display list can read from it.
+        flushRDRAMWriteback();
+
         if (!rdramCheckPending) {
             return;
         }
@@ -585,6 +592,22 @@ namespace RT64 {
         rdramCheckPending = false;
     }
 
+    void State::flushRDRAMWriteback() {
+        RDRAMWriteback &rdramWriteback = ext.workloadQueue->rdramWriteback;
+        if (rdramWriteback.writeToRAM(RDRAM)) {
+            // Indicate to the texture cache it's safe to delete the textures if no locks are active.
+            ext.textureCache->decrementLock();
+
+            framebufferManager.hashTracking(RDRAM, rdramWriteback.skippedFramebuffers);
+        }
+    }
+
+    void State::flushRDRAMWriteback(uint32_t addressStart, uint32_t addressEnd) {
+        if (ext.workloadQueue->rdramWriteback.overlaps(addressStart, addressEnd)) {
+            flushRDRAMWriteback();
+        }
+    }
+
     void State::fullSyncFramebufferPairTiles(Workload &workload, FramebufferPair &fbPair, uint32_t &loadOpCursor, uint32_t &rdpTileCursor) {
         auto loadOperation = [&](uint32_t loadOpIndex) {
             const auto &loadOp = workload.drawData.loadOperations[loadOpIndex];
@@ -592,6 +615,9 @@ namespace RT64 {
             // For emulating how Rice hashes textures, we need information about the load operation that was performed in the particular TMEM address.
             rdp->rice.lastLoadOpByTMEM[loadOp.tile.tmem] = loadOp;
 
+            // Keep track of the contents of RDRAM this operation loads so the TMEM hashes of the tiles that sample it can be memoized.
+            textureManager.hashMemo.recordLoad(loadOp, RDRAM);
+
             switch (loadOp.type) {
             case LoadOperation::Type::Block:
                 rdp->loadBlockOperation(loadOp.tile, loadOp.texture, false);
@@ -704,7 +730,11 @@ namespace RT64 {
     }
     
     void State::fullSync() {
+        flushRDRAMWriteback();
         flush();
+
+        // No render to RAM work is pending on the GPU after the flush, so the idle targets can be evicted.
+        renderTargetManager.evictIdle(*renderFramebufferManager, uint64_t(ext.userConfig->renderTargetBudget) * 1024 * 1024);
         submitFramebufferPair(FramebufferPair::FlushReason::ProcessDisplayListsEnd);
 
         // Append any framebuffer operations to the end of the last framebuffer pair.
@@ -1178,7 +1208,7 @@ namespace RT64 {
                 resizedTargets.clear();
             };
 
-            auto renderAndSynchronize = [&](uint32_t maxFramebufferPair) {
+            auto renderAndSynchronize = [&](uint32_t maxFramebufferPair, bool deferWriteback) {
                 // Preprocess all the framebuffer operations.
                 uint32_t pairCursor = framebufferPairCursor;
                 while (pairCursor < maxFramebufferPair) {
@@ -1385,22 +1415,31 @@ namespace RT64 {
 
                 ext.framebufferGraphicsWorker->commandList->end();
                 framebufferRenderer->waitForUploaders();
-                ext.framebufferGraphicsWorker->execute();
-                ext.framebufferGraphicsWorker->wait();
 
+                // When deferred, the copies to RDRAM are only done once the emulator needs to read the memory.
+                RDRAMWriteback &rdramWriteback = ext.workloadQueue->rdramWriteback;
                 pairCursor = framebufferPairCursor;
                 while (pairCursor < maxFramebufferPair) {
                     if (getFramebufferPairs(pairCursor)) {
-                        colorFb->copyNativeToRAM(&RDRAM[colorFb->addressStart], colorWriteWidth, colorRowStart, std::min(colorRowEnd, colorFb->height));
+                        rdramWriteback.addCopy(colorFb, colorWriteWidth, colorRowStart, colorRowEnd);
 
                         if (depthWriteWidth > 0) {
-                            depthFb->copyNativeToRAM(&RDRAM[depthFb->addressStart], depthWriteWidth, depthRowStart, std::min(depthRowEnd, depthFb->height));
+                            rdramWriteback.addCopy(depthFb, depthWriteWidth, depthRowStart, depthRowEnd);
                         }
                     }
 
                     pairCursor++;
                 }
 
+                if (deferWriteback) {
+                    rdramWriteback.submit(ext.framebufferGraphicsWorker, workloadCursor, RDRAM);
+                }
+                else {
+                    ext.framebufferGraphicsWorker->execute();
+                    ext.framebufferGraphicsWorker->wait();
+                    rdramWriteback.writeToRAM(RDRAM);
+                }
+
                 framebufferPairCursor = maxFramebufferPair;
             };
 
@@ -1468,15 +1507,15 @@ namespace RT64 {
                 }
 
                 if (fbPair.syncRequired) {
-                    renderAndSynchronize(f);
+                    renderAndSynchronize(f, false);
                     renderSetup();
                 }
 
                 fullSyncFramebufferPairTiles(workload, fbPair, loadOpCursor, rdpTileCursor);
             }
 
-            // Render any remaining batches of framebuffers.
-            renderAndSynchronize(workload.fbPairCount);
+            // Render any remaining batches of framebuffers. Nothing else reads RDRAM during this workload after the last batch.
+            renderAndSynchronize(workload.fbPairCount, ext.emulatorConfig->framebuffer.asyncWriteback);
         }
         else {
             // Process all tiles.
@@ -1507,10 +1546,13 @@ namespace RT64 {
         }
 
         if (renderToRDRAM) {
-            // Indicate to the texture cache it's safe to delete the textures if no locks are active.
-            ext.textureCache->decrementLock();
+            // The texture cache lock and the hash tracking are released by the flush if the writeback was deferred.
+            if (!ext.workloadQueue->rdramWriteback.isDeferred()) {
+                // Indicate to the texture cache it's safe to delete the textures if no locks are active.
+                ext.textureCache->decrementLock();
 
-            framebufferManager.hashTracking(RDRAM);
+                framebufferManager.hashTracking(RDRAM);
+            }
 
             advanceFramebufferRenderer();
 
@@ -1809,6 +1851,11 @@ namespace RT64 {
         bool fbChangesMade = false;
         bool screenChangesMade = false;
         if (newVI.visible()) {
+            // Only wait for a deferred render to RAM if the VI origin points at the memory it writes to.
+            if (screenFbSiz >= G_IM_SIZ_16b) {
+                flushRDRAMWriteback(screenFbAddress, screenFbAddress + (uint32_t(screenFbSize.x * screenFbSize.y) << (screenFbSiz - 1)));
+            }
+
             // See if there's an existing framebuffer that lines up with the VI. If there is, we support reading 
             // CPU changes directly to it and recreating them in the render thread at low resolution.
             RenderWorker *worker = ext.framebufferGraphicsWorker;
@@ -1817,9 +1864,11 @@ namespace RT64 {
                 // Check compatibility of the high resolution framebuffer with the VI first.
                 // Ensure both the siz and width are the same.
                 if ((screenFbSize.x == screenFb->width) && (screenFbSiz == screenFb->siz)) {
-                    const uint8_t *fbRAM = &RDRAM[screenFb->addressStart];
-                    uint64_t currentHash = XXH3_64bits(fbRAM, screenFb->RAMBytes);
+                    uint64_t currentHash = framebufferManager.hashRAM(*screenFb, RDRAM, framebufferManager.RAMWriteTracking);
                     if (currentHash != screenFb->RAMHash) {
+                        // The worker can't be used again until the deferred writeback is done with it.
+                        flushRDRAMWriteback();
+
                         {
                             RenderWorkerExecution workerExecution(worker);
                             thread_local std::vector<uint32_t> fbDiscards;
@@ -1834,10 +1883,11 @@ namespace RT64 {
 
                         // Only update the hash if it's not a discard.
                         if (present.fbOperations.front().type == FramebufferOperation::Type::WriteChanges) {
-                            screenFb->RAMHash = currentHash;
+                            framebufferManager.commitRAMHash(*screenFb, currentHash);
                             fbChangesMade = true;
                         }
                         else {
+                            screenFb->nativeSwappedRAMValid = false;
                             present.fbOperations.clear();
                         }
                     }
@@ -1878,6 +1928,9 @@ namespace RT64 {
 
     void State::updateMultisampling() {
         const RenderMultisampling multisampling = RasterShader::generateMultisamplingPattern(ext.userConfig->msaaSampleCount(), ext.device->getCapabilities().sampleLocations);
+
+        // A deferred writeback might still be using the render targets on the GPU.
+        ext.workloadQueue->rdramWriteback.waitForGPU();
         renderFramebufferManager->destroyAll();
         renderTargetManager.destroyAll();
         renderTargetManager.setMultisampling(multisampling);
@@ -2068,6 +2121,12 @@ namespace RT64 {
                         genConfigChanged = ImGui::InputInt("Refresh Rate Target", &userConfig.refreshRateTarget) || genConfigChanged;
                     }
 
+                    if (userConfig.refreshRate != UserConfiguration::RefreshRate::Original) {
+                        genConfigChanged = ImGui::InputInt("Present Latency Target (us)", &userConfig.presentLatencyTarget) || genConfigChanged;
+                    }
+
+                    genConfigChanged = ImGui::InputInt("Render Target Budget (MB)", &userConfig.renderTargetBudget) || genConfigChanged;
+
                     // Store the user configuration that was used during initialization the first time we check this.
                     static UserConfiguration::InternalColorFormat configColorFormat = UserConfiguration::InternalColorFormat::OptionCount;
                     if (configColorFormat == UserConfiguration::InternalColorFormat::OptionCount) {
@@ -2095,6 +2154,7 @@ namespace RT64 {
                     ImGui::Indent();
                     emulatorConfigChanged = ImGui::Checkbox("Render to RAM", &emulatorConfig.framebuffer.renderToRAM) || emulatorConfigChanged;
                     emulatorConfigChanged = ImGui::Checkbox("Copy with GPU", &emulatorConfig.framebuffer.copyWithGPU) || emulatorConfigChanged;
+                    emulatorConfigChanged = ImGui::Checkbox("Async Writeback", &emulatorConfig.framebuffer.asyncWriteback) || emulatorConfigChanged;
                     ImGui::Unindent();
 
                     // Enhancement configuration.
@@ -2152,6 +2212,28 @@ namespace RT64 {
                         ImGui::Text("Shader cache dumping is only available in D3D12.");
                     }
 
+                    ImGui::Unindent();
+                    ImGui::Text("Display list capture");
+                    ImGui::Indent();
+                    const DisplayListCapture::Writer *captureWriter = ext.app->captureWriter.get();
+                    ImGui::BeginDisabled(captureToggleQueued);
+                    if (ImGui::Button((captureWriter != nullptr) ? "Stop capturing" : "Start capturing")) {
+                        if (captureWriter != nullptr) {
+                            captureToggleQueued = true;
+                        }
+                        else {
+                            captureQueuedPath = FileDialog::getSaveFilename({ FileFilter("RT64 Capture Files", "rt64cap") });
+                            captureToggleQueued = !captureQueuedPath.empty();
+                        }
+                    }
+
+                    ImGui::EndDisabled();
+
+                    if (captureWriter != nullptr) {
+                        ImGui::SameLine();
+                        ImGui::Text("%" PRIu64 " events, %" PRIu64 " pages, %.1f MB", captureWriter->eventCount, captureWriter->pageCount, double(captureWriter->compressedSize) / (1024.0 * 1024.0));
+                    }
+
                     ImGui::Unindent();
                     ImGui::EndTabItem();
                 }
@@ -2197,6 +2279,14 @@ namespace RT64 {
                         }
                     }
 
+                    ImGui::SameLine();
+                    ImGui::Checkbox("Dump into archive", &dumpingTexturesArchive);
+                    if (textureManager.dumper != nullptr) {
+                        TextureDumper *dumper = textureManager.dumper.get();
+                        ImGui::SameLine();
+                        ImGui::Text("%" PRIu64 " written, %u pending, %" PRIu64 " dropped, %.1f MB", dumper->writtenCount.load(), dumper->getPendingCount(), dumper->droppedCount.load(), double(dumper->writtenBytes.load()) / (1024.0 * 1024.0));
+                    }
+
                     if (ext.textureCache->textureMap.replacementMap.fileSystemIsDirectory) {
                         ImGui::SameLine();
                         const bool removeUnused = ImGui::Button("Remove unused entries");
@@ -2362,15 +2452,116 @@ namespace RT64 {
                         ImGui::Text("Average Update Screen (VI Changed): %fms (%.1f FPS)\n", viChangedProfilerAverage, 1000.0 / viChangedProfilerAverage);
                         ImGui::Text("Average Update Screen (CPU): %fms (%.1f FPS)\n", screenCpuProfilerAverage, 1000.0 / screenCpuProfilerAverage);
 
+                        const DrawDataCapacity &drawDataCapacity = ext.workloadQueue->drawDataCapacity;
+                        ImGui::Text("Draw Data Reserved: %.1f KB, %" PRIu64 " growths\n", double(drawDataCapacity.reservedBytes) / 1024.0, uint64_t(drawDataCapacity.growthCount));
+
+                        const RDRAMWriteback &rdramWriteback = ext.workloadQueue->rdramWriteback;
+                        ImGui::Text("Average Writeback Stall Saved: %fms\n", rdramWriteback.stallSavedProfiler.average());
+                        ImGui::Text("Average Writeback Stall Blocked: %fms\n", rdramWriteback.stallBlockedProfiler.average());
+                        ImGui::Text("Writebacks Deferred: %" PRIu64 ", %" PRIu64 " blocked\n", rdramWriteback.deferredCount, rdramWriteback.blockedCount);
+
+                        // Show the GPU time of each pass measured with timestamp queries.
+                        if (ext.gpuProfiler != nullptr) {
+                            std::array<ProfilingTimer, GPUProfiler::SectionCount> gpuTimers;
+                            ext.gpuProfiler->copySectionTimers(gpuTimers);
+                            ImGui::NewLine();
+                            if (ImPlot::BeginPlot("GPU Passes")) {
+                                ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, FrametimeLimit);
+                                ImPlot::SetupAxis(ImAxis_Y1, "ms", ImPlotAxisFlags_AutoFit);
+                                for (uint32_t i = 0; i < GPUProfiler::SectionCount; i++) {
+                                    const ProfilingTimer &timer = gpuTimers[i];
+                                    ImPlot::PlotLine<double>(GPUProfiler::sectionName(GPUProfiler::Section(i)), timer.data(), static_cast<int>(timer.size()), 1.0, 0.0, ImPlotLineFlags_None, timer.index(), Stride);
+                                }
+
+                                ImPlot::EndPlot();
+                            }
+
+                            for (uint32_t i = 0; i < GPUProfiler::SectionCount; i++) {
+                                ImGui::Text("Average %s (GPU): %fms\n", GPUProfiler::sectionName(GPUProfiler::Section(i)), gpuTimers[i].average());
+                            }
+
+                            bool gpuProfilerEnabled = ext.gpuProfiler->enabled;
+                            if (ImGui::Checkbox("GPU Timestamps", &gpuProfilerEnabled)) {
+                                ext.gpuProfiler->enabled = gpuProfilerEnabled;
+                            }
+
+                            ImGui::SameLine();
+                            if (ImGui::Button("Export GPU Timings")) {
+                                std::filesystem::path savePath = FileDialog::getSaveFilename({ FileFilter("CSV Files", "csv") });
+                                if (!savePath.empty() && !ext.gpuProfiler->exportCSV(savePath)) {
+                                    fprintf(stderr, "Failed to export GPU timings to %s.\n", savePath.string().c_str());
+                                }
+                            }
+                        }
+
+                        // Show the frame pacing statistics of the presents that were paced to the target rate.
+                        FramePacer::Report pacerReport;
+                        ext.presentQueue->framePacer.copyReport(pacerReport);
+                        if (pacerReport.sampleCount > 0) {
+                            ImGui::NewLine();
+                            if (ImPlot::BeginPlot("Frame Pacing")) {
+                                ImPlot::SetupAxis(ImAxis_X1, "ms", ImPlotAxisFlags_AutoFit);
+                                ImPlot::SetupAxis(ImAxis_Y1, "Frames", ImPlotAxisFlags_AutoFit);
+                                const double binWidth = pacerReport.histogramBinMilliseconds;
+                                std::array<double, FramePacer::HistogramBinCount> binCenters, binCounts;
+                                for (uint32_t i = 0; i < FramePacer::HistogramBinCount; i++) {
+                                    binCenters[i] = (i + 0.5) * binWidth;
+                                    binCounts[i] = pacerReport.histogram[i];
+                                }
+
+                                ImPlot::PlotBars<double>("Frame Time", binCenters.data(), binCounts.data(), static_cast<int>(FramePacer::HistogramBinCount), binWidth);
+                                ImPlot::EndPlot();
+                            }
+
+                            ImGui::Text("Paced Frame Time: %fms average, %fms target\n", pacerReport.averageMilliseconds, pacerReport.targetMilliseconds);
+                            ImGui::Text("Jitter: %fms p50, %fms p90, %fms p99, %fms p99.9\n", pacerReport.jitterP50Milliseconds, pacerReport.jitterP90Milliseconds, pacerReport.jitterP99Milliseconds, pacerReport.jitterP999Milliseconds);
+                            ImGui::Text("Predicted GPU: %fms, Present: %fms\n", pacerReport.predictedGPUMilliseconds, pacerReport.predictedPresentMilliseconds);
+                            ImGui::Text("Spin Threshold: %fms, %" PRIu64 " missed frames\n", pacerReport.spinThresholdMilliseconds, pacerReport.missedCount);
+                        }
+
+                        // Show the memory used by the render targets of the workload queue and the textures released to their pool.
+                        double megabyteSize = 1024.0 * 1024.0;
+                        const RenderTargetManager &queueTargetManager = ext.sharedQueueResources->renderTargetManager;
+                        const RenderTargetPool &queueTargetPool = queueTargetManager.pool;
+                        ImGui::NewLine();
+                        ImGui::Text("Render Targets: %zu, %.1f MB\n", queueTargetManager.targetMap.size(), double(queueTargetManager.targetMemorySize) / megabyteSize);
+                        ImGui::Text("Render Target Pool: %.1f MB free, %" PRIu64 " recycled, %" PRIu64 " created, %" PRIu64 " destroyed\n", double(queueTargetPool.freeMemorySize) / megabyteSize,
+                            queueTargetPool.recycledCount, queueTargetPool.createdCount, queueTargetPool.destroyedCount);
+                        ImGui::Text("Render Targets Evicted: %" PRIu64 "\n", queueTargetManager.evictedCount);
+
                         // Show texture replacement statistics.
                         uint64_t poolUsed, poolCached, poolLimit;
-                        double megabyteSize = 1024.0 * 1024.0;
                         ext.textureCache->getReplacementPoolStats(poolUsed, poolCached, poolLimit);
                         ImGui::NewLine();
                         ImGui::Text("Texture Pool Used: %.1f MB\n", double(poolUsed) / megabyteSize);
                         ImGui::Text("Texture Pool Cached: %.1f MB\n", double(poolCached) / megabyteSize);
                         ImGui::Text("Texture Pool Limit: %1.f MB\n", double(poolLimit) / megabyteSize);
                         ImGui::Text("Average Texture Stream: %fms\n", textureStreamAverage);
+
+                        uint64_t ringHighWaterMark, ringStallCount, ringSize;
+                        ext.textureCache->getUploadRingStats(ringHighWaterMark, ringStallCount, ringSize);
+                        ImGui::Text("TMEM Upload Ring: %.1f / %.1f KB peak, %" PRIu64 " stalls\n", double(ringHighWaterMark) / 1024.0, double(ringSize) / 1024.0, ringStallCount);
+
+                        const TextureManager::HashMemo &hashMemo = textureManager.hashMemo;
+                        ImGui::Checkbox("Memoized TMEM Hashing", &textureManager.hashMemo.enabled);
+                        ImGui::Text("TMEM Hash Memo: %.1f%% hit rate, %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " uncached, %zu entries\n", hashMemo.hitRate() * 100.0, hashMemo.hitCount, hashMemo.missCount, hashMemo.uncachedCount, hashMemo.hashMap.size());
+                        ImGui::Text("TMEM Hash Memo: %.3fms saved, %zu load records\n", hashMemo.savedMilliseconds(), hashMemo.loadRecords.size());
+                        ImGui::Checkbox("Validate TMEM Hash Memo", &textureManager.hashMemo.validate);
+                        ImGui::Text("TMEM Hash Memo: %" PRIu64 " mismatches\n", hashMemo.mismatchCount);
+
+                        double decodeBatchTime, decodeTextureTime;
+                        bool decodeBatched = ext.textureCache->isDecodeBatched();
+                        if (ImGui::Checkbox("Batched TMEM Decoding", &decodeBatched)) {
+                            ext.textureCache->setDecodeBatched(decodeBatched);
+                        }
+
+                        ext.textureCache->getDecodeStats(false, decodeBatchTime, decodeTextureTime);
+                        ImGui::Text("Average TMEM Upload (Individual): %fms per batch, %fms per texture\n", decodeBatchTime, decodeTextureTime);
+                        ext.textureCache->getDecodeStats(true, decodeBatchTime, decodeTextureTime);
+                        ImGui::Text("Average TMEM Upload (Batched): %fms per batch, %fms per texture\n", decodeBatchTime, decodeTextureTime);
+                        if (ImGui::Button("Reset TMEM Upload Stats")) {
+                            ext.textureCache->resetDecodeStats();
+                        }
                     }
 
                     bool changed = false;
@@ -2438,6 +2629,28 @@ namespace RT64 {
                     ImGui::Text("Offline Shaders: %zu", ext.rasterShaderCache->offlineList.entries.size());
                     ImGui::Text("Specialized Shaders: %u", ext.rasterShaderCache->shaderCount());
 
+                    const RasterShaderCache::PipelineStore::Statistics storeStats = ext.rasterShaderCache->pipelineStoreStatistics();
+                    const double warmAverage = (storeStats.warmCount > 0) ? (storeStats.warmMilliseconds / storeStats.warmCount) : 0.0;
+                    const double coldAverage = (storeStats.coldCount > 0) ? (storeStats.coldMilliseconds / storeStats.coldCount) : 0.0;
+                    ImGui::Text("Warm Pipelines: %u (%.3f ms avg, %.1f ms total)", storeStats.warmCount, warmAverage, storeStats.warmMilliseconds);
+                    ImGui::Text("Cold Pipelines: %u (%.3f ms avg, %.1f ms total)", storeStats.coldCount, coldAverage, storeStats.coldMilliseconds);
+                    ImGui::Text("Pipeline Store: %s start, loaded in %.3f ms", storeStats.warmStart ? "Warm" : "Cold", storeStats.loadMilliseconds);
+                    ImGui::Text("Offline Shader Usage: %zu", ext.rasterShaderCache->loadedUsage.counters.size());
+
+                    const RasterShaderCache::SubmissionStatistics submissionStats = ext.rasterShaderCache->submissionStatistics();
+                    ImGui::Text("Submissions: %" PRIu64 " (%" PRIu64 " new, %" PRIu64 " reprioritized, %" PRIu64 " stale)", submissionStats.submitCount, submissionStats.insertedCount, submissionStats.reprioritizedCount, submissionStats.staleCount);
+
+                    RasterShaderCache::OfflineBudget offlineBudget = ext.rasterShaderCache->offlineBudget;
+                    double offlineBudgetMilliseconds = ext.rasterShaderCache->offlineBudgetMilliseconds;
+                    bool offlineBudgetChanged = ImGui::Combo("Offline Budget", reinterpret_cast<int *>(&offlineBudget), "Unlimited\0Per Frame\0Idle Only\0");
+                    if (offlineBudget == RasterShaderCache::OfflineBudget::PerFrame) {
+                        offlineBudgetChanged = ImGui::InputDouble("Offline Budget (ms)", &offlineBudgetMilliseconds) || offlineBudgetChanged;
+                    }
+
+                    if (offlineBudgetChanged) {
+                        ext.rasterShaderCache->setOfflineBudget(offlineBudget, std::max(offlineBudgetMilliseconds, 0.0));
+                    }
+
                     ImGui::NewLine();
 
                     bool ubershadersOnly = ext.workloadQueue->ubershadersOnly;
@@ -2448,6 +2661,15 @@ namespace RT64 {
                     ImGui::Checkbox("Ubershaders Visible", &ubershadersVisible);
                     ext.workloadQueue->ubershadersVisible = ubershadersVisible;
 
+                    bool reuseInterpolatedFrames = ext.workloadQueue->reuseInterpolatedFrames;
+                    ImGui::Checkbox("Reuse Interpolated Frames", &reuseInterpolatedFrames);
+                    ext.workloadQueue->reuseInterpolatedFrames = reuseInterpolatedFrames;
+                    ImGui::Text("Reused Interpolated Frames: %" PRIu64 "\n", uint64_t(ext.workloadQueue->reusedFrameCount));
+
+                    bool parallelMatching = ext.workloadQueue->parallelMatching;
+                    ImGui::Checkbox("Parallel Frame Matching", &parallelMatching);
+                    ext.workloadQueue->parallelMatching = parallelMatching;
+
                     ImGui::NewLine();
 
                     const RenderDeviceCapabilities &capabilities = ext.device->getCapabilities();
@@ -2615,6 +2837,8 @@ namespace RT64 {
     }
 
     void State::dumpRDRAM(const std::string &path) {
+        flushRDRAMWriteback();
+
         FILE *fp = fopen(path.c_str(), "wb");
         fwrite(RDRAM, RDRAMSize, 1, fp);
         fclose(fp);
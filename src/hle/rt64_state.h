@@ -60,6 +60,7 @@ namespace RT64 {
             UserConfiguration *userConfig;
             ProfilingTimer *dlApiProfiler;
             ProfilingTimer *screenApiProfiler;
+            GPUProfiler *gpuProfiler;
             UserConfiguration::GraphicsAPI createdGraphicsAPI;
 #       if RT_ENABLED
             RaytracingConfiguration *rtConfig;
@@ -114,7 +115,10 @@ namespace RT64 {
         ProfilingTimer screenCpuProfiler = ProfilingTimer(120);
         ProfilingTimer viChangedProfiler = ProfilingTimer(120);
         std::filesystem::path dumpingTexturesDirectory;
+        bool dumpingTexturesArchive = false;
         bool configurationSaveQueued = false;
+        bool captureToggleQueued = false;
+        std::filesystem::path captureQueuedPath;
         uint64_t workloadId = 0;
         uint64_t presentId = 0;
         uint32_t ditherRandomSeed = 0;
@@ -141,6 +145,8 @@ namespace RT64 {
         void flush();
         void submitFramebufferPair(FramebufferPair::FlushReason flushReason);
         void checkRDRAM();
+        void flushRDRAMWriteback();
+        void flushRDRAMWriteback(uint32_t addressStart, uint32_t addressEnd);
         void fullSync();
         void fullSyncFramebufferPairTiles(Workload &workload, FramebufferPair &fbPair, uint32_t &loadOpCursor, uint32_t &rdpTileCursor);
         void updateScreen(const VI &newVI, bool fromEarlyPresent);
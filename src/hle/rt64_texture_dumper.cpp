@@ -0,0 +1,236 @@
+//
+// RT64
+//
+
+#include "rt64_texture_dumper.h"
+
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include "xxHash/xxh3.h"
+
+#include "shared/rt64_f3d_defines.h"
+
+#include "common/rt64_texture_dump_archive.h"
+#include "common/rt64_thread.h"
+#include "common/rt64_tmem_hasher.h"
+
+namespace RT64 {
+    // TextureDumper
+
+    const uint32_t TextureDumper::MaxPendingDumps = 1024;
+    const uint64_t TextureDumper::MaxPendingBytes = 64 * 1024 * 1024;
+    const char *TextureDumper::ArchiveFilename = "textures.rt64dump";
+
+    TextureDumper::TextureDumper() {
+        threadRunning = true;
+        queuedCount = 0;
+        writtenCount = 0;
+        droppedCount = 0;
+        writtenBytes = 0;
+        thread = std::make_unique<std::thread>(&TextureDumper::threadLoop, this);
+    }
+
+    TextureDumper::~TextureDumper() {
+        // The thread finishes writing all the pending dumps before exiting.
+        {
+            std::unique_lock<std::mutex> pendingLock(pendingMutex);
+            threadRunning = false;
+        }
+
+        pendingChanged.notify_all();
+        thread->join();
+        thread.reset(nullptr);
+        closeArchive();
+    }
+
+    bool TextureDumper::queue(Dump &dump, const uint8_t *TMEM, const uint8_t *rdram, const uint8_t *paletteRdram) {
+        assert(TMEM != nullptr);
+        assert((rdram != nullptr) || (dump.rdramSize == 0));
+        assert((paletteRdram != nullptr) || (dump.paletteRdramSize == 0));
+
+        const uint64_t dumpSize = uint64_t(dump.tmemSize) + dump.rdramSize + dump.paletteRdramSize;
+        {
+            std::unique_lock<std::mutex> pendingLock(pendingMutex);
+            if ((pendingDumps.size() >= MaxPendingDumps) || ((pendingBytes + dumpSize) > MaxPendingBytes)) {
+                droppedCount++;
+                return false;
+            }
+
+            if (!bufferPool.empty()) {
+                dump.bytes = std::move(bufferPool.back());
+                bufferPool.pop_back();
+            }
+
+            pendingBytes += dumpSize;
+        }
+
+        // The copy is done outside of the lock so the thread can keep writing in the meantime.
+        dump.bytes.resize(dumpSize);
+        memcpy(dump.bytes.data(), TMEM, dump.tmemSize);
+        memcpy(dump.bytes.data() + dump.tmemSize, rdram, dump.rdramSize);
+        memcpy(dump.bytes.data() + dump.tmemSize + dump.rdramSize, paletteRdram, dump.paletteRdramSize);
+
+        {
+            std::unique_lock<std::mutex> pendingLock(pendingMutex);
+            pendingDumps.emplace_back(std::move(dump));
+        }
+
+        queuedCount++;
+        pendingChanged.notify_all();
+        return true;
+    }
+
+    uint32_t TextureDumper::getPendingCount() {
+        std::unique_lock<std::mutex> pendingLock(pendingMutex);
+        return uint32_t(pendingDumps.size());
+    }
+
+    void TextureDumper::threadLoop() {
+        Thread::setCurrentThreadName("RT64 Texture Dumper");
+        Thread::setCurrentThreadPriority(Thread::Priority::Low);
+
+        std::deque<Dump> batchDumps;
+        while (true) {
+            // Take every pending dump at once so they can be written in a single batch.
+            {
+                std::unique_lock<std::mutex> pendingLock(pendingMutex);
+                pendingChanged.wait(pendingLock, [this]() {
+                    return !threadRunning || !pendingDumps.empty();
+                });
+
+                if (pendingDumps.empty()) {
+                    break;
+                }
+
+                batchDumps.swap(pendingDumps);
+            }
+
+            for (const Dump &dump : batchDumps) {
+                writeDump(dump);
+            }
+
+            if (archiveStream.is_open()) {
+                archiveStream.flush();
+            }
+
+            // Return the buffers to the pool.
+            {
+                std::unique_lock<std::mutex> pendingLock(pendingMutex);
+                for (Dump &dump : batchDumps) {
+                    pendingBytes -= dump.bytes.size();
+                    if (bufferPool.size() < MaxPendingDumps) {
+                        bufferPool.emplace_back(std::move(dump.bytes));
+                    }
+                }
+            }
+
+            writtenCount += batchDumps.size();
+            batchDumps.clear();
+        }
+    }
+
+    void TextureDumper::writeDump(const Dump &dump) {
+        char baseName[64];
+        snprintf(baseName, sizeof(baseName), "%016" PRIx64 ".v%u", dump.hash, TMEMHasher::CurrentHashVersion);
+
+        // Dump the entirety of TMEM.
+        const uint8_t *tmemBytes = dump.bytes.data();
+        writeFile(dump, std::string(baseName) + ".tmem", tmemBytes, dump.tmemSize);
+
+        // Dump the RDRAM last loaded into the TMEM address pointed to by the tile. Required for generating hashes used by Rice.
+        if (dump.rdramSize > 0) {
+            const uint8_t *rdramBytes = tmemBytes + dump.tmemSize;
+            writeFile(dump, std::string(baseName) + ".rice.rdram", rdramBytes, dump.rdramSize);
+
+            json jroot;
+            jroot["tile"] = dump.loadOp.tile;
+            jroot["type"] = dump.loadOp.type;
+            jroot["texture"] = dump.loadOp.texture;
+            const std::string jsonString = jroot.dump(4) + "\n";
+            writeFile(dump, std::string(baseName) + ".rice.json", jsonString.data(), jsonString.size());
+        }
+
+        // Repeat a similar process for dumping the palette.
+        if (dump.tlut > 0) {
+            if (dump.paletteRdramSize > 0) {
+                const uint8_t *paletteRdramBytes = tmemBytes + dump.tmemSize + dump.rdramSize;
+                writeFile(dump, std::string(baseName) + ".rice.palette.rdram", paletteRdramBytes, dump.paletteRdramSize);
+            }
+
+            json jroot;
+            jroot["tile"] = dump.paletteLoadOp.tile;
+            jroot["type"] = dump.paletteLoadOp.type;
+            jroot["texture"] = dump.paletteLoadOp.texture;
+            const std::string jsonString = jroot.dump(4) + "\n";
+            writeFile(dump, std::string(baseName) + ".rice.palette.json", jsonString.data(), jsonString.size());
+        }
+
+        // Dump the parameters of the tile into a JSON file.
+        json jroot;
+        jroot["tile"] = dump.loadTile;
+        jroot["width"] = dump.width;
+        jroot["height"] = dump.height;
+
+        // Serialize the TLUT into an enum instead.
+        if (dump.tlut == G_TT_RGBA16) {
+            jroot["tlut"] = LoadTLUT::RGBA16;
+        }
+        else if (dump.tlut == G_TT_IA16) {
+            jroot["tlut"] = LoadTLUT::IA16;
+        }
+        else {
+            jroot["tlut"] = LoadTLUT::None;
+        }
+
+        const std::string jsonString = jroot.dump(4) + "\n";
+        writeFile(dump, std::string(baseName) + ".tile.json", jsonString.data(), jsonString.size());
+    }
+
+    void TextureDumper::writeFile(const Dump &dump, const std::string &filename, const void *data, uint64_t dataSize) {
+        if (dump.archive) {
+            const std::filesystem::path dumpArchivePath = dump.directory / ArchiveFilename;
+            if (archivePath != dumpArchivePath) {
+                closeArchive();
+
+                // Only write the header if the archive is new, as dumping can resume on an existing archive.
+                std::error_code ec;
+                const bool archiveExists = std::filesystem::exists(dumpArchivePath, ec) && (std::filesystem::file_size(dumpArchivePath, ec) > 0);
+                archivePath = dumpArchivePath;
+                archiveStream.open(dumpArchivePath, std::ios::binary | std::ios::app);
+                if (!archiveStream.is_open()) {
+                    const std::string u8string = dumpArchivePath.u8string();
+                    fprintf(stderr, "Failed to open texture dump archive at %s.\n", u8string.c_str());
+                }
+                else if (!archiveExists) {
+                    TextureDumpArchive::writeHeader(archiveStream);
+                }
+            }
+
+            if (!archiveStream.is_open()) {
+                return;
+            }
+
+            if (TextureDumpArchive::writeEntry(archiveStream, filename, data, dataSize)) {
+                writtenBytes += dataSize;
+            }
+        }
+        else {
+            std::ofstream fileStream(dump.directory / filename, std::ios::binary);
+            if (fileStream.is_open()) {
+                fileStream.write(reinterpret_cast<const char *>(data), dataSize);
+                fileStream.close();
+                writtenBytes += dataSize;
+            }
+        }
+    }
+
+    void TextureDumper::closeArchive() {
+        if (archiveStream.is_open()) {
+            archiveStream.close();
+        }
+
+        archivePath.clear();
+    }
+};
@@ -0,0 +1,72 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/rt64_load_types.h"
+
+namespace RT64 {
+    // Writes the files of dumped textures from a background thread. The emulator thread only copies the TMEM and RDRAM contents
+    // used by the texture into a pooled buffer and every file is written by the thread in batches. Dumps are dropped instead of
+    // stalling the emulator thread when too many are pending.
+    struct TextureDumper {
+        static const uint32_t MaxPendingDumps;
+        static const uint64_t MaxPendingBytes;
+        static const char *ArchiveFilename;
+
+        struct Dump {
+            uint64_t hash = 0;
+            std::filesystem::path directory;
+            bool archive = false;
+            LoadTile loadTile = {};
+            uint16_t width = 0;
+            uint16_t height = 0;
+            uint32_t tlut = 0;
+            LoadOperation loadOp = {};
+            LoadOperation paletteLoadOp = {};
+
+            // The buffer holds all of TMEM followed by the RDRAM last loaded by the tile and the RDRAM of the palette.
+            std::vector<uint8_t> bytes;
+            uint32_t tmemSize = 0;
+            uint32_t rdramSize = 0;
+            uint32_t paletteRdramSize = 0;
+        };
+
+        std::deque<Dump> pendingDumps;
+        std::vector<std::vector<uint8_t>> bufferPool;
+        uint64_t pendingBytes = 0;
+        std::mutex pendingMutex;
+        std::condition_variable pendingChanged;
+        std::unique_ptr<std::thread> thread;
+        std::atomic<bool> threadRunning;
+        std::atomic<uint64_t> queuedCount;
+        std::atomic<uint64_t> writtenCount;
+        std::atomic<uint64_t> droppedCount;
+        std::atomic<uint64_t> writtenBytes;
+        std::filesystem::path archivePath;
+        std::ofstream archiveStream;
+
+        TextureDumper();
+        ~TextureDumper();
+
+        // Copies the memory used by the texture and queues the dump. Returns false if the dump was dropped because the writer is
+        // too far behind, in which case it's up to the caller to try again later.
+        bool queue(Dump &dump, const uint8_t *TMEM, const uint8_t *rdram, const uint8_t *paletteRdram);
+        uint32_t getPendingCount();
+        void threadLoop();
+        void writeDump(const Dump &dump);
+        void writeFile(const Dump &dump, const std::string &filename, const void *data, uint64_t dataSize);
+        void closeArchive();
+    };
+};
@@ -0,0 +1,314 @@
+//
+// RT64
+//
+
+#include "rt64_vertex_ingest.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#   define VERTEX_INGEST_SSE2
+#   include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#   define VERTEX_INGEST_NEON
+#   include <arm_neon.h>
+#endif
+
+namespace RT64 {
+    namespace VertexIngest {
+        // Texture coordinates are stored as S10.5 and the texture scale as U0.16.
+        // The product of both fits in 32 bits and multiplying by a power of two
+        // in float produces the same result as the division in double precision.
+        // The only exception is a zero product from a negative coordinate, which
+        // is negative zero in float. Adding positive zero turns it into the
+        // positive zero of the integer product and leaves any other value as is.
+        static const float TexcoordScale = 1.0f / (65536.0f * 32.0f);
+
+        static_assert(sizeof(RSP::Vertex) == 16, "The kernels expect the vertex to be four words long.");
+
+        // Scalar
+
+        static void convertPositionColorScalar(const RSP::Vertex &v, int16_t *dstPos, uint8_t *dstNormCol) {
+            dstPos[0] = v.x;
+            dstPos[1] = v.y;
+            dstPos[2] = v.z;
+            dstNormCol[0] = v.color.r;
+            dstNormCol[1] = v.color.g;
+            dstNormCol[2] = v.color.b;
+            dstNormCol[3] = v.color.a;
+        }
+
+        static void convertTexcoordScalar(const RSP::Vertex &v, float scaleS, float scaleT, float *dstTc) {
+            dstTc[0] = float(v.s) * scaleS * TexcoordScale + 0.0f;
+            dstTc[1] = float(v.t) * scaleT * TexcoordScale + 0.0f;
+        }
+
+        struct TransformConstants {
+            float m[4][4];
+            float scale[3];
+            float translate[3];
+        };
+
+        static void transformPositionScalar(const RSP::Vertex &v, const TransformConstants &c, float *dstTransformed, float *dstScreen) {
+            const float x = float(v.x);
+            const float y = float(v.y);
+            const float z = float(v.z);
+            float tf[4];
+            for (uint32_t j = 0; j < 4; j++) {
+                tf[j] = ((x * c.m[0][j] + y * c.m[1][j]) + z * c.m[2][j]) + c.m[3][j];
+                dstTransformed[j] = tf[j];
+            }
+
+            dstScreen[0] = (tf[0] / tf[3]) * c.scale[0] + c.translate[0];
+            dstScreen[1] = (tf[1] / -tf[3]) * c.scale[1] + c.translate[1];
+            dstScreen[2] = (tf[2] / tf[3]) * c.scale[2] + c.translate[2];
+            dstScreen[3] = 0.0f;
+        }
+
+        // SSE2
+
+#   if defined(VERTEX_INGEST_SSE2)
+        static void convertPositionsColorsSIMD(const RSP::Vertex *srcVertices, uint32_t count, int16_t *dstPos, uint8_t *dstNormCol) {
+            const __m128i *src = reinterpret_cast<const __m128i *>(srcVertices);
+            uint32_t i = 0;
+            for (; (i + 4) <= count; i += 4) {
+                const __m128i v0 = _mm_loadu_si128(src + i + 0);
+                const __m128i v1 = _mm_loadu_si128(src + i + 1);
+                const __m128i v2 = _mm_loadu_si128(src + i + 2);
+                const __m128i v3 = _mm_loadu_si128(src + i + 3);
+
+                // Reorder (y, x, flag, z) into (x, y, z, flag). Each store writes one short past the vertex, which is overwritten by
+                // the next one. The last vertex of the batch is left to the scalar path so nothing is written past the destination.
+                const uint32_t simdVertices = ((i + 4) < count) ? 4 : 3;
+                const __m128i v[4] = { v0, v1, v2, v3 };
+                for (uint32_t j = 0; j < simdVertices; j++) {
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(dstPos + (i + j) * 3), _mm_shufflelo_epi16(v[j], _MM_SHUFFLE(2, 3, 0, 1)));
+                }
+
+                if (simdVertices < 4) {
+                    dstPos[(i + 3) * 3 + 0] = srcVertices[i + 3].x;
+                    dstPos[(i + 3) * 3 + 1] = srcVertices[i + 3].y;
+                    dstPos[(i + 3) * 3 + 2] = srcVertices[i + 3].z;
+                }
+
+                // Gather the color word of each vertex and reverse its bytes to get (r, g, b, a).
+                const __m128i hi01 = _mm_unpackhi_epi32(v0, v1);
+                const __m128i hi23 = _mm_unpackhi_epi32(v2, v3);
+                __m128i colors = _mm_unpackhi_epi64(hi01, hi23);
+                colors = _mm_or_si128(_mm_slli_epi16(colors, 8), _mm_srli_epi16(colors, 8));
+                colors = _mm_shufflehi_epi16(_mm_shufflelo_epi16(colors, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dstNormCol + i * 4), colors);
+            }
+
+            for (; i < count; i++) {
+                convertPositionColorScalar(srcVertices[i], dstPos + i * 3, dstNormCol + i * 4);
+            }
+        }
+
+        static void convertTexcoordsSIMD(const RSP::Vertex *srcVertices, uint32_t count, float scaleS, float scaleT, float *dstTc) {
+            const __m128i *src = reinterpret_cast<const __m128i *>(srcVertices);
+            const __m128 scaleSVector = _mm_set1_ps(scaleS * TexcoordScale);
+            const __m128 scaleTVector = _mm_set1_ps(scaleT * TexcoordScale);
+            const __m128 zero = _mm_setzero_ps();
+            uint32_t i = 0;
+            for (; (i + 4) <= count; i += 4) {
+                // Gather the (t, s) word of each vertex.
+                const __m128i hi01 = _mm_unpackhi_epi32(_mm_loadu_si128(src + i + 0), _mm_loadu_si128(src + i + 1));
+                const __m128i hi23 = _mm_unpackhi_epi32(_mm_loadu_si128(src + i + 2), _mm_loadu_si128(src + i + 3));
+                const __m128i texcoords = _mm_unpacklo_epi64(hi01, hi23);
+                const __m128 s = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(texcoords, 16)), scaleSVector), zero);
+                const __m128 t = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(texcoords, 16), 16)), scaleTVector), zero);
+                _mm_storeu_ps(dstTc + i * 2 + 0, _mm_unpacklo_ps(s, t));
+                _mm_storeu_ps(dstTc + i * 2 + 4, _mm_unpackhi_ps(s, t));
+            }
+
+            for (; i < count; i++) {
+                convertTexcoordScalar(srcVertices[i], scaleS, scaleT, dstTc + i * 2);
+            }
+        }
+        static void transformPositionsSIMD(const RSP::Vertex *srcVertices, uint32_t count, const TransformConstants &c, float *dstTransformed, float *dstScreen) {
+            const __m128i *src = reinterpret_cast<const __m128i *>(srcVertices);
+            __m128 m[4][4];
+            for (uint32_t i = 0; i < 4; i++) {
+                for (uint32_t j = 0; j < 4; j++) {
+                    m[i][j] = _mm_set1_ps(c.m[i][j]);
+                }
+            }
+
+            const __m128 scale[3] = { _mm_set1_ps(c.scale[0]), _mm_set1_ps(c.scale[1]), _mm_set1_ps(c.scale[2]) };
+            const __m128 translate[3] = { _mm_set1_ps(c.translate[0]), _mm_set1_ps(c.translate[1]), _mm_set1_ps(c.translate[2]) };
+            const __m128 signMask = _mm_set1_ps(-0.0f);
+            uint32_t i = 0;
+            for (; (i + 4) <= count; i += 4) {
+                // Gather the (y, x) and (flag, z) words of each vertex to transform four vertices at a time.
+                const __m128i lo01 = _mm_unpacklo_epi32(_mm_loadu_si128(src + i + 0), _mm_loadu_si128(src + i + 1));
+                const __m128i lo23 = _mm_unpacklo_epi32(_mm_loadu_si128(src + i + 2), _mm_loadu_si128(src + i + 3));
+                const __m128i xy = _mm_unpacklo_epi64(lo01, lo23);
+                const __m128i flagZ = _mm_unpackhi_epi64(lo01, lo23);
+                const __m128 x = _mm_cvtepi32_ps(_mm_srai_epi32(xy, 16));
+                const __m128 y = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(xy, 16), 16));
+                const __m128 z = _mm_cvtepi32_ps(_mm_srai_epi32(flagZ, 16));
+                __m128 tf[4];
+                for (uint32_t j = 0; j < 4; j++) {
+                    tf[j] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m[0][j]), _mm_mul_ps(y, m[1][j])), _mm_mul_ps(z, m[2][j])), m[3][j]);
+                }
+
+                __m128 sc[4];
+                sc[0] = _mm_add_ps(_mm_mul_ps(_mm_div_ps(tf[0], tf[3]), scale[0]), translate[0]);
+                sc[1] = _mm_add_ps(_mm_mul_ps(_mm_div_ps(tf[1], _mm_xor_ps(tf[3], signMask)), scale[1]), translate[1]);
+                sc[2] = _mm_add_ps(_mm_mul_ps(_mm_div_ps(tf[2], tf[3]), scale[2]), translate[2]);
+                sc[3] = _mm_setzero_ps();
+
+                // Transpose back into one vector per vertex.
+                _MM_TRANSPOSE4_PS(tf[0], tf[1], tf[2], tf[3]);
+                _MM_TRANSPOSE4_PS(sc[0], sc[1], sc[2], sc[3]);
+                for (uint32_t j = 0; j < 4; j++) {
+                    _mm_storeu_ps(dstTransformed + (i + j) * 4, tf[j]);
+                    _mm_storeu_ps(dstScreen + (i + j) * 4, sc[j]);
+                }
+            }
+
+            for (; i < count; i++) {
+                transformPositionScalar(srcVertices[i], c, dstTransformed + i * 4, dstScreen + i * 4);
+            }
+        }
+#   endif
+
+        // NEON
+
+#   if defined(VERTEX_INGEST_NEON)
+        static void convertPositionsColorsSIMD(const RSP::Vertex *srcVertices, uint32_t count, int16_t *dstPos, uint8_t *dstNormCol) {
+            const uint32_t *src = reinterpret_cast<const uint32_t *>(srcVertices);
+            uint32_t i = 0;
+            for (; (i + 4) <= count; i += 4) {
+                // Deinterleave the four words of each vertex: (y, x), (flag, z), (t, s) and the color.
+                const uint32x4x4_t words = vld4q_u32(src + i * 4);
+                const int32x4_t xy = vreinterpretq_s32_u32(words.val[0]);
+                const int32x4_t flagZ = vreinterpretq_s32_u32(words.val[1]);
+                int16x4x3_t positions;
+                positions.val[0] = vshrn_n_s32(xy, 16);
+                positions.val[1] = vmovn_s32(xy);
+                positions.val[2] = vshrn_n_s32(flagZ, 16);
+                vst3_s16(dstPos + i * 3, positions);
+                vst1q_u8(dstNormCol + i * 4, vrev32q_u8(vreinterpretq_u8_u32(words.val[3])));
+            }
+
+            for (; i < count; i++) {
+                convertPositionColorScalar(srcVertices[i], dstPos + i * 3, dstNormCol + i * 4);
+            }
+        }
+
+        static void convertTexcoordsSIMD(const RSP::Vertex *srcVertices, uint32_t count, float scaleS, float scaleT, float *dstTc) {
+            const uint32_t *src = reinterpret_cast<const uint32_t *>(srcVertices);
+            const float32x4_t scaleSVector = vdupq_n_f32(scaleS * TexcoordScale);
+            const float32x4_t scaleTVector = vdupq_n_f32(scaleT * TexcoordScale);
+            const float32x4_t zero = vdupq_n_f32(0.0f);
+            uint32_t i = 0;
+            for (; (i + 4) <= count; i += 4) {
+                const uint32x4x4_t words = vld4q_u32(src + i * 4);
+                const int32x4_t texcoords = vreinterpretq_s32_u32(words.val[2]);
+                float32x4x2_t st;
+                st.val[0] = vaddq_f32(vmulq_f32(vcvtq_f32_s32(vshrq_n_s32(texcoords, 16)), scaleSVector), zero);
+                st.val[1] = vaddq_f32(vmulq_f32(vcvtq_f32_s32(vshrq_n_s32(vshlq_n_s32(texcoords, 16), 16)), scaleTVector), zero);
+                vst2q_f32(dstTc + i * 2, st);
+            }
+
+            for (; i < count; i++) {
+                convertTexcoordScalar(srcVertices[i], scaleS, scaleT, dstTc + i * 2);
+            }
+        }
+        static void transformPositionsSIMD(const RSP::Vertex *srcVertices, uint32_t count, const TransformConstants &c, float *dstTransformed, float *dstScreen) {
+            const uint32_t *src = reinterpret_cast<const uint32_t *>(srcVertices);
+            float32x4_t m[4][4];
+            for (uint32_t i = 0; i < 4; i++) {
+                for (uint32_t j = 0; j < 4; j++) {
+                    m[i][j] = vdupq_n_f32(c.m[i][j]);
+                }
+            }
+
+            const float32x4_t scale[3] = { vdupq_n_f32(c.scale[0]), vdupq_n_f32(c.scale[1]), vdupq_n_f32(c.scale[2]) };
+            const float32x4_t translate[3] = { vdupq_n_f32(c.translate[0]), vdupq_n_f32(c.translate[1]), vdupq_n_f32(c.translate[2]) };
+            uint32_t i = 0;
+            for (; (i + 4) <= count; i += 4) {
+                // Separate multiplies and adds are used instead of fused ones to round the same way as the other kernels.
+                const uint32x4x4_t words = vld4q_u32(src + i * 4);
+                const int32x4_t xy = vreinterpretq_s32_u32(words.val[0]);
+                const int32x4_t flagZ = vreinterpretq_s32_u32(words.val[1]);
+                const float32x4_t x = vcvtq_f32_s32(vshrq_n_s32(xy, 16));
+                const float32x4_t y = vcvtq_f32_s32(vshrq_n_s32(vshlq_n_s32(xy, 16), 16));
+                const float32x4_t z = vcvtq_f32_s32(vshrq_n_s32(flagZ, 16));
+                float32x4x4_t tf;
+                for (uint32_t j = 0; j < 4; j++) {
+                    tf.val[j] = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(x, m[0][j]), vmulq_f32(y, m[1][j])), vmulq_f32(z, m[2][j])), m[3][j]);
+                }
+
+                float32x4x4_t sc;
+                sc.val[0] = vaddq_f32(vmulq_f32(vdivq_f32(tf.val[0], tf.val[3]), scale[0]), translate[0]);
+                sc.val[1] = vaddq_f32(vmulq_f32(vdivq_f32(tf.val[1], vnegq_f32(tf.val[3])), scale[1]), translate[1]);
+                sc.val[2] = vaddq_f32(vmulq_f32(vdivq_f32(tf.val[2], tf.val[3]), scale[2]), translate[2]);
+                sc.val[3] = vdupq_n_f32(0.0f);
+                vst4q_f32(dstTransformed + i * 4, tf);
+                vst4q_f32(dstScreen + i * 4, sc);
+            }
+
+            for (; i < count; i++) {
+                transformPositionScalar(srcVertices[i], c, dstTransformed + i * 4, dstScreen + i * 4);
+            }
+        }
+#   endif
+
+        // Public functions.
+
+        void convertPositionsColors(const RSP::Vertex *srcVertices, uint32_t count, int16_t *dstPos, uint8_t *dstNormCol) {
+#       if defined(VERTEX_INGEST_SSE2) || defined(VERTEX_INGEST_NEON)
+            convertPositionsColorsSIMD(srcVertices, count, dstPos, dstNormCol);
+#       else
+            for (uint32_t i = 0; i < count; i++) {
+                convertPositionColorScalar(srcVertices[i], dstPos + i * 3, dstNormCol + i * 4);
+            }
+#       endif
+        }
+
+        void convertTexcoords(const RSP::Vertex *srcVertices, uint32_t count, uint16_t textureSc, uint16_t textureTc, float *dstTc) {
+            const float scaleS = float(textureSc);
+            const float scaleT = float(textureTc);
+#       if defined(VERTEX_INGEST_SSE2) || defined(VERTEX_INGEST_NEON)
+            convertTexcoordsSIMD(srcVertices, count, scaleS, scaleT, dstTc);
+#       else
+            for (uint32_t i = 0; i < count; i++) {
+                convertTexcoordScalar(srcVertices[i], scaleS, scaleT, dstTc + i * 2);
+            }
+#       endif
+        }
+
+        void transformPositions(const RSP::Vertex *srcVertices, uint32_t count, const hlslpp::float4x4 &mvp, const interop::RSPViewport &viewport, float *dstTransformed, float *dstScreen) {
+            TransformConstants c;
+            for (uint32_t i = 0; i < 4; i++) {
+                for (uint32_t j = 0; j < 4; j++) {
+                    c.m[i][j] = mvp[i][j];
+                }
+            }
+
+            for (uint32_t i = 0; i < 3; i++) {
+                c.scale[i] = viewport.scale[i];
+                c.translate[i] = viewport.translate[i];
+            }
+
+#       if defined(VERTEX_INGEST_SSE2) || defined(VERTEX_INGEST_NEON)
+            transformPositionsSIMD(srcVertices, count, c, dstTransformed, dstScreen);
+#       else
+            for (uint32_t i = 0; i < count; i++) {
+                transformPositionScalar(srcVertices[i], c, dstTransformed + i * 4, dstScreen + i * 4);
+            }
+#       endif
+        }
+
+        const char *kernelName() {
+#       if defined(VERTEX_INGEST_SSE2)
+            return "SSE2";
+#       elif defined(VERTEX_INGEST_NEON)
+            return "NEON";
+#       else
+            return "Scalar";
+#       endif
+        }
+    };
+};
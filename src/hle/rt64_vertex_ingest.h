@@ -0,0 +1,28 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include "rt64_rsp.h"
+
+namespace RT64 {
+    // Conversion kernels from the RSP vertex layout into the workload streams. They use SSE2 on x86-64 and NEON on ARM64,
+    // which are part of the baseline of both architectures, and fall back to scalar code on any other target.
+    namespace VertexIngest {
+        // Writes three shorts per vertex (x, y, z) into dstPos and four bytes per vertex (r, g, b, a) into dstNormCol.
+        void convertPositionsColors(const RSP::Vertex *srcVertices, uint32_t count, int16_t *dstPos, uint8_t *dstNormCol);
+
+        // Writes two floats per vertex (s, t) into dstTc, scaled by the texture scale and the fixed point divisor of the RSP.
+        void convertTexcoords(const RSP::Vertex *srcVertices, uint32_t count, uint16_t textureSc, uint16_t textureTc, float *dstTc);
+
+        // Writes four floats per vertex into dstTransformed with the position multiplied by the matrix, and four floats per vertex into
+        // dstScreen with the position after the perspective divide and the viewport, the last one being padding. The products are
+        // accumulated in the same order as a row vector multiplication in hlslpp, so every kernel produces the same bits. This only holds
+        // while the compiler doesn't fuse the multiplies and adds, so this file and the check tool are built with contraction disabled.
+        void transformPositions(const RSP::Vertex *srcVertices, uint32_t count, const hlslpp::float4x4 &mvp, const interop::RSPViewport &viewport, float *dstTransformed, float *dstScreen);
+
+        // Name of the kernel set that was compiled for the current target.
+        const char *kernelName();
+    };
+};
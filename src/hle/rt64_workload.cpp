@@ -4,6 +4,9 @@
 
 #include "rt64_workload.h"
 
+#include <algorithm>
+#include <cassert>
+
 namespace RT64 {
     // Common functions.
 
@@ -11,6 +14,61 @@ namespace RT64 {
         return (value + powerOf2Alignment - 1) & ~(powerOf2Alignment - 1);
     }
 
+    // DrawDataCapacity
+
+    void DrawDataCapacity::learn(DrawData &drawData, const std::vector<size_t> &reservedCapacities) {
+        size_t vectorIndex = 0;
+        drawData.forEachVector([&](auto &vector) {
+            if (vectorIndex >= peaks.size()) {
+                peaks.resize(vectorIndex + 1, 0);
+            }
+
+            size_t &peak = peaks[vectorIndex];
+            // Rounding the decay up makes it take at least one element per frame, so small peaks still reach zero.
+            peak = std::max(vector.size(), peak - ((peak + PeakDecayDivisor - 1) / PeakDecayDivisor));
+
+            // The vector had to grow past the capacity that was reserved for it.
+            if ((vectorIndex < reservedCapacities.size()) && (vector.capacity() > reservedCapacities[vectorIndex])) {
+                growthCount++;
+            }
+
+            vectorIndex++;
+        });
+    }
+
+    void DrawDataCapacity::reserve(DrawData &drawData, std::vector<size_t> &reservedCapacities) {
+        // The vectors are expected to be empty at this point.
+        size_t vectorIndex = 0;
+        uint64_t totalBytes = 0;
+        reservedCapacities.resize(peaks.size(), 0);
+        drawData.forEachVector([&](auto &vector) {
+            typedef typename std::decay<decltype(vector)>::type VectorType;
+            assert(vector.empty());
+
+            const size_t peak = (vectorIndex < peaks.size()) ? peaks[vectorIndex] : 0;
+            const size_t target = peak + (peak / HeadroomDivisor);
+
+            // Release the memory when the reservation is far bigger than what recent frames have required.
+            if (vector.capacity() > (target * 2)) {
+                VectorType().swap(vector);
+            }
+
+            if (vector.capacity() < target) {
+                vector.reserve(target);
+            }
+
+            if (vectorIndex < reservedCapacities.size()) {
+                reservedCapacities[vectorIndex] = vector.capacity();
+            }
+
+            totalBytes += vector.capacity() * sizeof(typename VectorType::value_type);
+            vectorIndex++;
+        });
+
+        // Only the total of the most recently reset workload is kept, which is representative of all of them.
+        reservedBytes = totalBytes;
+    }
+
     // Workload
 
     void Workload::reset() {
@@ -42,55 +100,18 @@ namespace RT64 {
     }
 
     void Workload::resetDrawData() {
-        drawData.posShorts.clear();
-        drawData.velShorts.clear();
-        drawData.tcFloats.clear();
-        drawData.normColBytes.clear();
-        drawData.viewProjIndices.clear();
-        drawData.worldIndices.clear();
-        drawData.fogIndices.clear();
-        drawData.lightIndices.clear();
-        drawData.lightCounts.clear();
-        drawData.lookAtIndices.clear();
-        drawData.faceIndices.clear();
-        drawData.modifyPosUints.clear();
-        drawData.rdpParams.clear();
-        drawData.extraParams.clear();
-        drawData.renderParams.clear();
-        drawData.posTransformed.clear();
-        drawData.posScreen.clear();
-        drawData.rdpTiles.clear();
-        drawData.lerpRdpTiles.clear();
-        drawData.gpuTiles.clear();
-        drawData.callTiles.clear();
-        drawData.rspViewports.clear();
-        drawData.viewportOrigins.clear();
-        drawData.rspFog.clear();
-        drawData.rspLights.clear();
-        drawData.rspLookAt.clear();
-        drawData.loadOperations.clear();
-        drawData.worldTransforms.clear();
-        drawData.viewTransforms.clear();
-        drawData.projTransforms.clear();
-        drawData.viewProjTransforms.clear();
-        drawData.modViewTransforms.clear();
-        drawData.modProjTransforms.clear();
-        drawData.modViewProjTransforms.clear();
-        drawData.prevViewTransforms.clear();
-        drawData.prevProjTransforms.clear();
-        drawData.prevViewProjTransforms.clear();
-        drawData.lerpWorldTransforms.clear();
-        drawData.prevWorldTransforms.clear();
-        drawData.invTWorldTransforms.clear();
-        drawData.triPosFloats.clear();
-        drawData.triTcFloats.clear();
-        drawData.triColorFloats.clear();
-        drawData.transformGroups.clear();
-        drawData.worldTransformGroups.clear();
-        drawData.viewProjTransformGroups.clear();
-        drawData.worldTransformSegmentedAddresses.clear();
-        drawData.worldTransformPhysicalAddresses.clear();
-        drawData.worldTransformVertexIndices.clear();
+        // Learn from the sizes the vectors reached during the last frame before clearing them.
+        if (drawDataCapacity != nullptr) {
+            drawDataCapacity->learn(drawData, drawDataReserved);
+        }
+
+        drawData.forEachVector([](auto &vector) {
+            vector.clear();
+        });
+
+        if (drawDataCapacity != nullptr) {
+            drawDataCapacity->reserve(drawData, drawDataReserved);
+        }
 
         // Push an identity matrix into the transforms by default so rects can use them.
         drawData.rspViewports.push_back(interop::RSPViewport::identity());
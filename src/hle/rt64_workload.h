@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "render/rt64_buffer_uploader.h"
 #include "shared/rt64_extra_params.h"
 #include "shared/rt64_gpu_tile.h"
@@ -74,6 +76,60 @@ namespace RT64 {
         std::vector<uint32_t> worldTransformPhysicalAddresses;
         std::vector<uint32_t> worldTransformVertexIndices;
 
+        // Visits every vector in the draw data. Used for operations that must cover all of them, like clearing or reserving.
+        template<typename F>
+        void forEachVector(F &&callback) {
+            callback(posShorts);
+            callback(velShorts);
+            callback(tcFloats);
+            callback(normColBytes);
+            callback(viewProjIndices);
+            callback(worldIndices);
+            callback(fogIndices);
+            callback(lightIndices);
+            callback(lightCounts);
+            callback(lookAtIndices);
+            callback(faceIndices);
+            callback(modifyPosUints);
+            callback(posTransformed);
+            callback(posScreen);
+            callback(rdpParams);
+            callback(extraParams);
+            callback(renderParams);
+            callback(viewTransforms);
+            callback(projTransforms);
+            callback(viewProjTransforms);
+            callback(modViewTransforms);
+            callback(modProjTransforms);
+            callback(modViewProjTransforms);
+            callback(prevViewTransforms);
+            callback(prevProjTransforms);
+            callback(prevViewProjTransforms);
+            callback(worldTransforms);
+            callback(prevWorldTransforms);
+            callback(invTWorldTransforms);
+            callback(lerpWorldTransforms);
+            callback(rdpTiles);
+            callback(lerpRdpTiles);
+            callback(gpuTiles);
+            callback(callTiles);
+            callback(rspViewports);
+            callback(viewportOrigins);
+            callback(rspFog);
+            callback(rspLights);
+            callback(rspLookAt);
+            callback(loadOperations);
+            callback(triPosFloats);
+            callback(triTcFloats);
+            callback(triColorFloats);
+            callback(transformGroups);
+            callback(worldTransformGroups);
+            callback(viewProjTransformGroups);
+            callback(worldTransformSegmentedAddresses);
+            callback(worldTransformPhysicalAddresses);
+            callback(worldTransformVertexIndices);
+        }
+
         uint32_t vertexCount() const {
             return uint32_t(worldIndices.size());
         }
@@ -96,6 +152,24 @@ namespace RT64 {
         }
     };
 
+    // Capacities of the draw data vectors learned from the sizes reached by previous frames. It's shared by every workload in the queue,
+    // so each one can reserve what the game has needed recently before writing into it and avoid growing the vectors in the middle of
+    // the display list.
+    struct DrawDataCapacity {
+        // Fraction of the learned peak that decays every frame, so the reservation shrinks back after a demanding scene.
+        static const size_t PeakDecayDivisor = 256;
+
+        // Extra headroom reserved on top of the learned peak.
+        static const size_t HeadroomDivisor = 4;
+
+        std::vector<size_t> peaks;
+        std::atomic<uint64_t> reservedBytes = 0;
+        std::atomic<uint64_t> growthCount = 0;
+
+        void learn(DrawData &drawData, const std::vector<size_t> &reservedCapacities);
+        void reserve(DrawData &drawData, std::vector<size_t> &reservedCapacities);
+    };
+
     struct DrawRanges {
         typedef std::pair<size_t, size_t> Range;
 
@@ -199,6 +273,8 @@ namespace RT64 {
     struct Workload {
         uint64_t submissionFrame;
         DrawData drawData;
+        DrawDataCapacity *drawDataCapacity = nullptr;
+        std::vector<size_t> drawDataReserved;
         DrawRanges drawRanges;
         DrawBuffers drawBuffers;
         OutputBuffers outputBuffers;
@@ -213,7 +289,7 @@ namespace RT64 {
         uint32_t viOriginalRate;
         DebuggerRenderer debuggerRenderer;
         DebuggerCamera debuggerCamera;
-        std::multimap<uint32_t, uint32_t> transformIdMap;
+        std::vector<std::pair<uint32_t, uint32_t>> transformIdMap;
         std::multimap<uint32_t, uint32_t> physicalAddressTransformMap;
         std::vector<uint32_t> transformIgnoredIds;
         uint64_t workloadId = 0;
@@ -17,6 +17,10 @@ namespace RT64 {
     // WorkloadQueue
 
     WorkloadQueue::WorkloadQueue() {
+        for (Workload &w : workloads) {
+            w.drawDataCapacity = &drawDataCapacity;
+        }
+
         reset();
     }
 
@@ -110,6 +114,10 @@ namespace RT64 {
         transformProcessor.setup(ext.workloadGraphicsWorker);
         tileProcessor.setup(ext.workloadGraphicsWorker);
 
+        // The render thread also runs tasks while it waits for the pool, so it's counted as one of the threads used for matching.
+        const uint32_t matchingThreads = std::max(std::thread::hardware_concurrency() / 4U, 2U);
+        matchingTaskPool = std::make_unique<TaskPool>(matchingThreads - 1, "RT64 Matching");
+
         threadsRunning = true;
         renderThread = new std::thread(&WorkloadQueue::renderThreadLoop, this);
         idleThread = new std::thread(&WorkloadQueue::idleThreadLoop, this);
@@ -206,6 +214,7 @@ namespace RT64 {
         workloadConfig.aspectRatioScale = workloadConfig.aspectRatioTarget / workloadConfig.aspectRatioSource;
         workloadConfig.resolutionScale = { resolutionMultiplier * workloadConfig.aspectRatioScale, resolutionMultiplier };
         workloadConfig.downsampleMultiplier = ext.sharedResources->userConfig.downsampleMultiplier;
+        workloadConfig.renderTargetBudget = uint64_t(ext.sharedResources->userConfig.renderTargetBudget) * 1024 * 1024;
         ext.sharedResources->resolutionScale = workloadConfig.resolutionScale;
 
         // Find the target refresh rate from the configuration.
@@ -288,7 +297,7 @@ namespace RT64 {
     void WorkloadQueue::threadRenderFrame(GameFrame &curFrame, const GameFrame &prevFrame, const WorkloadConfiguration &workloadConfig,
         const DebuggerRenderer &debuggerRenderer, const DebuggerCamera &debuggerCamera, float curFrameWeight, float prevFrameWeight,
         float deltaTimeMs, RenderTargetKey overrideTargetKey, int32_t overrideTargetFbPairIndex, RenderTarget *overrideTarget,
-        uint32_t overrideTargetModifier, bool uploadVelocity, bool uploadExtras, bool interpolateTiles)
+        uint32_t overrideTargetModifier, bool uploadVelocity, bool uploadExtras, bool interpolateTiles, bool reuseFramebuffers)
     {
 #   if ENABLE_HIGH_RESOLUTION_RENDERER
         std::scoped_lock<std::mutex> managerLock(ext.sharedResources->workloadMutex);
@@ -543,8 +552,11 @@ namespace RT64 {
             // Indicate to the texture cache the textures must not be deleted.
             ext.textureCache->incrementLock();
 
-            // Reset the texture cache vectors for the framebuffer renderer.
-            framebufferRenderer->updateTextureCache(ext.textureCache);
+            // Reset the texture cache vectors for the framebuffer renderer. The vectors from the previous frame are kept when reusing
+            // its framebuffers, as the texture cache is locked for as long as the interpolated frames of the workload are rendered.
+            if (!reuseFramebuffers) {
+                framebufferRenderer->updateTextureCache(ext.textureCache);
+            }
 
             for (uint32_t f = 0; f < fbPairCount; f++) {
                 const FramebufferPair &fbPair = workload.fbPairs[f];
@@ -554,49 +566,65 @@ namespace RT64 {
             // Add all framebuffer pairs to the framebuffer renderer and setup the operations.
             scratchFbChangePool.reset();
             fbManager.resetOperations();
-            framebufferRenderer->resetFramebuffers(ext.workloadGraphicsWorker, ubershadersVisible, workload.extended.ditherNoiseStrength, targetManager.multisampling);
 
-#       if RT_ENABLED
-            if (workloadConfig.raytracingEnabled) {
-                framebufferRenderer->resetRaytracing(ext.rtShaderCache, ext.blueNoiseTexture);
+            // Interpolated frames of the same workload only differ in the weights and the buffers they affect, so the draw calls of the previous
+            // frame can be drawn again. Only the framebuffers that were redirected to a different target must be updated.
+            if (reuseFramebuffers) {
+                uint32_t framebufferIndex = 0;
+                for (uint32_t f = 0; f < fbPairCount; f++) {
+                    if (getTargetsFromPair(f)) {
+                        RenderFramebufferStorage &fbStorage = renderFramebufferManager->get(fbKey, colorTarget, (depthTarget != nullptr) ? depthTarget : dummyDepthTarget.get());
+                        framebufferRenderer->retargetFramebuffer(framebufferIndex++, &fbStorage);
+                    }
+                }
+
+                reusedFrameCount++;
             }
-#       endif
+            else {
+                framebufferRenderer->resetFramebuffers(ext.workloadGraphicsWorker, ubershadersVisible, workload.extended.ditherNoiseStrength, targetManager.multisampling);
 
-            for (uint32_t f = 0; f < fbPairCount; f++) {
-                const FramebufferPair &fbPair = workload.fbPairs[f];
-                if (getTargetsFromPair(f)) {
-                    RenderFramebufferStorage &fbStorage = renderFramebufferManager->get(fbKey, colorTarget, (depthTarget != nullptr) ? depthTarget : dummyDepthTarget.get());
-                    FramebufferRenderer::DrawParams drawParams;
-                    drawParams.worker = ext.workloadGraphicsWorker;
-                    drawParams.fbStorage = &fbStorage;
-                    drawParams.curWorkload = &workload;
-                    drawParams.fbPairIndex = f;
-                    drawParams.fbWidth = nativeColorWidth;
-                    drawParams.fbHeight = nativeColorHeight;
-                    drawParams.targetWidth = targetWidth;
-                    drawParams.targetHeight = targetHeight;
-                    drawParams.rasterShaderCache = ext.rasterShaderCache;
-                    drawParams.resolutionScale = fixedResScale;
-                    drawParams.aspectRatioSource = workloadConfig.aspectRatioSource;
-                    drawParams.aspectRatioTarget = workloadConfig.aspectRatioTarget;
-                    drawParams.extAspectPercentage = workloadConfig.extAspectPercentage;
-                    drawParams.horizontalMisalignment = float(colorTarget->misalignX);
-                    drawParams.presetScene = curFrame.presetScene;
-                    drawParams.rtEnabled = workloadConfig.raytracingEnabled;
-                    drawParams.submissionFrame = workload.submissionFrame;
-                    drawParams.deltaTimeMs = deltaTimeMs;
-                    drawParams.ubershadersOnly = ubershadersOnly;
-                    drawParams.fixRectLR = workloadConfig.fixRectLR;
-                    drawParams.postBlendNoise = workloadConfig.postBlendNoise;
-                    drawParams.maxGameCall = std::min(gameCallCountMax - gameCallCursor, fbPair.gameCallCount);
-                    framebufferRenderer->addFramebuffer(drawParams);
+#           if RT_ENABLED
+                if (workloadConfig.raytracingEnabled) {
+                    framebufferRenderer->resetRaytracing(ext.rtShaderCache, ext.blueNoiseTexture);
                 }
+#           endif
+
+                for (uint32_t f = 0; f < fbPairCount; f++) {
+                    const FramebufferPair &fbPair = workload.fbPairs[f];
+                    if (getTargetsFromPair(f)) {
+                        RenderFramebufferStorage &fbStorage = renderFramebufferManager->get(fbKey, colorTarget, (depthTarget != nullptr) ? depthTarget : dummyDepthTarget.get());
+                        FramebufferRenderer::DrawParams drawParams;
+                        drawParams.worker = ext.workloadGraphicsWorker;
+                        drawParams.fbStorage = &fbStorage;
+                        drawParams.curWorkload = &workload;
+                        drawParams.fbPairIndex = f;
+                        drawParams.fbWidth = nativeColorWidth;
+                        drawParams.fbHeight = nativeColorHeight;
+                        drawParams.targetWidth = targetWidth;
+                        drawParams.targetHeight = targetHeight;
+                        drawParams.rasterShaderCache = ext.rasterShaderCache;
+                        drawParams.resolutionScale = fixedResScale;
+                        drawParams.aspectRatioSource = workloadConfig.aspectRatioSource;
+                        drawParams.aspectRatioTarget = workloadConfig.aspectRatioTarget;
+                        drawParams.extAspectPercentage = workloadConfig.extAspectPercentage;
+                        drawParams.horizontalMisalignment = float(colorTarget->misalignX);
+                        drawParams.presetScene = curFrame.presetScene;
+                        drawParams.rtEnabled = workloadConfig.raytracingEnabled;
+                        drawParams.submissionFrame = workload.submissionFrame;
+                        drawParams.deltaTimeMs = deltaTimeMs;
+                        drawParams.ubershadersOnly = ubershadersOnly;
+                        drawParams.fixRectLR = workloadConfig.fixRectLR;
+                        drawParams.postBlendNoise = workloadConfig.postBlendNoise;
+                        drawParams.maxGameCall = std::min(gameCallCountMax - gameCallCursor, fbPair.gameCallCount);
+                        framebufferRenderer->addFramebuffer(drawParams);
+                    }
                 
-                gameCallCursor += fbPair.gameCallCount;
+                    gameCallCursor += fbPair.gameCallCount;
+                }
             }
 
-            // Create all GPU tile mappings and upload them.
-            if (!workload.drawData.gpuTiles.empty()) {
+            // Create all GPU tile mappings and upload them. The buffer already holds them if the framebuffers are reused.
+            if (!workload.drawData.gpuTiles.empty() && !reuseFramebuffers) {
                 std::pair<size_t, size_t> gpuTileRange;
                 gpuTileRange.first = 0;
                 gpuTileRange.second = workload.drawData.gpuTiles.size();
@@ -832,6 +860,9 @@ namespace RT64 {
                 Workload &workload = workloads[processCursor];
                 ext.presentQueue->waitForPresentId(workload.presentId);
 
+                // The buffers of the workload might still be in use by a render to RAM writeback that hasn't been flushed yet.
+                rdramWriteback.waitForWorkload(processCursor);
+
                 if (!threadsRunning) {
                     continue;
                 }
@@ -840,6 +871,12 @@ namespace RT64 {
                 workloadProfiler.start();
                 threadConfigurationUpdate(workloadConfig);
 
+                // Evict the render targets that haven't been used recently if they go over the budget.
+                {
+                    std::scoped_lock<std::mutex> workloadLock(ext.sharedResources->workloadMutex);
+                    ext.sharedResources->renderTargetManager.evictIdle(*renderFramebufferManager, workloadConfig.renderTargetBudget);
+                }
+
                 // FIXME: This is a very hacky way to find out if we need to advance the frame if the workload was paused for the first time.
                 if (!workload.paused || (!gameFrames[curFrameIndex].workloads.empty() && (gameFrames[curFrameIndex].workloads[0] != (uint32_t)processCursor))) {
                     prevFrameIndex = curFrameIndex;
@@ -906,7 +943,8 @@ namespace RT64 {
                 if (requiresFrameMatching) {
                     matchingProfiler.reset();
                     matchingProfiler.start();
-                    curFrame.match(ext.workloadGraphicsWorker, *this, prevFrame, ext.workloadVelocityUploader, velocityUploaderUsed, tileInterpolationUsed);
+                    TaskPool *matchingPool = parallelMatching ? matchingTaskPool.get() : nullptr;
+                    curFrame.match(ext.workloadGraphicsWorker, *this, prevFrame, ext.workloadVelocityUploader, matchingPool, velocityUploaderUsed, tileInterpolationUsed);
                     matchingProfiler.end();
                     matchingProfiler.log();
 
@@ -989,6 +1027,14 @@ namespace RT64 {
                 uint32_t targetIndex = 0;
                 uint32_t framesRendered = 0;
                 int64_t renderTimeTotalMicro = 0;
+
+                // The texture cache must keep the textures of the first frame alive if the rest of the frames will reuse its framebuffers.
+                // Raytracing builds acceleration structures while adding the framebuffers, so they can't be reused between frames.
+                const bool reuseFramebuffersAllowed = generateInterpolatedFrames && (displayFrames > 1) && reuseInterpolatedFrames && !workloadConfig.raytracingEnabled;
+                if (reuseFramebuffersAllowed) {
+                    ext.textureCache->incrementLock();
+                }
+
                 for (uint32_t frame = 0; (frame < displayFrames) && !skipWorkloadNow; frame++) {
                     // Evaluate if this frame should be skipped. Measure the current time and compare it to what frame is estimated should be have been rendered by now.
                     if ((frame > 0) && (originalTimeMicro > 0)) {
@@ -1041,9 +1087,12 @@ namespace RT64 {
                         ext.workloadExtrasUploader->submit(ext.workloadGraphicsWorker, { extrasUpload });
                     }
 
+                    // Any frame rendered after the first one can reuse the framebuffers it added.
+                    const bool reuseFramebuffers = reuseFramebuffersAllowed && (framesRendered > 0);
                     int64_t renderTimeMicro = workloadTimer.elapsedMicroseconds();
                     threadRenderFrame(curFrame, prevFrame, workloadConfig, workload.debuggerRenderer, workload.debuggerCamera, curFrameWeight, prevFrameWeight, deltaTimeMs,
-                        interpolationTargetKey, interpolationTargetFbPairIndex, overrideTarget, overrideModifier, velocityUploaderUsed, uploadExtras, tileInterpolationUsed);
+                        interpolationTargetKey, interpolationTargetFbPairIndex, overrideTarget, overrideModifier, velocityUploaderUsed, uploadExtras, tileInterpolationUsed,
+                        reuseFramebuffers);
 
                     // Add total time the frame took to render.
                     renderTimeTotalMicro += workloadTimer.elapsedMicroseconds() - renderTimeMicro;
@@ -1077,6 +1126,10 @@ namespace RT64 {
                     framesRendered++;
                 }
 
+                if (reuseFramebuffersAllowed) {
+                    ext.textureCache->decrementLock();
+                }
+
                 // Set the skipped parameter on the frame counter if the workload wasn't skipped but some of its frames were.
                 if (skippedFrames && !skipWorkloadNow) {
                     {
@@ -8,6 +8,7 @@
 
 #include "common/rt64_enhancement_configuration.h"
 #include "common/rt64_profiling_timer.h"
+#include "common/rt64_task_pool.h"
 #include "common/rt64_user_configuration.h"
 #include "render/rt64_framebuffer_renderer.h"
 #include "render/rt64_projection_processor.h"
@@ -15,6 +16,7 @@
 #include "render/rt64_tile_processor.h"
 #include "render/rt64_transform_processor.h"
 
+#include "rt64_rdram_writeback.h"
 #include "rt64_shared_queue_resources.h"
 #include "rt64_workload.h"
 
@@ -55,12 +57,15 @@ namespace RT64 {
             float aspectRatioScale = 1.0f;
             float extAspectPercentage = 1.0f;
             uint32_t targetRate = 0;
+            uint64_t renderTargetBudget = 0;
             bool fixRectLR = false;
             bool postBlendNoise = false;
         };
 
         External ext;
         std::array<Workload, WORKLOAD_QUEUE_SIZE> workloads;
+        DrawDataCapacity drawDataCapacity;
+        RDRAMWriteback rdramWriteback;
         int threadCursor;
         int writeCursor;
         int barrierCursor;
@@ -81,6 +86,10 @@ namespace RT64 {
         std::atomic<bool> rtEnabled = false;
         std::atomic<bool> ubershadersOnly = false;
         std::atomic<bool> ubershadersVisible = false;
+        std::atomic<bool> reuseInterpolatedFrames = true;
+        std::atomic<uint64_t> reusedFrameCount = 0;
+        std::atomic<bool> parallelMatching = true;
+        std::unique_ptr<TaskPool> matchingTaskPool;
         std::unique_ptr<FramebufferRenderer> framebufferRenderer;
         std::unique_ptr<RenderFramebufferManager> renderFramebufferManager;
         TileProcessor tileProcessor;
@@ -112,7 +121,7 @@ namespace RT64 {
         void threadRenderFrame(GameFrame &curFrame, const GameFrame &prevFrame, const WorkloadConfiguration &workloadConfig,
             const DebuggerRenderer &debuggerRenderer, const DebuggerCamera &debuggerCamera, float curFrameWeight, float prevFrameWeight,
             float deltaTimeMs, RenderTargetKey overrideTargetKey, int32_t overrideTargetFbPairIndex, RenderTarget *overrideTarget,
-            uint32_t overrideTargetModifier, bool uploadVelocity, bool uploadExtras, bool interpolateTiles);
+            uint32_t overrideTargetModifier, bool uploadVelocity, bool uploadExtras, bool interpolateTiles, bool reuseFramebuffers);
 
         void threadAdvanceBarrier();
         void threadAdvanceWorkloadId(uint64_t newWorkloadId);
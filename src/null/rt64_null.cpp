@@ -0,0 +1,687 @@
+//
+// RT64
+//
+
+#include "rt64_null.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+namespace RT64 {
+    static uint64_t textureMemorySize(const RenderTextureDesc &desc) {
+        // Sum up the size of every mip level as if the texture was stored linearly.
+        const uint64_t formatSize = std::max<uint64_t>(RenderFormatSize(desc.format), 1);
+        const uint64_t sampleCount = std::max<uint64_t>(desc.multisampling.sampleCount, 1);
+        const uint32_t mipLevels = std::max<uint32_t>(desc.mipLevels, 1);
+        uint64_t width = std::max<uint64_t>(desc.width, 1);
+        uint64_t height = std::max<uint64_t>(desc.height, 1);
+        uint64_t depth = std::max<uint64_t>(desc.depth, 1);
+        uint64_t memorySize = 0;
+        for (uint32_t i = 0; i < mipLevels; i++) {
+            memorySize += width * height * depth * formatSize * sampleCount;
+            width = std::max<uint64_t>(width >> 1, 1);
+            height = std::max<uint64_t>(height >> 1, 1);
+            depth = std::max<uint64_t>(depth >> 1, 1);
+        }
+
+        return memorySize;
+    }
+
+    // NullCommandCounters
+
+    void NullCommandCounters::add(const NullCommandCounters &counters) {
+        drawCount += counters.drawCount;
+        dispatchCount += counters.dispatchCount;
+        traceRaysCount += counters.traceRaysCount;
+        copyCount += counters.copyCount;
+        clearCount += counters.clearCount;
+        resolveCount += counters.resolveCount;
+        barrierCount += counters.barrierCount;
+        stateCount += counters.stateCount;
+        queryCount += counters.queryCount;
+        buildCount += counters.buildCount;
+    }
+
+    uint64_t NullCommandCounters::totalCount() const {
+        return drawCount + dispatchCount + traceRaysCount + copyCount + clearCount + resolveCount + barrierCount + stateCount + queryCount + buildCount;
+    }
+
+    // NullBuffer
+
+    NullBuffer::NullBuffer(NullDevice *device, const RenderBufferDesc &desc) {
+        assert(device != nullptr);
+
+        this->device = device;
+        this->desc = desc;
+
+        memory.resize(desc.size);
+
+        const std::scoped_lock<std::mutex> statisticsLock(device->statisticsMutex);
+        device->statistics.bufferCount++;
+        device->statistics.bufferMemory += desc.size;
+    }
+
+    NullBuffer::~NullBuffer() {
+        const std::scoped_lock<std::mutex> statisticsLock(device->statisticsMutex);
+        device->statistics.bufferCount--;
+        device->statistics.bufferMemory -= desc.size;
+    }
+
+    void *NullBuffer::map(uint32_t subresource, const RenderRange *readRange) {
+        return memory.data();
+    }
+
+    void NullBuffer::unmap(uint32_t subresource, const RenderRange *writtenRange) { }
+
+    std::unique_ptr<RenderBufferFormattedView> NullBuffer::createBufferFormattedView(RenderFormat format) {
+        return std::make_unique<NullBufferFormattedView>(this, format);
+    }
+
+    void NullBuffer::setName(const std::string &name) { }
+
+    // NullBufferFormattedView
+
+    NullBufferFormattedView::NullBufferFormattedView(NullBuffer *buffer, RenderFormat format) {
+        assert(buffer != nullptr);
+
+        this->buffer = buffer;
+        this->format = format;
+    }
+
+    // NullTexture
+
+    NullTexture::NullTexture(NullDevice *device, const RenderTextureDesc &desc) {
+        assert(device != nullptr);
+
+        this->device = device;
+        this->desc = desc;
+
+        memorySize = textureMemorySize(desc);
+
+        const std::scoped_lock<std::mutex> statisticsLock(device->statisticsMutex);
+        device->statistics.textureCount++;
+        device->statistics.textureMemory += memorySize;
+    }
+
+    NullTexture::~NullTexture() {
+        const std::scoped_lock<std::mutex> statisticsLock(device->statisticsMutex);
+        device->statistics.textureCount--;
+        device->statistics.textureMemory -= memorySize;
+    }
+
+    std::unique_ptr<RenderTextureView> NullTexture::createTextureView(const RenderTextureViewDesc &desc) {
+        return std::make_unique<NullTextureView>(this, desc);
+    }
+
+    void NullTexture::setName(const std::string &name) { }
+
+    // NullTextureView
+
+    NullTextureView::NullTextureView(NullTexture *texture, const RenderTextureViewDesc &desc) {
+        assert(texture != nullptr);
+
+        this->texture = texture;
+        this->desc = desc;
+    }
+
+    // NullAccelerationStructure
+
+    NullAccelerationStructure::NullAccelerationStructure(const RenderAccelerationStructureDesc &desc) {
+        this->desc = desc;
+    }
+
+    // NullPipelineLayout
+
+    NullPipelineLayout::NullPipelineLayout(const RenderPipelineLayoutDesc &desc) {
+        pushConstantRanges.assign(desc.pushConstantRanges, desc.pushConstantRanges + desc.pushConstantRangesCount);
+    }
+
+    // NullPipelineCache
+
+    NullPipelineCache::NullPipelineCache(const void *data, uint64_t size) {
+        if ((data != nullptr) && (size > 0)) {
+            const uint8_t *dataBytes = reinterpret_cast<const uint8_t *>(data);
+            this->data.assign(dataBytes, dataBytes + size);
+        }
+    }
+
+    bool NullPipelineCache::getData(std::vector<uint8_t> &data) {
+        data = this->data;
+        return true;
+    }
+
+    // NullQueryPool
+
+    NullQueryPool::NullQueryPool(uint32_t queryCount) {
+        results.resize(queryCount, 0);
+    }
+
+    void NullQueryPool::queryResults() { }
+
+    const uint64_t *NullQueryPool::getResults() const {
+        return results.data();
+    }
+
+    uint32_t NullQueryPool::getCount() const {
+        return uint32_t(results.size());
+    }
+
+    // NullShader
+
+    NullShader::NullShader(const char *entryPointName, RenderShaderFormat format) {
+        this->entryPointName = (entryPointName != nullptr) ? entryPointName : std::string();
+        this->format = format;
+    }
+
+    // NullSampler
+
+    NullSampler::NullSampler(const RenderSamplerDesc &desc) {
+        this->desc = desc;
+    }
+
+    // NullPipeline
+
+    NullPipeline::NullPipeline(NullDevice *device) {
+        assert(device != nullptr);
+
+        this->device = device;
+
+        const std::scoped_lock<std::mutex> statisticsLock(device->statisticsMutex);
+        device->statistics.pipelineCount++;
+    }
+
+    NullPipeline::~NullPipeline() {
+        const std::scoped_lock<std::mutex> statisticsLock(device->statisticsMutex);
+        device->statistics.pipelineCount--;
+    }
+
+    RenderPipelineProgram NullPipeline::getProgram(const std::string &name) const {
+        auto it = std::find(programNames.begin(), programNames.end(), name);
+        assert((it != programNames.end()) && "Program must exist in the pipeline.");
+        return RenderPipelineProgram(uint32_t(it - programNames.begin()));
+    }
+
+    // NullDescriptorSet
+
+    NullDescriptorSet::NullDescriptorSet(const RenderDescriptorSetDesc &desc) {
+        for (uint32_t i = 0; i < desc.descriptorRangesCount; i++) {
+            descriptorCount += desc.descriptorRanges[i].count;
+        }
+    }
+
+    void NullDescriptorSet::setBuffer(uint32_t descriptorIndex, const RenderBuffer *buffer, uint64_t bufferSize, const RenderBufferStructuredView *bufferStructuredView, const RenderBufferFormattedView *bufferFormattedView) {
+        assert(descriptorIndex < descriptorCount);
+    }
+
+    void NullDescriptorSet::setTexture(uint32_t descriptorIndex, const RenderTexture *texture, RenderTextureLayout textureLayout, const RenderTextureView *textureView) {
+        assert(descriptorIndex < descriptorCount);
+    }
+
+    void NullDescriptorSet::setAccelerationStructure(uint32_t descriptorIndex, const RenderAccelerationStructure *accelerationStructure) {
+        assert(descriptorIndex < descriptorCount);
+    }
+
+    // NullSwapChain
+
+    NullSwapChain::NullSwapChain(NullCommandQueue *commandQueue, RenderWindow renderWindow, uint32_t textureCount, RenderFormat format) {
+        assert(commandQueue != nullptr);
+        assert(textureCount > 0);
+
+        this->commandQueue = commandQueue;
+        this->renderWindow = renderWindow;
+        this->format = format;
+
+        textures.resize(textureCount);
+        resize();
+    }
+
+    bool NullSwapChain::present(uint32_t textureIndex, RenderCommandSemaphore **waitSemaphores, uint32_t waitSemaphoreCount) {
+        assert(textureIndex < textures.size());
+
+        NullDevice *device = commandQueue->device;
+        const std::scoped_lock<std::mutex> statisticsLock(device->statisticsMutex);
+        device->statistics.presentCount++;
+        return true;
+    }
+
+    bool NullSwapChain::resize() {
+        const RenderTextureDesc textureDesc = RenderTextureDesc::ColorTarget(width, height, format);
+        for (std::unique_ptr<NullTexture> &texture : textures) {
+            texture = std::make_unique<NullTexture>(commandQueue->device, textureDesc);
+        }
+
+        return true;
+    }
+
+    bool NullSwapChain::needsResize() const {
+        return false;
+    }
+
+    uint32_t NullSwapChain::getWidth() const {
+        return width;
+    }
+
+    uint32_t NullSwapChain::getHeight() const {
+        return height;
+    }
+
+    RenderTexture *NullSwapChain::getTexture(uint32_t textureIndex) {
+        assert(textureIndex < textures.size());
+        return textures[textureIndex].get();
+    }
+
+    uint32_t NullSwapChain::getTextureCount() const {
+        return uint32_t(textures.size());
+    }
+
+    bool NullSwapChain::acquireTexture(RenderCommandSemaphore *signalSemaphore, uint32_t *textureIndex) {
+        assert(textureIndex != nullptr);
+
+        *textureIndex = currentTextureIndex;
+        currentTextureIndex = (currentTextureIndex + 1) % uint32_t(textures.size());
+        return true;
+    }
+
+    RenderWindow NullSwapChain::getWindow() const {
+        return renderWindow;
+    }
+
+    bool NullSwapChain::isEmpty() const {
+        return (width == 0) || (height == 0);
+    }
+
+    uint32_t NullSwapChain::getRefreshRate() const {
+        return DefaultRefreshRate;
+    }
+
+    // NullFramebuffer
+
+    NullFramebuffer::NullFramebuffer(const RenderFramebufferDesc &desc) {
+        const RenderTexture *firstAttachment = (desc.colorAttachmentsCount > 0) ? desc.colorAttachments[0] : desc.depthAttachment;
+        if (firstAttachment != nullptr) {
+            const NullTexture *nullTexture = static_cast<const NullTexture *>(firstAttachment);
+            width = nullTexture->desc.width;
+            height = nullTexture->desc.height;
+        }
+    }
+
+    uint32_t NullFramebuffer::getWidth() const {
+        return width;
+    }
+
+    uint32_t NullFramebuffer::getHeight() const {
+        return height;
+    }
+
+    // NullCommandList
+
+    NullCommandList::NullCommandList(NullDevice *device, RenderCommandListType type) {
+        assert(device != nullptr);
+        assert(type != RenderCommandListType::UNKNOWN);
+
+        this->device = device;
+        this->type = type;
+    }
+
+    void NullCommandList::begin() {
+        assert(!open);
+
+        counters = NullCommandCounters();
+        open = true;
+    }
+
+    void NullCommandList::end() {
+        assert(open);
+
+        open = false;
+    }
+
+    void NullCommandList::barriers(RenderBarrierStages stages, const RenderBufferBarrier *bufferBarriers, uint32_t bufferBarriersCount, const RenderTextureBarrier *textureBarriers, uint32_t textureBarriersCount) {
+        counters.barrierCount += bufferBarriersCount + textureBarriersCount;
+    }
+
+    void NullCommandList::dispatch(uint32_t threadGroupCountX, uint32_t threadGroupCountY, uint32_t threadGroupCountZ) {
+        counters.dispatchCount++;
+    }
+
+    void NullCommandList::traceRays(uint32_t width, uint32_t height, uint32_t depth, RenderBufferReference shaderBindingTable, const RenderShaderBindingGroupsInfo &shaderBindingGroupsInfo) {
+        counters.traceRaysCount++;
+    }
+
+    void NullCommandList::drawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount, uint32_t startVertexLocation, uint32_t startInstanceLocation) {
+        counters.drawCount++;
+    }
+
+    void NullCommandList::drawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) {
+        counters.drawCount++;
+    }
+
+    void NullCommandList::setPipeline(const RenderPipeline *pipeline) {
+        counters.stateCount++;
+    }
+
+    void NullCommandList::setComputePipelineLayout(const RenderPipelineLayout *pipelineLayout) {
+        counters.stateCount++;
+    }
+
+    void NullCommandList::setComputePushConstants(uint32_t rangeIndex, const void *data) {
+        counters.stateCount++;
+    }
+
+    void NullCommandList::setComputeDescriptorSet(RenderDescriptorSet *descriptorSet, uint32_t setIndex) {
+        counters.stateCount++;
+    }
+
+    void NullCommandList::setGraphicsPipelineLayout(const RenderPipelineLayout *pipelineLayout) {
+        counters.stateCount++;
+    }
+
+    void NullCommandList::setGraphicsPushConstants(uint32_t rangeIndex, const void *data) {
+        counters.stateCount++;
+    }
+
+    void NullCommandList::setGraphicsDescriptorSet(RenderDescriptorSet *descriptorSet, uint32_t setIndex) {
+        counters.stateCount++;
+    }
+
+    void NullCommandList::setRaytracingPipelineLayout(const RenderPipelineLayout *pipelineLayout) {
+        counters.stateCount++;
+    }
+
+    void NullCommandList::setRaytracingPushConstants(uint32_t rangeIndex, const void *data) {
+        counters.stateCount++;
+    }
+
+    void NullCommandList::setRaytracingDescriptorSet(RenderDescriptorSet *descriptorSet, uint32_t setIndex) {
+        counters.stateCount++;
+    }
+
+    void NullCommandList::setIndexBuffer(const RenderIndexBufferView *view) {
+        counters.stateCount++;
+    }
+
+    void NullCommandList::setVertexBuffers(uint32_t startSlot, const RenderVertexBufferView *views, uint32_t viewCount, const RenderInputSlot *inputSlots) {
+        counters.stateCount++;
+    }
+
+    void NullCommandList::setViewports(const RenderViewport *viewports, uint32_t count) {
+        counters.stateCount++;
+    }
+
+    void NullCommandList::setScissors(const RenderRect *scissorRects, uint32_t count) {
+        counters.stateCount++;
+    }
+
+    void NullCommandList::setFramebuffer(const RenderFramebuffer *framebuffer) {
+        counters.stateCount++;
+    }
+
+    void NullCommandList::clearColor(uint32_t attachmentIndex, RenderColor colorValue, const RenderRect *clearRects, uint32_t clearRectsCount) {
+        counters.clearCount++;
+    }
+
+    void NullCommandList::clearDepth(bool clearDepth, float depthValue, const RenderRect *clearRects, uint32_t clearRectsCount) {
+        counters.clearCount++;
+    }
+
+    void NullCommandList::copyBufferRegion(RenderBufferReference dstBuffer, RenderBufferReference srcBuffer, uint64_t size) {
+        counters.copyCount++;
+    }
+
+    void NullCommandList::copyTextureRegion(const RenderTextureCopyLocation &dstLocation, const RenderTextureCopyLocation &srcLocation, uint32_t dstX, uint32_t dstY, uint32_t dstZ, const RenderBox *srcBox) {
+        counters.copyCount++;
+    }
+
+    void NullCommandList::copyBuffer(const RenderBuffer *dstBuffer, const RenderBuffer *srcBuffer) {
+        counters.copyCount++;
+    }
+
+    void NullCommandList::copyTexture(const RenderTexture *dstTexture, const RenderTexture *srcTexture) {
+        counters.copyCount++;
+    }
+
+    void NullCommandList::resolveTexture(const RenderTexture *dstTexture, const RenderTexture *srcTexture) {
+        counters.resolveCount++;
+    }
+
+    void NullCommandList::resolveTextureRegion(const RenderTexture *dstTexture, uint32_t dstX, uint32_t dstY, const RenderTexture *srcTexture, const RenderRect *srcRect) {
+        counters.resolveCount++;
+    }
+
+    void NullCommandList::buildBottomLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, const RenderBottomLevelASBuildInfo &buildInfo) {
+        counters.buildCount++;
+    }
+
+    void NullCommandList::buildTopLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, RenderBufferReference instancesBuffer, const RenderTopLevelASBuildInfo &buildInfo) {
+        counters.buildCount++;
+    }
+
+    void NullCommandList::resetQueryPool(const RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) {
+        assert(queryPool != nullptr);
+        assert((queryFirstIndex + queryCount) <= queryPool->getCount());
+
+        counters.queryCount++;
+    }
+
+    void NullCommandList::writeTimestamp(const RenderQueryPool *queryPool, uint32_t queryIndex) {
+        assert(queryPool != nullptr);
+        assert(queryIndex < queryPool->getCount());
+
+        // Nothing is executed, so the timestamp is taken from the CPU while recording instead.
+        NullQueryPool *nullQueryPool = const_cast<NullQueryPool *>(static_cast<const NullQueryPool *>(queryPool));
+        const auto timeSinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+        nullQueryPool->results[queryIndex] = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(timeSinceEpoch).count());
+        counters.queryCount++;
+    }
+
+    // NullCommandQueue
+
+    NullCommandQueue::NullCommandQueue(NullDevice *device, RenderCommandListType type) {
+        assert(device != nullptr);
+        assert(type != RenderCommandListType::UNKNOWN);
+
+        this->device = device;
+        this->type = type;
+    }
+
+    std::unique_ptr<RenderSwapChain> NullCommandQueue::createSwapChain(RenderWindow renderWindow, uint32_t textureCount, RenderFormat format) {
+        return std::make_unique<NullSwapChain>(this, renderWindow, textureCount, format);
+    }
+
+    void NullCommandQueue::executeCommandLists(const RenderCommandList **commandLists, uint32_t commandListCount, RenderCommandSemaphore **waitSemaphores, uint32_t waitSemaphoreCount, RenderCommandSemaphore **signalSemaphores, uint32_t signalSemaphoreCount, RenderCommandFence *signalFence) {
+        assert(commandLists != nullptr);
+
+        const std::scoped_lock<std::mutex> statisticsLock(device->statisticsMutex);
+        for (uint32_t i = 0; i < commandListCount; i++) {
+            const NullCommandList *commandList = static_cast<const NullCommandList *>(commandLists[i]);
+            assert(!commandList->open && "Command list must be closed before executing it.");
+            device->statistics.commands.add(commandList->counters);
+        }
+
+        device->statistics.commandListsExecuted += commandListCount;
+    }
+
+    void NullCommandQueue::waitForCommandFence(RenderCommandFence *fence) { }
+
+    // NullPool
+
+    NullPool::NullPool(NullDevice *device) {
+        assert(device != nullptr);
+
+        this->device = device;
+    }
+
+    std::unique_ptr<RenderBuffer> NullPool::createBuffer(const RenderBufferDesc &desc) {
+        return std::make_unique<NullBuffer>(device, desc);
+    }
+
+    std::unique_ptr<RenderTexture> NullPool::createTexture(const RenderTextureDesc &desc) {
+        return std::make_unique<NullTexture>(device, desc);
+    }
+
+    // NullDevice
+
+    NullDevice::NullDevice(NullInterface *renderInterface) {
+        assert(renderInterface != nullptr);
+
+        this->renderInterface = renderInterface;
+
+        description.name = "Null Device";
+    }
+
+    std::unique_ptr<RenderCommandList> NullDevice::createCommandList(RenderCommandListType type) {
+        return std::make_unique<NullCommandList>(this, type);
+    }
+
+    std::unique_ptr<RenderDescriptorSet> NullDevice::createDescriptorSet(const RenderDescriptorSetDesc &desc) {
+        return std::make_unique<NullDescriptorSet>(desc);
+    }
+
+    std::unique_ptr<RenderShader> NullDevice::createShader(const void *data, uint64_t size, const char *entryPointName, RenderShaderFormat format) {
+        return std::make_unique<NullShader>(entryPointName, format);
+    }
+
+    std::unique_ptr<RenderSampler> NullDevice::createSampler(const RenderSamplerDesc &desc) {
+        return std::make_unique<NullSampler>(desc);
+    }
+
+    std::unique_ptr<RenderPipeline> NullDevice::createComputePipeline(const RenderComputePipelineDesc &desc) {
+        return std::make_unique<NullPipeline>(this);
+    }
+
+    std::unique_ptr<RenderPipeline> NullDevice::createGraphicsPipeline(const RenderGraphicsPipelineDesc &desc) {
+        return std::make_unique<NullPipeline>(this);
+    }
+
+    std::unique_ptr<RenderPipeline> NullDevice::createRaytracingPipeline(const RenderRaytracingPipelineDesc &desc, const RenderPipeline *previousPipeline) {
+        // Programs are indexed in the same order as they're declared in the libraries and the hit groups.
+        std::unique_ptr<NullPipeline> pipeline = std::make_unique<NullPipeline>(this);
+        for (uint32_t i = 0; i < desc.librariesCount; i++) {
+            const RenderRaytracingPipelineLibrary &library = desc.libraries[i];
+            for (uint32_t j = 0; j < library.symbolsCount; j++) {
+                const RenderRaytracingPipelineLibrarySymbol &symbol = library.symbols[j];
+                pipeline->programNames.emplace_back((symbol.exportName != nullptr) ? symbol.exportName : symbol.importName);
+            }
+        }
+
+        for (uint32_t i = 0; i < desc.hitGroupsCount; i++) {
+            pipeline->programNames.emplace_back(desc.hitGroups[i].hitGroupName);
+        }
+
+        return pipeline;
+    }
+
+    std::unique_ptr<RenderCommandQueue> NullDevice::createCommandQueue(RenderCommandListType type) {
+        return std::make_unique<NullCommandQueue>(this, type);
+    }
+
+    std::unique_ptr<RenderBuffer> NullDevice::createBuffer(const RenderBufferDesc &desc) {
+        return std::make_unique<NullBuffer>(this, desc);
+    }
+
+    std::unique_ptr<RenderTexture> NullDevice::createTexture(const RenderTextureDesc &desc) {
+        return std::make_unique<NullTexture>(this, desc);
+    }
+
+    std::unique_ptr<RenderAccelerationStructure> NullDevice::createAccelerationStructure(const RenderAccelerationStructureDesc &desc) {
+        return std::make_unique<NullAccelerationStructure>(desc);
+    }
+
+    std::unique_ptr<RenderPool> NullDevice::createPool(const RenderPoolDesc &desc) {
+        return std::make_unique<NullPool>(this);
+    }
+
+    std::unique_ptr<RenderPipelineLayout> NullDevice::createPipelineLayout(const RenderPipelineLayoutDesc &desc) {
+        return std::make_unique<NullPipelineLayout>(desc);
+    }
+
+    std::unique_ptr<RenderCommandFence> NullDevice::createCommandFence() {
+        return std::make_unique<NullCommandFence>();
+    }
+
+    std::unique_ptr<RenderCommandSemaphore> NullDevice::createCommandSemaphore() {
+        return std::make_unique<NullCommandSemaphore>();
+    }
+
+    std::unique_ptr<RenderFramebuffer> NullDevice::createFramebuffer(const RenderFramebufferDesc &desc) {
+        return std::make_unique<NullFramebuffer>(desc);
+    }
+
+    std::unique_ptr<RenderPipelineCache> NullDevice::createPipelineCache(const void *data, uint64_t size) {
+        return std::make_unique<NullPipelineCache>(data, size);
+    }
+
+    std::unique_ptr<RenderQueryPool> NullDevice::createQueryPool(uint32_t queryCount) {
+        return std::make_unique<NullQueryPool>(queryCount);
+    }
+
+    void NullDevice::setBottomLevelASBuildInfo(RenderBottomLevelASBuildInfo &buildInfo, const RenderBottomLevelASMesh *meshes, uint32_t meshCount, bool preferFastBuild, bool preferFastTrace) {
+        buildInfo.meshCount = meshCount;
+        buildInfo.primitiveCount = 0;
+        buildInfo.preferFastBuild = preferFastBuild;
+        buildInfo.preferFastTrace = preferFastTrace;
+        buildInfo.scratchSize = 0;
+        buildInfo.accelerationStructureSize = 0;
+    }
+
+    void NullDevice::setTopLevelASBuildInfo(RenderTopLevelASBuildInfo &buildInfo, const RenderTopLevelASInstance *instances, uint32_t instanceCount, bool preferFastBuild, bool preferFastTrace) {
+        buildInfo.instanceCount = instanceCount;
+        buildInfo.preferFastBuild = preferFastBuild;
+        buildInfo.preferFastTrace = preferFastTrace;
+        buildInfo.scratchSize = 0;
+        buildInfo.accelerationStructureSize = 0;
+        buildInfo.instancesBufferData.clear();
+    }
+
+    void NullDevice::setShaderBindingTableInfo(RenderShaderBindingTableInfo &tableInfo, const RenderShaderBindingGroups &groups, const RenderPipeline *pipeline, RenderDescriptorSet **descriptorSets, uint32_t descriptorSetCount) {
+        tableInfo.tableBufferData.clear();
+        tableInfo.groups = RenderShaderBindingGroupsInfo();
+    }
+
+    const RenderDeviceCapabilities &NullDevice::getCapabilities() const {
+        return capabilities;
+    }
+
+    const RenderDeviceDescription &NullDevice::getDescription() const {
+        return description;
+    }
+
+    RenderSampleCounts NullDevice::getSampleCountsSupported(RenderFormat format) const {
+        return RenderSampleCount::COUNT_1 | RenderSampleCount::COUNT_2 | RenderSampleCount::COUNT_4 | RenderSampleCount::COUNT_8;
+    }
+
+    NullStatistics NullDevice::getStatistics() {
+        const std::scoped_lock<std::mutex> statisticsLock(statisticsMutex);
+        return statistics;
+    }
+
+    void NullDevice::resetStatistics() {
+        // Only the counters are reset, the resources are still alive.
+        const std::scoped_lock<std::mutex> statisticsLock(statisticsMutex);
+        statistics.commands = NullCommandCounters();
+        statistics.commandListsExecuted = 0;
+        statistics.presentCount = 0;
+    }
+
+    // NullInterface
+
+    NullInterface::NullInterface() {
+        // Shaders are never compiled, but the blobs that are embedded for Vulkan are always available.
+        capabilities.shaderFormat = RenderShaderFormat::SPIRV;
+    }
+
+    std::unique_ptr<RenderDevice> NullInterface::createDevice() {
+        return std::make_unique<NullDevice>(this);
+    }
+
+    const RenderInterfaceCapabilities &NullInterface::getCapabilities() const {
+        return capabilities;
+    }
+
+    // Global creation function.
+
+    std::unique_ptr<RenderInterface> CreateNullInterface() {
+        return std::make_unique<NullInterface>();
+    }
+};
@@ -0,0 +1,293 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include "rhi/rt64_render_interface.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace RT64 {
+    struct NullCommandQueue;
+    struct NullDevice;
+    struct NullInterface;
+
+    // Amount of commands recorded by each command list. Commands are only counted and never executed.
+    struct NullCommandCounters {
+        uint64_t drawCount = 0;
+        uint64_t dispatchCount = 0;
+        uint64_t traceRaysCount = 0;
+        uint64_t copyCount = 0;
+        uint64_t clearCount = 0;
+        uint64_t resolveCount = 0;
+        uint64_t barrierCount = 0;
+        uint64_t stateCount = 0;
+        uint64_t queryCount = 0;
+        uint64_t buildCount = 0;
+
+        void add(const NullCommandCounters &counters);
+        uint64_t totalCount() const;
+    };
+
+    struct NullStatistics {
+        NullCommandCounters commands;
+        uint64_t commandListsExecuted = 0;
+        uint64_t presentCount = 0;
+        uint64_t bufferCount = 0;
+        uint64_t bufferMemory = 0;
+        uint64_t textureCount = 0;
+        uint64_t textureMemory = 0;
+        uint64_t pipelineCount = 0;
+    };
+
+    struct NullBuffer : RenderBuffer {
+        NullDevice *device = nullptr;
+        RenderBufferDesc desc;
+        std::vector<uint8_t> memory;
+
+        NullBuffer(NullDevice *device, const RenderBufferDesc &desc);
+        ~NullBuffer() override;
+        void *map(uint32_t subresource, const RenderRange *readRange) override;
+        void unmap(uint32_t subresource, const RenderRange *writtenRange) override;
+        std::unique_ptr<RenderBufferFormattedView> createBufferFormattedView(RenderFormat format) override;
+        void setName(const std::string &name) override;
+    };
+
+    struct NullBufferFormattedView : RenderBufferFormattedView {
+        NullBuffer *buffer = nullptr;
+        RenderFormat format = RenderFormat::UNKNOWN;
+
+        NullBufferFormattedView(NullBuffer *buffer, RenderFormat format);
+    };
+
+    // Textures can't be mapped by the interface, so their contents are never stored. Only the memory they would use is tracked.
+    struct NullTexture : RenderTexture {
+        NullDevice *device = nullptr;
+        RenderTextureDesc desc;
+        uint64_t memorySize = 0;
+
+        NullTexture(NullDevice *device, const RenderTextureDesc &desc);
+        ~NullTexture() override;
+        std::unique_ptr<RenderTextureView> createTextureView(const RenderTextureViewDesc &desc) override;
+        void setName(const std::string &name) override;
+    };
+
+    struct NullTextureView : RenderTextureView {
+        NullTexture *texture = nullptr;
+        RenderTextureViewDesc desc;
+
+        NullTextureView(NullTexture *texture, const RenderTextureViewDesc &desc);
+    };
+
+    struct NullAccelerationStructure : RenderAccelerationStructure {
+        RenderAccelerationStructureDesc desc;
+
+        NullAccelerationStructure(const RenderAccelerationStructureDesc &desc);
+    };
+
+    struct NullPipelineLayout : RenderPipelineLayout {
+        std::vector<RenderPushConstantRange> pushConstantRanges;
+
+        NullPipelineLayout(const RenderPipelineLayoutDesc &desc);
+    };
+
+    struct NullPipelineCache : RenderPipelineCache {
+        std::vector<uint8_t> data;
+
+        NullPipelineCache(const void *data, uint64_t size);
+        bool getData(std::vector<uint8_t> &data) override;
+    };
+
+    struct NullQueryPool : RenderQueryPool {
+        std::vector<uint64_t> results;
+
+        NullQueryPool(uint32_t queryCount);
+        void queryResults() override;
+        const uint64_t *getResults() const override;
+        uint32_t getCount() const override;
+    };
+
+    struct NullShader : RenderShader {
+        std::string entryPointName;
+        RenderShaderFormat format = RenderShaderFormat::UNKNOWN;
+
+        NullShader(const char *entryPointName, RenderShaderFormat format);
+    };
+
+    struct NullSampler : RenderSampler {
+        RenderSamplerDesc desc;
+
+        NullSampler(const RenderSamplerDesc &desc);
+    };
+
+    struct NullPipeline : RenderPipeline {
+        NullDevice *device = nullptr;
+        std::vector<std::string> programNames;
+
+        NullPipeline(NullDevice *device);
+        ~NullPipeline() override;
+        RenderPipelineProgram getProgram(const std::string &name) const override;
+    };
+
+    struct NullDescriptorSet : RenderDescriptorSet {
+        uint32_t descriptorCount = 0;
+
+        NullDescriptorSet(const RenderDescriptorSetDesc &desc);
+        void setBuffer(uint32_t descriptorIndex, const RenderBuffer *buffer, uint64_t bufferSize, const RenderBufferStructuredView *bufferStructuredView, const RenderBufferFormattedView *bufferFormattedView) override;
+        void setTexture(uint32_t descriptorIndex, const RenderTexture *texture, RenderTextureLayout textureLayout, const RenderTextureView *textureView) override;
+        void setAccelerationStructure(uint32_t descriptorIndex, const RenderAccelerationStructure *accelerationStructure) override;
+    };
+
+    // Simulates a swap chain with a fixed size. Presenting only counts the frame, so no window is ever required.
+    struct NullSwapChain : RenderSwapChain {
+        static const uint32_t DefaultWidth = 1280;
+        static const uint32_t DefaultHeight = 720;
+        static const uint32_t DefaultRefreshRate = 60;
+
+        NullCommandQueue *commandQueue = nullptr;
+        RenderWindow renderWindow = {};
+        RenderFormat format = RenderFormat::UNKNOWN;
+        uint32_t width = DefaultWidth;
+        uint32_t height = DefaultHeight;
+        uint32_t currentTextureIndex = 0;
+        std::vector<std::unique_ptr<NullTexture>> textures;
+
+        NullSwapChain(NullCommandQueue *commandQueue, RenderWindow renderWindow, uint32_t textureCount, RenderFormat format);
+        bool present(uint32_t textureIndex, RenderCommandSemaphore **waitSemaphores, uint32_t waitSemaphoreCount) override;
+        bool resize() override;
+        bool needsResize() const override;
+        uint32_t getWidth() const override;
+        uint32_t getHeight() const override;
+        RenderTexture *getTexture(uint32_t textureIndex) override;
+        uint32_t getTextureCount() const override;
+        bool acquireTexture(RenderCommandSemaphore *signalSemaphore, uint32_t *textureIndex) override;
+        RenderWindow getWindow() const override;
+        bool isEmpty() const override;
+        uint32_t getRefreshRate() const override;
+    };
+
+    struct NullFramebuffer : RenderFramebuffer {
+        uint32_t width = 0;
+        uint32_t height = 0;
+
+        NullFramebuffer(const RenderFramebufferDesc &desc);
+        uint32_t getWidth() const override;
+        uint32_t getHeight() const override;
+    };
+
+    struct NullCommandList : RenderCommandList {
+        NullDevice *device = nullptr;
+        RenderCommandListType type = RenderCommandListType::UNKNOWN;
+        NullCommandCounters counters;
+        bool open = false;
+
+        NullCommandList(NullDevice *device, RenderCommandListType type);
+        void begin() override;
+        void end() override;
+        void barriers(RenderBarrierStages stages, const RenderBufferBarrier *bufferBarriers, uint32_t bufferBarriersCount, const RenderTextureBarrier *textureBarriers, uint32_t textureBarriersCount) override;
+        void dispatch(uint32_t threadGroupCountX, uint32_t threadGroupCountY, uint32_t threadGroupCountZ) override;
+        void traceRays(uint32_t width, uint32_t height, uint32_t depth, RenderBufferReference shaderBindingTable, const RenderShaderBindingGroupsInfo &shaderBindingGroupsInfo) override;
+        void drawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount, uint32_t startVertexLocation, uint32_t startInstanceLocation) override;
+        void drawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+        void setPipeline(const RenderPipeline *pipeline) override;
+        void setComputePipelineLayout(const RenderPipelineLayout *pipelineLayout) override;
+        void setComputePushConstants(uint32_t rangeIndex, const void *data) override;
+        void setComputeDescriptorSet(RenderDescriptorSet *descriptorSet, uint32_t setIndex) override;
+        void setGraphicsPipelineLayout(const RenderPipelineLayout *pipelineLayout) override;
+        void setGraphicsPushConstants(uint32_t rangeIndex, const void *data) override;
+        void setGraphicsDescriptorSet(RenderDescriptorSet *descriptorSet, uint32_t setIndex) override;
+        void setRaytracingPipelineLayout(const RenderPipelineLayout *pipelineLayout) override;
+        void setRaytracingPushConstants(uint32_t rangeIndex, const void *data) override;
+        void setRaytracingDescriptorSet(RenderDescriptorSet *descriptorSet, uint32_t setIndex) override;
+        void setIndexBuffer(const RenderIndexBufferView *view) override;
+        void setVertexBuffers(uint32_t startSlot, const RenderVertexBufferView *views, uint32_t viewCount, const RenderInputSlot *inputSlots) override;
+        void setViewports(const RenderViewport *viewports, uint32_t count) override;
+        void setScissors(const RenderRect *scissorRects, uint32_t count) override;
+        void setFramebuffer(const RenderFramebuffer *framebuffer) override;
+        void clearColor(uint32_t attachmentIndex, RenderColor colorValue, const RenderRect *clearRects, uint32_t clearRectsCount) override;
+        void clearDepth(bool clearDepth, float depthValue, const RenderRect *clearRects, uint32_t clearRectsCount) override;
+        void copyBufferRegion(RenderBufferReference dstBuffer, RenderBufferReference srcBuffer, uint64_t size) override;
+        void copyTextureRegion(const RenderTextureCopyLocation &dstLocation, const RenderTextureCopyLocation &srcLocation, uint32_t dstX, uint32_t dstY, uint32_t dstZ, const RenderBox *srcBox) override;
+        void copyBuffer(const RenderBuffer *dstBuffer, const RenderBuffer *srcBuffer) override;
+        void copyTexture(const RenderTexture *dstTexture, const RenderTexture *srcTexture) override;
+        void resolveTexture(const RenderTexture *dstTexture, const RenderTexture *srcTexture) override;
+        void resolveTextureRegion(const RenderTexture *dstTexture, uint32_t dstX, uint32_t dstY, const RenderTexture *srcTexture, const RenderRect *srcRect) override;
+        void buildBottomLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, const RenderBottomLevelASBuildInfo &buildInfo) override;
+        void buildTopLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, RenderBufferReference instancesBuffer, const RenderTopLevelASBuildInfo &buildInfo) override;
+        void resetQueryPool(const RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) override;
+        void writeTimestamp(const RenderQueryPool *queryPool, uint32_t queryIndex) override;
+    };
+
+    struct NullCommandFence : RenderCommandFence {
+        // Empty.
+    };
+
+    struct NullCommandSemaphore : RenderCommandSemaphore {
+        // Empty.
+    };
+
+    // Command lists are considered finished as soon as they're executed, so waiting on a fence never blocks.
+    struct NullCommandQueue : RenderCommandQueue {
+        NullDevice *device = nullptr;
+        RenderCommandListType type = RenderCommandListType::UNKNOWN;
+
+        NullCommandQueue(NullDevice *device, RenderCommandListType type);
+        std::unique_ptr<RenderSwapChain> createSwapChain(RenderWindow renderWindow, uint32_t textureCount, RenderFormat format) override;
+        void executeCommandLists(const RenderCommandList **commandLists, uint32_t commandListCount, RenderCommandSemaphore **waitSemaphores, uint32_t waitSemaphoreCount, RenderCommandSemaphore **signalSemaphores, uint32_t signalSemaphoreCount, RenderCommandFence *signalFence) override;
+        void waitForCommandFence(RenderCommandFence *fence) override;
+    };
+
+    struct NullPool : RenderPool {
+        NullDevice *device = nullptr;
+
+        NullPool(NullDevice *device);
+        std::unique_ptr<RenderBuffer> createBuffer(const RenderBufferDesc &desc) override;
+        std::unique_ptr<RenderTexture> createTexture(const RenderTextureDesc &desc) override;
+    };
+
+    struct NullDevice : RenderDevice {
+        NullInterface *renderInterface = nullptr;
+        RenderDeviceCapabilities capabilities;
+        RenderDeviceDescription description;
+        NullStatistics statistics;
+        std::mutex statisticsMutex;
+
+        NullDevice(NullInterface *renderInterface);
+        std::unique_ptr<RenderCommandList> createCommandList(RenderCommandListType type) override;
+        std::unique_ptr<RenderDescriptorSet> createDescriptorSet(const RenderDescriptorSetDesc &desc) override;
+        std::unique_ptr<RenderShader> createShader(const void *data, uint64_t size, const char *entryPointName, RenderShaderFormat format) override;
+        std::unique_ptr<RenderSampler> createSampler(const RenderSamplerDesc &desc) override;
+        std::unique_ptr<RenderPipeline> createComputePipeline(const RenderComputePipelineDesc &desc) override;
+        std::unique_ptr<RenderPipeline> createGraphicsPipeline(const RenderGraphicsPipelineDesc &desc) override;
+        std::unique_ptr<RenderPipeline> createRaytracingPipeline(const RenderRaytracingPipelineDesc &desc, const RenderPipeline *previousPipeline) override;
+        std::unique_ptr<RenderCommandQueue> createCommandQueue(RenderCommandListType type) override;
+        std::unique_ptr<RenderBuffer> createBuffer(const RenderBufferDesc &desc) override;
+        std::unique_ptr<RenderTexture> createTexture(const RenderTextureDesc &desc) override;
+        std::unique_ptr<RenderAccelerationStructure> createAccelerationStructure(const RenderAccelerationStructureDesc &desc) override;
+        std::unique_ptr<RenderPool> createPool(const RenderPoolDesc &desc) override;
+        std::unique_ptr<RenderPipelineLayout> createPipelineLayout(const RenderPipelineLayoutDesc &desc) override;
+        std::unique_ptr<RenderCommandFence> createCommandFence() override;
+        std::unique_ptr<RenderCommandSemaphore> createCommandSemaphore() override;
+        std::unique_ptr<RenderFramebuffer> createFramebuffer(const RenderFramebufferDesc &desc) override;
+        std::unique_ptr<RenderPipelineCache> createPipelineCache(const void *data, uint64_t size) override;
+        std::unique_ptr<RenderQueryPool> createQueryPool(uint32_t queryCount) override;
+        void setBottomLevelASBuildInfo(RenderBottomLevelASBuildInfo &buildInfo, const RenderBottomLevelASMesh *meshes, uint32_t meshCount, bool preferFastBuild, bool preferFastTrace) override;
+        void setTopLevelASBuildInfo(RenderTopLevelASBuildInfo &buildInfo, const RenderTopLevelASInstance *instances, uint32_t instanceCount, bool preferFastBuild, bool preferFastTrace) override;
+        void setShaderBindingTableInfo(RenderShaderBindingTableInfo &tableInfo, const RenderShaderBindingGroups &groups, const RenderPipeline *pipeline, RenderDescriptorSet **descriptorSets, uint32_t descriptorSetCount) override;
+        const RenderDeviceCapabilities &getCapabilities() const override;
+        const RenderDeviceDescription &getDescription() const override;
+        RenderSampleCounts getSampleCountsSupported(RenderFormat format) const override;
+        NullStatistics getStatistics();
+        void resetStatistics();
+    };
+
+    struct NullInterface : RenderInterface {
+        RenderInterfaceCapabilities capabilities;
+
+        NullInterface();
+        std::unique_ptr<RenderDevice> createDevice() override;
+        const RenderInterfaceCapabilities &getCapabilities() const override;
+    };
+};
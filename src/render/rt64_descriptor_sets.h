@@ -639,6 +639,52 @@ namespace RT64 {
         }
     };
 
+    struct TextureDecodeBatchDescriptorSet : RenderDescriptorSetBase {
+        uint32_t gItems;
+
+        TextureDecodeBatchDescriptorSet(RenderDevice *device = nullptr) {
+            builder.begin();
+            gItems = builder.addStructuredBuffer(1);
+            builder.end();
+
+            if (device != nullptr) {
+                create(device);
+            }
+        }
+    };
+
+    struct TextureDecodeBatchTMEMDescriptorSet : RenderDescriptorSetBase {
+        static const int UpperRange = 0x1FFF;
+
+        uint32_t gTMEM;
+
+        TextureDecodeBatchTMEMDescriptorSet(RenderDevice *device = nullptr, uint32_t itemCount = 0) {
+            builder.begin();
+            gTMEM = builder.addTexture(0, UpperRange);
+            builder.end(true, itemCount);
+
+            if (device != nullptr) {
+                create(device);
+            }
+        }
+    };
+
+    struct TextureDecodeBatchRGBA32DescriptorSet : RenderDescriptorSetBase {
+        static const int UpperRange = 0x1FFF;
+
+        uint32_t gRGBA32;
+
+        TextureDecodeBatchRGBA32DescriptorSet(RenderDevice *device = nullptr, uint32_t itemCount = 0) {
+            builder.begin();
+            gRGBA32 = builder.addReadWriteTexture(0, UpperRange);
+            builder.end(true, itemCount);
+
+            if (device != nullptr) {
+                create(device);
+            }
+        }
+    };
+
     struct VideoInterfaceDescriptorSet : RenderDescriptorSetBase {
         uint32_t gInput;
         uint32_t gSampler;
@@ -1091,7 +1091,10 @@ namespace RT64 {
             params.farPlane = rtResources->rtParams.farDist;
             params.fovY = rtResources->rtParams.fovRadians;
             params.resetAccumulation = false; // TODO: Make this configurable via the API.
-            upscaler->upscale(worker, params);
+            {
+                GPUProfiler::Scope profilerScope(worker, GPUProfiler::Section::Upscaler);
+                upscaler->upscale(worker, params);
+            }
 
             worker->commandList->barriers(RenderBarrierStage::GRAPHICS, afterBarriers);
         }
@@ -1200,6 +1203,8 @@ namespace RT64 {
     }
 
     void FramebufferRenderer::recordFramebuffer(RenderWorker *worker, uint32_t framebufferIndex) {
+        GPUProfiler::Scope profilerScope(worker, GPUProfiler::Section::Framebuffers);
+
         // Submit all transition barriers first.
         thread_local std::vector<RenderTextureBarrier> startBarriers;
         startBarriers.clear();
@@ -1708,6 +1713,23 @@ namespace RT64 {
         checkRasterScene(rasterScene);
     }
 
+    void FramebufferRenderer::retargetFramebuffer(uint32_t framebufferIndex, RenderFramebufferStorage *fbStorage) {
+        assert(framebufferIndex < framebufferCount);
+        assert(fbStorage != nullptr);
+
+        // Only the targets change when the framebuffers added previously are drawn again, so the draw calls can be kept as they are.
+        Framebuffer &framebuffer = framebufferVector[framebufferIndex];
+        RenderTargetDrawCall &targetDrawCall = framebuffer.renderTargetDrawCall;
+        if (targetDrawCall.fbStorage == fbStorage) {
+            return;
+        }
+
+        framebuffer.descRealFbSet->setTexture(framebuffer.descRealFbSet->gBackgroundColor, fbStorage->colorTarget->getResolvedTexture(), RenderTextureLayout::SHADER_READ, fbStorage->colorTarget->getResolvedTextureView());
+        framebuffer.descRealFbSet->setTexture(framebuffer.descRealFbSet->gBackgroundDepth, fbStorage->depthTarget->texture.get(), RenderTextureLayout::DEPTH_READ, fbStorage->depthTarget->textureView.get());
+        framebuffer.descDummyFbSet->setTexture(framebuffer.descDummyFbSet->gBackgroundColor, fbStorage->colorTarget->getResolvedTexture(), RenderTextureLayout::SHADER_READ, fbStorage->colorTarget->getResolvedTextureView());
+        targetDrawCall.fbStorage = fbStorage;
+    }
+
     void FramebufferRenderer::endFramebuffers(RenderWorker *worker, const DrawBuffers *drawBuffers, const OutputBuffers *outputBuffers, bool rtEnabled) {
         bool shaderViewRtEnabled = false;
         std::vector<BufferUploader::Upload> shaderUploads = {
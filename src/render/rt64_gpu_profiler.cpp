@@ -0,0 +1,168 @@
+//
+// RT64
+//
+
+#include "rt64_gpu_profiler.h"
+
+#include <fstream>
+
+#include "rt64_render_worker.h"
+
+namespace RT64 {
+    // GPUProfiler::Recorder
+
+    void GPUProfiler::Recorder::setup(GPUProfiler *profiler, RenderDevice *device) {
+        assert(profiler != nullptr);
+        assert(device != nullptr);
+
+        this->profiler = profiler;
+
+        if (device->getCapabilities().timestampQueries) {
+            queryPool = device->createQueryPool(MaxScopes * 2);
+        }
+    }
+
+    uint32_t GPUProfiler::Recorder::beginScope(RenderCommandList *commandList, Section section) {
+        if ((queryPool == nullptr) || !profiler->enabled) {
+            return UINT32_MAX;
+        }
+
+        const uint32_t scopeIndex = uint32_t(scopeSections.size());
+        if (scopeIndex >= MaxScopes) {
+            return UINT32_MAX;
+        }
+
+        // Reset all the queries the first time a scope is opened on the command list.
+        if (scopeIndex == 0) {
+            commandList->resetQueryPool(queryPool.get(), 0, queryPool->getCount());
+        }
+
+        scopeSections.emplace_back(section);
+        commandList->writeTimestamp(queryPool.get(), scopeIndex * 2 + 0);
+        return scopeIndex;
+    }
+
+    void GPUProfiler::Recorder::endScope(RenderCommandList *commandList, uint32_t scopeIndex) {
+        if (scopeIndex == UINT32_MAX) {
+            return;
+        }
+
+        commandList->writeTimestamp(queryPool.get(), scopeIndex * 2 + 1);
+    }
+
+    void GPUProfiler::Recorder::resolve() {
+        if (scopeSections.empty()) {
+            return;
+        }
+
+        queryPool->queryResults();
+
+        const uint64_t *results = queryPool->getResults();
+        std::array<double, SectionCount> sectionMilliseconds = {};
+        std::array<bool, SectionCount> sectionUsed = {};
+        for (size_t i = 0; i < scopeSections.size(); i++) {
+            const uint64_t beginTimestamp = results[i * 2 + 0];
+            const uint64_t endTimestamp = results[i * 2 + 1];
+            if ((beginTimestamp == 0) || (endTimestamp < beginTimestamp)) {
+                continue;
+            }
+
+            const uint32_t sectionIndex = uint32_t(scopeSections[i]);
+            sectionMilliseconds[sectionIndex] += double(endTimestamp - beginTimestamp) / 1000000.0;
+            sectionUsed[sectionIndex] = true;
+        }
+
+        scopeSections.clear();
+        profiler->logSections(sectionMilliseconds, sectionUsed);
+    }
+
+    // GPUProfiler::Scope
+
+    GPUProfiler::Scope::Scope(RenderWorker *worker, Section section) {
+        assert(worker != nullptr);
+
+        if (worker->profilerRecorder.profiler != nullptr) {
+            recorder = &worker->profilerRecorder;
+            commandList = worker->commandList.get();
+            scopeIndex = recorder->beginScope(commandList, section);
+        }
+    }
+
+    GPUProfiler::Scope::~Scope() {
+        if (recorder != nullptr) {
+            recorder->endScope(commandList, scopeIndex);
+        }
+    }
+
+    // GPUProfiler
+
+    GPUProfiler::GPUProfiler() {
+        for (ProfilingTimer &timer : sectionTimers) {
+            timer.setCount(HistorySize);
+        }
+    }
+
+    void GPUProfiler::logSections(const std::array<double, SectionCount> &sectionMilliseconds, const std::array<bool, SectionCount> &sectionUsed) {
+        const std::scoped_lock<std::mutex> sectionLock(sectionMutex);
+        for (uint32_t i = 0; i < SectionCount; i++) {
+            if (sectionUsed[i]) {
+                sectionTimers[i].accumulation = sectionMilliseconds[i];
+                sectionTimers[i].log();
+            }
+        }
+    }
+
+    void GPUProfiler::copySectionTimers(std::array<ProfilingTimer, SectionCount> &timers) {
+        const std::scoped_lock<std::mutex> sectionLock(sectionMutex);
+        timers = sectionTimers;
+    }
+
+    bool GPUProfiler::exportCSV(const std::filesystem::path &path) {
+        std::array<ProfilingTimer, SectionCount> timers;
+        copySectionTimers(timers);
+
+        std::ofstream csvStream(path);
+        if (!csvStream.is_open()) {
+            return false;
+        }
+
+        csvStream << "Sample";
+        for (uint32_t i = 0; i < SectionCount; i++) {
+            csvStream << "," << sectionName(Section(i)) << " (ms)";
+        }
+
+        csvStream << std::endl;
+
+        // Each section is logged once per command list it was used in, so samples are aligned by how recent they are, from oldest to newest.
+        for (uint32_t s = 0; s < HistorySize; s++) {
+            csvStream << s;
+            for (uint32_t i = 0; i < SectionCount; i++) {
+                const ProfilingTimer &timer = timers[i];
+                csvStream << "," << timer.data()[(timer.index() + s) % timer.size()];
+            }
+
+            csvStream << std::endl;
+        }
+
+        return !csvStream.bad();
+    }
+
+    const char *GPUProfiler::sectionName(Section section) {
+        switch (section) {
+        case Section::Framebuffers:
+            return "Framebuffers";
+        case Section::RSPProcessor:
+            return "RSP Processor";
+        case Section::VertexProcessor:
+            return "Vertex Processor";
+        case Section::TextureDecode:
+            return "Texture Decode";
+        case Section::VIRenderer:
+            return "VI Renderer";
+        case Section::Upscaler:
+            return "Upscaler";
+        default:
+            return "Unknown";
+        }
+    }
+};
@@ -0,0 +1,67 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+
+#include "common/rt64_profiling_timer.h"
+#include "rhi/rt64_render_interface.h"
+
+namespace RT64 {
+    struct RenderWorker;
+
+    // Measures the GPU time spent on named sections of the command lists through timestamp queries.
+    struct GPUProfiler {
+        enum class Section : uint32_t {
+            Framebuffers,
+            RSPProcessor,
+            VertexProcessor,
+            TextureDecode,
+            VIRenderer,
+            Upscaler,
+            Count
+        };
+
+        static const uint32_t HistorySize = 120;
+        static const uint32_t MaxScopes = 256;
+        static const uint32_t SectionCount = uint32_t(Section::Count);
+
+        // Owned by each worker. Queries are reset when the first scope of a command list is opened and the results are
+        // resolved once the worker has waited for the command list to finish.
+        struct Recorder {
+            GPUProfiler *profiler = nullptr;
+            std::unique_ptr<RenderQueryPool> queryPool;
+            std::vector<Section> scopeSections;
+
+            void setup(GPUProfiler *profiler, RenderDevice *device);
+            uint32_t beginScope(RenderCommandList *commandList, Section section);
+            void endScope(RenderCommandList *commandList, uint32_t scopeIndex);
+            void resolve();
+        };
+
+        // RAII convenience class for measuring a section of a worker's command list inside a scope.
+        struct Scope {
+            Recorder *recorder = nullptr;
+            RenderCommandList *commandList = nullptr;
+            uint32_t scopeIndex = UINT32_MAX;
+
+            Scope(RenderWorker *worker, Section section);
+            ~Scope();
+        };
+
+        std::array<ProfilingTimer, SectionCount> sectionTimers;
+        std::mutex sectionMutex;
+        std::atomic<bool> enabled = true;
+
+        GPUProfiler();
+        void logSections(const std::array<double, SectionCount> &sectionMilliseconds, const std::array<bool, SectionCount> &sectionUsed);
+        void copySectionTimers(std::array<ProfilingTimer, SectionCount> &timers);
+        bool exportCSV(const std::filesystem::path &path);
+        static const char *sectionName(Section section);
+    };
+};
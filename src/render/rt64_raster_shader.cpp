@@ -55,7 +55,7 @@ namespace RT64 {
     // RasterShader
 
     RasterShader::RasterShader(RenderDevice *device, const ShaderDescription &desc, const RenderPipelineLayout *pipelineLayout, RenderShaderFormat shaderFormat, const RenderMultisampling &multisampling, 
-        const ShaderCompiler *shaderCompiler, std::vector<uint8_t> *vsBytes, std::vector<uint8_t> *psBytes, bool useBytes)
+        const ShaderCompiler *shaderCompiler, RenderPipelineCache *pipelineCache, std::vector<uint8_t> *vsBytes, std::vector<uint8_t> *psBytes, bool useBytes)
     {
         assert(device != nullptr);
 
@@ -188,6 +188,8 @@ namespace RT64 {
         creation.usesHDR = desc.flags.usesHDR;
         creation.specConstants = specConstants;
         creation.multisampling = multisampling;
+        creation.pipelineCache = pipelineCache;
+        creation.pipelineCacheKey = pipelineCacheKey(desc, multisampling);
         pipeline = createPipeline(creation);
     }
 
@@ -302,6 +304,8 @@ namespace RT64 {
         pipelineDesc.pixelShader = c.pixelShader;
         pipelineDesc.specConstants = c.specConstants.data();
         pipelineDesc.specConstantsCount = uint32_t(c.specConstants.size());
+        pipelineDesc.pipelineCache = c.pipelineCache;
+        pipelineDesc.pipelineCacheKey = c.pipelineCacheKey;
 
         if (c.zCmp) {
             // While these modes evaluate equality in the hardware, we use LEQUAL to simulate the depth comparison in the shader instead.
@@ -334,6 +338,11 @@ namespace RT64 {
 
         return c.device->createGraphicsPipeline(pipelineDesc);
     }
+
+    uint64_t RasterShader::pipelineCacheKey(const ShaderDescription &desc, const RenderMultisampling &multisampling) {
+        // The same description results in a different pipeline depending on the sample count.
+        return XXH3_64bits_withSeed(&desc, sizeof(ShaderDescription), multisampling.sampleCount);
+    }
     
     RenderMultisampling RasterShader::generateMultisamplingPattern(RenderSampleCounts sampleCount, bool sampleLocationsSupported) {
 #   if SAMPLE_LOCATIONS_REQUIRED
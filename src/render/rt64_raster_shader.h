@@ -36,6 +36,8 @@ namespace RT64 {
         bool usesHDR;
         std::vector<RenderSpecConstant> specConstants;
         RenderMultisampling multisampling;
+        RenderPipelineCache *pipelineCache = nullptr;
+        uint64_t pipelineCacheKey = 0;
     };
 
     struct RasterShaderText {
@@ -49,11 +51,12 @@ namespace RT64 {
         std::unique_ptr<RenderPipeline> pipeline;
 
         RasterShader(RenderDevice *device, const ShaderDescription &desc, const RenderPipelineLayout *pipelineLayout, RenderShaderFormat shaderFormat, const RenderMultisampling &multisampling, 
-            const ShaderCompiler *shaderCompiler, std::vector<uint8_t> *vsBytes = nullptr, std::vector<uint8_t> *psBytes = nullptr, bool useBytes = false);
+            const ShaderCompiler *shaderCompiler, RenderPipelineCache *pipelineCache = nullptr, std::vector<uint8_t> *vsBytes = nullptr, std::vector<uint8_t> *psBytes = nullptr, bool useBytes = false);
 
         ~RasterShader();
         static RasterShaderText generateShaderText(const ShaderDescription &desc, bool multisampling);
         static std::unique_ptr<RenderPipeline> createPipeline(const PipelineCreation &c);
+        static uint64_t pipelineCacheKey(const ShaderDescription &desc, const RenderMultisampling &multisampling);
         static RenderMultisampling generateMultisamplingPattern(uint32_t sampleCount, bool sampleLocationsSupported);
     };
 
@@ -4,11 +4,113 @@
 
 #include "rt64_raster_shader_cache.h"
 
+#include "common/rt64_elapsed_timer.h"
 #include "common/rt64_thread.h"
 
+#include "xxHash/xxh3.h"
+
 #define ENABLE_OPTIMIZED_SHADER_GENERATION
 
 namespace RT64 {
+    // RasterShaderCache::OfflineUsage
+
+    static const uint32_t UsageMagic = 0x55535452;
+    static const uint32_t UsageVersion = 1;
+
+    // Amount of frames since recording started that are considered to be part of the boot sequence.
+    static const uint32_t UsageEarlyFrames = 60 * 30;
+
+    void RasterShaderCache::OfflineUsage::startRecording() {
+        counters.clear();
+        recording = true;
+        earlyWindow = true;
+        recordedFrames = 0;
+    }
+
+    void RasterShaderCache::OfflineUsage::stopRecording() {
+        recording = false;
+        earlyWindow = false;
+    }
+
+    void RasterShaderCache::OfflineUsage::hit(uint64_t shaderHash) {
+        if (!recording) {
+            return;
+        }
+
+        Counter &counter = counters[shaderHash];
+        counter.totalHits++;
+        if (earlyWindow) {
+            counter.earlyHits++;
+        }
+    }
+
+    void RasterShaderCache::OfflineUsage::advanceFrame() {
+        if (!recording) {
+            return;
+        }
+
+        recordedFrames++;
+        earlyWindow = (recordedFrames < UsageEarlyFrames);
+    }
+
+    bool RasterShaderCache::OfflineUsage::load(std::istream &stream) {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint32_t counterCount = 0;
+        stream.read(reinterpret_cast<char *>(&magic), sizeof(uint32_t));
+        stream.read(reinterpret_cast<char *>(&version), sizeof(uint32_t));
+        stream.read(reinterpret_cast<char *>(&counterCount), sizeof(uint32_t));
+        if (stream.fail() || (magic != UsageMagic) || (version != UsageVersion)) {
+            return false;
+        }
+
+        counters.clear();
+        for (uint32_t i = 0; i < counterCount; i++) {
+            uint64_t shaderHash = 0;
+            Counter counter;
+            stream.read(reinterpret_cast<char *>(&shaderHash), sizeof(uint64_t));
+            stream.read(reinterpret_cast<char *>(&counter.earlyHits), sizeof(uint64_t));
+            stream.read(reinterpret_cast<char *>(&counter.totalHits), sizeof(uint64_t));
+            if (stream.fail()) {
+                counters.clear();
+                return false;
+            }
+
+            counters[shaderHash] = counter;
+        }
+
+        return true;
+    }
+
+    bool RasterShaderCache::OfflineUsage::save(std::ostream &stream) const {
+        const uint32_t counterCount = uint32_t(counters.size());
+        stream.write(reinterpret_cast<const char *>(&UsageMagic), sizeof(uint32_t));
+        stream.write(reinterpret_cast<const char *>(&UsageVersion), sizeof(uint32_t));
+        stream.write(reinterpret_cast<const char *>(&counterCount), sizeof(uint32_t));
+        for (const auto &it : counters) {
+            stream.write(reinterpret_cast<const char *>(&it.first), sizeof(uint64_t));
+            stream.write(reinterpret_cast<const char *>(&it.second.earlyHits), sizeof(uint64_t));
+            stream.write(reinterpret_cast<const char *>(&it.second.totalHits), sizeof(uint64_t));
+        }
+
+        return !stream.bad();
+    }
+
+    bool RasterShaderCache::OfflineUsage::isHotter(uint64_t shaderHashA, uint64_t shaderHashB) const {
+        auto aIt = counters.find(shaderHashA);
+        auto bIt = counters.find(shaderHashB);
+        const Counter a = (aIt != counters.end()) ? aIt->second : Counter();
+        const Counter b = (bIt != counters.end()) ? bIt->second : Counter();
+
+        // Shaders used during the boot sequence are prioritized over the ones that are used more often during the rest of the game.
+        if (a.earlyHits != b.earlyHits) {
+            return a.earlyHits > b.earlyHits;
+        }
+        else {
+            return a.totalHits > b.totalHits;
+        }
+    }
+
     // RasterShaderCache::OfflineList
 
     static const uint32_t OfflineMagic = 0x43535452;
@@ -38,6 +140,7 @@ namespace RT64 {
             }
 
             stream.read(reinterpret_cast<char *>(&entry.shaderDesc), sizeof(ShaderDescription));
+            entry.shaderHash = entry.shaderDesc.hash();
 
             uint32_t vsDxilSize = 0;
             stream.read(reinterpret_cast<char *>(&vsDxilSize), sizeof(uint32_t));
@@ -76,6 +179,18 @@ namespace RT64 {
         }
     }
 
+    void RasterShaderCache::OfflineList::sortByUsage(const OfflineUsage &usage) {
+        // Only sort the entries that haven't been stepped through yet. The sort is stable, so entries without usage keep their file order.
+        std::list<Entry> remainingEntries;
+        remainingEntries.splice(remainingEntries.end(), entries, entryIterator, entries.end());
+        remainingEntries.sort([&usage](const Entry &a, const Entry &b) {
+            return usage.isHotter(a.shaderHash, b.shaderHash);
+        });
+
+        entryIterator = remainingEntries.begin();
+        entries.splice(entries.end(), remainingEntries);
+    }
+
     bool RasterShaderCache::OfflineList::atEnd() const {
         if (!entries.empty()) {
             return entryIterator == entries.end();
@@ -90,6 +205,7 @@ namespace RT64 {
     bool RasterShaderCache::OfflineDumper::startDumping(const std::filesystem::path &path) {
         assert(!dumpStream.is_open());
         dumpStream.open(path, std::ios::binary);
+        dumpPath = path;
         return dumpStream.is_open();
     }
     
@@ -120,6 +236,257 @@ namespace RT64 {
         return dumpStream.is_open();
     }
 
+    // RasterShaderCache::PipelineStore
+
+    static const uint32_t PipelineStoreMagic = 0x50505452;
+    static const uint32_t PipelineStoreVersion = 1;
+    static const uint32_t PipelineStoreSaveThreshold = 32;
+
+    // Sizes read from the file are checked against this before allocating, as a truncated or corrupted file can hold any value.
+    static uint64_t remainingStreamBytes(std::ifstream &stream) {
+        const std::streampos position = stream.tellg();
+        stream.seekg(0, std::ios::end);
+        const std::streampos endPosition = stream.tellg();
+        stream.seekg(position);
+        if (stream.fail() || (position < 0) || (endPosition < position)) {
+            return 0;
+        }
+
+        return uint64_t(endPosition - position);
+    }
+
+    bool RasterShaderCache::PipelineStore::load(RenderDevice *device, RenderShaderFormat shaderFormat, const std::filesystem::path &path) {
+        assert(device != nullptr);
+
+        ElapsedTimer loadTimer;
+        {
+            const std::unique_lock<std::mutex> lock(storeMutex);
+            this->path = path;
+            identityHash = computeIdentityHash(device, shaderFormat);
+            loadedKeys.clear();
+            storedKeys.clear();
+            pendingCount = 0;
+            statistics = Statistics();
+        }
+
+        // Read the contents of the store if it exists and was created by the same device, driver and shader libraries.
+        std::vector<uint8_t> cacheData;
+        std::ifstream stream(path, std::ios::binary);
+        if (stream.is_open()) {
+            uint32_t magic = 0;
+            uint32_t version = 0;
+            uint64_t fileIdentityHash = 0;
+            uint32_t keyCount = 0;
+            stream.read(reinterpret_cast<char *>(&magic), sizeof(uint32_t));
+            stream.read(reinterpret_cast<char *>(&version), sizeof(uint32_t));
+            stream.read(reinterpret_cast<char *>(&fileIdentityHash), sizeof(uint64_t));
+            stream.read(reinterpret_cast<char *>(&keyCount), sizeof(uint32_t));
+            const bool headerValid = !stream.fail() && (magic == PipelineStoreMagic) && (version == PipelineStoreVersion) && (fileIdentityHash == identityHash);
+            if (headerValid && ((uint64_t(keyCount) * sizeof(uint64_t)) <= remainingStreamBytes(stream))) {
+                std::vector<uint64_t> keys(keyCount);
+                uint64_t dataSize = 0;
+                stream.read(reinterpret_cast<char *>(keys.data()), keyCount * sizeof(uint64_t));
+                stream.read(reinterpret_cast<char *>(&dataSize), sizeof(uint64_t));
+                if (!stream.fail() && (dataSize <= remainingStreamBytes(stream))) {
+                    cacheData.resize(dataSize);
+                    stream.read(reinterpret_cast<char *>(cacheData.data()), dataSize);
+                }
+
+                if (!stream.fail()) {
+                    const std::unique_lock<std::mutex> lock(storeMutex);
+                    loadedKeys.insert(keys.begin(), keys.end());
+                    storedKeys = loadedKeys;
+                }
+                else {
+                    cacheData.clear();
+                }
+            }
+        }
+
+        pipelineCache = device->createPipelineCache(cacheData.data(), cacheData.size());
+
+        const std::unique_lock<std::mutex> lock(storeMutex);
+        statistics.loadMilliseconds = loadTimer.elapsedMilliseconds();
+        statistics.warmStart = !cacheData.empty();
+        return statistics.warmStart;
+    }
+
+    bool RasterShaderCache::PipelineStore::save() {
+        if ((pipelineCache == nullptr) || path.empty()) {
+            return false;
+        }
+
+        std::vector<uint64_t> keys;
+        uint64_t fileIdentityHash = 0;
+        {
+            const std::unique_lock<std::mutex> lock(storeMutex);
+            keys.assign(storedKeys.begin(), storedKeys.end());
+            fileIdentityHash = identityHash;
+            pendingCount = 0;
+        }
+
+        std::vector<uint8_t> cacheData;
+        if (!pipelineCache->getData(cacheData)) {
+            return false;
+        }
+
+        // Write to a temporary file first and replace the store afterwards so a partially written file is never loaded.
+        std::filesystem::path tempPath = path;
+        tempPath += ".tmp";
+        {
+            std::ofstream stream(tempPath, std::ios::binary);
+            if (!stream.is_open()) {
+                return false;
+            }
+
+            const uint32_t keyCount = uint32_t(keys.size());
+            const uint64_t dataSize = cacheData.size();
+            stream.write(reinterpret_cast<const char *>(&PipelineStoreMagic), sizeof(uint32_t));
+            stream.write(reinterpret_cast<const char *>(&PipelineStoreVersion), sizeof(uint32_t));
+            stream.write(reinterpret_cast<const char *>(&fileIdentityHash), sizeof(uint64_t));
+            stream.write(reinterpret_cast<const char *>(&keyCount), sizeof(uint32_t));
+            stream.write(reinterpret_cast<const char *>(keys.data()), keyCount * sizeof(uint64_t));
+            stream.write(reinterpret_cast<const char *>(&dataSize), sizeof(uint64_t));
+            stream.write(reinterpret_cast<const char *>(cacheData.data()), dataSize);
+            if (stream.bad()) {
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        return !ec;
+    }
+
+    void RasterShaderCache::PipelineStore::record(uint64_t pipelineKey, double milliseconds) {
+        const std::unique_lock<std::mutex> lock(storeMutex);
+        if (loadedKeys.find(pipelineKey) != loadedKeys.end()) {
+            statistics.warmCount++;
+            statistics.warmMilliseconds += milliseconds;
+        }
+        else {
+            statistics.coldCount++;
+            statistics.coldMilliseconds += milliseconds;
+        }
+
+        if (storedKeys.insert(pipelineKey).second) {
+            pendingCount++;
+        }
+    }
+
+    bool RasterShaderCache::PipelineStore::needsSave() {
+        const std::unique_lock<std::mutex> lock(storeMutex);
+        return (pipelineCache != nullptr) && !path.empty() && (pendingCount >= PipelineStoreSaveThreshold);
+    }
+
+    RasterShaderCache::PipelineStore::Statistics RasterShaderCache::PipelineStore::getStatistics() {
+        const std::unique_lock<std::mutex> lock(storeMutex);
+        return statistics;
+    }
+
+    uint64_t RasterShaderCache::PipelineStore::computeIdentityHash(RenderDevice *device, RenderShaderFormat shaderFormat) {
+        const RenderDeviceDescription &description = device->getDescription();
+        const uint64_t identityValues[] = {
+            description.vendorId,
+            description.deviceId,
+            description.driverVersion,
+            uint64_t(shaderFormat),
+            RasterShaderUber::RasterVSLibraryHash,
+            RasterShaderUber::RasterPSLibraryHash
+        };
+
+        const uint64_t nameHash = XXH3_64bits(description.name.data(), description.name.size());
+        return XXH3_64bits_withSeed(identityValues, sizeof(identityValues), nameHash);
+    }
+
+    // RasterShaderCache::SubmissionSet
+
+    RasterShaderCache::SubmissionSet::Result RasterShaderCache::SubmissionSet::submit(uint64_t shaderHash, uint32_t frame) {
+        Shard &shard = shardFor(shaderHash);
+        const std::unique_lock<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(shaderHash);
+        if (it == shard.entries.end()) {
+            Entry &entry = shard.entries[shaderHash];
+            entry.lastFrame = frame;
+            entry.pending = true;
+            return Result::Inserted;
+        }
+
+        // The shader is still waiting in the queue but it was seen again in a newer frame, so it must be queued again with a higher priority.
+        Entry &entry = it->second;
+        if (entry.pending && (entry.lastFrame != frame)) {
+            entry.lastFrame = frame;
+            return Result::Reprioritized;
+        }
+
+        return Result::Existing;
+    }
+
+    bool RasterShaderCache::SubmissionSet::insertIfMissing(uint64_t shaderHash) {
+        Shard &shard = shardFor(shaderHash);
+        const std::unique_lock<std::mutex> lock(shard.mutex);
+        return shard.entries.emplace(shaderHash, Entry()).second;
+    }
+
+    bool RasterShaderCache::SubmissionSet::acquire(uint64_t shaderHash, uint32_t frame) {
+        Shard &shard = shardFor(shaderHash);
+        const std::unique_lock<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(shaderHash);
+        if ((it == shard.entries.end()) || !it->second.pending || (it->second.lastFrame != frame)) {
+            return false;
+        }
+
+        it->second.pending = false;
+        return true;
+    }
+
+    void RasterShaderCache::SubmissionSet::clear() {
+        for (Shard &shard : shards) {
+            const std::unique_lock<std::mutex> lock(shard.mutex);
+            shard.entries.clear();
+        }
+    }
+
+    RasterShaderCache::SubmissionSet::Shard &RasterShaderCache::SubmissionSet::shardFor(uint64_t shaderHash) {
+        // The hash is already well distributed, so the upper bits can be used directly.
+        return shards[(shaderHash >> 60) % ShardCount];
+    }
+
+    // RasterShaderCache::SubmissionQueue
+
+    bool RasterShaderCache::SubmissionQueue::ItemCompare::operator()(const Item &a, const Item &b) const {
+        // Shaders seen in the most recent frame go first. Shaders from the same frame are compiled in the order they were submitted.
+        if (a.frame != b.frame) {
+            return a.frame < b.frame;
+        }
+        else {
+            return a.sequence > b.sequence;
+        }
+    }
+
+    void RasterShaderCache::SubmissionQueue::push(const ShaderDescription &shaderDesc, uint64_t shaderHash, uint32_t frame) {
+        Item item;
+        item.shaderDesc = shaderDesc;
+        item.shaderHash = shaderHash;
+        item.frame = frame;
+        item.sequence = sequence++;
+        items.push(item);
+    }
+
+    void RasterShaderCache::SubmissionQueue::pop(Item &item) {
+        assert(!items.empty());
+        item = items.top();
+        items.pop();
+    }
+
+    bool RasterShaderCache::SubmissionQueue::empty() const {
+        return items.empty();
+    }
+
+    void RasterShaderCache::SubmissionQueue::clear() {
+        items = decltype(items)();
+    }
+
     // RasterShaderCache::CompilationThread
     
     RasterShaderCache::CompilationThread::CompilationThread(RasterShaderCache *shaderCache) {
@@ -147,6 +514,7 @@ namespace RT64 {
         threadRunning = true;
 
         OfflineList::Entry offlineListEntry;
+        SubmissionQueue::Item queueItem;
         std::vector<uint8_t> dumperVsBytes;
         std::vector<uint8_t> dumperPsBytes;
         while (threadRunning) {
@@ -159,28 +527,33 @@ namespace RT64 {
                 std::unique_lock<std::mutex> queueLock(shaderCache->descQueueMutex);
                 shaderCache->descQueueActiveCount--;
                 shaderCache->descQueueChanged.wait(queueLock, [this]() {
-                    return !threadRunning || !shaderCache->descQueue.empty() || !shaderCache->offlineList.atEnd();
+                    return !threadRunning || !shaderCache->descQueue.empty() || shaderCache->isOfflineListAvailable();
                 });
 
                 shaderCache->descQueueActiveCount++;
-                if (!shaderCache->descQueue.empty()) {
-                    shaderDesc = shaderCache->descQueue.front();
-                    shaderCache->descQueue.pop();
-                    fromPriorityQueue = true;
+
+                // Entries that were queued again with a newer frame leave behind stale copies that must be skipped.
+                while (!shaderCache->descQueue.empty() && !fromPriorityQueue) {
+                    shaderCache->descQueue.pop(queueItem);
+                    if (shaderCache->submissionSet.acquire(queueItem.shaderHash, queueItem.frame)) {
+                        shaderDesc = queueItem.shaderDesc;
+                        shaderCache->priorityActiveCount++;
+                        fromPriorityQueue = true;
+                    }
+                    else {
+                        shaderCache->staleCount++;
+                    }
                 }
-                else if (!shaderCache->offlineList.atEnd()) {
-                    std::unique_lock<std::mutex> queueLock(shaderCache->submissionMutex);
+
+                if (!fromPriorityQueue && shaderCache->isOfflineListAvailable()) {
                     while (!shaderCache->offlineList.atEnd() && !fromOfflineList) {
                         shaderCache->offlineList.step(offlineListEntry);
 
                         // Make sure the hash hasn't been submitted yet by the game. If it hasn't, mark it as such and use this entry of the list.
                         // Also make sure the internal color format used by the shader is compatible.
-                        uint64_t shaderHash = offlineListEntry.shaderDesc.hash();
                         const bool matchesColorFormat = (offlineListEntry.shaderDesc.flags.usesHDR == shaderCache->usesHDR);
-                        const bool hashMissing = (shaderCache->shaderHashes.find(shaderHash) == shaderCache->shaderHashes.end());
-                        if (matchesColorFormat && hashMissing) {
+                        if (matchesColorFormat && shaderCache->submissionSet.insertIfMissing(offlineListEntry.shaderHash)) {
                             shaderDesc = offlineListEntry.shaderDesc;
-                            shaderCache->shaderHashes[shaderHash] = true;
                             fromOfflineList = true;
                         }
                     }
@@ -189,6 +562,8 @@ namespace RT64 {
             
             // Compile the shader at the top of the queue.
             if (fromPriorityQueue || fromOfflineList) {
+                ElapsedTimer compilationTimer;
+
                 // Check if the shader dumper is active. Specify the shader's bytes should be stored in the thread's vectors.
                 std::vector<uint8_t> *shaderVsBytes = nullptr;
                 std::vector<uint8_t> *shaderPsBytes = nullptr;
@@ -209,7 +584,12 @@ namespace RT64 {
                 assert((shaderCache->shaderUber != nullptr) && "Ubershader should've been created by the time a new shader is submitted to the cache.");
                 const RenderPipelineLayout *uberPipelineLayout = shaderCache->shaderUber->pipelineLayout.get();
                 const RenderMultisampling multisampling = shaderCache->multisampling;
-                std::unique_ptr<RasterShader> newShader = std::make_unique<RasterShader>(shaderCache->device, shaderDesc, uberPipelineLayout, shaderCache->shaderFormat, multisampling, shaderCache->shaderCompiler.get(), shaderVsBytes, shaderPsBytes, useShaderBytes);
+                RenderPipelineCache *pipelineCache = shaderCache->pipelineStore.pipelineCache.get();
+                ElapsedTimer creationTimer;
+                std::unique_ptr<RasterShader> newShader = std::make_unique<RasterShader>(shaderCache->device, shaderDesc, uberPipelineLayout, shaderCache->shaderFormat, multisampling, shaderCache->shaderCompiler.get(), pipelineCache, shaderVsBytes, shaderPsBytes, useShaderBytes);
+                if (pipelineCache != nullptr) {
+                    shaderCache->pipelineStore.record(RasterShader::pipelineCacheKey(shaderDesc, multisampling), creationTimer.elapsedMilliseconds());
+                }
 
                 // Dump the bytes of the shader if requested.
                 if (!useShaderBytes && (shaderVsBytes != nullptr) && (shaderPsBytes != nullptr)) {
@@ -220,7 +600,7 @@ namespace RT64 {
                         // Toggle the use of HDR and compile another shader.
                         ShaderDescription shaderDescAlt = shaderDesc;
                         shaderDescAlt.flags.usesHDR = (shaderDescAlt.flags.usesHDR == 0);
-                        std::unique_ptr<RasterShader> altShader = std::make_unique<RasterShader>(shaderCache->device, shaderDescAlt, uberPipelineLayout, shaderCache->shaderFormat, multisampling, shaderCache->shaderCompiler.get(), shaderVsBytes, shaderPsBytes, useShaderBytes);
+                        std::unique_ptr<RasterShader> altShader = std::make_unique<RasterShader>(shaderCache->device, shaderDescAlt, uberPipelineLayout, shaderCache->shaderFormat, multisampling, shaderCache->shaderCompiler.get(), nullptr, shaderVsBytes, shaderPsBytes, useShaderBytes);
                         shaderCache->offlineDumper.stepDumping(shaderDescAlt, dumperVsBytes, dumperPsBytes);
                     }
                 }
@@ -229,6 +609,28 @@ namespace RT64 {
                     const std::unique_lock<std::mutex> lock(shaderCache->GPUShadersMutex);
                     shaderCache->GPUShaders[shaderDesc.hash()] = std::move(newShader);
                 }
+
+                // Write the pipeline store back incrementally once enough new pipelines have been created.
+                if (shaderCache->pipelineStore.needsSave()) {
+                    shaderCache->pipelineStore.save();
+                }
+
+                // Shaders from the offline list consume the budget. Threads waiting for idle time must be woken up once there's no more priority work.
+                bool priorityFinished = false;
+                {
+                    std::unique_lock<std::mutex> queueLock(shaderCache->descQueueMutex);
+                    if (fromPriorityQueue) {
+                        shaderCache->priorityActiveCount--;
+                        priorityFinished = (shaderCache->priorityActiveCount == 0);
+                    }
+                    else {
+                        shaderCache->offlineBudgetSpent += compilationTimer.elapsedMilliseconds();
+                    }
+                }
+
+                if (priorityFinished) {
+                    shaderCache->descQueueChanged.notify_all();
+                }
             }
         }
     }
@@ -239,6 +641,15 @@ namespace RT64 {
         assert(threadCount > 0);
 
         this->threadCount = threadCount;
+        submissionFrame = 0;
+        submitCount = 0;
+        insertedCount = 0;
+        reprioritizedCount = 0;
+        staleCount = 0;
+        submissionTiming = false;
+        timedCount = 0;
+        timedNanoseconds = 0;
+        offlineUsageRecording = false;
 
 #ifdef ENABLE_OPTIMIZED_SHADER_GENERATION
 #   ifdef _WIN32
@@ -255,37 +666,66 @@ namespace RT64 {
 
     RasterShaderCache::~RasterShaderCache() {
         compilationThreads.clear();
+
+        pipelineStore.save();
     }
 
-    void RasterShaderCache::setup(RenderDevice *device, RenderShaderFormat shaderFormat, const ShaderLibrary *shaderLibrary, const RenderMultisampling &multisampling) {
+    void RasterShaderCache::setup(RenderDevice *device, RenderShaderFormat shaderFormat, const ShaderLibrary *shaderLibrary, const RenderMultisampling &multisampling, const std::filesystem::path &pipelineStorePath) {
         assert(device != nullptr);
 
         this->device = device;
         this->shaderFormat = shaderFormat;
         this->multisampling = multisampling;
 
+        // Only load the pipeline store the first time the cache is set up. Subsequent setups keep using the same store.
+        if (!pipelineStorePath.empty() && (pipelineStore.pipelineCache == nullptr)) {
+            pipelineStore.load(device, shaderFormat, pipelineStorePath);
+        }
+
         shaderUber = std::make_unique<RasterShaderUber>(device, shaderFormat, multisampling, shaderLibrary, threadCount);
         usesHDR = shaderLibrary->usesHDR;
     }
 
     void RasterShaderCache::submit(const ShaderDescription &desc) {
-        {
-            std::unique_lock<std::mutex> queueLock(submissionMutex);
+        // Most submissions are a single lookup in the shard of the hash, so reading the clock twice per draw call would be a
+        // noticeable part of their cost. Only rt64_check turns this on.
+        if (submissionTiming) {
+            ElapsedTimer submitTimer;
+            submitDescription(desc);
+            timedNanoseconds += uint64_t(submitTimer.elapsedNanoseconds());
+            timedCount++;
+        }
+        else {
+            submitDescription(desc);
+        }
+    }
 
-            // Verify if an entry with the same hash was already submitted before.
-            const uint64_t shaderHash = desc.hash();
-            bool &found = shaderHashes[shaderHash];
-            if (found) {
-                return;
-            }
+    void RasterShaderCache::submitDescription(const ShaderDescription &desc) {
+        const uint64_t shaderHash = desc.hash();
+        if (offlineUsageRecording) {
+            std::unique_lock<std::mutex> queueLock(submissionMutex);
+            offlineUsage.hit(shaderHash);
+        }
 
-            found = true;
+        // Verify if an entry with the same hash was already submitted before. Only the shard the hash belongs to is locked,
+        // so the common case of an already submitted shader doesn't contend with the compilation threads.
+        submitCount++;
+        const uint32_t frame = submissionFrame;
+        const SubmissionSet::Result result = submissionSet.submit(shaderHash, frame);
+        if (result == SubmissionSet::Result::Existing) {
+            return;
+        }
+        else if (result == SubmissionSet::Result::Inserted) {
+            insertedCount++;
+        }
+        else {
+            reprioritizedCount++;
         }
 
         // Push a new shader compilation to the queue.
         {
             const std::unique_lock<std::mutex> queueLock(descQueueMutex);
-            descQueue.push(desc);
+            descQueue.push(desc, shaderHash, frame);
         }
 
         descQueueChanged.notify_all();
@@ -294,7 +734,7 @@ namespace RT64 {
     void RasterShaderCache::waitForAll() {
         {
             std::unique_lock<std::mutex> queueLock(descQueueMutex);
-            descQueue = std::queue<ShaderDescription>();
+            descQueue.clear();
         }
 
         bool keepWaiting = false;
@@ -310,10 +750,7 @@ namespace RT64 {
             GPUShaders.clear();
         }
 
-        {
-            std::unique_lock<std::mutex> queueLock(submissionMutex);
-            shaderHashes.clear();
-        }
+        submissionSet.clear();
     }
 
     RasterShader *RasterShaderCache::getGPUShader(const ShaderDescription &desc) {
@@ -339,11 +776,39 @@ namespace RT64 {
 
     bool RasterShaderCache::startOfflineDumper(const std::filesystem::path &path) {
         const std::unique_lock<std::mutex> lock(offlineDumperMutex);
-        return offlineDumper.startDumping(path);
+        if (!offlineDumper.startDumping(path)) {
+            return false;
+        }
+
+        // Record the usage of every shader while dumping so the list can be sorted by hotness when it's loaded.
+        {
+            std::unique_lock<std::mutex> queueLock(submissionMutex);
+            offlineUsage.startRecording();
+            offlineUsageRecording = true;
+        }
+
+        return true;
     }
 
     bool RasterShaderCache::stopOfflineDumper() {
         const std::unique_lock<std::mutex> lock(offlineDumperMutex);
+        OfflineUsage recordedUsage;
+        {
+            std::unique_lock<std::mutex> queueLock(submissionMutex);
+            offlineUsage.stopRecording();
+            offlineUsageRecording = false;
+            recordedUsage = offlineUsage;
+            offlineUsage.counters.clear();
+        }
+
+        // Store the usage statistics next to the dump. Loading the dump by its path will load them along with it.
+        std::filesystem::path usagePath = offlineDumper.dumpPath;
+        usagePath.replace_extension(".usage");
+        std::ofstream usageStream(usagePath, std::ios::binary);
+        if (usageStream.is_open()) {
+            recordedUsage.save(usageStream);
+        }
+
         return offlineDumper.stopDumping();
     }
 
@@ -353,6 +818,24 @@ namespace RT64 {
         {
             std::unique_lock<std::mutex> queueLock(descQueueMutex);
             result = offlineList.load(stream);
+            if (!loadedUsage.counters.empty()) {
+                offlineList.sortByUsage(loadedUsage);
+            }
+        }
+
+        descQueueChanged.notify_all();
+        return result;
+    }
+
+    bool RasterShaderCache::loadOfflineUsage(std::istream &stream) {
+        bool result = false;
+
+        {
+            std::unique_lock<std::mutex> queueLock(descQueueMutex);
+            result = loadedUsage.load(stream);
+            if (result) {
+                offlineList.sortByUsage(loadedUsage);
+            }
         }
 
         descQueueChanged.notify_all();
@@ -368,6 +851,73 @@ namespace RT64 {
         descQueueChanged.notify_all();
     }
 
+    void RasterShaderCache::setOfflineBudget(OfflineBudget budget, double milliseconds) {
+        {
+            std::unique_lock<std::mutex> queueLock(descQueueMutex);
+            offlineBudget = budget;
+            offlineBudgetMilliseconds = milliseconds;
+            offlineBudgetSpent = 0.0;
+        }
+
+        descQueueChanged.notify_all();
+    }
+
+    bool RasterShaderCache::isOfflineListAvailable() const {
+        // Must be called while holding the queue mutex.
+        if (offlineList.atEnd()) {
+            return false;
+        }
+
+        switch (offlineBudget) {
+        case OfflineBudget::PerFrame:
+            return offlineBudgetSpent < offlineBudgetMilliseconds;
+        case OfflineBudget::IdleOnly:
+            return descQueue.empty() && (priorityActiveCount == 0);
+        case OfflineBudget::Unlimited:
+        default:
+            return true;
+        }
+    }
+
+    void RasterShaderCache::advanceFrame() {
+        submissionFrame++;
+
+        {
+            std::unique_lock<std::mutex> queueLock(submissionMutex);
+            offlineUsage.advanceFrame();
+        }
+
+        bool budgetRefilled = false;
+        {
+            std::unique_lock<std::mutex> queueLock(descQueueMutex);
+            budgetRefilled = (offlineBudget == OfflineBudget::PerFrame) && (offlineBudgetSpent > 0.0);
+            offlineBudgetSpent = 0.0;
+        }
+
+        if (budgetRefilled) {
+            descQueueChanged.notify_all();
+        }
+    }
+
+    bool RasterShaderCache::savePipelineStore() {
+        return pipelineStore.save();
+    }
+
+    RasterShaderCache::PipelineStore::Statistics RasterShaderCache::pipelineStoreStatistics() {
+        return pipelineStore.getStatistics();
+    }
+
+    RasterShaderCache::SubmissionStatistics RasterShaderCache::submissionStatistics() const {
+        SubmissionStatistics statistics;
+        statistics.submitCount = submitCount;
+        statistics.insertedCount = insertedCount;
+        statistics.reprioritizedCount = reprioritizedCount;
+        statistics.staleCount = staleCount;
+        statistics.timedCount = timedCount;
+        statistics.timedNanoseconds = timedNanoseconds;
+        return statistics;
+    }
+
     uint32_t RasterShaderCache::shaderCount() {
         std::unique_lock<std::mutex> lock(GPUShadersMutex);
         return GPUShaders.size();
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <filesystem>
@@ -12,14 +13,36 @@
 #include <queue>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "rt64_raster_shader.h"
 
 namespace RT64 {
     struct RasterShaderCache {
+        struct OfflineUsage {
+            struct Counter {
+                uint64_t earlyHits = 0;
+                uint64_t totalHits = 0;
+            };
+
+            std::unordered_map<uint64_t, Counter> counters;
+            bool recording = false;
+            bool earlyWindow = false;
+            uint32_t recordedFrames = 0;
+
+            void startRecording();
+            void stopRecording();
+            void hit(uint64_t shaderHash);
+            void advanceFrame();
+            bool load(std::istream &stream);
+            bool save(std::ostream &stream) const;
+            bool isHotter(uint64_t shaderHashA, uint64_t shaderHashB) const;
+        };
+
         struct OfflineList {
             struct Entry {
                 ShaderDescription shaderDesc;
+                uint64_t shaderHash = 0;
                 std::vector<uint8_t> vsDxilBytes;
                 std::vector<uint8_t> psDxilBytes;
             };
@@ -31,11 +54,19 @@ namespace RT64 {
             bool load(std::istream &stream);
             void reset();
             void step(Entry &entry);
+            void sortByUsage(const OfflineUsage &usage);
             bool atEnd() const;
         };
 
+        enum class OfflineBudget {
+            Unlimited,
+            PerFrame,
+            IdleOnly
+        };
+
         struct OfflineDumper {
             std::ofstream dumpStream;
+            std::filesystem::path dumpPath;
 
             bool startDumping(const std::filesystem::path &path);
             bool stepDumping(const ShaderDescription &shaderDesc, const std::vector<uint8_t> &vsDxilBytes, const std::vector<uint8_t> &psDxilBytes);
@@ -43,6 +74,90 @@ namespace RT64 {
             bool isDumping() const;
         };
 
+        struct PipelineStore {
+            struct Statistics {
+                uint32_t warmCount = 0;
+                uint32_t coldCount = 0;
+                double warmMilliseconds = 0.0;
+                double coldMilliseconds = 0.0;
+                double loadMilliseconds = 0.0;
+                bool warmStart = false;
+            };
+
+            std::filesystem::path path;
+            std::unique_ptr<RenderPipelineCache> pipelineCache;
+            std::unordered_set<uint64_t> loadedKeys;
+            std::unordered_set<uint64_t> storedKeys;
+            uint64_t identityHash = 0;
+            uint32_t pendingCount = 0;
+            Statistics statistics;
+            std::mutex storeMutex;
+
+            bool load(RenderDevice *device, RenderShaderFormat shaderFormat, const std::filesystem::path &path);
+            bool save();
+            void record(uint64_t pipelineKey, double milliseconds);
+            bool needsSave();
+            Statistics getStatistics();
+            static uint64_t computeIdentityHash(RenderDevice *device, RenderShaderFormat shaderFormat);
+        };
+
+        struct SubmissionSet {
+            struct Entry {
+                uint32_t lastFrame = 0;
+                bool pending = false;
+            };
+
+            struct Shard {
+                std::mutex mutex;
+                std::unordered_map<uint64_t, Entry> entries;
+            };
+
+            enum class Result {
+                Existing,
+                Inserted,
+                Reprioritized
+            };
+
+            static const uint32_t ShardCount = 16;
+            std::array<Shard, ShardCount> shards;
+
+            Result submit(uint64_t shaderHash, uint32_t frame);
+            bool insertIfMissing(uint64_t shaderHash);
+            bool acquire(uint64_t shaderHash, uint32_t frame);
+            void clear();
+            Shard &shardFor(uint64_t shaderHash);
+        };
+
+        struct SubmissionQueue {
+            struct Item {
+                ShaderDescription shaderDesc;
+                uint64_t shaderHash = 0;
+                uint32_t frame = 0;
+                uint64_t sequence = 0;
+            };
+
+            struct ItemCompare {
+                bool operator()(const Item &a, const Item &b) const;
+            };
+
+            std::priority_queue<Item, std::vector<Item>, ItemCompare> items;
+            uint64_t sequence = 0;
+
+            void push(const ShaderDescription &shaderDesc, uint64_t shaderHash, uint32_t frame);
+            void pop(Item &item);
+            bool empty() const;
+            void clear();
+        };
+
+        struct SubmissionStatistics {
+            uint64_t submitCount = 0;
+            uint64_t insertedCount = 0;
+            uint64_t reprioritizedCount = 0;
+            uint64_t staleCount = 0;
+            uint64_t timedCount = 0;
+            uint64_t timedNanoseconds = 0;
+        };
+
         struct CompilationThread {
             RasterShaderCache *shaderCache;
             std::unique_ptr<std::thread> thread;
@@ -56,11 +171,20 @@ namespace RT64 {
         RenderDevice *device;
         std::unique_ptr<RasterShaderUber> shaderUber;
         std::mutex submissionMutex;
-        std::queue<ShaderDescription> descQueue;
+        SubmissionSet submissionSet;
+        std::atomic<uint32_t> submissionFrame;
+        std::atomic<uint64_t> submitCount;
+        std::atomic<uint64_t> insertedCount;
+        std::atomic<uint64_t> reprioritizedCount;
+        std::atomic<uint64_t> staleCount;
+        std::atomic<bool> submissionTiming;
+        std::atomic<uint64_t> timedCount;
+        std::atomic<uint64_t> timedNanoseconds;
+        SubmissionQueue descQueue;
         std::mutex descQueueMutex;
         int32_t descQueueActiveCount = 0;
+        int32_t priorityActiveCount = 0;
         std::condition_variable descQueueChanged;
-        std::unordered_map<uint64_t, bool> shaderHashes;
         std::unordered_map<uint64_t, std::unique_ptr<RasterShader>> GPUShaders;
         std::mutex GPUShadersMutex;
         std::list<std::unique_ptr<CompilationThread>> compilationThreads;
@@ -69,14 +193,22 @@ namespace RT64 {
         std::unique_ptr<ShaderCompiler> shaderCompiler;
         RenderMultisampling multisampling;
         OfflineList offlineList;
+        OfflineUsage offlineUsage;
+        std::atomic<bool> offlineUsageRecording;
+        OfflineUsage loadedUsage;
+        OfflineBudget offlineBudget = OfflineBudget::Unlimited;
+        double offlineBudgetMilliseconds = 2.0;
+        double offlineBudgetSpent = 0.0;
         OfflineDumper offlineDumper;
         std::mutex offlineDumperMutex;
+        PipelineStore pipelineStore;
         bool usesHDR = false;
         
         RasterShaderCache(uint32_t threadCount);
         ~RasterShaderCache();
-        void setup(RenderDevice *device, RenderShaderFormat shaderFormat, const ShaderLibrary *shaderLibrary, const RenderMultisampling &multisampling);
+        void setup(RenderDevice *device, RenderShaderFormat shaderFormat, const ShaderLibrary *shaderLibrary, const RenderMultisampling &multisampling, const std::filesystem::path &pipelineStorePath = std::filesystem::path());
         void submit(const ShaderDescription &desc);
+        void submitDescription(const ShaderDescription &desc);
         void waitForAll();
         void destroyAll();
         RasterShader *getGPUShader(const ShaderDescription &desc);
@@ -85,7 +217,14 @@ namespace RT64 {
         bool startOfflineDumper(const std::filesystem::path &path);
         bool stopOfflineDumper();
         bool loadOfflineList(std::istream &stream);
+        bool loadOfflineUsage(std::istream &stream);
         void resetOfflineList();
+        void setOfflineBudget(OfflineBudget budget, double milliseconds);
+        bool isOfflineListAvailable() const;
+        void advanceFrame();
+        bool savePipelineStore();
+        PipelineStore::Statistics pipelineStoreStatistics();
+        SubmissionStatistics submissionStatistics() const;
         uint32_t shaderCount();
     };
 };
\ No newline at end of file
@@ -37,6 +37,12 @@ namespace RT64 {
     }
 
     void RenderTarget::releaseTextures() {
+        // Give the textures back to the pool so they can be recycled by any other target of the same size.
+        if (pool != nullptr) {
+            pool->release(getTextureDesc(false), texture, textureView);
+            pool->release(getTextureDesc(true), resolvedTexture, resolvedTextureView);
+        }
+
         textureView.reset();
         resolvedTextureView.reset();
         texture.reset();
@@ -50,6 +56,45 @@ namespace RT64 {
         fbWriteDescSet.reset();
     }
 
+    void RenderTarget::acquireTexture(RenderWorker *worker, const RenderTextureDesc &desc, std::unique_ptr<RenderTexture> &dstTexture, std::unique_ptr<RenderTextureView> &dstTextureView) {
+        assert(worker != nullptr);
+
+        if (pool != nullptr) {
+            pool->acquire(worker->device, desc, format, dstTexture, dstTextureView);
+        }
+        else {
+            dstTexture = worker->device->createTexture(desc);
+            dstTextureView = dstTexture->createTextureView(RenderTextureViewDesc::Texture2D(format));
+        }
+    }
+
+    RenderTextureDesc RenderTarget::getTextureDesc(bool resolved) const {
+        if (type == Framebuffer::Type::Depth) {
+            return RenderTextureDesc::DepthTarget(width, height, format, multisampling);
+        }
+        else {
+            return RenderTextureDesc::ColorTarget(width, height, format, resolved ? RenderMultisampling() : multisampling);
+        }
+    }
+
+    uint64_t RenderTarget::getMemorySize() const {
+        // The dummy texture is left out as it's shared with all the other targets of the same size.
+        uint64_t memorySize = 0;
+        if (texture != nullptr) {
+            memorySize += RenderTargetPool::memorySize(getTextureDesc(false));
+        }
+
+        if (resolvedTexture != nullptr) {
+            memorySize += RenderTargetPool::memorySize(getTextureDesc(true));
+        }
+
+        if ((downsampledTexture != nullptr) && (downsampledTextureMultiplier > 0)) {
+            memorySize += RenderTargetPool::memorySize(getTextureDesc(true)) / (downsampledTextureMultiplier * downsampledTextureMultiplier);
+        }
+
+        return memorySize;
+    }
+
     bool RenderTarget::resize(RenderWorker *worker, uint32_t newWidth, uint32_t newHeight) {
         const bool insufficientSize = (width < newWidth) || (height < newHeight);
         if (insufficientSize) {
@@ -83,14 +128,12 @@ namespace RT64 {
         format = colorBufferFormat(usesHDR);
         
         RenderClearValue clearValue = RenderClearValue::Color(RenderColor(), format);
-        texture = worker->device->createTexture(RenderTextureDesc::ColorTarget(width, height, format, multisampling, &clearValue));
-        textureView = texture->createTextureView(RenderTextureViewDesc::Texture2D(format));
+        acquireTexture(worker, RenderTextureDesc::ColorTarget(width, height, format, multisampling, &clearValue), texture, textureView);
         texture->setName("Render Target Color #" + std::to_string(addressForName));
         textureRevision++;
 
         if (multisampling.sampleCount > 1) {
-            resolvedTexture = worker->device->createTexture(RenderTextureDesc::ColorTarget(width, height, format, RenderMultisampling(), &clearValue));
-            resolvedTextureView = resolvedTexture->createTextureView(RenderTextureViewDesc::Texture2D(format));
+            acquireTexture(worker, RenderTextureDesc::ColorTarget(width, height, format, RenderMultisampling(), &clearValue), resolvedTexture, resolvedTextureView);
             resolvedTexture->setName("Render Target Color Resolved #" + std::to_string(addressForName));
         }
     }
@@ -107,8 +150,7 @@ namespace RT64 {
         format = depthBufferFormat();
         
         RenderClearValue clearValue = RenderClearValue::Depth(RenderDepth(), RenderFormat::D32_FLOAT);
-        texture = worker->device->createTexture(RenderTextureDesc::DepthTarget(width, height, format, multisampling, &clearValue));
-        textureView = texture->createTextureView(RenderTextureViewDesc::Texture2D(format));
+        acquireTexture(worker, RenderTextureDesc::DepthTarget(width, height, format, multisampling, &clearValue), texture, textureView);
         texture->setName("Render Target Depth #" + std::to_string(addressForName));
         textureRevision++;
     }
@@ -117,7 +159,15 @@ namespace RT64 {
         assert(worker != nullptr);
         
         if (dummyTexture == nullptr) {
-            dummyTexture = worker->device->createTexture(RenderTextureDesc::ColorTarget(width, height, colorBufferFormat(usesHDR), multisampling));
+            // The contents of the dummy texture are never read, so the pool can alias it across all the targets of the same size.
+            const RenderTextureDesc dummyDesc = RenderTextureDesc::ColorTarget(width, height, colorBufferFormat(usesHDR), multisampling);
+            if (pool != nullptr) {
+                dummyTexture = pool->acquireShared(worker->device, dummyDesc);
+            }
+            else {
+                dummyTexture = worker->device->createTexture(dummyDesc);
+            }
+
             dummyTexture->setName("Render Target Dummy");
         }
     }
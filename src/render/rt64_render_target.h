@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <stdint.h>
 
 #include "common/rt64_common.h"
@@ -11,6 +12,7 @@
 #include "hle/rt64_framebuffer_changes.h"
 
 #include "rt64_descriptor_sets.h"
+#include "rt64_render_target_pool.h"
 #include "rt64_render_worker.h"
 
 namespace RT64 {
@@ -25,7 +27,7 @@ namespace RT64 {
         std::unique_ptr<RenderTextureView> resolvedTextureView;
         std::unique_ptr<RenderTexture> downsampledTexture;
         uint32_t downsampledTextureMultiplier = 0;
-        std::unique_ptr<RenderTexture> dummyTexture;
+        std::shared_ptr<RenderTexture> dummyTexture;
         std::unique_ptr<RenderFramebuffer> textureFramebuffer;
         RenderMultisampling multisampling;
         RenderFormat format = RenderFormat::UNKNOWN;
@@ -44,10 +46,18 @@ namespace RT64 {
         int32_t invMisalignX = 0;
         bool resolvedTextureDirty = false;
         bool usesHDR = false;
+        RenderTargetPool *pool = nullptr;
+        uint64_t lastUseFrame = 0;
+
+        // Presents that use the target without holding the workload mutex. The target can't be evicted while it's referenced.
+        std::atomic<uint32_t> presentReferences = 0;
 
         RenderTarget(uint32_t addressForName, Framebuffer::Type type, const RenderMultisampling &multisampling, bool usesHDR);
         ~RenderTarget();
         void releaseTextures();
+        void acquireTexture(RenderWorker *worker, const RenderTextureDesc &desc, std::unique_ptr<RenderTexture> &dstTexture, std::unique_ptr<RenderTextureView> &dstTextureView);
+        RenderTextureDesc getTextureDesc(bool resolved) const;
+        uint64_t getMemorySize() const;
         bool resize(RenderWorker *worker, uint32_t newWidth, uint32_t newHeight);
         void setupColor(RenderWorker *worker, uint32_t width, uint32_t height);
         void setupDepth(RenderWorker *worker, uint32_t width, uint32_t height);
@@ -4,6 +4,8 @@
 
 #include "rt64_render_target_manager.h"
 
+#include <algorithm>
+
 #include "xxHash/xxh3.h"
 
 namespace RT64 {
@@ -26,6 +28,9 @@ namespace RT64 {
     
     // RenderTargetManager
 
+    const uint64_t RenderTargetManager::MinEvictionIdleFrames = 8;
+    const uint64_t RenderTargetManager::PoolIdleFrames = 120;
+
     RenderTargetManager::RenderTargetManager() { }
 
     void RenderTargetManager::setMultisampling(const RenderMultisampling &multisampling) {
@@ -46,16 +51,60 @@ namespace RT64 {
         }
 
         std::unique_ptr<RenderTarget> &target = targetMap[keyHash];
-        if (target != nullptr) {
-            return *target;
+        if (target == nullptr) {
+            target = std::make_unique<RenderTarget>(key.address, key.fbType, multisampling, usesHDR);
+            target->pool = &pool;
         }
 
-        target = std::make_unique<RenderTarget>(key.address, key.fbType, multisampling, usesHDR);
+        target->lastUseFrame = currentFrame;
         return *target;
     }
+
+    void RenderTargetManager::evictIdle(RenderFramebufferManager &framebufferManager, uint64_t memoryBudget) {
+        currentFrame++;
+        pool.currentFrame = currentFrame;
+
+        thread_local std::vector<std::pair<uint64_t, uint64_t>> evictionCandidates;
+        evictionCandidates.clear();
+        targetMemorySize = 0;
+        for (const auto &it : targetMap) {
+            const RenderTarget *target = it.second.get();
+            targetMemorySize += target->getMemorySize();
+            if (((currentFrame - target->lastUseFrame) > MinEvictionIdleFrames) && (target->presentReferences == 0)) {
+                evictionCandidates.emplace_back(target->lastUseFrame, it.first);
+            }
+        }
+
+        if ((memoryBudget > 0) && ((targetMemorySize + pool.freeMemorySize) > memoryBudget)) {
+            std::sort(evictionCandidates.begin(), evictionCandidates.end());
+            for (const auto &candidate : evictionCandidates) {
+                if (targetMemorySize <= memoryBudget) {
+                    break;
+                }
+
+                // The released textures are moved to the pool, which is trimmed afterwards to fit in whatever's left of the budget.
+                auto targetIt = targetMap.find(candidate.second);
+                RenderTarget *target = targetIt->second.get();
+                targetMemorySize -= target->getMemorySize();
+                framebufferManager.destroyAllWithRenderTarget(target);
+                target->releaseTextures();
+                targetMap.erase(targetIt);
+                evictedCount++;
+            }
+        }
+
+        uint64_t freeMemoryLimit = UINT64_MAX;
+        if (memoryBudget > 0) {
+            freeMemoryLimit = (memoryBudget > targetMemorySize) ? (memoryBudget - targetMemorySize) : 0;
+        }
+
+        pool.trim(PoolIdleFrames, freeMemoryLimit);
+    }
     
     void RenderTargetManager::destroyAll() {
         targetMap.clear();
+        pool.clear();
+        targetMemorySize = 0;
     }
 
     void RenderTargetManager::setOverride(const RenderTargetKey &key, RenderTarget *target) {
@@ -12,6 +12,8 @@
 #include "rt64_render_target.h"
 
 namespace RT64 {
+    struct RenderFramebufferManager;
+
     struct RenderTargetKey {
         uint32_t address = 0;
         uint32_t width = 0;
@@ -25,15 +27,30 @@ namespace RT64 {
     };
 
     struct RenderTargetManager {
+        // Targets must be idle for at least this many frames before they can be evicted, so none of the queues can still be using them.
+        static const uint64_t MinEvictionIdleFrames;
+
+        // Released textures that aren't recycled after this many frames are destroyed.
+        static const uint64_t PoolIdleFrames;
+
+        RenderTargetPool pool;
         std::unordered_map<uint64_t, std::unique_ptr<RenderTarget>> targetMap;
         std::unordered_map<uint64_t, RenderTarget *> overrideMap;
         RenderMultisampling multisampling;
         bool usesHDR = false;
+        uint64_t currentFrame = 0;
+        uint64_t targetMemorySize = 0;
+        uint64_t evictedCount = 0;
 
         RenderTargetManager();
         void setMultisampling(const RenderMultisampling &multisampling);
         void setUsesHDR(bool usesHDR);
         RenderTarget &get(const RenderTargetKey &key, bool ignoreOverrides = false);
+
+        // Advances the frame used for tracking when each target was last used. If the memory used by the targets and the released
+        // textures goes over the budget, the least recently used idle targets are evicted. A budget of zero is considered unlimited.
+        // The GPU must not be using any of the targets that weren't used during the last frames when this is called.
+        void evictIdle(RenderFramebufferManager &framebufferManager, uint64_t memoryBudget);
         void destroyAll();
         void setOverride(const RenderTargetKey &key, RenderTarget *target);
         void removeOverride(const RenderTargetKey &key);
@@ -0,0 +1,156 @@
+//
+// RT64
+//
+
+#include "rt64_render_target_pool.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "xxHash/xxh3.h"
+
+namespace RT64 {
+    // RenderTargetPool
+
+    bool RenderTargetPool::acquire(RenderDevice *device, const RenderTextureDesc &desc, RenderFormat viewFormat, std::unique_ptr<RenderTexture> &texture, std::unique_ptr<RenderTextureView> &textureView) {
+        assert(device != nullptr);
+
+        auto it = freeEntries.find(hashDesc(desc));
+        if ((it != freeEntries.end()) && !it->second.empty()) {
+            // Recycle the most recently released texture, as it's the least likely to have been paged out by the driver.
+            Entry &entry = it->second.back();
+            texture = std::move(entry.texture);
+            textureView = std::move(entry.textureView);
+            freeMemorySize -= entry.memorySize;
+            it->second.pop_back();
+            recycledCount++;
+            return true;
+        }
+
+        texture = device->createTexture(desc);
+        textureView = texture->createTextureView(RenderTextureViewDesc::Texture2D(viewFormat));
+        createdCount++;
+        return false;
+    }
+
+    void RenderTargetPool::release(const RenderTextureDesc &desc, std::unique_ptr<RenderTexture> &texture, std::unique_ptr<RenderTextureView> &textureView) {
+        if (texture == nullptr) {
+            textureView.reset();
+            return;
+        }
+
+        Entry entry;
+        entry.texture = std::move(texture);
+        entry.textureView = std::move(textureView);
+        entry.releaseFrame = currentFrame;
+        entry.memorySize = memorySize(desc);
+        freeMemorySize += entry.memorySize;
+        freeEntries[hashDesc(desc)].emplace_back(std::move(entry));
+    }
+
+    std::shared_ptr<RenderTexture> RenderTargetPool::acquireShared(RenderDevice *device, const RenderTextureDesc &desc) {
+        assert(device != nullptr);
+
+        std::weak_ptr<RenderTexture> &weakTexture = sharedTextures[hashDesc(desc)];
+        std::shared_ptr<RenderTexture> texture = weakTexture.lock();
+        if (texture == nullptr) {
+            texture = device->createTexture(desc);
+            weakTexture = texture;
+            createdCount++;
+        }
+        else {
+            recycledCount++;
+        }
+
+        return texture;
+    }
+
+    void RenderTargetPool::trim(uint64_t maxIdleFrames, uint64_t maxFreeMemorySize) {
+        for (auto it = freeEntries.begin(); it != freeEntries.end();) {
+            std::vector<Entry> &entries = it->second;
+
+            // Entries are sorted from oldest to newest as they're always released at the current frame.
+            size_t expiredCount = 0;
+            while ((expiredCount < entries.size()) && ((currentFrame - entries[expiredCount].releaseFrame) > maxIdleFrames)) {
+                freeMemorySize -= entries[expiredCount].memorySize;
+                expiredCount++;
+            }
+
+            entries.erase(entries.begin(), entries.begin() + expiredCount);
+            destroyedCount += expiredCount;
+
+            if (entries.empty()) {
+                it = freeEntries.erase(it);
+            }
+            else {
+                it++;
+            }
+        }
+
+        while (freeMemorySize > maxFreeMemorySize) {
+            auto oldestIt = freeEntries.end();
+            for (auto it = freeEntries.begin(); it != freeEntries.end(); it++) {
+                if ((oldestIt == freeEntries.end()) || (it->second.front().releaseFrame < oldestIt->second.front().releaseFrame)) {
+                    oldestIt = it;
+                }
+            }
+
+            if (oldestIt == freeEntries.end()) {
+                break;
+            }
+
+            freeMemorySize -= oldestIt->second.front().memorySize;
+            oldestIt->second.erase(oldestIt->second.begin());
+            destroyedCount++;
+
+            if (oldestIt->second.empty()) {
+                freeEntries.erase(oldestIt);
+            }
+        }
+
+        for (auto it = sharedTextures.begin(); it != sharedTextures.end();) {
+            if (it->second.expired()) {
+                it = sharedTextures.erase(it);
+            }
+            else {
+                it++;
+            }
+        }
+    }
+
+    void RenderTargetPool::clear() {
+        freeEntries.clear();
+        sharedTextures.clear();
+        freeMemorySize = 0;
+    }
+
+    uint64_t RenderTargetPool::hashDesc(const RenderTextureDesc &desc) {
+        // The optimized clear value is left out as all render targets of the same format use the same one.
+        struct {
+            RenderTextureDimension dimension;
+            uint32_t width;
+            uint32_t height;
+            uint32_t depth;
+            uint32_t mipLevels;
+            RenderSampleCounts sampleCount;
+            RenderFormat format;
+            RenderTextureFlags flags;
+        } hashable;
+
+        memset(&hashable, 0, sizeof(hashable));
+        hashable.dimension = desc.dimension;
+        hashable.width = desc.width;
+        hashable.height = desc.height;
+        hashable.depth = desc.depth;
+        hashable.mipLevels = desc.mipLevels;
+        hashable.sampleCount = desc.multisampling.sampleCount;
+        hashable.format = desc.format;
+        hashable.flags = desc.flags;
+        return XXH3_64bits(&hashable, sizeof(hashable));
+    }
+
+    uint64_t RenderTargetPool::memorySize(const RenderTextureDesc &desc) {
+        const uint64_t sampleCount = std::max<uint64_t>(desc.multisampling.sampleCount, 1);
+        return uint64_t(desc.width) * uint64_t(desc.height) * std::max<uint64_t>(desc.depth, 1) * RenderFormatSize(desc.format) * sampleCount;
+    }
+};
@@ -0,0 +1,45 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "rhi/rt64_render_interface.h"
+
+namespace RT64 {
+    // Keeps the textures released by render targets so any other target that needs a texture with the same description can
+    // recycle them instead of creating a new one. Textures whose contents are never read, like the dummy color attachments used
+    // when rendering to a depth target, are aliased instead: every target with the same description shares the same texture.
+    struct RenderTargetPool {
+        struct Entry {
+            std::unique_ptr<RenderTexture> texture;
+            std::unique_ptr<RenderTextureView> textureView;
+            uint64_t releaseFrame = 0;
+            uint64_t memorySize = 0;
+        };
+
+        std::unordered_map<uint64_t, std::vector<Entry>> freeEntries;
+        std::unordered_map<uint64_t, std::weak_ptr<RenderTexture>> sharedTextures;
+        uint64_t currentFrame = 0;
+        uint64_t freeMemorySize = 0;
+        uint64_t recycledCount = 0;
+        uint64_t createdCount = 0;
+        uint64_t destroyedCount = 0;
+
+        // Returns true if a released texture was recycled. The view of the texture is created along with it if it's new.
+        bool acquire(RenderDevice *device, const RenderTextureDesc &desc, RenderFormat viewFormat, std::unique_ptr<RenderTexture> &texture, std::unique_ptr<RenderTextureView> &textureView);
+        void release(const RenderTextureDesc &desc, std::unique_ptr<RenderTexture> &texture, std::unique_ptr<RenderTextureView> &textureView);
+        std::shared_ptr<RenderTexture> acquireShared(RenderDevice *device, const RenderTextureDesc &desc);
+
+        // Destroys the released textures that haven't been recycled after the specified amount of frames, as well as the oldest ones
+        // until the memory used by the released textures fits in the limit.
+        void trim(uint64_t maxIdleFrames, uint64_t maxFreeMemorySize);
+        void clear();
+        static uint64_t hashDesc(const RenderTextureDesc &desc);
+        static uint64_t memorySize(const RenderTextureDesc &desc);
+    };
+};
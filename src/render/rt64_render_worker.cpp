@@ -20,12 +20,19 @@ namespace RT64 {
 
     RenderWorker::~RenderWorker() { }
 
+    void RenderWorker::setProfiler(GPUProfiler *profiler) {
+        profilerRecorder.setup(profiler, device);
+    }
+
     void RenderWorker::execute() {
         commandQueue->executeCommandLists(commandList.get(), commandFence.get());
     }
 
     void RenderWorker::wait() {
         commandQueue->waitForCommandFence(commandFence.get());
+
+        // The timestamps written by the command list are available once the fence is signaled.
+        profilerRecorder.resolve();
     }
 
     // RenderWorkerExecution
@@ -6,6 +6,8 @@
 
 #include "rhi/rt64_render_interface.h"
 
+#include "rt64_gpu_profiler.h"
+
 namespace RT64 {
     struct RenderWorker {
         RenderDevice *device = nullptr;
@@ -13,9 +15,11 @@ namespace RT64 {
         std::unique_ptr<RenderCommandQueue> commandQueue;
         std::unique_ptr<RenderCommandList> commandList;
         std::unique_ptr<RenderCommandFence> commandFence;
+        GPUProfiler::Recorder profilerRecorder;
 
         RenderWorker(RenderDevice *device, const std::string &name, RenderCommandListType commandListType);
         ~RenderWorker();
+        void setProfiler(GPUProfiler *profiler);
         void execute();
         void wait();
     };
@@ -55,6 +55,7 @@ namespace RT64 {
 
     void RSPProcessor::recordCommandList(RenderWorker *worker, const ShaderLibrary *shaderLibrary, const OutputBuffers *outputBuffers) {
         const uint32_t ThreadGroupSize = 64;
+        GPUProfiler::Scope profilerScope(worker, GPUProfiler::Section::RSPProcessor);
         
         if (processCB.vertexCount > 0) {
             RenderBufferBarrier beforeBarriers[] = {
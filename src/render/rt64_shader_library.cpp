@@ -37,6 +37,7 @@
 #include "shaders/RtCopyDepthToColorPSMS.hlsl.spirv.h"
 #include "shaders/TextureCopyPS.hlsl.spirv.h"
 #include "shaders/TextureDecodeCS.hlsl.spirv.h"
+#include "shaders/TextureDecodeBatchCS.hlsl.spirv.h"
 #include "shaders/VideoInterfacePSRegular.hlsl.spirv.h"
 #include "shaders/VideoInterfacePSPixel.hlsl.spirv.h"
 #include "shaders/FullScreenVS.hlsl.spirv.h"
@@ -78,6 +79,7 @@
 #   include "shaders/RtCopyDepthToColorPSMS.hlsl.dxil.h"
 #   include "shaders/TextureCopyPS.hlsl.dxil.h"
 #   include "shaders/TextureDecodeCS.hlsl.dxil.h"
+#   include "shaders/TextureDecodeBatchCS.hlsl.dxil.h"
 #   include "shaders/VideoInterfacePSRegular.hlsl.dxil.h"
 #   include "shaders/VideoInterfacePSPixel.hlsl.dxil.h"
 #   include "shaders/FullScreenVS.hlsl.dxil.h"
@@ -518,6 +520,24 @@ namespace RT64 {
             textureDecode.pipeline = device->createComputePipeline(pipelineDesc);
         }
 
+        // Texture Decode Batch.
+        {
+            TextureDecodeBatchDescriptorSet descriptorSet;
+            TextureDecodeBatchTMEMDescriptorSet descriptorTMEMSet;
+            TextureDecodeBatchRGBA32DescriptorSet descriptorRGBA32Set;
+            layoutBuilder.begin();
+            layoutBuilder.addPushConstant(0, 0, sizeof(uint32_t) * 4, RenderShaderStageFlag::COMPUTE);
+            layoutBuilder.addDescriptorSet(descriptorSet);
+            layoutBuilder.addDescriptorSet(descriptorTMEMSet);
+            layoutBuilder.addDescriptorSet(descriptorRGBA32Set);
+            layoutBuilder.end();
+            textureDecodeBatch.pipelineLayout = layoutBuilder.create(device);
+
+            std::unique_ptr<RenderShader> computeShader = device->createShader(CREATE_SHADER_INPUTS(TextureDecodeBatchCSBlobDXIL, TextureDecodeBatchCSBlobSPIRV, "CSMain", shaderFormat));
+            RenderComputePipelineDesc pipelineDesc(textureDecodeBatch.pipelineLayout.get(), computeShader.get());
+            textureDecodeBatch.pipeline = device->createComputePipeline(pipelineDesc);
+        }
+
         // Video Interface.
         {
             std::unique_ptr<RenderShader> regularShader = device->createShader(CREATE_SHADER_INPUTS(VideoInterfacePSRegularBlobDXIL, VideoInterfacePSRegularBlobSPIRV, "PSMain", shaderFormat));
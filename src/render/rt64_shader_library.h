@@ -53,6 +53,7 @@ namespace RT64 {
         ShaderRecord rtCopyColorToDepthMS;
         ShaderRecord rtCopyDepthToColorMS;
         ShaderRecord textureDecode;
+        ShaderRecord textureDecodeBatch;
         ShaderRecord textureCopy;
         ShaderRecord videoInterfaceLinear;
         ShaderRecord videoInterfaceNearest;
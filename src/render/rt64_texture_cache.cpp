@@ -11,8 +11,10 @@
 // Needs to be included before other headers.
 #include "gbi/rt64_f3d.h"
 
+#include "common/rt64_elapsed_timer.h"
 #include "common/rt64_filesystem_combined.h"
 #include "common/rt64_filesystem_directory.h"
+#include "common/rt64_filesystem_indexed_pack.h"
 #include "common/rt64_filesystem_zip.h"
 #include "common/rt64_load_types.h"
 #include "common/rt64_thread.h"
@@ -21,6 +23,8 @@
 
 #include "rt64_texture_cache.h"
 
+#include <chrono>
+
 #define ONLY_USE_LOW_MIP_CACHE 0
 
 namespace RT64 {
@@ -59,6 +63,7 @@ namespace RT64 {
         resolvedPathMap.clear();
         lowMipCacheTextures.clear();
         resolvedPathMap.clear();
+        indexedPacks.clear();
         replacementDirectories.clear();
 
         usedTexturePoolSize = 0;
@@ -121,6 +126,15 @@ namespace RT64 {
     }
 
     bool ReplacementMap::getResolvedPathFromHash(uint64_t tmemHash, ReplacementResolvedPath &resolvedPath) const {
+        for (const FileSystemIndexedPack *indexedPack : indexedPacks) {
+            const FileSystemIndexedPack::HashEntry *hashEntry = indexedPack->findHash(tmemHash);
+            if (hashEntry != nullptr) {
+                resolvedPath.relativePath = indexedPack->getPath(hashEntry->fileIndex);
+                resolvedPath.operation = ReplacementOperation(hashEntry->operation);
+                return true;
+            }
+        }
+
         auto pathIt = resolvedPathMap.find(tmemHash);
         if (pathIt != resolvedPathMap.end()) {
             resolvedPath = pathIt->second;
@@ -189,11 +203,81 @@ namespace RT64 {
         }
     }
 
+    // TextureUploadRing
+
+    // Offsets of buffer to texture copies must be aligned to this value on D3D12.
+    static const uint64_t TextureUploadRingAlignment = 512;
+
+    void TextureUploadRing::setup(RenderDevice *device, uint64_t size) {
+        assert(device != nullptr);
+        assert(size > 0);
+
+        this->size = size;
+        buffer = device->createBuffer(RenderBufferDesc::UploadBuffer(size));
+        buffer->setName("Texture Cache TMEM Upload Ring");
+        mappedData = reinterpret_cast<uint8_t *>(buffer->map());
+        head = 0;
+        tail = 0;
+    }
+
+    void TextureUploadRing::release() {
+        if (buffer != nullptr) {
+            buffer->unmap();
+            buffer.reset();
+        }
+
+        mappedData = nullptr;
+    }
+
+    bool TextureUploadRing::allocate(uint64_t byteCount, uint64_t &offset, uint64_t &end) {
+        const uint64_t alignedCount = ((byteCount + TextureUploadRingAlignment - 1) / TextureUploadRingAlignment) * TextureUploadRingAlignment;
+        assert(alignedCount <= size);
+
+        // Skip the remainder of the buffer if the allocation doesn't fit before wrapping around.
+        uint64_t start = head;
+        const uint64_t startOffset = start % size;
+        if ((startOffset + alignedCount) > size) {
+            start += size - startOffset;
+        }
+
+        const uint64_t newHead = start + alignedCount;
+        if ((newHead - tail) > size) {
+            return false;
+        }
+
+        head = newHead;
+        highWaterMark = std::max(highWaterMark, head - tail);
+        offset = start % size;
+        end = newHead;
+        return true;
+    }
+
+    void TextureUploadRing::reclaim(uint64_t end) {
+        assert(end <= head);
+        tail = std::max(tail, end);
+    }
+
+    const uint8_t *TextureUploadRing::data(uint64_t offset) const {
+        assert(offset < size);
+        return mappedData + offset;
+    }
+
     // TextureMap
 
+    // The max age allowed is the difference between the last time the texture was used and the time it was uploaded.
+    // Ensure the textures live long enough for the frame queue to use them.
+    static const uint64_t TextureMinimumMaxAge = WORKLOAD_QUEUE_SIZE * 2;
+    static const uint64_t TextureMaximumMaxAge = WORKLOAD_QUEUE_SIZE * 32;
+
+    // Textures are bucketed by the frame they expire on. Since the age is bounded, the buckets can be reused as a ring.
+    static const uint32_t TextureExpirationBucketCount = TextureMaximumMaxAge + 1;
+
     TextureMap::TextureMap() {
         globalVersion = 0;
+        expirationFrameProcessed = 0;
+        expirationBuckets.resize(TextureExpirationBucketCount, InvalidIndex);
         replacementMapEnabled = true;
+        statisticsEnabled = false;
     }
 
     TextureMap::~TextureMap() {
@@ -219,7 +303,7 @@ namespace RT64 {
     }
 
     void TextureMap::add(uint64_t hash, uint64_t creationFrame, Texture *texture) {
-        assert(hashMap.find(hash) == hashMap.end());
+        assert(!hashMap.contains(hash));
 
         // Check for free spaces on the LIFO queue first.
         uint32_t textureIndex;
@@ -236,10 +320,13 @@ namespace RT64 {
             hashes.push_back(0);
             versions.push_back(0);
             creationFrames.push_back(0);
-            listIterators.push_back(accessList.end());
+            accessFrames.push_back(0);
+            expirationFrames.push_back(0);
+            expirationPrevious.push_back(InvalidIndex);
+            expirationNext.push_back(InvalidIndex);
         }
 
-        hashMap[hash] = textureIndex;
+        hashMap.insert(hash, textureIndex);
         textures[textureIndex] = texture;
         textureReplacements[textureIndex] = nullptr;
         textureReplacementReferenceCounted[textureIndex] = false;
@@ -249,32 +336,32 @@ namespace RT64 {
         creationFrames[textureIndex] = creationFrame;
         globalVersion++;
 
-        accessList.push_front({ textureIndex, creationFrame });
-        listIterators[textureIndex] = accessList.begin();
+        scheduleExpiration(textureIndex, creationFrame);
     }
 
     void TextureMap::replace(uint64_t hash, Texture *texture, bool referenceCounted) {
-        const auto it = hashMap.find(hash);
-        if (it == hashMap.end()) {
+        const uint32_t *indexPtr = hashMap.find(hash);
+        if (indexPtr == nullptr) {
             return;
         }
 
         // Do nothing if it's the same texture. If the operations were done correctly, it's not possible for either the texture or the
         // replacement to be any different, so the operation can be considered a no-op.
-        if (texture == textureReplacements[it->second]) {
+        const uint32_t textureIndex = *indexPtr;
+        if (texture == textureReplacements[textureIndex]) {
             return;
         }
 
         // If it's a different texture and a texture was already replaced, decrement its reference.
-        if ((textureReplacements[it->second] != nullptr) && textureReplacementReferenceCounted[it->second]) {
-            replacementMap.decrementReference(textureReplacements[it->second]);
+        if ((textureReplacements[textureIndex] != nullptr) && textureReplacementReferenceCounted[textureIndex]) {
+            replacementMap.decrementReference(textureReplacements[textureIndex]);
         }
 
-        Texture *replacedTexture = textures[it->second];
-        textureReplacements[it->second] = texture;
-        textureReplacementReferenceCounted[it->second] = referenceCounted;
-        textureScales[it->second] = { float(texture->width) / float(replacedTexture->width), float(texture->height) / float(replacedTexture->height) };
-        versions[it->second]++;
+        Texture *replacedTexture = textures[textureIndex];
+        textureReplacements[textureIndex] = texture;
+        textureReplacementReferenceCounted[textureIndex] = referenceCounted;
+        textureScales[textureIndex] = { float(texture->width) / float(replacedTexture->width), float(texture->height) / float(replacedTexture->height) };
+        versions[textureIndex]++;
         globalVersion++;
 
         if (referenceCounted) {
@@ -285,14 +372,14 @@ namespace RT64 {
 
     bool TextureMap::use(uint64_t hash, uint64_t submissionFrame, uint32_t &textureIndex, interop::float2 &textureScale, bool &textureReplaced, bool &hasMipmaps) {
         // Find the matching texture index in the hash map.
-        const auto it = hashMap.find(hash);
-        if (it == hashMap.end()) {
+        const uint32_t *indexPtr = hashMap.find(hash);
+        if (indexPtr == nullptr) {
             textureIndex = 0;
             textureScale = IdentityScale;
             return false;
         }
 
-        textureIndex = it->second;
+        textureIndex = *indexPtr;
         textureReplaced = replacementMapEnabled && (textureReplacements[textureIndex] != nullptr);
 
         if (textureReplaced) {
@@ -304,63 +391,46 @@ namespace RT64 {
             hasMipmaps = false;
         }
 
-        // Remove the existing entry from the list if it exists.
-        AccessList::iterator listIt = listIterators[textureIndex];
-        if (listIt != accessList.end()) {
-            accessList.erase(listIt);
+        // Move the texture to the bucket of its new expiration frame. Textures are usually used many times during the same frame,
+        // so this only needs to be done on the first use.
+        if (accessFrames[textureIndex] != submissionFrame) {
+            unscheduleExpiration(textureIndex);
+            scheduleExpiration(textureIndex, submissionFrame);
         }
 
-        // Push a new access entry to the front of the list and store the new iterator.
-        accessList.push_front({ textureIndex, submissionFrame });
-        listIterators[textureIndex] = accessList.begin();
         return true;
     }
 
     bool TextureMap::evict(uint64_t submissionFrame, std::vector<uint64_t> &evictedHashes) {
         evictedHashes.clear();
 
-        auto it = accessList.rbegin();
-        while (it != accessList.rend()) {
-            assert(submissionFrame >= it->second);
-            
-            // The max age allowed is the difference between the last time the texture was used and the time it was uploaded.
-            // Ensure the textures live long enough for the frame queue to use them.
-            const uint64_t MinimumMaxAge = WORKLOAD_QUEUE_SIZE * 2;
-            const uint64_t MaximumMaxAge = WORKLOAD_QUEUE_SIZE * 32;
-            const uint64_t age = submissionFrame - it->second;
-            const uint64_t maxAge = std::clamp(it->second - creationFrames[it->first], MinimumMaxAge, MaximumMaxAge);
-
-            // Evict all entries that are present in the access list and are older than the frame by the specified margin.
-            if (age >= maxAge) {
-                const uint32_t textureIndex = it->first;
-                const uint64_t textureHash = hashes[textureIndex];
-                evictedTextures.emplace_back(textures[textureIndex]);
-                textures[textureIndex] = nullptr;
-                textureScales[textureIndex] = { 1.0f, 1.0f };
-                hashes[textureIndex] = 0;
-                creationFrames[textureIndex] = 0;
-                freeSpaces.push_back(textureIndex);
-                listIterators[textureIndex] = accessList.end();
-                hashMap.erase(textureHash);
-                evictedHashes.push_back(textureHash);
-                it = decltype(it)(accessList.erase(std::next(it).base()));
-
-                // If a texture replacement was used for this texture, decrease the reference in the map.
-                if (textureReplacementReferenceCounted[textureIndex] && (textureReplacements[textureIndex] != nullptr)) {
-                    replacementMap.decrementReference(textureReplacements[textureIndex]);
-                    textureReplacements[textureIndex] = nullptr;
-                    textureReplacementReferenceCounted[textureIndex] = false;
+        if (submissionFrame <= expirationFrameProcessed) {
+            return false;
+        }
+
+        // Only visit the buckets for the frames that have passed since the last eviction. If more frames than buckets have passed,
+        // each bucket only needs to be visited once.
+        uint64_t firstFrame = expirationFrameProcessed + 1;
+        if ((submissionFrame - firstFrame) >= TextureExpirationBucketCount) {
+            firstFrame = submissionFrame - TextureExpirationBucketCount + 1;
+        }
+
+        for (uint64_t frame = firstFrame; frame <= submissionFrame; frame++) {
+            uint32_t textureIndex = expirationBuckets[frame % TextureExpirationBucketCount];
+            while (textureIndex != InvalidIndex) {
+                const uint32_t nextIndex = expirationNext[textureIndex];
+
+                // The bucket can also hold textures that expire on a later cycle of the ring.
+                if (expirationFrames[textureIndex] <= submissionFrame) {
+                    unscheduleExpiration(textureIndex);
+                    evictIndex(textureIndex, evictedHashes);
                 }
-            }
-            // Stop iterating if we reach an entry that has been used in the present.
-            else if (age == 0) {
-                break;
-            }
-            else {
-                it++;
+
+                textureIndex = nextIndex;
             }
         }
 
+        expirationFrameProcessed = submissionFrame;
         return !evictedHashes.empty();
     }
 
@@ -373,6 +443,66 @@ namespace RT64 {
         return textures.size();
     }
 
+    void TextureMap::scheduleExpiration(uint32_t textureIndex, uint64_t accessFrame) {
+        const uint64_t creationFrame = creationFrames[textureIndex];
+        const uint64_t usedAge = (accessFrame > creationFrame) ? (accessFrame - creationFrame) : 0;
+        const uint64_t maxAge = std::clamp(usedAge, TextureMinimumMaxAge, TextureMaximumMaxAge);
+
+        // Never schedule a texture on a bucket that was already processed.
+        const uint64_t expirationFrame = std::max(accessFrame + maxAge, expirationFrameProcessed + 1);
+        uint32_t &bucketHead = expirationBuckets[expirationFrame % TextureExpirationBucketCount];
+        accessFrames[textureIndex] = accessFrame;
+        expirationFrames[textureIndex] = expirationFrame;
+        expirationPrevious[textureIndex] = InvalidIndex;
+        expirationNext[textureIndex] = bucketHead;
+        if (bucketHead != InvalidIndex) {
+            expirationPrevious[bucketHead] = textureIndex;
+        }
+
+        bucketHead = textureIndex;
+    }
+
+    void TextureMap::unscheduleExpiration(uint32_t textureIndex) {
+        const uint32_t previousIndex = expirationPrevious[textureIndex];
+        const uint32_t nextIndex = expirationNext[textureIndex];
+        if (previousIndex != InvalidIndex) {
+            expirationNext[previousIndex] = nextIndex;
+        }
+        else {
+            uint32_t &bucketHead = expirationBuckets[expirationFrames[textureIndex] % TextureExpirationBucketCount];
+            assert(bucketHead == textureIndex);
+            bucketHead = nextIndex;
+        }
+
+        if (nextIndex != InvalidIndex) {
+            expirationPrevious[nextIndex] = previousIndex;
+        }
+
+        expirationPrevious[textureIndex] = InvalidIndex;
+        expirationNext[textureIndex] = InvalidIndex;
+    }
+
+    void TextureMap::evictIndex(uint32_t textureIndex, std::vector<uint64_t> &evictedHashes) {
+        const uint64_t textureHash = hashes[textureIndex];
+        evictedTextures.emplace_back(textures[textureIndex]);
+        textures[textureIndex] = nullptr;
+        textureScales[textureIndex] = { 1.0f, 1.0f };
+        hashes[textureIndex] = 0;
+        creationFrames[textureIndex] = 0;
+        accessFrames[textureIndex] = 0;
+        expirationFrames[textureIndex] = 0;
+        freeSpaces.push_back(textureIndex);
+        hashMap.erase(textureHash);
+        evictedHashes.push_back(textureHash);
+
+        // If a texture replacement was used for this texture, decrease the reference in the map.
+        if (textureReplacementReferenceCounted[textureIndex] && (textureReplacements[textureIndex] != nullptr)) {
+            replacementMap.decrementReference(textureReplacements[textureIndex]);
+            textureReplacements[textureIndex] = nullptr;
+            textureReplacementReferenceCounted[textureIndex] = false;
+        }
+    }
+
     // TextureCache::StreamThread
 
     TextureCache::StreamThread::StreamThread(TextureCache *textureCache) {
@@ -387,7 +517,7 @@ namespace RT64 {
 
     TextureCache::StreamThread::~StreamThread() {
         threadRunning = false;
-        textureCache->streamDescStackChanged.notify_all();
+        textureCache->streamQueueChanged.notify_all();
         thread->join();
         thread.reset(nullptr);
     }
@@ -402,27 +532,23 @@ namespace RT64 {
 
         std::vector<uint8_t> replacementBytes;
         while (threadRunning) {
-            StreamDescription streamDesc;
+            TextureStreamQueue::Request streamRequest;
 
-            // Check the top of the queue or wait if it's empty.
+            // Take the request with the highest priority from the queue or wait if it's empty.
             {
-                std::unique_lock queueLock(textureCache->streamDescStackMutex);
-                textureCache->streamDescStackActiveCount--;
-                textureCache->streamDescStackChanged.wait(queueLock, [this]() {
-                    return !threadRunning || !textureCache->streamDescStack.empty();
+                std::unique_lock queueLock(textureCache->streamQueueMutex);
+                textureCache->streamQueueActiveCount--;
+                textureCache->streamQueueChanged.wait(queueLock, [this]() {
+                    return !threadRunning || !textureCache->streamQueue.empty();
                 });
 
-                textureCache->streamDescStackActiveCount++;
-
-                if (!textureCache->streamDescStack.empty()) {
-                    streamDesc = textureCache->streamDescStack.top();
-                    textureCache->streamDescStack.pop();
-                }
+                textureCache->streamQueueActiveCount++;
+                textureCache->streamQueue.pop(streamRequest);
             }
             
-            if (!streamDesc.relativePath.empty()) {
+            if (!streamRequest.relativePath.empty()) {
                 ElapsedTimer elapsedTimer;
-                bool fileLoaded = textureCache->textureMap.replacementMap.fileSystem->load(streamDesc.relativePath, replacementBytes);
+                bool fileLoaded = textureCache->textureMap.replacementMap.fileSystem->load(streamRequest.relativePath, replacementBytes);
                 textureCache->addStreamLoadTime(elapsedTimer.elapsedMicroseconds());
 
                 if (fileLoaded) {
@@ -435,7 +561,7 @@ namespace RT64 {
                         worker->execute();
                         worker->wait();
                         textureCache->uploadQueueMutex.lock();
-                        textureCache->streamResultQueue.emplace_back(texture, streamDesc.relativePath, streamDesc.fromPreload);
+                        textureCache->streamResultQueue.emplace_back(texture, streamRequest.relativePath, streamRequest.fromPreload);
                         textureCache->uploadQueueMutex.unlock();
                         textureCache->uploadQueueChanged.notify_all();
                     }
@@ -455,6 +581,7 @@ namespace RT64 {
         this->developerMode = developerMode;
 
         lockCounter = 0;
+        decodeBatched = true;
 
         // Copy the command list and fence used by the methods called from the main thread.
         loaderCommandList = copyWorker->device->createCommandList(RenderCommandListType::COPY);
@@ -470,11 +597,15 @@ namespace RT64 {
         poolDesc.allowOnlyBuffers = true;
         uploadResourcePool = directWorker->device->createPool(poolDesc);
 
+        // Create the ring used for uploading TMEM contents.
+        const uint64_t TMEMUploadRingSize = 4 * 1024 * 1024;
+        tmemUploadRing.setup(copyWorker->device, TMEMUploadRingSize);
+
         // Create upload thread.
         uploadThread = std::make_unique<std::thread>(&TextureCache::uploadThreadLoop, this);
 
         // Create streaming threads.
-        streamDescStackActiveCount = threadCount;
+        streamQueueActiveCount = threadCount;
 
         for (uint32_t i = 0; i < threadCount; i++) {
             streamThreads.push_back(std::make_unique<StreamThread>(this));
@@ -493,7 +624,11 @@ namespace RT64 {
         }
         
         descriptorSets.clear();
-        tmemUploadResources.clear();
+        decodeBatchSet.reset();
+        decodeBatchTMEMSet.reset();
+        decodeBatchRGBA32Set.reset();
+        decodeBatchItemsBuffer.reset();
+        tmemUploadRing.release();
         replacementUploadResources.clear();
         uploadResourcePool.reset(nullptr);
     }
@@ -963,16 +1098,22 @@ namespace RT64 {
         std::vector<TextureUpload> newQueue;
         std::vector<ReplacementCheck> replacementQueueCopy;
         std::vector<StreamResult> streamResultQueueCopy;
+        std::vector<uint64_t> streamEvictedHashesCopy;
+        std::vector<std::string> streamCancelledPaths;
         std::vector<TextureMapAddition> textureMapAdditions;
         std::vector<ReplacementMapAddition> replacementMapAdditions;
         std::vector<RenderTextureBarrier> beforeCopyBarriers;
         std::vector<RenderTextureBarrier> beforeDecodeBarriers;
         std::vector<RenderTextureBarrier> afterDecodeBarriers;
         std::vector<uint8_t> replacementBytes;
+        std::vector<interop::TextureDecodeItem> decodeItems;
+        std::vector<Texture *> decodeTextures;
 
         while (uploadThreadRunning) {
             replacementQueueCopy.clear();
             streamResultQueueCopy.clear();
+            streamEvictedHashesCopy.clear();
+            streamCancelledPaths.clear();
             beforeCopyBarriers.clear();
             beforeDecodeBarriers.clear();
             afterDecodeBarriers.clear();
@@ -981,7 +1122,7 @@ namespace RT64 {
             {
                 std::unique_lock queueLock(uploadQueueMutex);
                 uploadQueueChanged.wait(queueLock, [this]() {
-                    return !uploadThreadRunning || !uploadQueue.empty() || !replacementQueue.empty() || !streamResultQueue.empty();
+                    return !uploadThreadRunning || !uploadQueue.empty() || !replacementQueue.empty() || !streamResultQueue.empty() || !streamEvictedHashes.empty();
                 });
 
                 if (!uploadQueue.empty()) {
@@ -997,6 +1138,26 @@ namespace RT64 {
                     streamResultQueueCopy.insert(streamResultQueueCopy.end(), streamResultQueue.begin(), streamResultQueue.end());
                     streamResultQueue.clear();
                 }
+
+                if (!streamEvictedHashes.empty()) {
+                    streamEvictedHashesCopy.insert(streamEvictedHashesCopy.end(), streamEvictedHashes.begin(), streamEvictedHashes.end());
+                    streamEvictedHashes.clear();
+                }
+            }
+
+            // Cancel the streaming requests that only evicted textures were waiting on if their loads haven't started yet.
+            if (!streamEvictedHashesCopy.empty()) {
+                {
+                    std::unique_lock queueLock(streamQueueMutex);
+                    for (uint64_t hash : streamEvictedHashesCopy) {
+                        streamQueue.cancelTexture(hash, streamCancelledPaths);
+                    }
+                }
+
+                for (const std::string &relativePath : streamCancelledPaths) {
+                    textureMap.replacementMap.streamRelativePathSet.erase(relativePath);
+                    streamPendingReplacementChecks.erase(relativePath);
+                }
             }
             
             if (!streamResultQueueCopy.empty()) {
@@ -1028,20 +1189,16 @@ namespace RT64 {
             }
 
             if (!queueCopy.empty() || !replacementQueueCopy.empty() || !afterDecodeBarriers.empty()) {
-                // Create new upload buffers and descriptor heaps to fill out the required size.
+                // Decode all the textures of the batch with a single dispatch if possible. Otherwise, create new descriptor sets
+                // to fill out the required size for decoding each texture individually.
                 const size_t queueSize = queueCopy.size();
-                const uint64_t TMEMSize = 0x1000;
-                {
-                    std::unique_lock queueLock(uploadResourcePoolMutex);
-                    for (size_t i = tmemUploadResources.size(); i < queueSize; i++) {
-                        tmemUploadResources.emplace_back(uploadResourcePool->createBuffer(RenderBufferDesc::UploadBuffer(TMEMSize)));
+                const bool useBatchedDecode = decodeBatched && (queueSize <= size_t(TextureDecodeBatchTMEMDescriptorSet::UpperRange));
+                if (!useBatchedDecode) {
+                    for (size_t i = descriptorSets.size(); i < queueSize; i++) {
+                        descriptorSets.emplace_back(std::make_unique<TextureDecodeDescriptorSet>(directWorker->device));
                     }
                 }
 
-                for (size_t i = descriptorSets.size(); i < queueSize; i++) {
-                    descriptorSets.emplace_back(std::make_unique<TextureDecodeDescriptorSet>(directWorker->device));
-                }
-
                 // Upload all textures in the queue using the copy worker. It's worth noting the usage of a copy worker during copy texture operations is intentional
                 // to avoid issues with drivers that are not very explicit about where they execute the copy texture operations and end up causing subtle synchronization
                 // issues that can't be accounted for. Using dedicated copy queues for these operations has shown to eliminate these issues entirely.
@@ -1056,19 +1213,16 @@ namespace RT64 {
                     textureMapAdditions.emplace_back(TextureMapAddition{ upload.hash, newTexture });
 
                     if (developerMode) {
-                        newTexture->bytesTMEM = upload.bytesTMEM;
+                        const uint8_t *uploadBytes = tmemUploadRing.data(upload.ringOffset);
+                        newTexture->bytesTMEM = std::vector<uint8_t>(uploadBytes, uploadBytes + upload.byteCount);
                     }
 
                     newTexture->format = RenderFormat::R8_UINT;
                     newTexture->width = upload.width;
                     newTexture->height = upload.height;
-                    newTexture->tmem = copyWorker->device->createTexture(RenderTextureDesc::Texture1D(uint32_t(upload.bytesTMEM.size()), 1, newTexture->format));
+                    newTexture->tmem = copyWorker->device->createTexture(RenderTextureDesc::Texture1D(upload.byteCount, 1, newTexture->format));
                     newTexture->tmem->setName("Texture Cache TMEM #" + std::to_string(TMEMGlobalCounter++));
 
-                    void *dstData = tmemUploadResources[i]->map();
-                    memcpy(dstData, upload.bytesTMEM.data(), upload.bytesTMEM.size());
-                    tmemUploadResources[i]->unmap();
-
                     beforeCopyBarriers.emplace_back(newTexture->tmem.get(), RenderTextureLayout::COPY_DEST);
                 }
 
@@ -1076,23 +1230,26 @@ namespace RT64 {
 
                 for (size_t i = 0; i < queueSize; i++) {
                     const TextureUpload &upload = queueCopy[i];
-                    const uint32_t byteCount = uint32_t(upload.bytesTMEM.size());
+                    const uint32_t byteCount = upload.byteCount;
                     Texture *dstTexture = textureMapAdditions[i].texture;
                     copyWorker->commandList->copyTextureRegion(
                         RenderTextureCopyLocation::Subresource(dstTexture->tmem.get()),
-                        RenderTextureCopyLocation::PlacedFootprint(tmemUploadResources[i].get(), RenderFormat::R8_UINT, byteCount, 1, 1, byteCount)
+                        RenderTextureCopyLocation::PlacedFootprint(tmemUploadRing.buffer.get(), RenderFormat::R8_UINT, byteCount, 1, 1, byteCount, upload.ringOffset)
                     );
 
                     beforeDecodeBarriers.emplace_back(dstTexture->tmem.get(), RenderTextureLayout::SHADER_READ);
 
                     if (upload.decodeTMEM) {
                         static uint32_t TextureGlobalCounter = 0;
-                        TextureDecodeDescriptorSet *descSet = descriptorSets[i].get();
                         dstTexture->format = RenderFormat::R8G8B8A8_UNORM;
                         dstTexture->texture = directWorker->device->createTexture(RenderTextureDesc::Texture2D(upload.width, upload.height, 1, dstTexture->format, RenderTextureFlag::STORAGE | RenderTextureFlag::UNORDERED_ACCESS));
                         dstTexture->texture->setName("Texture Cache RGBA32 #" + std::to_string(TextureGlobalCounter++));
-                        descSet->setTexture(descSet->TMEM, dstTexture->tmem.get(), RenderTextureLayout::SHADER_READ);
-                        descSet->setTexture(descSet->RGBA32, dstTexture->texture.get(), RenderTextureLayout::GENERAL);
+                        if (!useBatchedDecode) {
+                            TextureDecodeDescriptorSet *descSet = descriptorSets[i].get();
+                            descSet->setTexture(descSet->TMEM, dstTexture->tmem.get(), RenderTextureLayout::SHADER_READ);
+                            descSet->setTexture(descSet->RGBA32, dstTexture->texture.get(), RenderTextureLayout::GENERAL);
+                        }
+
                         beforeDecodeBarriers.emplace_back(dstTexture->texture.get(), RenderTextureLayout::GENERAL);
 
                         // If the databases that were loaded have different hash versions, we have much to to check for all possible replacements with all possible hashes.
@@ -1100,16 +1257,16 @@ namespace RT64 {
                             // If the database uses an older hash version, we hash TMEM again with the version corresponding to the database.
                             uint64_t databaseHash = upload.hash;
                             if (hashVersion < TMEMHasher::CurrentHashVersion) {
-                                databaseHash = TMEMHasher::hash(upload.bytesTMEM.data(), upload.loadTile, upload.width, upload.height, upload.tlut, hashVersion);
+                                databaseHash = TMEMHasher::hash(tmemUploadRing.data(upload.ringOffset), upload.loadTile, upload.width, upload.height, upload.tlut, hashVersion);
                             }
 
                             // Add this hash so it's checked for a replacement.
-                            replacementQueueCopy.emplace_back(ReplacementCheck{ upload.hash, databaseHash });
+                            replacementQueueCopy.emplace_back(ReplacementCheck{ upload.hash, databaseHash, upload.creationFrame, uint64_t(upload.width) * upload.height });
                         }
                     }
                     else {
                         // Hash version differences from database versions are not possible when TMEM doesn't need to be decoded.
-                        replacementQueueCopy.emplace_back(ReplacementCheck{ upload.hash, upload.hash });
+                        replacementQueueCopy.emplace_back(ReplacementCheck{ upload.hash, upload.hash, upload.creationFrame, uint64_t(upload.width) * upload.height });
                     }
                 }
 
@@ -1139,15 +1296,28 @@ namespace RT64 {
                             // Queue the texture for being loaded from a texture cache streaming thread.
                             if (resolvedPath.operation == ReplacementOperation::Stream) {
 #                           if !ONLY_USE_LOW_MIP_CACHE
-                                // Make sure the replacement map hasn't queued or loaded the relative path already.
-                                if (textureMap.replacementMap.streamRelativePathSet.find(resolvedPath.relativePath) == textureMap.replacementMap.streamRelativePathSet.end()) {
+                                // Make sure the replacement map hasn't queued or loaded the relative path already. If the request is still
+                                // waiting in the queue, it's merged with this one so it ranks higher.
+                                const bool streamRequested = textureMap.replacementMap.streamRelativePathSet.find(resolvedPath.relativePath) != textureMap.replacementMap.streamRelativePathSet.end();
+                                if (!streamRequested) {
                                     textureMap.replacementMap.streamRelativePathSet.insert(resolvedPath.relativePath);
+                                }
+
+                                {
+                                    std::unique_lock queueLock(streamQueueMutex);
+                                    if (!streamRequested || streamQueue.contains(resolvedPath.relativePath)) {
+                                        TextureStreamQueue::Request streamRequest;
+                                        streamRequest.relativePath = resolvedPath.relativePath;
+                                        streamRequest.useFrame = replacementCheck.useFrame;
+                                        streamRequest.texelArea = replacementCheck.texelArea;
+                                        streamQueue.push(streamRequest, replacementCheck.textureHash);
+                                    }
+                                }
 
-                                    // Push to the streaming queue.
-                                    streamDescStackMutex.lock();
-                                    streamDescStack.push(StreamDescription(resolvedPath.relativePath, false));
-                                    streamDescStackMutex.unlock();
-                                    streamDescStackChanged.notify_all();
+                                // Start reading the file in the background while the request waits in the queue.
+                                if (!streamRequested) {
+                                    textureMap.replacementMap.fileSystem->prefetch(resolvedPath.relativePath);
+                                    streamQueueChanged.notify_all();
                                 }
 #                           endif
 
@@ -1186,11 +1356,35 @@ namespace RT64 {
                 directWorker->commandList->begin();
                 directWorker->commandList->barriers(RenderBarrierStage::GRAPHICS_AND_COMPUTE, beforeDecodeBarriers);
 
+                GPUProfiler::Recorder &profilerRecorder = directWorker->profilerRecorder;
+                const uint32_t decodeProfilerScope = profilerRecorder.beginScope(directWorker->commandList.get(), GPUProfiler::Section::TextureDecode);
                 const ShaderRecord &textureDecode = shaderLibrary->textureDecode;
                 bool pipelineSet = false;
+                decodeItems.clear();
+                decodeTextures.clear();
+                const uint32_t ThreadGroupSize = 8;
+                uint32_t decodeGroupCount = 0;
                 for (size_t i = 0; i < queueSize; i++) {
                     const TextureUpload &upload = queueCopy[i];
-                    if (upload.decodeTMEM) {
+                    if (upload.decodeTMEM && useBatchedDecode) {
+                        // Each item is assigned the range of groups that starts where the previous one ends.
+                        interop::TextureDecodeItem decodeItem;
+                        decodeItem.Resolution.x = upload.width;
+                        decodeItem.Resolution.y = upload.height;
+                        decodeItem.fmt = upload.loadTile.fmt;
+                        decodeItem.siz = upload.loadTile.siz;
+                        decodeItem.address = interop::uint(upload.loadTile.tmem) << 3;
+                        decodeItem.stride = interop::uint(upload.loadTile.line) << 3;
+                        decodeItem.tlut = upload.tlut;
+                        decodeItem.palette = upload.loadTile.palette;
+                        decodeItem.groupOffset = decodeGroupCount;
+                        decodeItem.groupsX = (upload.width + ThreadGroupSize - 1) / ThreadGroupSize;
+                        decodeGroupCount += decodeItem.groupsX * ((upload.height + ThreadGroupSize - 1) / ThreadGroupSize);
+                        decodeItems.emplace_back(decodeItem);
+                        decodeTextures.emplace_back(textureMapAdditions[i].texture);
+                        afterDecodeBarriers.emplace_back(RenderTextureBarrier(textureMapAdditions[i].texture->texture.get(), RenderTextureLayout::SHADER_READ));
+                    }
+                    else if (upload.decodeTMEM) {
                         if (!pipelineSet) {
                             directWorker->commandList->setPipeline(textureDecode.pipeline.get());
                             directWorker->commandList->setComputePipelineLayout(textureDecode.pipelineLayout.get());
@@ -1207,7 +1401,6 @@ namespace RT64 {
                         decodeCB.palette = upload.loadTile.palette;
 
                         // Dispatch compute shader for decoding texture.
-                        const uint32_t ThreadGroupSize = 8;
                         const uint32_t dispatchX = (decodeCB.Resolution.x + ThreadGroupSize - 1) / ThreadGroupSize;
                         const uint32_t dispatchY = (decodeCB.Resolution.y + ThreadGroupSize - 1) / ThreadGroupSize;
                         directWorker->commandList->setComputePushConstants(0, &decodeCB);
@@ -1218,24 +1411,99 @@ namespace RT64 {
                     }
                 }
 
+                if (!decodeItems.empty() && (decodeGroupCount > 0)) {
+                    // Grow the descriptor sets and the item buffer if the batch doesn't fit.
+                    const uint32_t itemCount = uint32_t(decodeItems.size());
+                    if (itemCount > decodeBatchCapacity) {
+                        decodeBatchCapacity = std::max(decodeBatchCapacity, 64U);
+                        while (decodeBatchCapacity < itemCount) {
+                            decodeBatchCapacity *= 2;
+                        }
+
+                        decodeBatchCapacity = std::min(decodeBatchCapacity, uint32_t(TextureDecodeBatchTMEMDescriptorSet::UpperRange));
+                        decodeBatchSet = std::make_unique<TextureDecodeBatchDescriptorSet>(directWorker->device);
+                        decodeBatchTMEMSet = std::make_unique<TextureDecodeBatchTMEMDescriptorSet>(directWorker->device, decodeBatchCapacity);
+                        decodeBatchRGBA32Set = std::make_unique<TextureDecodeBatchRGBA32DescriptorSet>(directWorker->device, decodeBatchCapacity);
+                        decodeBatchItemsBuffer = directWorker->device->createBuffer(RenderBufferDesc::UploadBuffer(sizeof(interop::TextureDecodeItem) * decodeBatchCapacity, RenderBufferFlag::STORAGE));
+                        decodeBatchItemsBuffer->setName("Texture Cache Decode Items");
+                        decodeBatchSet->setBuffer(decodeBatchSet->gItems, decodeBatchItemsBuffer.get(), RenderBufferStructuredView(sizeof(interop::TextureDecodeItem)));
+                    }
+
+                    void *itemsData = decodeBatchItemsBuffer->map();
+                    memcpy(itemsData, decodeItems.data(), sizeof(interop::TextureDecodeItem) * itemCount);
+                    decodeBatchItemsBuffer->unmap();
+
+                    // The previous batch has finished executing at this point, so the descriptors can be overwritten.
+                    for (uint32_t i = 0; i < itemCount; i++) {
+                        decodeBatchTMEMSet->setTexture(decodeBatchTMEMSet->gTMEM + i, decodeTextures[i]->tmem.get(), RenderTextureLayout::SHADER_READ);
+                        decodeBatchRGBA32Set->setTexture(decodeBatchRGBA32Set->gRGBA32 + i, decodeTextures[i]->texture.get(), RenderTextureLayout::GENERAL);
+                    }
+
+                    // The groups are laid out in rows so the dispatch doesn't exceed the limit of groups per dimension.
+                    const ShaderRecord &textureDecodeBatch = shaderLibrary->textureDecodeBatch;
+                    const uint32_t DispatchRowGroups = 1024;
+                    interop::TextureDecodeBatchCB batchCB;
+                    batchCB.itemOffset = 0;
+                    batchCB.itemCount = itemCount;
+                    batchCB.groupCount = decodeGroupCount;
+                    batchCB.dispatchGroupsX = std::min(decodeGroupCount, DispatchRowGroups);
+                    const uint32_t dispatchX = batchCB.dispatchGroupsX;
+                    const uint32_t dispatchY = (decodeGroupCount + DispatchRowGroups - 1) / DispatchRowGroups;
+                    directWorker->commandList->setPipeline(textureDecodeBatch.pipeline.get());
+                    directWorker->commandList->setComputePipelineLayout(textureDecodeBatch.pipelineLayout.get());
+                    directWorker->commandList->setComputePushConstants(0, &batchCB);
+                    directWorker->commandList->setComputeDescriptorSet(decodeBatchSet->get(), 0);
+                    directWorker->commandList->setComputeDescriptorSet(decodeBatchTMEMSet->get(), 1);
+                    directWorker->commandList->setComputeDescriptorSet(decodeBatchRGBA32Set->get(), 2);
+                    directWorker->commandList->dispatch(dispatchX, dispatchY, 1);
+                }
+
+                profilerRecorder.endScope(directWorker->commandList.get(), decodeProfilerScope);
+
                 if (!afterDecodeBarriers.empty()) {
                     directWorker->commandList->barriers(RenderBarrierStage::GRAPHICS_AND_COMPUTE, afterDecodeBarriers);
                 }
 
                 // Execute the direct worker but make it wait for the copy worker to finish first.
                 const RenderCommandList *directCommandList = directWorker->commandList.get();
+                ElapsedTimer decodeTimer;
                 directWorker->commandList->end();
                 directWorker->commandQueue->executeCommandLists(&directCommandList, 1, &syncSemaphore, 1, nullptr, 0, directWorker->commandFence.get());
                 directWorker->wait();
 
+                // Track the time it took for the GPU to finish the batch so both decoding modes can be compared.
+                uint64_t decodedCount = 0;
+                for (size_t i = 0; i < queueSize; i++) {
+                    decodedCount += queueCopy[i].decodeTMEM ? 1 : 0;
+                }
+
+                if (decodedCount > 0) {
+                    std::unique_lock lock(decodePerformanceMutex);
+                    const uint32_t modeIndex = useBatchedDecode ? 1 : 0;
+                    decodeTimeTotal[modeIndex] += decodeTimer.elapsedMilliseconds();
+                    decodeBatchCount[modeIndex]++;
+                    decodeTextureCount[modeIndex] += decodedCount;
+                }
+
                 // Delete all the resources used during the upload of replacements.
                 replacementUploadResources.clear();
                 
                 // Add all the textures to the map once they're ready.
                 {
                     std::unique_lock lock(textureMapMutex);
-                    for (const TextureMapAddition &addition : textureMapAdditions) {
-                        textureMap.add(addition.hash, addition.texture->creationFrame, addition.texture);
+                    if (textureMap.statisticsEnabled) {
+                        ElapsedTimer addTimer;
+                        for (const TextureMapAddition &addition : textureMapAdditions) {
+                            textureMap.add(addition.hash, addition.texture->creationFrame, addition.texture);
+                        }
+
+                        textureMap.statistics.addNanoseconds += uint64_t(addTimer.elapsedNanoseconds());
+                        textureMap.statistics.addCount += textureMapAdditions.size();
+                    }
+                    else {
+                        for (const TextureMapAddition &addition : textureMapAdditions) {
+                            textureMap.add(addition.hash, addition.texture->creationFrame, addition.texture);
+                        }
                     }
 
                     for (const ReplacementMapAddition &addition : replacementMapAdditions) {
@@ -1246,10 +1514,15 @@ namespace RT64 {
                 }
 
                 // Make the new queue the remaining subsection of the upload queue that wasn't processed in this batch.
+                // The fence for the batch has been waited on already, so the ring space used by it can be reclaimed.
                 {
                     std::unique_lock queueLock(uploadQueueMutex);
                     newQueue = std::vector<TextureUpload>(uploadQueue.begin() + queueSize, uploadQueue.end());
                     uploadQueue = std::move(newQueue);
+
+                    if (queueSize > 0) {
+                        tmemUploadRing.reclaim(queueCopy[queueSize - 1].ringEnd);
+                    }
                 }
 
                 queueCopy.clear();
@@ -1270,11 +1543,20 @@ namespace RT64 {
         newUpload.height = height;
         newUpload.tlut = tlut;
         newUpload.loadTile = loadTile;
-        newUpload.bytesTMEM = std::vector<uint8_t>(bytes, bytes + bytesCount);
+        newUpload.byteCount = uint32_t(bytesCount);
         newUpload.decodeTMEM = decodeTMEM;
 
         {
+            // Write the contents directly into the upload ring. Wait for the upload thread to reclaim space if it's full.
             std::unique_lock queueLock(uploadQueueMutex);
+            if (!tmemUploadRing.allocate(bytesCount, newUpload.ringOffset, newUpload.ringEnd)) {
+                tmemUploadRing.stallCount++;
+                uploadQueueFinished.wait(queueLock, [&]() {
+                    return tmemUploadRing.allocate(bytesCount, newUpload.ringOffset, newUpload.ringEnd);
+                });
+            }
+
+            memcpy(tmemUploadRing.mappedData + newUpload.ringOffset, bytes, bytesCount);
             uploadQueue.emplace_back(newUpload);
         }
 
@@ -1290,7 +1572,15 @@ namespace RT64 {
 
     bool TextureCache::useTexture(uint64_t hash, uint64_t submissionFrame, uint32_t &textureIndex, interop::float2 &textureScale, bool &textureReplaced, bool &hasMipmaps) {
         std::unique_lock lock(textureMapMutex);
-        return textureMap.use(hash, submissionFrame, textureIndex, textureScale, textureReplaced, hasMipmaps);
+        if (!textureMap.statisticsEnabled) {
+            return textureMap.use(hash, submissionFrame, textureIndex, textureScale, textureReplaced, hasMipmaps);
+        }
+
+        ElapsedTimer useTimer;
+        const bool textureFound = textureMap.use(hash, submissionFrame, textureIndex, textureScale, textureReplaced, hasMipmaps);
+        textureMap.statistics.useNanoseconds += uint64_t(useTimer.elapsedNanoseconds());
+        textureMap.statistics.useCount++;
+        return textureFound;
     }
 
     bool TextureCache::useTexture(uint64_t hash, uint64_t submissionFrame, uint32_t &textureIndex) {
@@ -1400,14 +1690,26 @@ namespace RT64 {
         textureMap.replacementMap.replacementDirectories = replacementDirectories;
 
         std::vector<std::unique_ptr<FileSystem>> fileSystems;
+        std::vector<const FileSystemIndexedPack *> fileSystemIndexedPacks;
         for (const ReplacementDirectory &replacementDirectory : replacementDirectories) {
-            if (std::filesystem::is_regular_file(replacementDirectory.dirOrZipPath)) {
+            if (std::filesystem::is_regular_file(replacementDirectory.dirOrZipPath) && FileSystemIndexedPack::isIndexedPack(replacementDirectory.dirOrZipPath)) {
+                std::unique_ptr<FileSystemIndexedPack> indexedPack = FileSystemIndexedPack::create(replacementDirectory.dirOrZipPath);
+                if (indexedPack == nullptr) {
+                    fprintf(stderr, "Failed to load file system as an indexed pack for replacements.\n");
+                    return false;
+                }
+
+                fileSystemIndexedPacks.emplace_back(indexedPack.get());
+                fileSystems.emplace_back(std::move(indexedPack));
+            }
+            else if (std::filesystem::is_regular_file(replacementDirectory.dirOrZipPath)) {
                 std::unique_ptr<FileSystem> fileSystem = FileSystemZip::create(replacementDirectory.dirOrZipPath, replacementDirectory.zipBasePath);
                 if (fileSystem == nullptr) {
                     fprintf(stderr, "Failed to load file system as a pack for replacements.\n");
                     return false;
                 }
 
+                fileSystemIndexedPacks.emplace_back(nullptr);
                 fileSystems.emplace_back(std::move(fileSystem));
             }
             else if (std::filesystem::is_directory(replacementDirectory.dirOrZipPath)) {
@@ -1419,6 +1721,7 @@ namespace RT64 {
 
                 // Only enable that file system is a directory if it's only one directory.
                 textureMap.replacementMap.fileSystemIsDirectory = (replacementDirectories.size() == 1);
+                fileSystemIndexedPacks.emplace_back(nullptr);
                 fileSystems.emplace_back(std::move(fileSystem));
             }
             else {
@@ -1434,32 +1737,58 @@ namespace RT64 {
 
             uint64_t totalMemory = 0;
             std::vector<uint8_t> databaseBytes;
+            std::vector<uint8_t> databaseBinaryBytes;
             std::vector<uint8_t> mipCacheBytes;
             std::vector<std::unique_ptr<RenderBuffer>> uploadBuffers;
             std::vector<bool> knownHashVersions;
             knownHashVersions.resize(TMEMHasher::CurrentHashVersion + 1, false);
+            auto addHashVersion = [&](uint32_t hashVersion) {
+                if (!knownHashVersions[hashVersion]) {
+                    textureMap.replacementMap.resolvedHashVersions.insert(textureMap.replacementMap.resolvedHashVersions.begin(), hashVersion);
+                    knownHashVersions[hashVersion] = true;
+                }
+            };
+
+            bool resolvedPathsInMap = false;
             for (int32_t i = int32_t(fileSystems.size() - 1); i >= 0; i--) {
-                if (fileSystems[i]->load(ReplacementDatabaseFilename, databaseBytes)) {
-                    try {
-                        ReplacementDatabase db;
-                        db = json::parse(databaseBytes.begin(), databaseBytes.end(), nullptr, true);
+                const FileSystemIndexedPack *indexedPack = fileSystemIndexedPacks[i];
+                if (indexedPack != nullptr) {
+                    if (indexedPack->getHashVersion() <= TMEMHasher::CurrentHashVersion) {
+                        resolveIndexedPack(indexedPack, resolvedPathsInMap, hashesToPreload);
+                        addHashVersion(indexedPack->getHashVersion());
+                    }
+                }
+                else if (fileSystems[i]->load(ReplacementDatabaseFilename, databaseBytes)) {
+                    ReplacementDatabase db;
+                    bool databaseLoaded = false;
+
+                    // Use the compiled database instead if it was generated from the same JSON. The JSON is still read and hashed
+                    // to detect a stale compiled database, but parsing it is skipped. The directory being edited always uses the
+                    // JSON, as the compiled database sorts the textures and they'd be saved in that order.
+                    if (!textureMap.replacementMap.fileSystemIsDirectory && fileSystems[i]->load(ReplacementDatabaseBinaryFilename, databaseBinaryBytes)) {
+                        const uint64_t sourceHash = ReplacementDatabase::hashSource(databaseBytes.data(), databaseBytes.size());
+                        databaseLoaded = db.fromBinary(databaseBinaryBytes.data(), databaseBinaryBytes.size(), sourceHash);
+                    }
 
-                        if (db.config.hashVersion <= TMEMHasher::CurrentHashVersion) {
-                            db.resolvePaths(fileSystems[i].get(), textureMap.replacementMap.resolvedPathMap, false, nullptr, &hashesToPreload);
+                    if (!databaseLoaded) {
+                        try {
+                            db = json::parse(databaseBytes.begin(), databaseBytes.end(), nullptr, true);
+                            databaseLoaded = true;
+                        }
+                        catch (const nlohmann::detail::exception &e) {
+                            fprintf(stderr, "JSON parsing error: %s\n", e.what());
+                        }
+                    }
 
-                            if (!knownHashVersions[db.config.hashVersion]) {
-                                textureMap.replacementMap.resolvedHashVersions.insert(textureMap.replacementMap.resolvedHashVersions.begin(), db.config.hashVersion);
-                                knownHashVersions[db.config.hashVersion] = true;
-                            }
+                    if (databaseLoaded && (db.config.hashVersion <= TMEMHasher::CurrentHashVersion)) {
+                        db.resolvePaths(fileSystems[i].get(), textureMap.replacementMap.resolvedPathMap, false, nullptr, &hashesToPreload);
+                        addHashVersion(db.config.hashVersion);
+                        resolvedPathsInMap = true;
 
-                            if (textureMap.replacementMap.fileSystemIsDirectory) {
-                                textureMap.replacementMap.directoryDatabase = std::move(db);
-                            }
+                        if (textureMap.replacementMap.fileSystemIsDirectory) {
+                            textureMap.replacementMap.directoryDatabase = std::move(db);
                         }
                     }
-                    catch (const nlohmann::detail::exception &e) {
-                        fprintf(stderr, "JSON parsing error: %s\n", e.what());
-                    }
                 }
 
                 if (fileSystems[i]->load(ReplacementLowMipCacheFilename, mipCacheBytes)) {
@@ -1494,18 +1823,22 @@ namespace RT64 {
         if (preloadTexturesWithThreads) {
             // Queue all textures that must be preloaded to the stream queues.
             {
-                std::unique_lock queueLock(streamDescStackMutex);
+                std::unique_lock queueLock(streamQueueMutex);
+                ReplacementResolvedPath resolvedPath;
+                TextureStreamQueue::Request streamRequest;
+                streamRequest.fromPreload = true;
                 for (uint64_t hash : hashesToPreload) {
-                    auto it = textureMap.replacementMap.resolvedPathMap.find(hash);
-                    const std::string &relativePath = it->second.relativePath;
+                    textureMap.replacementMap.getResolvedPathFromHash(hash, resolvedPath);
+                    const std::string &relativePath = resolvedPath.relativePath;
                     if (textureMap.replacementMap.streamRelativePathSet.find(relativePath) == textureMap.replacementMap.streamRelativePathSet.end()) {
-                        streamDescStack.push(StreamDescription(relativePath, true));
+                        streamRequest.relativePath = relativePath;
+                        streamQueue.push(streamRequest, 0);
                         textureMap.replacementMap.streamRelativePathSet.insert(relativePath);
                     }
                 }
             }
 
-            streamDescStackChanged.notify_all();
+            streamQueueChanged.notify_all();
         }
 
         if (preloadTexturesWithThreads) {
@@ -1519,7 +1852,9 @@ namespace RT64 {
             replacementQueue.clear();
             for (size_t i = 0; i < textureMap.hashes.size(); i++) {
                 if (textureMap.hashes[i] != 0) {
-                    replacementQueue.emplace_back(ReplacementCheck{ textureMap.hashes[i], textureMap.hashes[i] });
+                    const Texture *texture = textureMap.textures[i];
+                    const uint64_t texelArea = (texture != nullptr) ? uint64_t(texture->width) * texture->height : 0;
+                    replacementQueue.emplace_back(ReplacementCheck{ textureMap.hashes[i], textureMap.hashes[i], textureMap.accessFrames[i], texelArea });
                 }
             }
         }
@@ -1529,6 +1864,41 @@ namespace RT64 {
         return true;
     }
 
+    void TextureCache::resolveIndexedPack(const FileSystemIndexedPack *indexedPack, bool resolvedPathsInMap, std::unordered_set<uint64_t> &hashesToPreload) {
+        ReplacementMap &replacementMap = textureMap.replacementMap;
+        if (!resolvedPathsInMap) {
+            // All the file systems with higher priority are indexed packs as well, so the index can be searched directly.
+            for (uint32_t i = 0; i < indexedPack->getPreloadCount(); i++) {
+                const uint64_t hash = indexedPack->getPreloadHash(i);
+                bool overridden = false;
+                for (const FileSystemIndexedPack *priorityPack : replacementMap.indexedPacks) {
+                    overridden = overridden || (priorityPack->findHash(hash) != nullptr);
+                }
+
+                if (!overridden) {
+                    hashesToPreload.insert(hash);
+                }
+            }
+
+            replacementMap.indexedPacks.emplace_back(indexedPack);
+        }
+        else {
+            // A file system with higher priority had to be resolved into the map, so the index must be copied into it to respect the order.
+            for (uint32_t i = 0; i < indexedPack->header->hashCount; i++) {
+                const FileSystemIndexedPack::HashEntry &hashEntry = indexedPack->hashEntries[i];
+                if (hashEntry.fileIndex >= indexedPack->header->fileCount) {
+                    continue;
+                }
+
+                const ReplacementOperation operation = ReplacementOperation(hashEntry.operation);
+                auto insertResult = replacementMap.resolvedPathMap.emplace(hashEntry.hash, ReplacementResolvedPath{ indexedPack->getPath(hashEntry.fileIndex), operation });
+                if (insertResult.second && (operation == ReplacementOperation::Preload)) {
+                    hashesToPreload.insert(hashEntry.hash);
+                }
+            }
+        }
+    }
+
     bool TextureCache::saveReplacementDatabase() {
         std::unique_lock lock(textureMapMutex);
         if (!textureMap.replacementMap.fileSystemIsDirectory) {
@@ -1587,8 +1957,32 @@ namespace RT64 {
     }
 
     bool TextureCache::evict(uint64_t submissionFrame, std::vector<uint64_t> &evictedHashes) {
-        std::unique_lock lock(textureMapMutex);
-        return textureMap.evict(submissionFrame, evictedHashes);
+        bool evicted = false;
+        {
+            std::unique_lock lock(textureMapMutex);
+            if (textureMap.statisticsEnabled) {
+                ElapsedTimer evictTimer;
+                evicted = textureMap.evict(submissionFrame, evictedHashes);
+                textureMap.statistics.evictNanoseconds += uint64_t(evictTimer.elapsedNanoseconds());
+                textureMap.statistics.evictedCount += evictedHashes.size();
+                textureMap.statistics.evictCount++;
+            }
+            else {
+                evicted = textureMap.evict(submissionFrame, evictedHashes);
+            }
+        }
+
+        // Let the upload thread cancel any streaming requests that are no longer needed.
+        if (evicted) {
+            {
+                std::unique_lock queueLock(uploadQueueMutex);
+                streamEvictedHashes.insert(streamEvictedHashes.end(), evictedHashes.begin(), evictedHashes.end());
+            }
+
+            uploadQueueChanged.notify_all();
+        }
+
+        return evicted;
     }
 
     void TextureCache::incrementLock() {
@@ -1612,15 +2006,15 @@ namespace RT64 {
 
     void TextureCache::waitForAllStreamThreads(bool clearQueueImmediately) {
         if (clearQueueImmediately) {
-            std::unique_lock<std::mutex> queueLock(streamDescStackMutex);
-            streamDescStack = std::stack<StreamDescription>();
+            std::unique_lock<std::mutex> queueLock(streamQueueMutex);
+            streamQueue.clear();
         }
 
         bool keepWaiting = false;
         do {
-            streamDescStackMutex.lock();
-            keepWaiting = (streamDescStackActiveCount > 0);
-            streamDescStackMutex.unlock();
+            streamQueueMutex.lock();
+            keepWaiting = (streamQueueActiveCount > 0);
+            streamQueueMutex.unlock();
 
             if (keepWaiting) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(1));
@@ -1640,6 +2034,30 @@ namespace RT64 {
         streamLoadCount++;
     }
 
+    void TextureCache::setDecodeBatched(bool batched) {
+        decodeBatched = batched;
+    }
+
+    bool TextureCache::isDecodeBatched() const {
+        return decodeBatched;
+    }
+
+    void TextureCache::getDecodeStats(bool batched, double &averageBatchTime, double &averageTextureTime) {
+        std::unique_lock lock(decodePerformanceMutex);
+        const uint32_t modeIndex = batched ? 1 : 0;
+        averageBatchTime = (decodeBatchCount[modeIndex] > 0) ? (decodeTimeTotal[modeIndex] / decodeBatchCount[modeIndex]) : 0.0;
+        averageTextureTime = (decodeTextureCount[modeIndex] > 0) ? (decodeTimeTotal[modeIndex] / decodeTextureCount[modeIndex]) : 0.0;
+    }
+
+    void TextureCache::resetDecodeStats() {
+        std::unique_lock lock(decodePerformanceMutex);
+        for (uint32_t i = 0; i < 2; i++) {
+            decodeTimeTotal[i] = 0.0;
+            decodeBatchCount[i] = 0;
+            decodeTextureCount[i] = 0;
+        }
+    }
+
     uint64_t TextureCache::getAverageStreamLoadTime() {
         std::unique_lock lock(streamPerformanceMutex);
         if (streamLoadTimeTotal > 0) {
@@ -1661,4 +2079,24 @@ namespace RT64 {
         cachedSize = textureMap.replacementMap.cachedTexturePoolSize;
         maxSize = textureMap.replacementMap.maxTexturePoolSize;
     }
+
+    void TextureCache::getUploadRingStats(uint64_t &highWaterMark, uint64_t &stallCount, uint64_t &ringSize) {
+        std::unique_lock queueLock(uploadQueueMutex);
+        highWaterMark = tmemUploadRing.highWaterMark;
+        stallCount = tmemUploadRing.stallCount;
+        ringSize = tmemUploadRing.size;
+    }
+
+    void TextureCache::setTextureMapStatisticsEnabled(bool enabled) {
+        std::unique_lock lock(textureMapMutex);
+        textureMap.statisticsEnabled = enabled;
+        textureMap.statistics = TextureMap::Statistics();
+    }
+
+    TextureMap::Statistics TextureCache::getTextureMapStatistics() {
+        std::unique_lock lock(textureMapMutex);
+        TextureMap::Statistics statistics = textureMap.statistics;
+        statistics.residentCount = textureMap.hashMap.size();
+        return statistics;
+    }
 };
\ No newline at end of file
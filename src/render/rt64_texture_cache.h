@@ -8,12 +8,12 @@
 #include <condition_variable>
 #include <filesystem>
 #include <mutex>
-#include <stack>
 #include <thread>
 #include <unordered_map>
 
 #include <json/json.hpp>
 
+#include "common/rt64_flat_hash_map.h"
 #include "common/rt64_replacement_database.h"
 #include "hle/rt64_draw_call.h"
 
@@ -21,6 +21,7 @@
 #include "rt64_render_worker.h"
 #include "rt64_shader_library.h"
 #include "rt64_texture.h"
+#include "rt64_texture_stream_queue.h"
 
 namespace interop {
     struct alignas(16) TextureDecodeCB {
@@ -32,9 +33,30 @@ namespace interop {
         uint tlut;
         uint palette;
     };
+
+    struct TextureDecodeBatchCB {
+        uint itemOffset;
+        uint itemCount;
+        uint groupCount;
+        uint dispatchGroupsX;
+    };
+
+    struct TextureDecodeItem {
+        uint2 Resolution;
+        uint fmt;
+        uint siz;
+        uint address;
+        uint stride;
+        uint tlut;
+        uint palette;
+        uint groupOffset;
+        uint groupsX;
+    };
 };
 
 namespace RT64 {
+    struct FileSystemIndexedPack;
+
     struct TextureUpload {
         uint64_t hash;
         uint64_t creationFrame;
@@ -42,18 +64,35 @@ namespace RT64 {
         uint32_t height;
         uint32_t tlut;
         LoadTile loadTile;
-        std::vector<uint8_t> bytesTMEM;
+        uint64_t ringOffset;
+        uint64_t ringEnd;
+        uint32_t byteCount;
         bool decodeTMEM;
     };
 
+    // Persistently mapped upload buffer that TMEM contents are written into directly when they're queued.
+    // Space is reclaimed in submission order once the upload thread's fence for the batch has been signaled.
+    struct TextureUploadRing {
+        std::unique_ptr<RenderBuffer> buffer;
+        uint8_t *mappedData = nullptr;
+        uint64_t size = 0;
+        uint64_t head = 0;
+        uint64_t tail = 0;
+        uint64_t highWaterMark = 0;
+        uint64_t stallCount = 0;
+
+        void setup(RenderDevice *device, uint64_t size);
+        void release();
+        bool allocate(uint64_t byteCount, uint64_t &offset, uint64_t &end);
+        void reclaim(uint64_t end);
+        const uint8_t *data(uint64_t offset) const;
+    };
+
     struct LowMipCacheTexture {
         Texture *texture = nullptr;
         bool transitioned = false;
     };
 
-    typedef std::pair<uint32_t, uint64_t> AccessPair;
-    typedef std::list<AccessPair> AccessList;
-
     struct ReplacementDirectory {
         std::filesystem::path dirOrZipPath;
         std::string zipBasePath; // Only applies to Zip.
@@ -80,6 +119,9 @@ namespace RT64 {
         std::list<Texture *> unusedTextureList;
         std::unordered_set<std::string> streamRelativePathSet;
         std::unordered_map<uint64_t, ReplacementResolvedPath> resolvedPathMap;
+
+        // Indexed packs are searched directly in priority order before the resolved path map. They're owned by the file system.
+        std::vector<const FileSystemIndexedPack *> indexedPacks;
         std::vector<uint32_t> resolvedHashVersions;
         std::unordered_map<std::string, LowMipCacheTexture> lowMipCacheTextures;
         std::unique_ptr<FileSystem> fileSystem;
@@ -107,6 +149,10 @@ namespace RT64 {
     struct ReplacementCheck {
         uint64_t textureHash = 0;
         uint64_t databaseHash = 0;
+
+        // Used to prioritize the replacement if it must be streamed.
+        uint64_t useFrame = 0;
+        uint64_t texelArea = 0;
     };
 
     struct TextureMapAddition {
@@ -121,7 +167,22 @@ namespace RT64 {
     };
 
     struct TextureMap {
-        std::unordered_map<uint64_t, uint32_t> hashMap;
+        static const uint32_t InvalidIndex = UINT32_MAX;
+
+        // Gathered by the texture cache only while statisticsEnabled is set. A use is a single probe of the hash map, so
+        // reading the clock around every one of them would slow down the draw calls that are being measured.
+        struct Statistics {
+            uint64_t useCount = 0;
+            uint64_t useNanoseconds = 0;
+            uint64_t addCount = 0;
+            uint64_t addNanoseconds = 0;
+            uint64_t evictCount = 0;
+            uint64_t evictedCount = 0;
+            uint64_t evictNanoseconds = 0;
+            uint64_t residentCount = 0;
+        };
+
+        FlatHashMap<uint32_t> hashMap;
         std::vector<Texture *> textures;
         std::vector<Texture *> textureReplacements;
         std::vector<bool> textureReplacementReferenceCounted;
@@ -131,11 +192,17 @@ namespace RT64 {
         std::vector<uint32_t> versions;
         std::vector<uint64_t> creationFrames;
         uint32_t globalVersion;
-        AccessList accessList;
-        std::vector<AccessList::iterator> listIterators;
+        std::vector<uint64_t> accessFrames;
+        std::vector<uint64_t> expirationFrames;
+        std::vector<uint32_t> expirationPrevious;
+        std::vector<uint32_t> expirationNext;
+        std::vector<uint32_t> expirationBuckets;
+        uint64_t expirationFrameProcessed;
         std::vector<Texture *> evictedTextures;
         ReplacementMap replacementMap;
         bool replacementMapEnabled;
+        Statistics statistics;
+        bool statisticsEnabled;
 
         TextureMap();
         ~TextureMap();
@@ -148,23 +215,12 @@ namespace RT64 {
         void decrementLock();
         Texture *get(uint32_t index) const;
         size_t getMaxIndex() const;
+        void scheduleExpiration(uint32_t textureIndex, uint64_t accessFrame);
+        void unscheduleExpiration(uint32_t textureIndex);
+        void evictIndex(uint32_t textureIndex, std::vector<uint64_t> &evictedHashes);
     };
 
     struct TextureCache {
-        struct StreamDescription {
-            std::string relativePath;
-            bool fromPreload = false;
-
-            StreamDescription() {
-                // Default constructor.
-            }
-
-            StreamDescription(const std::string &relativePath, bool fromPreload) {
-                this->relativePath = relativePath;
-                this->fromPreload = fromPreload;
-            }
-        };
-
         struct StreamResult {
             Texture *texture = nullptr;
             std::string relativePath;
@@ -197,18 +253,29 @@ namespace RT64 {
         std::vector<TextureUpload> uploadQueue;
         std::vector<ReplacementCheck> replacementQueue;
         std::vector<StreamResult> streamResultQueue;
-        std::vector<std::unique_ptr<RenderBuffer>> tmemUploadResources;
+        std::vector<uint64_t> streamEvictedHashes;
+        TextureUploadRing tmemUploadRing;
         std::vector<std::unique_ptr<RenderBuffer>> replacementUploadResources;
         std::vector<std::unique_ptr<TextureDecodeDescriptorSet>> descriptorSets;
+        std::unique_ptr<TextureDecodeBatchDescriptorSet> decodeBatchSet;
+        std::unique_ptr<TextureDecodeBatchTMEMDescriptorSet> decodeBatchTMEMSet;
+        std::unique_ptr<TextureDecodeBatchRGBA32DescriptorSet> decodeBatchRGBA32Set;
+        std::unique_ptr<RenderBuffer> decodeBatchItemsBuffer;
+        uint32_t decodeBatchCapacity = 0;
+        std::atomic<bool> decodeBatched;
+        std::mutex decodePerformanceMutex;
+        double decodeTimeTotal[2] = {};
+        uint64_t decodeBatchCount[2] = {};
+        uint64_t decodeTextureCount[2] = {};
         std::mutex uploadQueueMutex;
         std::condition_variable uploadQueueChanged;
         std::condition_variable uploadQueueFinished;
         std::unique_ptr<std::thread> uploadThread;
         std::atomic<bool> uploadThreadRunning;
-        std::stack<StreamDescription> streamDescStack;
-        std::mutex streamDescStackMutex;
-        std::condition_variable streamDescStackChanged;
-        int32_t streamDescStackActiveCount = 0;
+        TextureStreamQueue streamQueue;
+        std::mutex streamQueueMutex;
+        std::condition_variable streamQueueChanged;
+        int32_t streamQueueActiveCount = 0;
         std::list<std::unique_ptr<StreamThread>> streamThreads;
         std::unordered_multimap<std::string, ReplacementCheck> streamPendingReplacementChecks;
         std::mutex streamPerformanceMutex;
@@ -237,6 +304,7 @@ namespace RT64 {
         void clearReplacementDirectories();
         bool loadReplacementDirectory(const ReplacementDirectory &replacementDirectory);
         bool loadReplacementDirectories(const std::vector<ReplacementDirectory> &replacementDirectories);
+        void resolveIndexedPack(const FileSystemIndexedPack *indexedPack, bool resolvedPathsInMap, std::unordered_set<uint64_t> &hashesToPreload);
         bool saveReplacementDatabase();
         void removeUnusedEntriesFromDatabase();
         bool evict(uint64_t submissionFrame, std::vector<uint64_t> &evictedHashes);
@@ -246,8 +314,15 @@ namespace RT64 {
         void resetStreamPerformanceCounters();
         void addStreamLoadTime(uint64_t streamLoadTime);
         uint64_t getAverageStreamLoadTime();
+        void setDecodeBatched(bool batched);
+        bool isDecodeBatched() const;
+        void getDecodeStats(bool batched, double &averageBatchTime, double &averageTextureTime);
+        void resetDecodeStats();
         void setReplacementPoolMaxSize(uint64_t maxSize);
         void getReplacementPoolStats(uint64_t &usedSize, uint64_t &cachedSize, uint64_t &maxSize);
+        void getUploadRingStats(uint64_t &highWaterMark, uint64_t &stallCount, uint64_t &ringSize);
+        void setTextureMapStatisticsEnabled(bool enabled);
+        TextureMap::Statistics getTextureMapStatistics();
         Texture *getTexture(uint32_t textureIndex);
         static void setRGBA32(Texture *dstTexture, RenderDevice *device, RenderCommandList *commandList, const uint8_t *bytes, size_t byteCount, uint32_t width, uint32_t height, uint32_t rowPitch, std::unique_ptr<RenderBuffer> &dstUploadResource, RenderPool *uploadResourcePool = nullptr, std::mutex *uploadResourcePoolMutex = nullptr);
         static bool setDDS(Texture *dstTexture, RenderDevice *device, RenderCommandList *commandList, const uint8_t *bytes, size_t byteCount, std::unique_ptr<RenderBuffer> &dstUploadResource, RenderPool *uploadResourcePool = nullptr, std::mutex *uploadResourcePoolMutex = nullptr);
@@ -0,0 +1,144 @@
+//
+// RT64
+//
+
+#include "rt64_texture_stream_queue.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace RT64 {
+    // TextureStreamQueue::Key
+
+    bool TextureStreamQueue::Key::operator<(const Key &other) const {
+        if (fromPreload != other.fromPreload) {
+            return !fromPreload;
+        }
+        else if (useFrame != other.useFrame) {
+            return useFrame > other.useFrame;
+        }
+        else if (requestCount != other.requestCount) {
+            return requestCount > other.requestCount;
+        }
+        else if (texelArea != other.texelArea) {
+            return texelArea < other.texelArea;
+        }
+        else {
+            return sequence < other.sequence;
+        }
+    }
+
+    // TextureStreamQueue
+
+    void TextureStreamQueue::push(const Request &request, uint64_t textureHash) {
+        assert(!request.relativePath.empty());
+
+        auto it = entries.find(request.relativePath);
+        if (it == entries.end()) {
+            Entry &entry = entries[request.relativePath];
+            entry.key.fromPreload = request.fromPreload;
+            entry.key.useFrame = request.useFrame;
+            entry.key.texelArea = request.texelArea;
+            entry.key.sequence = sequenceCounter++;
+
+            if (textureHash != 0) {
+                entry.textureHashes.emplace_back(textureHash);
+                entry.key.requestCount = 1;
+                textureHashPaths.emplace(textureHash, request.relativePath);
+            }
+
+            orderedEntries.emplace(entry.key, request.relativePath);
+            return;
+        }
+
+        // Merge the request with the one that's already queued. A preload becomes urgent as soon as a texture requests it.
+        Entry &entry = it->second;
+        orderedEntries.erase({ entry.key, request.relativePath });
+        entry.key.fromPreload = entry.key.fromPreload && request.fromPreload;
+        entry.key.useFrame = std::max(entry.key.useFrame, request.useFrame);
+        entry.key.texelArea = std::max(entry.key.texelArea, request.texelArea);
+
+        if ((textureHash != 0) && (std::find(entry.textureHashes.begin(), entry.textureHashes.end(), textureHash) == entry.textureHashes.end())) {
+            entry.textureHashes.emplace_back(textureHash);
+            entry.key.requestCount++;
+            textureHashPaths.emplace(textureHash, request.relativePath);
+        }
+
+        orderedEntries.emplace(entry.key, request.relativePath);
+    }
+
+    bool TextureStreamQueue::pop(Request &request) {
+        if (orderedEntries.empty()) {
+            return false;
+        }
+
+        auto orderedIt = orderedEntries.begin();
+        auto it = entries.find(orderedIt->second);
+        assert(it != entries.end());
+
+        const Entry &entry = it->second;
+        request.relativePath = it->first;
+        request.fromPreload = entry.key.fromPreload;
+        request.useFrame = entry.key.useFrame;
+        request.texelArea = entry.key.texelArea;
+
+        // Once the load starts, the textures waiting on it can no longer cancel it.
+        for (uint64_t textureHash : entry.textureHashes) {
+            auto range = textureHashPaths.equal_range(textureHash);
+            for (auto pathIt = range.first; pathIt != range.second; pathIt++) {
+                if (pathIt->second == request.relativePath) {
+                    textureHashPaths.erase(pathIt);
+                    break;
+                }
+            }
+        }
+
+        orderedEntries.erase(orderedIt);
+        entries.erase(it);
+        return true;
+    }
+
+    void TextureStreamQueue::cancelTexture(uint64_t textureHash, std::vector<std::string> &cancelledPaths) {
+        auto range = textureHashPaths.equal_range(textureHash);
+        for (auto pathIt = range.first; pathIt != range.second; pathIt++) {
+            auto it = entries.find(pathIt->second);
+            if (it == entries.end()) {
+                continue;
+            }
+
+            Entry &entry = it->second;
+            orderedEntries.erase({ entry.key, it->first });
+            entry.textureHashes.erase(std::remove(entry.textureHashes.begin(), entry.textureHashes.end(), textureHash), entry.textureHashes.end());
+            entry.key.requestCount = uint32_t(entry.textureHashes.size());
+
+            if (entry.textureHashes.empty() && !entry.key.fromPreload) {
+                cancelledPaths.emplace_back(it->first);
+                entries.erase(it);
+                cancelledCount++;
+            }
+            else {
+                orderedEntries.emplace(entry.key, it->first);
+            }
+        }
+
+        textureHashPaths.erase(range.first, range.second);
+    }
+
+    void TextureStreamQueue::clear() {
+        entries.clear();
+        orderedEntries.clear();
+        textureHashPaths.clear();
+    }
+
+    bool TextureStreamQueue::contains(const std::string &relativePath) const {
+        return (entries.find(relativePath) != entries.end());
+    }
+
+    bool TextureStreamQueue::empty() const {
+        return entries.empty();
+    }
+
+    size_t TextureStreamQueue::size() const {
+        return entries.size();
+    }
+};
@@ -0,0 +1,63 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace RT64 {
+    // Orders the replacements waiting to be loaded by the streaming threads. Requests for textures the game is drawing always go
+    // before the background preloads. Among them, the ones requested on the most recent frame go first, followed by the ones the
+    // most textures are waiting on. The smallest textures go first after that, as they're the fastest to load and finishing them
+    // early lowers the average time textures spend drawn without their replacement.
+    //
+    // Requests for the same path are merged into one. The queue is not thread-safe and must be guarded by the owner.
+    struct TextureStreamQueue {
+        struct Request {
+            std::string relativePath;
+            bool fromPreload = false;
+            uint64_t useFrame = 0;
+            uint64_t texelArea = 0;
+        };
+
+        struct Key {
+            bool fromPreload = false;
+            uint64_t useFrame = 0;
+            uint32_t requestCount = 0;
+            uint64_t texelArea = 0;
+            uint64_t sequence = 0;
+
+            bool operator<(const Key &other) const;
+        };
+
+        struct Entry {
+            Key key;
+            std::vector<uint64_t> textureHashes;
+        };
+
+        std::unordered_map<std::string, Entry> entries;
+        std::set<std::pair<Key, std::string>> orderedEntries;
+        std::unordered_multimap<uint64_t, std::string> textureHashPaths;
+        uint64_t sequenceCounter = 0;
+        uint64_t cancelledCount = 0;
+
+        // A texture hash of zero indicates there's no texture in the cache waiting on the request.
+        void push(const Request &request, uint64_t textureHash);
+
+        // Returns false if the queue is empty.
+        bool pop(Request &request);
+
+        // Stops the texture from waiting on any of the queued requests. Requests left without any textures waiting on them are removed
+        // and their paths are added to the vector. Preloads are never removed.
+        void cancelTexture(uint64_t textureHash, std::vector<std::string> &cancelledPaths);
+        void clear();
+        bool contains(const std::string &relativePath) const;
+        bool empty() const;
+        size_t size() const;
+    };
+};
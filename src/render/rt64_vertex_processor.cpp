@@ -43,6 +43,8 @@ namespace RT64 {
             return;
         }
 
+        GPUProfiler::Scope profilerScope(worker, GPUProfiler::Section::VertexProcessor);
+
         RenderBufferBarrier beforeBarriers[] = {
             RenderBufferBarrier(outputBuffers->worldPosBuffer.buffer.get(), RenderBufferAccess::WRITE),
             RenderBufferBarrier(outputBuffers->worldNormBuffer.buffer.get(), RenderBufferAccess::WRITE),
@@ -56,6 +56,7 @@ namespace RT64 {
     struct RenderBuffer;
     struct RenderDescriptorSet;
     struct RenderPipeline;
+    struct RenderPipelineCache;
     struct RenderPipelineLayout;
     struct RenderSampler;
     struct RenderShader;
@@ -1115,6 +1116,10 @@ namespace RT64 {
         uint32_t inputElementsCount = 0;
         const RenderSpecConstant *specConstants = nullptr;
         uint32_t specConstantsCount = 0;
+
+        // Optional. The key must uniquely identify the pipeline's description across sessions.
+        RenderPipelineCache *pipelineCache = nullptr;
+        uint64_t pipelineCacheKey = 0;
     };
 
     struct RenderRaytracingPipelineLibrarySymbol {
@@ -1662,7 +1667,9 @@ namespace RT64 {
 
     struct RenderDeviceDescription {
         std::string name = "Unknown";
-        uint32_t driverVersion = 0;
+        uint32_t vendorId = 0;
+        uint32_t deviceId = 0;
+        uint64_t driverVersion = 0;
         uint64_t dedicatedVideoMemory = 0;
     };
 
@@ -1684,6 +1691,9 @@ namespace RT64 {
 
         // HDR.
         bool preferHDR = false;
+
+        // Queries.
+        bool timestampQueries = false;
     };
 
     struct RenderInterfaceCapabilities {
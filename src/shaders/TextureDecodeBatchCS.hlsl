@@ -0,0 +1,61 @@
+//
+// RT64
+//
+
+#include "TextureDecoder.hlsli"
+
+#define GROUP_SIZE 8
+
+struct TextureDecodeBatchCB {
+    uint itemOffset;
+    uint itemCount;
+    uint groupCount;
+    uint dispatchGroupsX;
+};
+
+struct TextureDecodeItem {
+    uint2 Resolution;
+    uint fmt;
+    uint siz;
+    uint address;
+    uint stride;
+    uint tlut;
+    uint palette;
+    uint groupOffset;
+    uint groupsX;
+};
+
+[[vk::push_constant]] ConstantBuffer<TextureDecodeBatchCB> gConstants : register(b0, space0);
+StructuredBuffer<TextureDecodeItem> gItems : register(t1, space0);
+Texture1D<uint> gTMEM[] : register(t0, space1);
+RWTexture2D<float4> gRGBA32[] : register(u0, space2);
+
+// Every item of the batch is assigned a contiguous range of groups, stored as a prefix sum of the group counts of the items.
+// The group finds its item with a binary search over the offsets, so the dispatch only has as many groups as the items need.
+[numthreads(GROUP_SIZE, GROUP_SIZE, 1)]
+void CSMain(uint3 groupId : SV_GroupID, uint3 groupThreadId : SV_GroupThreadID) {
+    const uint groupIndex = groupId.y * gConstants.dispatchGroupsX + groupId.x;
+    if (groupIndex >= gConstants.groupCount) {
+        return;
+    }
+
+    uint low = 0;
+    uint high = gConstants.itemCount;
+    while ((high - low) > 1) {
+        const uint middle = (low + high) / 2;
+        if (gItems[gConstants.itemOffset + middle].groupOffset <= groupIndex) {
+            low = middle;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    const uint itemIndex = gConstants.itemOffset + low;
+    const TextureDecodeItem item = gItems[itemIndex];
+    const uint itemGroup = groupIndex - item.groupOffset;
+    const uint2 coord = uint2(itemGroup % item.groupsX, itemGroup / item.groupsX) * GROUP_SIZE + groupThreadId.xy;
+    if ((coord.x < item.Resolution.x) && (coord.y < item.Resolution.y)) {
+        gRGBA32[NonUniformResourceIndex(itemIndex)][coord] = sampleTMEM(coord, item.siz, item.fmt, item.address, item.stride, item.tlut, item.palette, gTMEM[NonUniformResourceIndex(itemIndex)]);
+    }
+}
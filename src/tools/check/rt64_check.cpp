@@ -0,0 +1,602 @@
+//
+// RT64
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <stack>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "hle/rt64_vertex_ingest.h"
+#include "render/rt64_texture_stream_queue.h"
+
+#include "../replay/rt64_replay_core.h"
+
+using namespace RT64;
+
+// Compares the vertex ingest kernels against the per-vertex code they replaced in RSP::setVertexCommon. Every output must match
+// bit for bit, as the renderer relies on the transformed positions being identical to the ones it used to compute.
+json checkVertexKernels(uint32_t iterations, uint64_t &mismatchCount) {
+    std::mt19937 random(iterations);
+    std::uniform_int_distribution<int32_t> shortDistribution(INT16_MIN, INT16_MAX);
+    std::uniform_int_distribution<uint32_t> byteDistribution(0, UINT8_MAX);
+    std::uniform_int_distribution<uint32_t> countDistribution(0, RSP_MAX_VERTICES);
+    std::uniform_real_distribution<float> matrixDistribution(-2.0f, 2.0f);
+    std::uniform_real_distribution<float> wDistribution(1.0f, 2.0f);
+
+    // Keep the W row small enough for W to never get close to zero, as the division would produce values that can't be compared.
+    std::uniform_real_distribution<float> wRowDistribution(-1e-5f, 1e-5f);
+
+    std::vector<RSP::Vertex> vertices(RSP_MAX_VERTICES);
+    std::vector<int16_t> posShorts(RSP_MAX_VERTICES * 3);
+    std::vector<uint8_t> normColBytes(RSP_MAX_VERTICES * 4);
+    std::vector<float> tcFloats(RSP_MAX_VERTICES * 2);
+    std::vector<float> transformedFloats(RSP_MAX_VERTICES * 4);
+    std::vector<float> screenFloats(RSP_MAX_VERTICES * 4);
+    auto sameBits = [](float a, float b) {
+        return memcmp(&a, &b, sizeof(float)) == 0;
+    };
+
+    uint64_t vertexCount = 0;
+    uint64_t positionMismatches = 0;
+    uint64_t texcoordMismatches = 0;
+    uint64_t transformMismatches = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        const uint32_t count = countDistribution(random);
+        for (uint32_t j = 0; j < count; j++) {
+            RSP::Vertex &v = vertices[j];
+            v.x = int16_t(shortDistribution(random));
+            v.y = int16_t(shortDistribution(random));
+            v.z = int16_t(shortDistribution(random));
+            v.flag = uint16_t(shortDistribution(random));
+            v.s = int16_t(shortDistribution(random));
+            v.t = int16_t(shortDistribution(random));
+            v.color.r = uint8_t(byteDistribution(random));
+            v.color.g = uint8_t(byteDistribution(random));
+            v.color.b = uint8_t(byteDistribution(random));
+            v.color.a = uint8_t(byteDistribution(random));
+        }
+
+        float m[16];
+        for (uint32_t j = 0; j < 16; j++) {
+            m[j] = ((j % 4) == 3) ? wRowDistribution(random) : matrixDistribution(random);
+        }
+
+        m[15] = wDistribution(random);
+
+        const hlslpp::float4x4 mvp(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15]);
+        interop::RSPViewport viewport;
+        viewport.scale = hlslpp::float3(matrixDistribution(random), matrixDistribution(random), matrixDistribution(random)) * 160.0f;
+        viewport.translate = hlslpp::float3(matrixDistribution(random), matrixDistribution(random), matrixDistribution(random)) * 120.0f;
+
+        const uint16_t textureSc = uint16_t(shortDistribution(random));
+        const uint16_t textureTc = uint16_t(shortDistribution(random));
+        VertexIngest::convertPositionsColors(vertices.data(), count, posShorts.data(), normColBytes.data());
+        VertexIngest::convertTexcoords(vertices.data(), count, textureSc, textureTc, tcFloats.data());
+        VertexIngest::transformPositions(vertices.data(), count, mvp, viewport, transformedFloats.data(), screenFloats.data());
+
+        const int32_t TextureSc = (int32_t)(textureSc);
+        const int32_t TextureTc = (int32_t)(textureTc);
+        const double Divisor = 65536.0f * 32.0f;
+        for (uint32_t j = 0; j < count; j++) {
+            const RSP::Vertex &v = vertices[j];
+            const int16_t *pos = &posShorts[j * 3];
+            const uint8_t *normCol = &normColBytes[j * 4];
+            if ((pos[0] != v.x) || (pos[1] != v.y) || (pos[2] != v.z) || (normCol[0] != v.color.r) || (normCol[1] != v.color.g) || (normCol[2] != v.color.b) || (normCol[3] != v.color.a)) {
+                positionMismatches++;
+            }
+
+            const float s = (float)((double)((v.s) * TextureSc) / Divisor);
+            const float t = (float)((double)((v.t) * TextureTc) / Divisor);
+            if (!sameBits(tcFloats[j * 2 + 0], s) || !sameBits(tcFloats[j * 2 + 1], t)) {
+                texcoordMismatches++;
+            }
+
+            const hlslpp::float4 tfPos = hlslpp::mul(hlslpp::float4(v.x, v.y, v.z, 1.0f), mvp);
+            const hlslpp::float3 screenPos = (tfPos.xyz / hlslpp::float3(tfPos.w, -tfPos.w, tfPos.w)) * viewport.scale + viewport.translate;
+            const float *tf = &transformedFloats[j * 4];
+            const float *sc = &screenFloats[j * 4];
+            bool transformMatches = true;
+            for (uint32_t k = 0; k < 4; k++) {
+                transformMatches = transformMatches && sameBits(tf[k], tfPos[k]);
+            }
+
+            for (uint32_t k = 0; k < 3; k++) {
+                transformMatches = transformMatches && sameBits(sc[k], screenPos[k]);
+            }
+
+            if (!transformMatches) {
+                transformMismatches++;
+            }
+        }
+
+        vertexCount += count;
+    }
+
+    mismatchCount = positionMismatches + texcoordMismatches + transformMismatches;
+
+    json jroot;
+    jroot["kernel"] = VertexIngest::kernelName();
+    jroot["iterations"] = iterations;
+    jroot["vertices"] = vertexCount;
+    jroot["positionColorMismatches"] = positionMismatches;
+    jroot["texcoordMismatches"] = texcoordMismatches;
+    jroot["transformMismatches"] = transformMismatches;
+    return jroot;
+}
+
+// Runs random pushes, merges, cancellations and pops on the texture stream queue and compares every pop against a plain list that
+// is searched in full for the highest priority. Requests with the same priority must come out in the order they were first pushed.
+json checkStreamQueue(uint32_t iterations, uint64_t &mismatchCount) {
+    struct ReferenceEntry {
+        std::string relativePath;
+        bool fromPreload = false;
+        uint64_t useFrame = 0;
+        uint64_t texelArea = 0;
+        uint64_t sequence = 0;
+        std::vector<uint64_t> textureHashes;
+    };
+
+    // Lower is popped first. The sequence is left out so requests with the same priority can be detected.
+    auto priority = [](const ReferenceEntry &entry) {
+        return std::make_tuple(entry.fromPreload, UINT64_MAX - entry.useFrame, UINT64_MAX - entry.textureHashes.size(), entry.texelArea);
+    };
+
+    std::mt19937 random(iterations);
+    std::uniform_int_distribution<uint32_t> operationDistribution(0, 99);
+    std::uniform_int_distribution<uint32_t> pathDistribution(0, 63);
+    std::uniform_int_distribution<uint64_t> hashDistribution(0, 31);
+    std::uniform_int_distribution<uint64_t> areaDistribution(0, 3);
+    std::uniform_int_distribution<uint64_t> frameDistribution(0, 2);
+    TextureStreamQueue queue;
+    std::vector<ReferenceEntry> reference;
+    std::vector<std::string> cancelledPaths;
+    std::vector<std::string> referenceCancelledPaths;
+    uint64_t sequenceCounter = 0;
+    uint64_t currentFrame = 0;
+    uint64_t pushCount = 0;
+    uint64_t mergeCount = 0;
+    uint64_t cancelCount = 0;
+    uint64_t popCount = 0;
+    uint64_t tiedPopCount = 0;
+    uint64_t orderMismatches = 0;
+    uint64_t requestMismatches = 0;
+    uint64_t cancelMismatches = 0;
+    uint64_t sizeMismatches = 0;
+    auto popAndCompare = [&]() {
+        auto expectedIt = reference.end();
+        uint32_t tiedCount = 0;
+        for (auto it = reference.begin(); it != reference.end(); it++) {
+            if ((expectedIt == reference.end()) || (priority(*it) < priority(*expectedIt)) || ((priority(*it) == priority(*expectedIt)) && (it->sequence < expectedIt->sequence))) {
+                expectedIt = it;
+            }
+        }
+
+        for (const ReferenceEntry &entry : reference) {
+            tiedCount += (priority(entry) == priority(*expectedIt)) ? 1 : 0;
+        }
+
+        TextureStreamQueue::Request request;
+        if (!queue.pop(request)) {
+            orderMismatches++;
+            reference.erase(expectedIt);
+            return;
+        }
+
+        if (request.relativePath != expectedIt->relativePath) {
+            orderMismatches++;
+        }
+        else if ((request.fromPreload != expectedIt->fromPreload) || (request.useFrame != expectedIt->useFrame) || (request.texelArea != expectedIt->texelArea)) {
+            requestMismatches++;
+        }
+
+        tiedPopCount += (tiedCount > 1) ? 1 : 0;
+        popCount++;
+        reference.erase(expectedIt);
+    };
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        const uint32_t operation = operationDistribution(random);
+        if (operation < 65) {
+            TextureStreamQueue::Request request;
+            request.relativePath = "texture" + std::to_string(pathDistribution(random)) + ".dds";
+            request.fromPreload = (operation < 10);
+            request.useFrame = currentFrame + frameDistribution(random);
+            request.texelArea = areaDistribution(random) * 1024;
+
+            // A hash of zero is a request without any textures waiting on it.
+            const uint64_t textureHash = hashDistribution(random);
+            queue.push(request, textureHash);
+            pushCount++;
+
+            auto it = std::find_if(reference.begin(), reference.end(), [&](const ReferenceEntry &entry) { return entry.relativePath == request.relativePath; });
+            if (it == reference.end()) {
+                ReferenceEntry entry;
+                entry.relativePath = request.relativePath;
+                entry.fromPreload = request.fromPreload;
+                entry.useFrame = request.useFrame;
+                entry.texelArea = request.texelArea;
+                entry.sequence = sequenceCounter++;
+                if (textureHash != 0) {
+                    entry.textureHashes.emplace_back(textureHash);
+                }
+
+                reference.emplace_back(entry);
+            }
+            else {
+                it->fromPreload = it->fromPreload && request.fromPreload;
+                it->useFrame = std::max(it->useFrame, request.useFrame);
+                it->texelArea = std::max(it->texelArea, request.texelArea);
+                if ((textureHash != 0) && (std::find(it->textureHashes.begin(), it->textureHashes.end(), textureHash) == it->textureHashes.end())) {
+                    it->textureHashes.emplace_back(textureHash);
+                }
+
+                mergeCount++;
+            }
+        }
+        else if (operation < 75) {
+            const uint64_t textureHash = hashDistribution(random) + 1;
+            cancelledPaths.clear();
+            queue.cancelTexture(textureHash, cancelledPaths);
+            cancelCount++;
+
+            referenceCancelledPaths.clear();
+            for (auto it = reference.begin(); it != reference.end();) {
+                const size_t hashCount = it->textureHashes.size();
+                it->textureHashes.erase(std::remove(it->textureHashes.begin(), it->textureHashes.end(), textureHash), it->textureHashes.end());
+                if ((hashCount > 0) && it->textureHashes.empty() && !it->fromPreload) {
+                    referenceCancelledPaths.emplace_back(it->relativePath);
+                    it = reference.erase(it);
+                }
+                else {
+                    it++;
+                }
+            }
+
+            std::sort(cancelledPaths.begin(), cancelledPaths.end());
+            std::sort(referenceCancelledPaths.begin(), referenceCancelledPaths.end());
+            if (cancelledPaths != referenceCancelledPaths) {
+                cancelMismatches++;
+            }
+        }
+        else if (operation < 95) {
+            if (!reference.empty()) {
+                popAndCompare();
+            }
+        }
+        else {
+            currentFrame++;
+        }
+
+        if (queue.size() != reference.size()) {
+            sizeMismatches++;
+        }
+    }
+
+    while (!reference.empty()) {
+        popAndCompare();
+    }
+
+    if (!queue.empty()) {
+        sizeMismatches++;
+    }
+
+    mismatchCount = orderMismatches + requestMismatches + cancelMismatches + sizeMismatches;
+
+    json jroot;
+    jroot["iterations"] = iterations;
+    jroot["pushes"] = pushCount;
+    jroot["merges"] = mergeCount;
+    jroot["cancels"] = cancelCount;
+    jroot["pops"] = popCount;
+    jroot["tiedPops"] = tiedPopCount;
+    jroot["orderMismatches"] = orderMismatches;
+    jroot["requestMismatches"] = requestMismatches;
+    jroot["cancelMismatches"] = cancelMismatches;
+    jroot["sizeMismatches"] = sizeMismatches;
+    return jroot;
+}
+
+// Replays a synthetic trace of replacement requests through a model of the streaming threads and measures how long the visible textures
+// wait for their replacement, both with the LIFO stack the threads used to pop from and with the texture stream queue. The trace has 400
+// background preloads queued at the start and 300 frames of up to 11 visible requests each, spread across 2000 paths with texel areas
+// from 16x16 to 256x256. Two loaders take 200 microseconds plus one microsecond for every 16 texels to load a replacement. Paths are only
+// loaded once, as later requests for them would be served by the cache. The trace is deterministic, so the means can be compared against
+// the ones measured when the queue was introduced: 2.86 ms with the stack and 2.42 ms with the queue.
+json checkStreamTrace(bool &succeeded) {
+    struct TraceRequest {
+        std::string relativePath;
+        bool fromPreload = false;
+        uint64_t useFrame = 0;
+        uint64_t texelArea = 0;
+        uint64_t textureHash = 0;
+        double microseconds = 0.0;
+    };
+
+    const uint32_t LoaderCount = 2;
+    const uint32_t PreloadCount = 400;
+    const uint32_t FrameCount = 300;
+    const double FrameMicroseconds = 16667.0;
+    const double LoadMicroseconds = 200.0;
+    const double TexelsPerMicrosecond = 16.0;
+    const double ExpectedStackMilliseconds = 2.86;
+    const double ExpectedQueueMilliseconds = 2.42;
+    std::vector<TraceRequest> trace;
+    std::mt19937 random(1);
+    for (uint32_t i = 0; i < PreloadCount; i++) {
+        TraceRequest request;
+        request.relativePath = "preload" + std::to_string(i) + ".dds";
+        request.fromPreload = true;
+        request.texelArea = 256 * 256;
+        trace.emplace_back(request);
+    }
+
+    for (uint32_t f = 1; f <= FrameCount; f++) {
+        const uint32_t requestCount = random() % 12;
+        for (uint32_t k = 0; k < requestCount; k++) {
+            const uint64_t textureWidth = uint64_t(16) << (random() % 5);
+            TraceRequest request;
+            request.relativePath = "texture" + std::to_string(random() % 2000) + ".dds";
+            request.useFrame = f;
+            request.texelArea = textureWidth * textureWidth;
+            request.textureHash = f * 100 + k + 1;
+            request.microseconds = f * FrameMicroseconds + k * 50.0;
+            trace.emplace_back(request);
+        }
+    }
+
+    auto simulate = [&](bool useQueue, uint64_t &visibleCount) {
+        TextureStreamQueue queue;
+        std::stack<std::string> stack;
+        std::unordered_set<std::string> requestedPaths;
+        std::unordered_map<std::string, std::vector<double>> waitingRequests;
+        std::unordered_map<std::string, uint64_t> pathTexelAreas;
+        double loaderFreeMicroseconds[LoaderCount] = {};
+        double totalWaitMicroseconds = 0.0;
+        size_t traceIndex = 0;
+        visibleCount = 0;
+        while (true) {
+            // The loader that becomes free first takes the next request. It sleeps until the next request arrives if there's nothing queued.
+            const uint32_t loaderIndex = uint32_t(std::min_element(loaderFreeMicroseconds, loaderFreeMicroseconds + LoaderCount) - loaderFreeMicroseconds);
+            double nowMicroseconds = loaderFreeMicroseconds[loaderIndex];
+            if (useQueue ? queue.empty() : stack.empty()) {
+                if (traceIndex >= trace.size()) {
+                    break;
+                }
+
+                nowMicroseconds = std::max(nowMicroseconds, trace[traceIndex].microseconds);
+            }
+
+            while ((traceIndex < trace.size()) && (trace[traceIndex].microseconds <= nowMicroseconds)) {
+                const TraceRequest &request = trace[traceIndex++];
+                pathTexelAreas[request.relativePath] = request.texelArea;
+                if (!request.fromPreload) {
+                    waitingRequests[request.relativePath].emplace_back(request.microseconds);
+                }
+
+                // Like the texture cache, a path is only pushed again while it's still queued so the queue can merge the requests.
+                const bool firstRequest = requestedPaths.insert(request.relativePath).second;
+                if (useQueue) {
+                    if (firstRequest || queue.contains(request.relativePath)) {
+                        queue.push({ request.relativePath, request.fromPreload, request.useFrame, request.texelArea }, request.textureHash);
+                    }
+                }
+                else if (firstRequest) {
+                    stack.push(request.relativePath);
+                }
+            }
+
+            std::string relativePath;
+            if (useQueue) {
+                TextureStreamQueue::Request request;
+                if (!queue.pop(request)) {
+                    loaderFreeMicroseconds[loaderIndex] = nowMicroseconds;
+                    continue;
+                }
+
+                relativePath = request.relativePath;
+            }
+            else {
+                if (stack.empty()) {
+                    loaderFreeMicroseconds[loaderIndex] = nowMicroseconds;
+                    continue;
+                }
+
+                relativePath = stack.top();
+                stack.pop();
+            }
+
+            const double loadedMicroseconds = nowMicroseconds + LoadMicroseconds + pathTexelAreas[relativePath] / TexelsPerMicrosecond;
+            loaderFreeMicroseconds[loaderIndex] = loadedMicroseconds;
+
+            std::vector<double> &waitingMicroseconds = waitingRequests[relativePath];
+            for (double requestMicroseconds : waitingMicroseconds) {
+                totalWaitMicroseconds += loadedMicroseconds - requestMicroseconds;
+                visibleCount++;
+            }
+
+            waitingMicroseconds.clear();
+        }
+
+        return (visibleCount > 0) ? (totalWaitMicroseconds / visibleCount / 1000.0) : 0.0;
+    };
+
+    uint64_t stackVisibleCount = 0;
+    uint64_t queueVisibleCount = 0;
+    const double stackMilliseconds = simulate(false, stackVisibleCount);
+    const double queueMilliseconds = simulate(true, queueVisibleCount);
+
+    // The means are compared after rounding them the same way they were reported. Any change to the queue that makes the visible
+    // textures wait longer than they did when it was introduced, or longer than with the stack, fails the check.
+    auto roundToHundredths = [](double value) {
+        return std::round(value * 100.0) / 100.0;
+    };
+
+    const bool stackMatches = (roundToHundredths(stackMilliseconds) == ExpectedStackMilliseconds);
+    const bool queueRegressed = (roundToHundredths(queueMilliseconds) > ExpectedQueueMilliseconds) || (queueMilliseconds >= stackMilliseconds);
+    succeeded = stackMatches && !queueRegressed && (stackVisibleCount == queueVisibleCount);
+
+    json jroot;
+    jroot["visibleRequests"] = queueVisibleCount;
+    jroot["stackMeanMs"] = stackMilliseconds;
+    jroot["queueMeanMs"] = queueMilliseconds;
+    jroot["expectedStackMeanMs"] = ExpectedStackMilliseconds;
+    jroot["expectedQueueMeanMs"] = ExpectedQueueMilliseconds;
+    jroot["stackMatches"] = stackMatches;
+    jroot["queueRegressed"] = queueRegressed;
+    return jroot;
+}
+
+// Replays a capture on the null backend with the statistics of the shader cache, the texture map and the framebuffer RAM checks enabled.
+// The hashes memoized for TMEM are validated against hashing the contents on every hit.
+// These aren't part of the replay timings as measuring every call adds to the time of the calls themselves.
+json checkStatistics(const std::filesystem::path &capturePath, bool &succeeded) {
+    json jroot;
+    succeeded = false;
+
+    DisplayListCapture::Reader reader;
+    if (!reader.open(capturePath)) {
+        return jroot;
+    }
+
+    ApplicationConfiguration appConfig;
+    appConfig.detectDataPath = false;
+    appConfig.useConfigurationFile = false;
+    appConfig.useNullRenderInterface = true;
+
+    ReplayCore replayCore;
+    Application app(replayCore.toApplicationCore(), appConfig);
+    if (app.setup(0) != Application::SetupResult::Success) {
+        fprintf(stderr, "Failed to set up the application.\n");
+        return jroot;
+    }
+
+    app.userConfig.refreshRate = UserConfiguration::RefreshRate::Original;
+    app.updateUserConfig(false);
+    app.rasterShaderCache->submissionTiming = true;
+    app.textureCache->setTextureMapStatisticsEnabled(true);
+    app.state->framebufferManager.RAMStatisticsEnabled = true;
+    app.state->textureManager.hashMemo.validate = true;
+    replayCore.replay(reader, app);
+    app.workloadQueue->waitForIdle();
+    app.presentQueue->waitForIdle();
+
+    jroot["capture"] = capturePath.u8string();
+    jroot["frames"] = replayCore.updateScreenTimings.samples.size();
+
+    // Submissions are timed on the workload thread while the compilation threads drain the queue.
+    const RasterShaderCache::SubmissionStatistics submissionStats = app.rasterShaderCache->submissionStatistics();
+    json &jshaders = jroot["shaderCache"];
+    jshaders["compilationThreads"] = app.rasterShaderCache->threadCount;
+    jshaders["submissions"] = submissionStats.submitCount;
+    jshaders["inserted"] = submissionStats.insertedCount;
+    jshaders["reprioritized"] = submissionStats.reprioritizedCount;
+    jshaders["stale"] = submissionStats.staleCount;
+    jshaders["submitAverageNs"] = (submissionStats.timedCount > 0) ? (double(submissionStats.timedNanoseconds) / submissionStats.timedCount) : 0.0;
+    jshaders["submitTotalMs"] = submissionStats.timedNanoseconds / 1000000.0;
+    jshaders["shaders"] = app.rasterShaderCache->shaderCount();
+
+    // The sequence of uses, additions and evictions of the texture map is the one recorded in the capture.
+    const TextureMap::Statistics textureMapStats = app.textureCache->getTextureMapStatistics();
+    auto averageNanoseconds = [](uint64_t nanoseconds, uint64_t count) {
+        return (count > 0) ? (double(nanoseconds) / count) : 0.0;
+    };
+
+    json &jtextureMap = jroot["textureMap"];
+    jtextureMap["uses"] = textureMapStats.useCount;
+    jtextureMap["useAverageNs"] = averageNanoseconds(textureMapStats.useNanoseconds, textureMapStats.useCount);
+    jtextureMap["additions"] = textureMapStats.addCount;
+    jtextureMap["addAverageNs"] = averageNanoseconds(textureMapStats.addNanoseconds, textureMapStats.addCount);
+    jtextureMap["evictions"] = textureMapStats.evictCount;
+    jtextureMap["evictedTextures"] = textureMapStats.evictedCount;
+    jtextureMap["evictAverageNs"] = averageNanoseconds(textureMapStats.evictNanoseconds, textureMapStats.evictCount);
+    jtextureMap["residentTextures"] = textureMapStats.residentCount;
+
+    // Framebuffers written to by the CPU, like HUD overlays, show up as uploads of their dirty range.
+    const FramebufferManager::RAMStatistics &RAMStats = app.state->framebufferManager.RAMStats;
+    json &jframebufferRAM = jroot["framebufferRAM"];
+    jframebufferRAM["checks"] = RAMStats.checkCount;
+    jframebufferRAM["checkAverageNs"] = averageNanoseconds(RAMStats.checkNanoseconds, RAMStats.checkCount);
+    jframebufferRAM["hashedBytes"] = RAMStats.hashedBytes;
+    jframebufferRAM["skippedBytes"] = RAMStats.skippedBytes;
+    jframebufferRAM["differentFramebuffers"] = RAMStats.differentCount;
+    jframebufferRAM["uploads"] = RAMStats.uploadCount;
+    jframebufferRAM["uploadDirtyBytes"] = RAMStats.uploadDirtyBytes;
+    jframebufferRAM["uploadTotalBytes"] = RAMStats.uploadTotalBytes;
+
+    // Every hit is hashed again, so a memoized hash that doesn't match the TMEM contents fails the check.
+    const TextureManager::HashMemo &hashMemo = app.state->textureManager.hashMemo;
+    json &jhashMemo = jroot["tmemHashMemo"];
+    jhashMemo["hits"] = hashMemo.hitCount;
+    jhashMemo["misses"] = hashMemo.missCount;
+    jhashMemo["uncached"] = hashMemo.uncachedCount;
+    jhashMemo["mismatches"] = hashMemo.mismatchCount;
+
+    app.end();
+    succeeded = (hashMemo.mismatchCount == 0);
+    return jroot;
+}
+
+void showHelp() {
+    fprintf(stderr,
+        "rt64_check --vertex-kernels [--count <iterations>]\n"
+        "\tCompare the vertex ingest kernels against the per-vertex code on random vertices and\n"
+        "\tprint the amount of mismatches as JSON. Fails if any output is not bit-exact.\n\n"
+        "rt64_check --stream-queue [--count <iterations>]\n"
+        "\tRun random operations on the texture stream queue and verify the requests come out by\n"
+        "\tpriority and in the order they were pushed when their priority is the same.\n\n"
+        "rt64_check --stream-trace\n"
+        "\tSimulate the streaming threads on a synthetic trace of visible requests and preloads and\n"
+        "\tcompare the mean time-to-replacement of the stream queue against a LIFO stack. Fails if\n"
+        "\tthe queue is slower than the stack or than the 2.42 ms it measured when it was introduced.\n\n"
+        "rt64_check --statistics <capture>\n"
+        "\tReplay a display list capture on the null backend and print the statistics of the shader\n"
+        "\tcache submissions, the texture map and the framebuffer RAM checks as JSON. Fails if a\n"
+        "\tmemoized TMEM hash doesn't match the hash of the TMEM contents.\n\n"
+    );
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        showHelp();
+        return 1;
+    }
+
+    const std::string modeString = argv[1];
+    json jroot;
+    bool succeeded = false;
+    if ((modeString == "--vertex-kernels") || (modeString == "--stream-queue")) {
+        const bool checkKernels = (modeString == "--vertex-kernels");
+        uint32_t iterations = checkKernels ? 10000 : 100000;
+        if ((argc >= 4) && (strcmp(argv[2], "--count") == 0)) {
+            iterations = uint32_t(std::max(atoi(argv[3]), 1));
+        }
+
+        uint64_t mismatchCount = 0;
+        jroot = checkKernels ? checkVertexKernels(iterations, mismatchCount) : checkStreamQueue(iterations, mismatchCount);
+        succeeded = (mismatchCount == 0);
+    }
+    else if (modeString == "--stream-trace") {
+        jroot = checkStreamTrace(succeeded);
+    }
+    else if ((modeString == "--statistics") && (argc >= 3)) {
+        jroot = checkStatistics(std::filesystem::u8path(argv[2]), succeeded);
+        if (jroot.empty()) {
+            return 1;
+        }
+    }
+    else {
+        fprintf(stderr, "Unrecognized argument %s.\n\n", modeString.c_str());
+        showHelp();
+        return 1;
+    }
+
+    fprintf(stdout, "%s\n", jroot.dump(4).c_str());
+    return succeeded ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+//
+// RT64
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "plainargs/plainargs.h"
+
+#include "../../common/rt64_frame_pacer.cpp"
+#include "../../common/rt64_thread.cpp"
+#include "../../common/rt64_timer.cpp"
+
+struct PacingResult {
+    double averageMilliseconds = 0.0;
+    double jitterP50Milliseconds = 0.0;
+    double jitterP90Milliseconds = 0.0;
+    double jitterP99Milliseconds = 0.0;
+    double jitterP999Milliseconds = 0.0;
+    double jitterMaxMilliseconds = 0.0;
+    uint32_t missedCount = 0;
+};
+
+// Simulates the work done by the present thread between each wait.
+void spinFor(int64_t workMicroseconds) {
+    const RT64::Timestamp workStart = RT64::Timer::current();
+    while (RT64::Timer::deltaMicroseconds(workStart, RT64::Timer::current()) < workMicroseconds);
+}
+
+PacingResult computeResult(const std::vector<RT64::Timestamp> &presents, int64_t intervalMicroseconds) {
+    PacingResult result;
+    if (presents.size() < 2) {
+        return result;
+    }
+
+    const double targetMilliseconds = intervalMicroseconds / 1000.0;
+    std::vector<double> jitter;
+    jitter.reserve(presents.size() - 1);
+    for (size_t i = 1; i < presents.size(); i++) {
+        const double frameMilliseconds = RT64::Timer::deltaMicroseconds(presents[i - 1], presents[i]) / 1000.0;
+        result.averageMilliseconds += frameMilliseconds;
+        jitter.emplace_back(std::abs(frameMilliseconds - targetMilliseconds));
+
+        // Same criteria as the frame pacer for considering a frame as missed.
+        if ((frameMilliseconds * 2.0) > (targetMilliseconds * 3.0)) {
+            result.missedCount++;
+        }
+    }
+
+    result.averageMilliseconds /= jitter.size();
+
+    std::sort(jitter.begin(), jitter.end());
+    auto percentile = [&](double p) {
+        return jitter[std::min(size_t(p * jitter.size()), jitter.size() - 1)];
+    };
+
+    result.jitterP50Milliseconds = percentile(0.5);
+    result.jitterP90Milliseconds = percentile(0.9);
+    result.jitterP99Milliseconds = percentile(0.99);
+    result.jitterP999Milliseconds = percentile(0.999);
+    result.jitterMaxMilliseconds = jitter.back();
+    return result;
+}
+
+// The previous pacing method. Sleeps for the time left until each deadline and relies entirely on the precision of the OS timer.
+PacingResult benchmarkSleep(uint32_t frameCount, int64_t intervalMicroseconds, int64_t workMicroseconds) {
+    std::vector<RT64::Timestamp> presents;
+    presents.reserve(frameCount);
+
+    const std::chrono::microseconds interval(intervalMicroseconds);
+    RT64::Timestamp deadline;
+    for (uint32_t i = 0; i < frameCount; i++) {
+        spinFor(workMicroseconds);
+
+        // Like the frame pacer, the first frame isn't paced and the deadlines start from it.
+        if (i > 0) {
+            const int64_t remainingMicroseconds = RT64::Timer::deltaMicroseconds(RT64::Timer::current(), deadline);
+            if (remainingMicroseconds > 0) {
+                RT64::Thread::sleepMicroseconds(uint32_t(remainingMicroseconds));
+            }
+        }
+
+        presents.emplace_back(RT64::Timer::current());
+        deadline = ((i > 0) ? deadline : presents.back()) + interval;
+    }
+
+    return computeResult(presents, intervalMicroseconds);
+}
+
+// The frame pacer used by the present queue. Sleeps until it's close to the deadline and spins for the remainder.
+PacingResult benchmarkPacer(uint32_t frameCount, int64_t intervalMicroseconds, int64_t workMicroseconds) {
+    std::vector<RT64::Timestamp> presents;
+    presents.reserve(frameCount);
+
+    RT64::FramePacer framePacer;
+    for (uint32_t i = 0; i < frameCount; i++) {
+        spinFor(workMicroseconds);
+        framePacer.waitForPresent(intervalMicroseconds, 0);
+
+        const RT64::Timestamp presentTimestamp = RT64::Timer::current();
+        framePacer.logPresent(presentTimestamp, presentTimestamp);
+        presents.emplace_back(presentTimestamp);
+    }
+
+    return computeResult(presents, intervalMicroseconds);
+}
+
+void printResult(const char *name, const PacingResult &result) {
+    fprintf(stdout, "%s\n", name);
+    fprintf(stdout, "\tAverage: %.3fms\n", result.averageMilliseconds);
+    fprintf(stdout, "\tJitter P50: %.3fms P90: %.3fms P99: %.3fms P99.9: %.3fms Max: %.3fms\n", result.jitterP50Milliseconds, result.jitterP90Milliseconds,
+        result.jitterP99Milliseconds, result.jitterP999Milliseconds, result.jitterMaxMilliseconds);
+    fprintf(stdout, "\tMissed: %u\n", result.missedCount);
+}
+
+void showHelp() {
+    fprintf(stderr,
+        "pacing_benchmark [--frames <count>] [--rate <hz>] [--work <microseconds>]\n"
+        "\tMeasure the frame time jitter of pacing with only sleeping against the frame pacer's sleep and spin.\n"
+        "\tDefaults to 600 frames at 60 Hz with no simulated work per frame.\n\n"
+    );
+}
+
+int main(int argc, char *argv[]) {
+    plainargs::Result args = plainargs::parse(argc, argv);
+    if (args.hasOption("help", "h")) {
+        showHelp();
+        return 0;
+    }
+
+    uint32_t frameCount = 600;
+    double rate = 60.0;
+    int64_t workMicroseconds = 0;
+    try {
+        const std::string framesString = args.getValue("frames", "f");
+        const std::string rateString = args.getValue("rate", "r");
+        const std::string workString = args.getValue("work", "w");
+        if (!framesString.empty()) {
+            frameCount = uint32_t(std::stoul(framesString));
+        }
+
+        if (!rateString.empty()) {
+            rate = std::stod(rateString);
+        }
+
+        if (!workString.empty()) {
+            workMicroseconds = std::stoll(workString);
+        }
+    }
+    catch (const std::exception &e) {
+        fprintf(stderr, "Invalid argument: %s\n\n", e.what());
+        showHelp();
+        return 1;
+    }
+
+    if ((frameCount < 2) || (rate <= 0.0)) {
+        fprintf(stderr, "At least two frames and a positive rate are required.\n\n");
+        showHelp();
+        return 1;
+    }
+
+    const int64_t intervalMicroseconds = std::llround(1000000.0 / rate);
+    if (workMicroseconds >= intervalMicroseconds) {
+        fprintf(stderr, "The simulated work must be shorter than the frame interval.\n");
+        return 1;
+    }
+
+    RT64::Timer::initialize();
+
+    fprintf(stdout, "Pacing %u frames at %.3fms with %.3fms of work per frame.\n", frameCount, intervalMicroseconds / 1000.0, workMicroseconds / 1000.0);
+    printResult("Sleep", benchmarkSleep(frameCount, intervalMicroseconds, workMicroseconds));
+    printResult("Sleep and spin", benchmarkPacer(frameCount, intervalMicroseconds, workMicroseconds));
+    return 0;
+}
@@ -0,0 +1,171 @@
+//
+// RT64
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#include "common/rt64_elapsed_timer.h"
+#include "null/rt64_null.h"
+
+#include "rt64_replay_core.h"
+
+using namespace RT64;
+
+json profilerToJson(const ProfilingTimer &profiler) {
+    json jroot;
+    jroot["averageMs"] = profiler.average();
+    jroot["samples"] = profiler.size();
+    return jroot;
+}
+
+void showHelp() {
+    fprintf(stderr,
+        "rt64_replay <capture> [--null | --vulkan | --d3d12] [--output <file>]\n"
+        "            [--target-rate <hz>] [--serial-matching]\n"
+        "\tReplay a display list capture as fast as possible and print the timings as JSON.\n"
+        "\tThe null backend is used by default so only the CPU side of the renderer is measured.\n"
+        "\tA target rate enables frame matching and interpolation, which is otherwise skipped.\n\n"
+    );
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        showHelp();
+        return 1;
+    }
+
+    std::filesystem::path capturePath(argv[1]);
+    std::filesystem::path outputPath;
+    ApplicationConfiguration appConfig;
+    appConfig.detectDataPath = false;
+    appConfig.useConfigurationFile = false;
+    appConfig.useNullRenderInterface = true;
+
+    UserConfiguration::GraphicsAPI graphicsAPI = UserConfiguration::GraphicsAPI::Vulkan;
+    int targetRate = 0;
+    bool serialMatching = false;
+    for (int i = 2; i < argc; i++) {
+        std::string argString = argv[i];
+        if (argString == "--null") {
+            appConfig.useNullRenderInterface = true;
+        }
+        else if (argString == "--vulkan") {
+            appConfig.useNullRenderInterface = false;
+            graphicsAPI = UserConfiguration::GraphicsAPI::Vulkan;
+        }
+        else if (argString == "--d3d12") {
+            appConfig.useNullRenderInterface = false;
+            graphicsAPI = UserConfiguration::GraphicsAPI::D3D12;
+        }
+        else if ((argString == "--output") && ((i + 1) < argc)) {
+            outputPath = argv[++i];
+        }
+        else if ((argString == "--target-rate") && ((i + 1) < argc)) {
+            targetRate = std::max(atoi(argv[++i]), 0);
+        }
+        else if (argString == "--serial-matching") {
+            serialMatching = true;
+        }
+        else {
+            fprintf(stderr, "Unrecognized argument %s.\n\n", argString.c_str());
+            showHelp();
+            return 1;
+        }
+    }
+
+    DisplayListCapture::Reader reader;
+    if (!reader.open(capturePath)) {
+        return 1;
+    }
+
+    ReplayCore replayCore;
+    Application app(replayCore.toApplicationCore(), appConfig);
+    app.userConfig.graphicsAPI = graphicsAPI;
+    if (app.setup(0) != Application::SetupResult::Success) {
+        fprintf(stderr, "Failed to set up the application.\n");
+        return 1;
+    }
+
+    // Don't pace the presents so the replay runs as fast as the renderer allows.
+    if (targetRate > 0) {
+        app.userConfig.refreshRate = UserConfiguration::RefreshRate::Manual;
+        app.userConfig.refreshRateTarget = targetRate;
+    }
+    else {
+        app.userConfig.refreshRate = UserConfiguration::RefreshRate::Original;
+    }
+
+    app.updateUserConfig(false);
+    app.workloadQueue->parallelMatching = !serialMatching;
+
+    ElapsedTimer replayTimer;
+    replayCore.replay(reader, app);
+
+    // Include the time it takes for the queues to finish all the work that was submitted.
+    const double submitSeconds = replayTimer.elapsedSeconds();
+    app.workloadQueue->waitForIdle();
+    app.presentQueue->waitForIdle();
+    const double totalSeconds = replayTimer.elapsedSeconds();
+
+    json jroot;
+    jroot["capture"] = capturePath.u8string();
+    jroot["backend"] = appConfig.useNullRenderInterface ? "null" : ((graphicsAPI == UserConfiguration::GraphicsAPI::D3D12) ? "d3d12" : "vulkan");
+    jroot["events"] = replayCore.eventCount;
+    jroot["rdramPages"] = replayCore.pageCount;
+    jroot["ucodeLoads"] = replayCore.ucodeLoadCount;
+    jroot["frames"] = replayCore.updateScreenTimings.samples.size();
+    jroot["submitSeconds"] = submitSeconds;
+    jroot["totalSeconds"] = totalSeconds;
+    jroot["framesPerSecond"] = (totalSeconds > 0.0) ? (replayCore.updateScreenTimings.samples.size() / totalSeconds) : 0.0;
+    jroot["calls"]["processDisplayLists"] = replayCore.displayListTimings.toJson();
+    jroot["calls"]["updateScreen"] = replayCore.updateScreenTimings.toJson();
+
+    // The profilers of the renderer only keep the most recent samples, so their averages describe the end of the capture.
+    jroot["profilers"]["dlCpu"] = profilerToJson(app.state->dlCpuProfiler);
+    jroot["profilers"]["screenCpu"] = profilerToJson(app.state->screenCpuProfiler);
+    jroot["profilers"]["viChanged"] = profilerToJson(app.state->viChangedProfiler);
+    jroot["profilers"]["workload"] = profilerToJson(app.workloadQueue->workloadProfiler);
+    jroot["profilers"]["matching"] = profilerToJson(app.workloadQueue->matchingProfiler);
+    jroot["profilers"]["renderer"] = profilerToJson(app.workloadQueue->rendererProfiler);
+    jroot["profilers"]["present"] = profilerToJson(app.presentQueue->presentProfiler);
+
+    if (appConfig.useNullRenderInterface) {
+        NullDevice *nullDevice = static_cast<NullDevice *>(app.device.get());
+        const NullStatistics statistics = nullDevice->getStatistics();
+        json &jdevice = jroot["device"];
+        jdevice["commandListsExecuted"] = statistics.commandListsExecuted;
+        jdevice["presents"] = statistics.presentCount;
+        jdevice["draws"] = statistics.commands.drawCount;
+        jdevice["dispatches"] = statistics.commands.dispatchCount;
+        jdevice["copies"] = statistics.commands.copyCount;
+        jdevice["barriers"] = statistics.commands.barrierCount;
+        jdevice["commands"] = statistics.commands.totalCount();
+        jdevice["buffers"] = statistics.bufferCount;
+        jdevice["bufferMemory"] = statistics.bufferMemory;
+        jdevice["textures"] = statistics.textureCount;
+        jdevice["textureMemory"] = statistics.textureMemory;
+        jdevice["pipelines"] = statistics.pipelineCount;
+    }
+
+    app.end();
+
+    const std::string jsonString = jroot.dump(4) + "\n";
+    if (!outputPath.empty()) {
+        std::ofstream outputStream(outputPath);
+        if (!outputStream.is_open()) {
+            std::string u8string = outputPath.u8string();
+            fprintf(stderr, "Failed to open %s for writing.\n", u8string.c_str());
+            return 1;
+        }
+
+        outputStream << jsonString;
+    }
+    else {
+        fprintf(stdout, "%s", jsonString.c_str());
+    }
+
+    return 0;
+}
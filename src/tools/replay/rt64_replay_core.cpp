@@ -0,0 +1,159 @@
+//
+// RT64
+//
+
+#include "rt64_replay_core.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/rt64_elapsed_timer.h"
+
+namespace RT64 {
+    // CallTimings
+
+    void CallTimings::add(double milliseconds) {
+        samples.emplace_back(milliseconds);
+    }
+
+    json CallTimings::toJson() const {
+        json jroot;
+        jroot["count"] = samples.size();
+        if (samples.empty()) {
+            return jroot;
+        }
+
+        std::vector<double> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+
+        double total = 0.0;
+        for (double sample : sorted) {
+            total += sample;
+        }
+
+        jroot["totalMs"] = total;
+        jroot["averageMs"] = total / sorted.size();
+        jroot["minMs"] = sorted.front();
+        jroot["medianMs"] = sorted[sorted.size() / 2];
+        jroot["p95Ms"] = sorted[std::min(size_t(sorted.size() * 0.95), sorted.size() - 1)];
+        jroot["maxMs"] = sorted.back();
+        return jroot;
+    }
+
+    // ReplayCore
+
+    ReplayCore::ReplayCore() {
+        RDRAM.resize(DisplayListCapture::RDRAMSize, 0);
+        DMEM.resize(DisplayListCapture::DMEMSize, 0);
+        IMEM.resize(DisplayListCapture::DMEMSize, 0);
+        HEADER.resize(0x40, 0);
+    }
+
+    void ReplayCore::checkInterrupts() { }
+
+    Application::Core ReplayCore::toApplicationCore() {
+        Application::Core core = {};
+        core.HEADER = HEADER.data();
+        core.RDRAM = RDRAM.data();
+        core.DMEM = DMEM.data();
+        core.IMEM = IMEM.data();
+        core.MI_INTR_REG = &MI_INTR_REG;
+        core.DPC_START_REG = &DPC_REGS[0];
+        core.DPC_END_REG = &DPC_REGS[1];
+        core.DPC_CURRENT_REG = &DPC_REGS[2];
+        core.DPC_STATUS_REG = &DPC_REGS[3];
+        core.DPC_CLOCK_REG = &DPC_REGS[4];
+        core.DPC_BUFBUSY_REG = &DPC_REGS[5];
+        core.DPC_PIPEBUSY_REG = &DPC_REGS[6];
+        core.DPC_TMEM_REG = &DPC_REGS[7];
+        core.VI_STATUS_REG = &VI.status;
+        core.VI_ORIGIN_REG = &VI.origin;
+        core.VI_WIDTH_REG = &VI.width;
+        core.VI_INTR_REG = &VI.intr;
+        core.VI_V_CURRENT_LINE_REG = &VI.vCurrentLine;
+        core.VI_TIMING_REG = &VI.timing;
+        core.VI_V_SYNC_REG = &VI.vSync;
+        core.VI_H_SYNC_REG = &VI.hSync;
+        core.VI_LEAP_REG = &VI.leap;
+        core.VI_H_START_REG = &VI.hStart;
+        core.VI_V_START_REG = &VI.vStart;
+        core.VI_V_BURST_REG = &VI.vBurst;
+        core.VI_X_SCALE_REG = &VI.xScale;
+        core.VI_Y_SCALE_REG = &VI.yScale;
+        core.checkInterrupts = &ReplayCore::checkInterrupts;
+        return core;
+    }
+
+    void ReplayCore::replay(DisplayListCapture::Reader &reader, Application &app) {
+        DisplayListCapture::EventType eventType;
+        std::vector<uint8_t> payload;
+        while (reader.nextEvent(eventType, payload)) {
+            eventCount++;
+
+            switch (eventType) {
+            case DisplayListCapture::EventType::RDRAMPages: {
+                const size_t pageEntrySize = sizeof(uint32_t) + DisplayListCapture::PageSize;
+                for (size_t offset = 0; (offset + pageEntrySize) <= payload.size(); offset += pageEntrySize) {
+                    uint32_t pageIndex;
+                    memcpy(&pageIndex, &payload[offset], sizeof(uint32_t));
+                    if (pageIndex < (DisplayListCapture::RDRAMSize / DisplayListCapture::PageSize)) {
+                        memcpy(&RDRAM[pageIndex * DisplayListCapture::PageSize], &payload[offset + sizeof(uint32_t)], DisplayListCapture::PageSize);
+                        pageCount++;
+                    }
+                }
+
+                break;
+            }
+            case DisplayListCapture::EventType::LoadUCode: {
+                DisplayListCapture::LoadUCodeEvent event;
+                if (payload.size() < sizeof(event)) {
+                    break;
+                }
+
+                // Nested loads will be done again by the interpreter when it runs the display lists.
+                memcpy(&event, payload.data(), sizeof(event));
+                if (!event.nested) {
+                    app.interpreter->loadUCodeGBI(event.textAddress, event.dataAddress, event.resetFromTask);
+                    ucodeLoadCount++;
+                }
+
+                break;
+            }
+            case DisplayListCapture::EventType::DisplayLists: {
+                DisplayListCapture::DisplayListsEvent event;
+                if (payload.size() < sizeof(event)) {
+                    break;
+                }
+
+                memcpy(&event, payload.data(), sizeof(event));
+
+                uint8_t *memory = RDRAM.data();
+                if (event.fromDMEM && (payload.size() >= (sizeof(event) + DisplayListCapture::DMEMSize))) {
+                    memcpy(DMEM.data(), &payload[sizeof(event)], DisplayListCapture::DMEMSize);
+                    memory = DMEM.data();
+                }
+
+                ElapsedTimer callTimer;
+                app.processDisplayLists(memory, event.dlStartAddress, event.dlEndAddress, event.isHLE);
+                displayListTimings.add(callTimer.elapsedMilliseconds());
+                break;
+            }
+            case DisplayListCapture::EventType::UpdateScreen: {
+                if (payload.size() < sizeof(VI)) {
+                    break;
+                }
+
+                memcpy(&VI, payload.data(), sizeof(VI));
+
+                ElapsedTimer callTimer;
+                app.updateScreen();
+                updateScreenTimings.add(callTimer.elapsedMilliseconds());
+                break;
+            }
+            default:
+                fprintf(stderr, "Skipping unknown event type %u.\n", uint32_t(eventType));
+                break;
+            }
+        }
+    }
+};
@@ -0,0 +1,43 @@
+//
+// RT64
+//
+
+#pragma once
+
+#include <vector>
+
+#include "hle/rt64_application.h"
+#include "hle/rt64_display_list_capture.h"
+
+namespace RT64 {
+    // Keeps every sample of the run, unlike the profilers of the renderer which only keep a short history.
+    struct CallTimings {
+        std::vector<double> samples;
+
+        void add(double milliseconds);
+        json toJson() const;
+    };
+
+    // Stands in for the emulator the capture was recorded from. The registers and memory are only updated by the events of the capture.
+    struct ReplayCore {
+        std::vector<uint8_t> RDRAM;
+        std::vector<uint8_t> DMEM;
+        std::vector<uint8_t> IMEM;
+        std::vector<uint8_t> HEADER;
+        uint32_t MI_INTR_REG = 0;
+        uint32_t DPC_REGS[8] = {};
+        DisplayListCapture::UpdateScreenEvent VI = {};
+        uint64_t eventCount = 0;
+        uint64_t pageCount = 0;
+        uint64_t ucodeLoadCount = 0;
+        CallTimings displayListTimings;
+        CallTimings updateScreenTimings;
+
+        ReplayCore();
+        static void checkInterrupts();
+        Application::Core toApplicationCore();
+
+        // Feeds every event left in the capture to the application as fast as possible.
+        void replay(DisplayListCapture::Reader &reader, Application &app);
+    };
+};
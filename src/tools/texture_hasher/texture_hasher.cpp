@@ -9,6 +9,7 @@
 #include "../../contrib/xxHash/xxh3.h"
 #include "../../common/rt64_load_types.cpp"
 #include "../../common/rt64_replacement_database.cpp"
+#include "../../common/rt64_texture_dump_archive.h"
 #include "../../shared/rt64_f3d_defines.h"
 #include "../../common/rt64_tmem_hasher.h"
 
@@ -448,12 +449,47 @@ void upgradeHash(const std::filesystem::path &directory, const std::string oldHa
     }
 }
 
+int extractArchive(const std::filesystem::path &directory) {
+    const std::filesystem::path archivePath = directory / "textures.rt64dump";
+    std::ifstream archiveStream(archivePath, std::ios::binary);
+    if (!archiveStream.is_open() || !RT64::TextureDumpArchive::readHeader(archiveStream)) {
+        std::string u8string = archivePath.u8string();
+        fprintf(stderr, "Failed to read texture dump archive at %s.\n", u8string.c_str());
+        return 1;
+    }
+
+    std::string name;
+    std::vector<uint8_t> data;
+    uint32_t extractedCount = 0;
+    while (RT64::TextureDumpArchive::readEntry(archiveStream, name, data)) {
+        // Entries are only allowed to be written to the same directory as the archive.
+        if ((name.find_first_of("/\\") != std::string::npos) || (name.find("..") == 0)) {
+            fprintf(stderr, "Skipping entry with invalid name %s.\n", name.c_str());
+            continue;
+        }
+
+        std::ofstream fileStream(directory / name, std::ios::binary);
+        if (fileStream.is_open()) {
+            fileStream.write((const char *)(data.data()), data.size());
+            extractedCount++;
+        }
+        else {
+            fprintf(stderr, "Failed to write file %s.\n", name.c_str());
+        }
+    }
+
+    fprintf(stdout, "Extracted %u files from the archive.\n", extractedCount);
+    return 0;
+}
+
 void showHelp() {
     fprintf(stderr, 
         "texture_hasher <path> --rice\n"
         "\tGenerate Rice matches based on the dumped textures.\n\n"
         "texture_hasher <path> --upgrade\n"
         "\tUpgrade the database to the latest version. Will recalculate any hashes as necessary.\n\n"
+        "texture_hasher <path> --extract\n"
+        "\tExtract the files of a texture dump archive (textures.rt64dump) into the same directory.\n\n"
     );
 }
 
@@ -482,6 +518,10 @@ int main(int argc, char *argv[]) {
             fprintf(stdout, "Upgrading database to latest hash version.\n");
             mode = Mode::Upgrade;
         }
+        else if ((modeString == "--extract") || (modeString == "-x")) {
+            fprintf(stdout, "Extracting texture dump archive.\n");
+            return extractArchive(searchDirectory);
+        }
         else if ((modeString == "--rice") || (modeString == "-r")) {
             fprintf(stdout, "Generating Rice hashes for files in the directory.\n");
             mode = Mode::Rice;
@@ -3,6 +3,7 @@
 //
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <filesystem>
 #include <fstream>
@@ -16,9 +17,16 @@
 #include <ddspp/ddspp.h>
 #include <miniz/miniz.h>
 #include <plainargs/plainargs.h>
+#include <zdict.h>
 #include <zstd.h>
 
+#include "../../common/rt64_filesystem_indexed_pack.cpp"
+#include "../../common/rt64_filesystem_zip.cpp"
+#include "../../common/rt64_mapped_file.cpp"
 #include "../../common/rt64_replacement_database.cpp"
+#include "../../common/rt64_task_pool.cpp"
+#include "../../common/rt64_thread.cpp"
+#include "../../common/rt64_zstd_decompressor.cpp"
 
 enum {
     MZ_ZIP_LDH_METHOD_OFS = 8,
@@ -26,6 +34,13 @@ enum {
     MZ_ZSTD = 93,
 };
 
+// Files larger than this are compressed as multiple independent zstd frames so they can be decompressed in parallel.
+static const size_t ZstdFrameSize = 1024 * 1024;
+
+// Files up to this size are compressed with a dictionary trained on all of them, as they compress poorly on their own.
+static const size_t DictionaryFileMaxSize = 16 * 1024;
+static const size_t DictionaryMaxSize = 112640;
+static const size_t DictionaryMinSamples = 64;
 static const uint32_t TextureDataPitchAlignment = 256;
 static const uint32_t TextureDataPlacementAlignment = 512;
 
@@ -38,9 +53,27 @@ static uint32_t nextSizeAlignedTo(uint32_t size, uint32_t alignment) {
     }
 }
 
+static size_t compressZstdFrames(uint8_t *dstData, size_t dstCapacity, const uint8_t *srcData, size_t srcSize, int compressionLevel) {
+    size_t dstSize = 0;
+    size_t srcOffset = 0;
+    do {
+        const size_t frameSrcSize = std::min(ZstdFrameSize, srcSize - srcOffset);
+        const size_t frameDstSize = ZSTD_compress(dstData + dstSize, dstCapacity - dstSize, srcData + srcOffset, frameSrcSize, compressionLevel);
+        if (ZSTD_isError(frameDstSize)) {
+            return 0;
+        }
+
+        dstSize += frameDstSize;
+        srcOffset += frameSrcSize;
+    } while (srcOffset < srcSize);
+
+    return dstSize;
+}
+
 struct CompressionInput {
     std::string zipPath;
     std::filesystem::path filePath;
+    bool allowDictionary = false;
 };
 
 struct CompressionOutput {
@@ -58,9 +91,11 @@ std::condition_variable outputQueueChanged;
 std::atomic<bool> compressionFailed;
 std::atomic<bool> useCompression;
 std::atomic<bool> useZstd;
+ZSTD_CDict *compressionDictionary = nullptr;
 
 void compressionThread() {
     std::vector<uint8_t> fileData;
+    ZSTD_CCtx *compressionContext = ZSTD_createCCtx();
     while (!compressionFailed) {
         CompressionInput input;
         {
@@ -99,8 +134,14 @@ void compressionThread() {
         size_t outputSize = 0;
         if (useCompression) {
             if (useZstd) {
-                // Max compression level has shown significant advantages in size reduction.
-                outputSize = ZSTD_compress(output.fileData.data(), output.fileData.size(), fileData.data(), fileData.size(), ZSTD_maxCLevel());
+                // Max compression level has shown significant advantages in size reduction. The dictionary was created with it as well.
+                if (input.allowDictionary && (compressionDictionary != nullptr) && (fileData.size() <= DictionaryFileMaxSize)) {
+                    outputSize = ZSTD_compress_usingCDict(compressionContext, output.fileData.data(), output.fileData.size(), fileData.data(), fileData.size(), compressionDictionary);
+                    outputSize = ZSTD_isError(outputSize) ? 0 : outputSize;
+                }
+                else {
+                    outputSize = compressZstdFrames(output.fileData.data(), output.fileData.size(), fileData.data(), fileData.size(), ZSTD_maxCLevel());
+                }
             }
             else {
                 // Probe number extracted from miniz's compression level 10.
@@ -135,13 +176,333 @@ void compressionThread() {
     if (compressionFailed) {
         outputQueueChanged.notify_all();
     }
+
+    ZSTD_freeCCtx(compressionContext);
+}
+
+// Returns false if there's not enough small files to train a dictionary with.
+bool trainDictionary(const std::filesystem::path &directoryPath, const std::set<std::string> &relativePaths, std::vector<uint8_t> &dictionaryBytes) {
+    std::vector<uint8_t> samplesBytes;
+    std::vector<size_t> samplesSizes;
+    for (const std::string &relativePath : relativePaths) {
+        const std::filesystem::path filePath = directoryPath / std::filesystem::u8path(relativePath);
+        std::error_code ec;
+        const uintmax_t fileSize = std::filesystem::file_size(filePath, ec);
+        if (ec || (fileSize == 0) || (fileSize > DictionaryFileMaxSize)) {
+            continue;
+        }
+
+        std::ifstream fileStream(filePath, std::ios::binary);
+        const size_t sampleOffset = samplesBytes.size();
+        samplesBytes.resize(sampleOffset + fileSize);
+        fileStream.read(reinterpret_cast<char *>(&samplesBytes[sampleOffset]), fileSize);
+        if (!fileStream.good()) {
+            samplesBytes.resize(sampleOffset);
+            continue;
+        }
+
+        samplesSizes.emplace_back(fileSize);
+    }
+
+    if (samplesSizes.size() < DictionaryMinSamples) {
+        return false;
+    }
+
+    // The dictionary can't be larger than the samples it was trained on.
+    dictionaryBytes.resize(std::min(DictionaryMaxSize, samplesBytes.size() / 10));
+    const size_t dictionarySize = ZDICT_trainFromBuffer(dictionaryBytes.data(), dictionaryBytes.size(), samplesBytes.data(), samplesSizes.data(), unsigned(samplesSizes.size()));
+    if (ZDICT_isError(dictionarySize)) {
+        fprintf(stderr, "Failed to train the zstd dictionary: %s.\n", ZDICT_getErrorName(dictionarySize));
+        return false;
+    }
+
+    dictionaryBytes.resize(dictionarySize);
+    return true;
+}
+
+struct IndexedPackWriter {
+    struct FileRecord {
+        std::string path;
+        RT64::FileSystemIndexedPack::FileEntry entry = {};
+    };
+
+    std::ofstream stream;
+    std::vector<FileRecord> fileRecords;
+
+    bool open(const std::filesystem::path &packPath) {
+        stream.open(packPath, std::ios::binary);
+        if (!stream.is_open()) {
+            return false;
+        }
+
+        // The header is written again once the tables are known.
+        RT64::FileSystemIndexedPack::Header header = {};
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        return !stream.bad();
+    }
+
+    bool addFile(const std::string &path, const uint8_t *data, size_t size, size_t uncompressedSize, RT64::FileSystemIndexedPack::Compression compression, uint32_t checksum) {
+        FileRecord record;
+        record.path = path;
+        record.entry.dataOffset = uint64_t(stream.tellp());
+        record.entry.compressedSize = size;
+        record.entry.uncompressedSize = uncompressedSize;
+        record.entry.compression = compression;
+        record.entry.checksumCRC32 = checksum;
+        fileRecords.emplace_back(record);
+        stream.write(reinterpret_cast<const char *>(data), size);
+        return !stream.bad();
+    }
+
+    bool finalize(const std::unordered_map<uint64_t, RT64::ReplacementResolvedPath> &resolvedPathMap, uint32_t hashVersion) {
+        std::sort(fileRecords.begin(), fileRecords.end(), [](const FileRecord &a, const FileRecord &b) {
+            return a.path < b.path;
+        });
+
+        std::string stringTable;
+        std::unordered_map<std::string, uint32_t> pathIndexMap;
+        std::vector<RT64::FileSystemIndexedPack::FileEntry> fileEntries;
+        for (FileRecord &record : fileRecords) {
+            record.entry.pathOffset = uint32_t(stringTable.size());
+            record.entry.pathLength = uint32_t(record.path.size());
+            stringTable += record.path;
+            pathIndexMap[record.path] = uint32_t(fileEntries.size());
+            fileEntries.emplace_back(record.entry);
+        }
+
+        std::vector<RT64::FileSystemIndexedPack::HashEntry> hashEntries;
+        std::vector<uint64_t> preloadHashes;
+        for (const auto &it : resolvedPathMap) {
+            auto pathIt = pathIndexMap.find(it.second.relativePath);
+            if (pathIt == pathIndexMap.end()) {
+                fprintf(stderr, "The path %s was not added to the pack.\n", it.second.relativePath.c_str());
+                return false;
+            }
+
+            RT64::FileSystemIndexedPack::HashEntry hashEntry;
+            hashEntry.hash = it.first;
+            hashEntry.fileIndex = pathIt->second;
+            hashEntry.operation = uint32_t(it.second.operation);
+            hashEntries.emplace_back(hashEntry);
+
+            if (it.second.operation == RT64::ReplacementOperation::Preload) {
+                preloadHashes.emplace_back(it.first);
+            }
+        }
+
+        std::sort(hashEntries.begin(), hashEntries.end(), [](const RT64::FileSystemIndexedPack::HashEntry &a, const RT64::FileSystemIndexedPack::HashEntry &b) {
+            return a.hash < b.hash;
+        });
+
+        std::sort(preloadHashes.begin(), preloadHashes.end());
+
+        // Keep the tables aligned to their largest member.
+        while ((stream.tellp() % sizeof(uint64_t)) != 0) {
+            stream.put(0);
+        }
+
+        RT64::FileSystemIndexedPack::Header header = {};
+        memcpy(header.magic, RT64::FileSystemIndexedPack::Magic, sizeof(header.magic));
+        header.version = RT64::FileSystemIndexedPack::Version;
+        header.hashVersion = hashVersion;
+        header.fileCount = uint32_t(fileEntries.size());
+        header.hashCount = uint32_t(hashEntries.size());
+        header.preloadCount = uint32_t(preloadHashes.size());
+        header.fileTableOffset = uint64_t(stream.tellp());
+        stream.write(reinterpret_cast<const char *>(fileEntries.data()), fileEntries.size() * sizeof(RT64::FileSystemIndexedPack::FileEntry));
+        header.hashTableOffset = uint64_t(stream.tellp());
+        stream.write(reinterpret_cast<const char *>(hashEntries.data()), hashEntries.size() * sizeof(RT64::FileSystemIndexedPack::HashEntry));
+        header.preloadTableOffset = uint64_t(stream.tellp());
+        stream.write(reinterpret_cast<const char *>(preloadHashes.data()), preloadHashes.size() * sizeof(uint64_t));
+        header.stringTableOffset = uint64_t(stream.tellp());
+        header.stringTableSize = stringTable.size();
+        stream.write(stringTable.data(), stringTable.size());
+        stream.seekp(0);
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        stream.close();
+        return !stream.bad();
+    }
+};
+
+// Compares every field of the database loaded from the compiled database against the JSON it was compiled from. Returns the
+// amount of entries that differ and prints them if requested.
+uint32_t countDatabaseMismatches(const RT64::ReplacementDatabase &jsonDatabase, const RT64::ReplacementDatabase &binaryDatabase, bool printMismatches) {
+    uint32_t mismatchCount = 0;
+    auto reportMismatch = [&](const char *entry, size_t index, const std::string &expected, const std::string &actual) {
+        if (printMismatches) {
+            fprintf(stderr, "Mismatch in %s %zu: expected \"%s\", got \"%s\".\n", entry, index, expected.c_str(), actual.c_str());
+        }
+
+        mismatchCount++;
+    };
+
+    const RT64::ReplacementConfiguration &a = jsonDatabase.config;
+    const RT64::ReplacementConfiguration &b = binaryDatabase.config;
+    if (a.autoPath != b.autoPath) {
+        reportMismatch("configuration autoPath", 0, std::to_string(uint32_t(a.autoPath)), std::to_string(uint32_t(b.autoPath)));
+    }
+
+    if (a.configurationVersion != b.configurationVersion) {
+        reportMismatch("configuration configurationVersion", 0, std::to_string(a.configurationVersion), std::to_string(b.configurationVersion));
+    }
+
+    if (a.hashVersion != b.hashVersion) {
+        reportMismatch("configuration hashVersion", 0, std::to_string(a.hashVersion), std::to_string(b.hashVersion));
+    }
+
+    if (jsonDatabase.operationFilters.size() != binaryDatabase.operationFilters.size()) {
+        reportMismatch("operation filter count", 0, std::to_string(jsonDatabase.operationFilters.size()), std::to_string(binaryDatabase.operationFilters.size()));
+    }
+
+    const size_t filterCount = std::min(jsonDatabase.operationFilters.size(), binaryDatabase.operationFilters.size());
+    for (size_t i = 0; i < filterCount; i++) {
+        const RT64::ReplacementOperationFilter &filterA = jsonDatabase.operationFilters[i];
+        const RT64::ReplacementOperationFilter &filterB = binaryDatabase.operationFilters[i];
+        if (filterA.wildcard != filterB.wildcard) {
+            reportMismatch("operation filter wildcard", i, filterA.wildcard, filterB.wildcard);
+        }
+
+        if (filterA.operation != filterB.operation) {
+            reportMismatch("operation filter operation", i, std::to_string(uint32_t(filterA.operation)), std::to_string(uint32_t(filterB.operation)));
+        }
+    }
+
+    // The compiled database stores the textures sorted by hash.
+    std::vector<RT64::ReplacementTexture> sortedTextures = jsonDatabase.textures;
+    std::stable_sort(sortedTextures.begin(), sortedTextures.end(), [](const RT64::ReplacementTexture &a, const RT64::ReplacementTexture &b) {
+        return RT64::ReplacementDatabase::stringToHash(a.hashes.rt64) < RT64::ReplacementDatabase::stringToHash(b.hashes.rt64);
+    });
+
+    if (sortedTextures.size() != binaryDatabase.textures.size()) {
+        reportMismatch("texture count", 0, std::to_string(sortedTextures.size()), std::to_string(binaryDatabase.textures.size()));
+    }
+
+    const size_t textureCount = std::min(sortedTextures.size(), binaryDatabase.textures.size());
+    for (size_t i = 0; i < textureCount; i++) {
+        const RT64::ReplacementTexture &textureA = sortedTextures[i];
+        const RT64::ReplacementTexture &textureB = binaryDatabase.textures[i];
+        if (textureA.path != textureB.path) {
+            reportMismatch("texture path", i, textureA.path, textureB.path);
+        }
+
+        if (textureA.hashes.rt64 != textureB.hashes.rt64) {
+            reportMismatch("texture rt64 hash", i, textureA.hashes.rt64, textureB.hashes.rt64);
+        }
+
+        if (textureA.hashes.rice != textureB.hashes.rice) {
+            reportMismatch("texture rice hash", i, textureA.hashes.rice, textureB.hashes.rice);
+        }
+    }
+
+    // Textures that share a hash must resolve to the same replacement in both databases.
+    for (size_t i = 0; i < jsonDatabase.textures.size(); i++) {
+        const std::string &hash = jsonDatabase.textures[i].hashes.rt64;
+        const RT64::ReplacementTexture replacementA = jsonDatabase.getReplacement(hash);
+        const RT64::ReplacementTexture replacementB = binaryDatabase.getReplacement(hash);
+        if (replacementA.path != replacementB.path) {
+            reportMismatch("replacement for hash", i, replacementA.path, replacementB.path);
+        }
+    }
+
+    return mismatchCount;
+}
+
+bool createDatabaseBinary(const std::filesystem::path &directoryPath, const RT64::ReplacementDatabase &database) {
+    // The compiled database is tied to the exact bytes of the JSON it was created from.
+    std::ifstream jsonStream(directoryPath / RT64::ReplacementDatabaseFilename, std::ios::binary);
+    std::vector<uint8_t> jsonBytes((std::istreambuf_iterator<char>(jsonStream)), std::istreambuf_iterator<char>());
+    if (jsonStream.bad()) {
+        fprintf(stderr, "Failed to read %s.\n", RT64::ReplacementDatabaseFilename.c_str());
+        return false;
+    }
+
+    std::vector<uint8_t> binaryBytes;
+    const uint64_t sourceHash = RT64::ReplacementDatabase::hashSource(jsonBytes.data(), jsonBytes.size());
+    database.toBinary(sourceHash, binaryBytes);
+
+    // Verify the round trip before writing it.
+    RT64::ReplacementDatabase binaryDatabase;
+    if (!binaryDatabase.fromBinary(binaryBytes.data(), binaryBytes.size(), sourceHash) || (countDatabaseMismatches(database, binaryDatabase, false) > 0)) {
+        fprintf(stderr, "The compiled database is not equivalent to %s.\n", RT64::ReplacementDatabaseFilename.c_str());
+        return false;
+    }
+
+    std::filesystem::path binaryPath = directoryPath / RT64::ReplacementDatabaseBinaryFilename;
+    std::ofstream binaryStream(binaryPath, std::ios::binary);
+    binaryStream.write(reinterpret_cast<const char *>(binaryBytes.data()), binaryBytes.size());
+    if (!binaryStream.is_open() || binaryStream.bad()) {
+        std::string u8string = binaryPath.u8string();
+        fprintf(stderr, "Failed to write the compiled database at %s.\n", u8string.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool checkDatabase(const std::filesystem::path &directoryPath, const RT64::ReplacementDatabase &database) {
+    std::ifstream jsonStream(directoryPath / RT64::ReplacementDatabaseFilename, std::ios::binary);
+    std::vector<uint8_t> jsonBytes((std::istreambuf_iterator<char>(jsonStream)), std::istreambuf_iterator<char>());
+    if (jsonStream.bad()) {
+        fprintf(stderr, "Failed to read %s.\n", RT64::ReplacementDatabaseFilename.c_str());
+        return false;
+    }
+
+    std::vector<uint8_t> binaryBytes;
+    const uint64_t sourceHash = RT64::ReplacementDatabase::hashSource(jsonBytes.data(), jsonBytes.size());
+    database.toBinary(sourceHash, binaryBytes);
+
+    RT64::ReplacementDatabase binaryDatabase;
+    if (!binaryDatabase.fromBinary(binaryBytes.data(), binaryBytes.size(), sourceHash)) {
+        fprintf(stderr, "Failed to load the compiled database.\n");
+        return false;
+    }
+
+    uint32_t mismatchCount = countDatabaseMismatches(database, binaryDatabase, true);
+
+    // A compiled database must be rejected if it doesn't match the JSON it's loaded with.
+    RT64::ReplacementDatabase staleDatabase;
+    if (staleDatabase.fromBinary(binaryBytes.data(), binaryBytes.size(), sourceHash + 1)) {
+        fprintf(stderr, "The compiled database was loaded with a different source hash.\n");
+        mismatchCount++;
+    }
+
+    // Both databases must resolve the files in the directory to the same hashes and operations.
+    RT64::ReplacementDatabase resolveJsonDatabase = database;
+    std::unique_ptr<RT64::FileSystem> fileSystem = RT64::FileSystemDirectory::create(directoryPath);
+    std::unordered_map<uint64_t, RT64::ReplacementResolvedPath> jsonResolvedPathMap;
+    std::unordered_map<uint64_t, RT64::ReplacementResolvedPath> binaryResolvedPathMap;
+    resolveJsonDatabase.resolvePaths(fileSystem.get(), jsonResolvedPathMap, false);
+    binaryDatabase.resolvePaths(fileSystem.get(), binaryResolvedPathMap, false);
+    if (jsonResolvedPathMap.size() != binaryResolvedPathMap.size()) {
+        fprintf(stderr, "Mismatch in resolved path count: expected %zu, got %zu.\n", jsonResolvedPathMap.size(), binaryResolvedPathMap.size());
+        mismatchCount++;
+    }
+
+    for (const auto &it : jsonResolvedPathMap) {
+        const std::string hashString = RT64::ReplacementDatabase::hashToString(it.first);
+        auto binaryIt = binaryResolvedPathMap.find(it.first);
+        if (binaryIt == binaryResolvedPathMap.end()) {
+            fprintf(stderr, "Mismatch in resolved path for hash %s: expected \"%s\", got nothing.\n", hashString.c_str(), it.second.relativePath.c_str());
+            mismatchCount++;
+        }
+        else if ((binaryIt->second.relativePath != it.second.relativePath) || (binaryIt->second.operation != it.second.operation)) {
+            fprintf(stderr, "Mismatch in resolved path for hash %s: expected \"%s\" (%u), got \"%s\" (%u).\n", hashString.c_str(), it.second.relativePath.c_str(),
+                uint32_t(it.second.operation), binaryIt->second.relativePath.c_str(), uint32_t(binaryIt->second.operation));
+            mismatchCount++;
+        }
+    }
+
+    fprintf(stdout, "Checked %zu textures, %zu operation filters and %zu resolved paths in %zu bytes: %u mismatches.\n", database.textures.size(),
+        database.operationFilters.size(), jsonResolvedPathMap.size(), binaryBytes.size(), mismatchCount);
+
+    return (mismatchCount == 0);
 }
 
 void showHelp() {
     fprintf(stdout,
         "texture_packer <path> --create-low-mip-cache\n"
         "\tGenerate the cache used for streaming textures in by extracting the lowest quality mipmaps.\n\n"
-        "texture_packer <path> --create-pack [--deflate] [--store] [--threads number]\n"
+        "texture_packer <path> --create-pack [--deflate] [--store] [--indexed] [--no-dictionary] [--threads number]\n"
         "\tCreate the pack by including all the textures supported by the database and the low mip cache.\n"
         "\tUse '--deflate' to downgrade the compression algorithm and make the resulting package compatible\n"
         "\twith more third-party zip software. This is not recommended as load times will be worse.\n"
@@ -149,7 +510,31 @@ void showHelp() {
         "\tthe speed of the storage where the pack is loaded from.\n"
         "\tUse '--threads number' to specify the amount of compression threads. By default, the tool will\n"
         "\tuse all threads of the system available.\n"
+        "\tThe database is also compiled into %s next to the JSON and included in the pack.\n"
+        "\tWhen using zstd, files up to %u KB are compressed with a dictionary trained on all of them, which is\n"
+        "\tsaved as %s and included in the pack. Use '--no-dictionary' to compress them individually.\n"
+        "\tUse '--indexed' to store the resolved database as a prebuilt index instead of creating a zip. The\n"
+        "\tresulting pack opens without scanning its contents, but can't be opened by third-party zip software.\n"
+        "\t\n"
+        "texture_packer <path> --benchmark-open [--count number]\n"
+        "\tWrite a synthetic zip pack and indexed pack with the specified amount of textures (100000 by default)\n"
+        "\tto the directory and measure the time it takes for the first texture to be available on each of them.\n"
         "\t\n"
+        "texture_packer <path> --benchmark-load [--count number]\n"
+        "\tWrite two synthetic zip packs with the specified amount of large textures (8 by default) to the directory,\n"
+        "\tone with each texture compressed as a single zstd frame and one with multiple frames, and measure the\n"
+        "\ttime it takes to load the textures from each of them.\n"
+        "texture_packer <path> --benchmark-dictionary [--count number]\n"
+        "\tWrite two synthetic zip packs with the specified amount of small textures (4000 by default) to the\n"
+        "\tdirectory, one compressed with a dictionary and one without it, and compare their size and load times.\n"
+        "\t\n"
+        "texture_packer <path> --check-database\n"
+        "\tCompile the database in the directory, load it back and compare every entry against the JSON, including\n"
+        "\tthe paths each of them resolves to. Reports every entry that doesn't match.\n"
+        "\t\n",
+        RT64::ReplacementDatabaseBinaryFilename.c_str(),
+        uint32_t(DictionaryFileMaxSize / 1024),
+        RT64::ZstdDecompressor::DictionaryFilename.c_str()
     );
 }
 
@@ -263,11 +648,402 @@ bool extractLowMipsToStream(const std::filesystem::path &directoryPath, const st
     return true;
 }
 
+bool benchmarkOpen(const std::filesystem::path &directoryPath, uint32_t textureCount) {
+    typedef std::chrono::high_resolution_clock Clock;
+    auto elapsedMs = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    // Generate a database and the contents of every texture. The contents are irrelevant to the time it takes to open the pack.
+    fprintf(stdout, "Generating %u synthetic textures...\n", textureCount);
+
+    RT64::ReplacementDatabase database;
+    std::unordered_map<uint64_t, RT64::ReplacementResolvedPath> resolvedPathMap;
+    uint64_t hashState = 0x9E3779B97F4A7C15ULL;
+    for (uint32_t i = 0; i < textureCount; i++) {
+        hashState ^= hashState << 13;
+        hashState ^= hashState >> 7;
+        hashState ^= hashState << 17;
+
+        RT64::ReplacementTexture texture;
+        texture.hashes.rt64 = RT64::ReplacementDatabase::hashToString(hashState);
+        texture.path = "textures/" + texture.hashes.rt64;
+        database.textures.emplace_back(texture);
+        resolvedPathMap[hashState] = { texture.path + ".dds", RT64::ReplacementOperation::Stream };
+    }
+
+    const std::string databaseString = json(database).dump();
+    const uint64_t firstHash = RT64::ReplacementDatabase::stringToHash(database.textures[textureCount / 2].hashes.rt64);
+    std::vector<uint8_t> textureBytes(4096);
+    for (size_t i = 0; i < textureBytes.size(); i++) {
+        textureBytes[i] = uint8_t(i * 31);
+    }
+
+    const uint32_t textureChecksum = mz_crc32(MZ_CRC32_INIT, textureBytes.data(), textureBytes.size());
+    const uint32_t databaseChecksum = mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const uint8_t *>(databaseString.data()), databaseString.size());
+
+    fprintf(stdout, "Writing synthetic packs...\n");
+
+    const std::filesystem::path zipPackPath = directoryPath / "benchmark-zip.rtz";
+    const std::filesystem::path indexedPackPath = directoryPath / "benchmark-indexed.rtz";
+    const std::string zipPackPathStr = zipPackPath.u8string();
+    mz_zip_archive zipArchive = {};
+    IndexedPackWriter indexedPackWriter;
+    if (!mz_zip_writer_init_file_v2(&zipArchive, zipPackPathStr.c_str(), 0, MZ_ZIP_FLAG_WRITE_ZIP64) || !indexedPackWriter.open(indexedPackPath)) {
+        fprintf(stderr, "Failed to open the synthetic packs for writing.\n");
+        return false;
+    }
+
+    bool writeFailed = false;
+    auto addFile = [&](const std::string &path, const uint8_t *data, size_t size, uint32_t checksum) {
+        writeFailed = writeFailed || !mz_zip_writer_add_mem_ex_v2(&zipArchive, path.c_str(), data, size, nullptr, 0, 0, 0, checksum, nullptr, nullptr, 0, nullptr, 0, 0);
+        writeFailed = writeFailed || !indexedPackWriter.addFile(path, data, size, size, RT64::FileSystemIndexedPack::Compression::None, checksum);
+    };
+
+    addFile(RT64::ReplacementDatabaseFilename, reinterpret_cast<const uint8_t *>(databaseString.data()), databaseString.size(), databaseChecksum);
+    for (const auto &it : resolvedPathMap) {
+        addFile(it.second.relativePath, textureBytes.data(), textureBytes.size(), textureChecksum);
+    }
+
+    writeFailed = writeFailed || !mz_zip_writer_finalize_archive(&zipArchive);
+    writeFailed = !mz_zip_writer_end(&zipArchive) || writeFailed;
+    writeFailed = writeFailed || !indexedPackWriter.finalize(resolvedPathMap, database.config.hashVersion);
+    if (writeFailed) {
+        fprintf(stderr, "Failed to write the synthetic packs.\n");
+        return false;
+    }
+
+    // Measure the same steps the texture cache goes through until the first replacement can be loaded.
+    std::vector<uint8_t> loadedBytes;
+    Clock::time_point zipStart = Clock::now();
+    double zipOpenMs = 0.0;
+    {
+        std::unique_ptr<RT64::FileSystem> fileSystem = RT64::FileSystemZip::create(zipPackPath, std::string());
+        zipOpenMs = elapsedMs(zipStart);
+
+        std::vector<uint8_t> databaseBytes;
+        RT64::ReplacementDatabase zipDatabase;
+        std::unordered_map<uint64_t, RT64::ReplacementResolvedPath> zipResolvedPathMap;
+        std::unordered_set<uint64_t> hashesToPreload;
+        if ((fileSystem == nullptr) || !fileSystem->load(RT64::ReplacementDatabaseFilename, databaseBytes)) {
+            fprintf(stderr, "Failed to open the synthetic zip pack.\n");
+            return false;
+        }
+
+        zipDatabase = json::parse(databaseBytes.begin(), databaseBytes.end(), nullptr, true);
+        zipDatabase.resolvePaths(fileSystem.get(), zipResolvedPathMap, false, nullptr, &hashesToPreload);
+
+        auto it = zipResolvedPathMap.find(firstHash);
+        if ((it == zipResolvedPathMap.end()) || !fileSystem->load(it->second.relativePath, loadedBytes)) {
+            fprintf(stderr, "Failed to load a texture from the synthetic zip pack.\n");
+            return false;
+        }
+    }
+
+    const double zipFirstTextureMs = elapsedMs(zipStart);
+
+    Clock::time_point indexedStart = Clock::now();
+    double indexedOpenMs = 0.0;
+    {
+        std::unique_ptr<RT64::FileSystemIndexedPack> fileSystem = RT64::FileSystemIndexedPack::create(indexedPackPath);
+        indexedOpenMs = elapsedMs(indexedStart);
+
+        const RT64::FileSystemIndexedPack::HashEntry *hashEntry = (fileSystem != nullptr) ? fileSystem->findHash(firstHash) : nullptr;
+        if ((hashEntry == nullptr) || !fileSystem->load(fileSystem->getPath(hashEntry->fileIndex), loadedBytes)) {
+            fprintf(stderr, "Failed to load a texture from the synthetic indexed pack.\n");
+            return false;
+        }
+    }
+
+    const double indexedFirstTextureMs = elapsedMs(indexedStart);
+
+    fprintf(stdout, "Textures: %u\n", textureCount);
+    fprintf(stdout, "Zip pack: open %.3f ms, first texture %.3f ms\n", zipOpenMs, zipFirstTextureMs);
+    fprintf(stdout, "Indexed pack: open %.3f ms, first texture %.3f ms\n", indexedOpenMs, indexedFirstTextureMs);
+
+    std::error_code ec;
+    std::filesystem::remove(zipPackPath, ec);
+    std::filesystem::remove(indexedPackPath, ec);
+    return true;
+}
+
+bool benchmarkLoad(const std::filesystem::path &directoryPath, uint32_t textureCount) {
+    typedef std::chrono::high_resolution_clock Clock;
+    auto elapsedMs = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    // About the size of a 4096x4096 BC7 texture with all of its mipmaps. The contents only need to compress about as well as one.
+    const size_t TextureSize = 22 * 1024 * 1024;
+    const int CompressionLevel = 3;
+    const uint32_t LoadRounds = 4;
+    fprintf(stdout, "Generating %u synthetic textures...\n", textureCount);
+
+    std::vector<std::vector<uint8_t>> textureBytes(textureCount);
+    uint64_t randomState = 0x9E3779B97F4A7C15ULL;
+    for (std::vector<uint8_t> &bytes : textureBytes) {
+        bytes.resize(TextureSize);
+        for (size_t i = 0; i < TextureSize; i++) {
+            randomState ^= randomState << 13;
+            randomState ^= randomState >> 7;
+            randomState ^= randomState << 17;
+            bytes[i] = uint8_t((randomState & 0x1F) + (i / 4096));
+        }
+    }
+
+    fprintf(stdout, "Writing synthetic packs...\n");
+
+    const std::filesystem::path singleFramePackPath = directoryPath / "benchmark-single-frame.rtz";
+    const std::filesystem::path multiFramePackPath = directoryPath / "benchmark-multi-frame.rtz";
+    auto writePack = [&](const std::filesystem::path &packPath, bool multiFrame) {
+        const std::string packPathStr = packPath.u8string();
+        mz_zip_archive zipArchive = {};
+        if (!mz_zip_writer_init_file_v2(&zipArchive, packPathStr.c_str(), 0, MZ_ZIP_FLAG_WRITE_ZIP64)) {
+            return false;
+        }
+
+        bool writeFailed = false;
+        std::vector<uint8_t> compressedBytes(ZSTD_compressBound(TextureSize) + ZSTD_compressBound(ZstdFrameSize) * (TextureSize / ZstdFrameSize));
+        for (uint32_t i = 0; (i < textureCount) && !writeFailed; i++) {
+            const std::vector<uint8_t> &bytes = textureBytes[i];
+            size_t compressedSize = 0;
+            if (multiFrame) {
+                compressedSize = compressZstdFrames(compressedBytes.data(), compressedBytes.size(), bytes.data(), bytes.size(), CompressionLevel);
+            }
+            else {
+                compressedSize = ZSTD_compress(compressedBytes.data(), compressedBytes.size(), bytes.data(), bytes.size(), CompressionLevel);
+                compressedSize = ZSTD_isError(compressedSize) ? 0 : compressedSize;
+            }
+
+            const std::string path = "textures/" + std::to_string(i) + ".dds";
+            const uint32_t checksum = mz_crc32(MZ_CRC32_INIT, bytes.data(), bytes.size());
+            writeFailed = (compressedSize == 0) || !mz_zip_writer_add_mem_ex_v2(&zipArchive, path.c_str(), compressedBytes.data(), compressedSize, nullptr, 0, MZ_ZIP_FLAG_COMPRESSED_DATA, bytes.size(), checksum, nullptr, nullptr, 0, nullptr, 0, MZ_ZSTD);
+        }
+
+        writeFailed = writeFailed || !mz_zip_writer_finalize_archive(&zipArchive);
+        writeFailed = !mz_zip_writer_end(&zipArchive) || writeFailed;
+        return !writeFailed;
+    };
+
+    if (!writePack(singleFramePackPath, false) || !writePack(multiFramePackPath, true)) {
+        fprintf(stderr, "Failed to write the synthetic packs.\n");
+        return false;
+    }
+
+    // Load every texture a few times from each pack and verify the contents.
+    auto measurePack = [&](const std::filesystem::path &packPath, double &averageMs) {
+        std::unique_ptr<RT64::FileSystem> fileSystem = RT64::FileSystemZip::create(packPath, std::string());
+        if (fileSystem == nullptr) {
+            return false;
+        }
+
+        std::vector<uint8_t> loadedBytes;
+        double totalMs = 0.0;
+        for (uint32_t r = 0; r < LoadRounds; r++) {
+            for (uint32_t i = 0; i < textureCount; i++) {
+                const std::string path = "textures/" + std::to_string(i) + ".dds";
+                Clock::time_point loadStart = Clock::now();
+                if (!fileSystem->load(path, loadedBytes)) {
+                    return false;
+                }
+
+                totalMs += elapsedMs(loadStart);
+
+                if (loadedBytes != textureBytes[i]) {
+                    return false;
+                }
+            }
+        }
+
+        averageMs = totalMs / (LoadRounds * textureCount);
+        return true;
+    };
+
+    double singleFrameMs = 0.0;
+    double multiFrameMs = 0.0;
+    if (!measurePack(singleFramePackPath, singleFrameMs) || !measurePack(multiFramePackPath, multiFrameMs)) {
+        fprintf(stderr, "Failed to load the textures from the synthetic packs.\n");
+        return false;
+    }
+
+    const uint32_t decompressionThreads = RT64::ZstdDecompressor::get().taskPool->getThreadCount();
+    fprintf(stdout, "Textures: %u of %.1f MB\n", textureCount, TextureSize / (1024.0 * 1024.0));
+    fprintf(stdout, "Single frame: %.3f ms per texture\n", singleFrameMs);
+    fprintf(stdout, "Multiple frames: %.3f ms per texture (%u decompression threads and the loading thread)\n", multiFrameMs, decompressionThreads);
+
+    std::error_code ec;
+    std::filesystem::remove(singleFramePackPath, ec);
+    std::filesystem::remove(multiFramePackPath, ec);
+    return true;
+}
+
+bool benchmarkDictionary(const std::filesystem::path &directoryPath, uint32_t textureCount) {
+    typedef std::chrono::high_resolution_clock Clock;
+    auto elapsedMs = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    // Small textures share most of their header and have payloads with a similar structure, which is what the dictionary exploits.
+    const uint32_t LoadRounds = 4;
+    fprintf(stdout, "Generating %u synthetic textures...\n", textureCount);
+
+    std::vector<std::vector<uint8_t>> textureBytes(textureCount);
+    std::vector<size_t> textureSizes(textureCount);
+    uint64_t randomState = 0x9E3779B97F4A7C15ULL;
+    auto random = [&]() {
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 7;
+        randomState ^= randomState << 17;
+        return randomState;
+    };
+
+    for (uint32_t i = 0; i < textureCount; i++) {
+        const uint32_t dimension = 16U << (random() % 4);
+        std::vector<uint8_t> &bytes = textureBytes[i];
+        bytes.resize(128 + (dimension * dimension));
+        memcpy(bytes.data(), "DDS |", 5);
+        bytes[12] = uint8_t(dimension);
+        bytes[16] = uint8_t(dimension);
+        bytes[84] = 'D';
+        bytes[85] = 'X';
+        bytes[86] = 'T';
+        bytes[87] = '5';
+        for (size_t j = 128; j < bytes.size(); j += 16) {
+            // Blocks of two endpoints followed by the indices, with the endpoints drawn from a small palette.
+            const uint64_t blockRandom = random();
+            bytes[j + 0] = 0xFF;
+            bytes[j + 1] = 0x00;
+            bytes[j + 8] = uint8_t(0xF8 - ((blockRandom & 0x7) << 3));
+            bytes[j + 9] = uint8_t(0x1F + ((blockRandom >> 3) & 0x3));
+            bytes[j + 10] = uint8_t(0x40 + ((blockRandom >> 5) & 0x7));
+            bytes[j + 11] = 0x08;
+            for (size_t k = 12; k < 16; k++) {
+                bytes[j + k] = uint8_t((blockRandom >> (k * 4)) & 0x55);
+            }
+        }
+
+        textureSizes[i] = bytes.size();
+    }
+
+    std::vector<uint8_t> samplesBytes;
+    for (const std::vector<uint8_t> &bytes : textureBytes) {
+        samplesBytes.insert(samplesBytes.end(), bytes.begin(), bytes.end());
+    }
+
+    std::vector<uint8_t> dictionaryBytes(std::min(DictionaryMaxSize, samplesBytes.size() / 10));
+    const size_t dictionarySize = ZDICT_trainFromBuffer(dictionaryBytes.data(), dictionaryBytes.size(), samplesBytes.data(), textureSizes.data(), textureCount);
+    if (ZDICT_isError(dictionarySize)) {
+        fprintf(stderr, "Failed to train the zstd dictionary: %s.\n", ZDICT_getErrorName(dictionarySize));
+        return false;
+    }
+
+    dictionaryBytes.resize(dictionarySize);
+
+    fprintf(stdout, "Writing synthetic packs...\n");
+
+    const std::filesystem::path plainPackPath = directoryPath / "benchmark-no-dictionary.rtz";
+    const std::filesystem::path dictionaryPackPath = directoryPath / "benchmark-dictionary.rtz";
+    auto writePack = [&](const std::filesystem::path &packPath, bool useDictionary) {
+        const std::string packPathStr = packPath.u8string();
+        mz_zip_archive zipArchive = {};
+        if (!mz_zip_writer_init_file_v2(&zipArchive, packPathStr.c_str(), 0, MZ_ZIP_FLAG_WRITE_ZIP64)) {
+            return false;
+        }
+
+        ZSTD_CCtx *context = ZSTD_createCCtx();
+        ZSTD_CDict *dictionary = useDictionary ? ZSTD_createCDict(dictionaryBytes.data(), dictionaryBytes.size(), ZSTD_maxCLevel()) : nullptr;
+        std::vector<uint8_t> compressedBytes;
+        bool writeFailed = (context == nullptr) || (useDictionary && (dictionary == nullptr));
+        auto addFile = [&](const std::string &path, const std::vector<uint8_t> &bytes, bool compressWithDictionary) {
+            compressedBytes.resize(ZSTD_compressBound(bytes.size()));
+
+            size_t compressedSize = 0;
+            if (compressWithDictionary) {
+                compressedSize = ZSTD_compress_usingCDict(context, compressedBytes.data(), compressedBytes.size(), bytes.data(), bytes.size(), dictionary);
+            }
+            else {
+                compressedSize = ZSTD_compressCCtx(context, compressedBytes.data(), compressedBytes.size(), bytes.data(), bytes.size(), ZSTD_maxCLevel());
+            }
+
+            const uint32_t checksum = mz_crc32(MZ_CRC32_INIT, bytes.data(), bytes.size());
+            writeFailed = writeFailed || ZSTD_isError(compressedSize) || !mz_zip_writer_add_mem_ex_v2(&zipArchive, path.c_str(), compressedBytes.data(), compressedSize, nullptr, 0, MZ_ZIP_FLAG_COMPRESSED_DATA, bytes.size(), checksum, nullptr, nullptr, 0, nullptr, 0, MZ_ZSTD);
+        };
+
+        if (useDictionary) {
+            addFile(RT64::ZstdDecompressor::DictionaryFilename, dictionaryBytes, false);
+        }
+
+        for (uint32_t i = 0; (i < textureCount) && !writeFailed; i++) {
+            addFile("textures/" + std::to_string(i) + ".dds", textureBytes[i], useDictionary);
+        }
+
+        ZSTD_freeCDict(dictionary);
+        ZSTD_freeCCtx(context);
+        writeFailed = writeFailed || !mz_zip_writer_finalize_archive(&zipArchive);
+        writeFailed = !mz_zip_writer_end(&zipArchive) || writeFailed;
+        return !writeFailed;
+    };
+
+    if (!writePack(plainPackPath, false) || !writePack(dictionaryPackPath, true)) {
+        fprintf(stderr, "Failed to write the synthetic packs.\n");
+        return false;
+    }
+
+    // Load every texture a few times from each pack and verify the contents.
+    auto measurePack = [&](const std::filesystem::path &packPath, double &averageMs) {
+        std::unique_ptr<RT64::FileSystem> fileSystem = RT64::FileSystemZip::create(packPath, std::string());
+        if (fileSystem == nullptr) {
+            return false;
+        }
+
+        std::vector<uint8_t> loadedBytes;
+        double totalMs = 0.0;
+        for (uint32_t r = 0; r < LoadRounds; r++) {
+            for (uint32_t i = 0; i < textureCount; i++) {
+                const std::string path = "textures/" + std::to_string(i) + ".dds";
+                Clock::time_point loadStart = Clock::now();
+                if (!fileSystem->load(path, loadedBytes)) {
+                    return false;
+                }
+
+                totalMs += elapsedMs(loadStart);
+
+                if (loadedBytes != textureBytes[i]) {
+                    return false;
+                }
+            }
+        }
+
+        averageMs = totalMs / (LoadRounds * textureCount);
+        return true;
+    };
+
+    double plainMs = 0.0;
+    double dictionaryMs = 0.0;
+    if (!measurePack(plainPackPath, plainMs) || !measurePack(dictionaryPackPath, dictionaryMs)) {
+        fprintf(stderr, "Failed to load the textures from the synthetic packs.\n");
+        return false;
+    }
+
+    std::error_code ec;
+    fprintf(stdout, "Textures: %u, %.1f KB on average\n", textureCount, samplesBytes.size() / (1024.0 * textureCount));
+    fprintf(stdout, "Without dictionary: pack %.1f KB, %.4f ms per texture\n", std::filesystem::file_size(plainPackPath, ec) / 1024.0, plainMs);
+    fprintf(stdout, "With dictionary: pack %.1f KB (dictionary of %.1f KB), %.4f ms per texture\n", std::filesystem::file_size(dictionaryPackPath, ec) / 1024.0, dictionaryBytes.size() / 1024.0, dictionaryMs);
+
+    std::filesystem::remove(plainPackPath, ec);
+    std::filesystem::remove(dictionaryPackPath, ec);
+    return true;
+}
+
 int main(int argc, char *argv[]) {
     enum class Mode {
         Unknown,
         CreateLowMipCache,
-        CreatePack
+        CreatePack,
+        BenchmarkOpen,
+        BenchmarkLoad,
+        BenchmarkDictionary,
+        CheckDatabase
     };
 
     plainargs::Result args = plainargs::parse(argc, argv);
@@ -293,12 +1069,44 @@ int main(int argc, char *argv[]) {
         fprintf(stdout, "Creating pack.\n");
         mode = Mode::CreatePack;
     }
+    else if (args.hasOption("benchmark-open", "b")) {
+        fprintf(stdout, "Benchmarking pack opening.\n");
+        mode = Mode::BenchmarkOpen;
+    }
+    else if (args.hasOption("benchmark-load", "l")) {
+        fprintf(stdout, "Benchmarking texture loading.\n");
+        mode = Mode::BenchmarkLoad;
+    }
+    else if (args.hasOption("benchmark-dictionary", "y")) {
+        fprintf(stdout, "Benchmarking dictionary compression.\n");
+        mode = Mode::BenchmarkDictionary;
+    }
+    else if (args.hasOption("check-database", "k")) {
+        fprintf(stdout, "Checking compiled database.\n");
+        mode = Mode::CheckDatabase;
+    }
     else {
         fprintf(stderr, "No operation mode was specified.\n");
         showHelp();
         return 1;
     }
 
+    if (mode == Mode::BenchmarkOpen) {
+        std::string countValue = args.getValue("count", "c");
+        uint32_t textureCount = countValue.empty() ? 100000 : std::stoi(countValue);
+        return benchmarkOpen(searchDirectory, std::max(textureCount, 1U)) ? 0 : 1;
+    }
+    else if (mode == Mode::BenchmarkLoad) {
+        std::string countValue = args.getValue("count", "c");
+        uint32_t textureCount = countValue.empty() ? 8 : std::stoi(countValue);
+        return benchmarkLoad(searchDirectory, std::max(textureCount, 1U)) ? 0 : 1;
+    }
+    else if (mode == Mode::BenchmarkDictionary) {
+        std::string countValue = args.getValue("count", "c");
+        uint32_t textureCount = countValue.empty() ? 4000 : std::stoi(countValue);
+        return benchmarkDictionary(searchDirectory, std::max(textureCount, uint32_t(DictionaryMinSamples))) ? 0 : 1;
+    }
+
     RT64::ReplacementDatabase database;
     std::filesystem::path databasePath = searchDirectory / RT64::ReplacementDatabaseFilename;
     if (!std::filesystem::exists(databasePath)) {
@@ -328,6 +1136,10 @@ int main(int argc, char *argv[]) {
         databaseStream.close();
     }
 
+    if (mode == Mode::CheckDatabase) {
+        return checkDatabase(searchDirectory, database) ? 0 : 1;
+    }
+
     fprintf(stdout, "Resolving database paths...\n");
 
     // Resolve all paths for the database and build a unique set of files.
@@ -389,6 +1201,7 @@ int main(int argc, char *argv[]) {
 
         compressionFailed = false;
 
+        const bool createIndexed = args.hasOption("indexed", "i");
         mz_uint16 compressionMethod = MZ_ZSTD;
         if (args.hasOption("deflate", "d")) {
             fprintf(stdout, "Using deflate for compression.\n");
@@ -443,31 +1256,75 @@ int main(int argc, char *argv[]) {
         std::filesystem::path packPath = searchDirectory / packName;
         std::string packPathStr = packPath.u8string();
         mz_zip_archive zipArchive = {};
-        if (!mz_zip_writer_init_file_v2(&zipArchive, packPathStr.c_str(), 0, MZ_ZIP_FLAG_WRITE_ZIP64)) {
+        IndexedPackWriter indexedPackWriter;
+        if (createIndexed) {
+            fprintf(stdout, "Using the indexed pack format.\n");
+
+            if (!indexedPackWriter.open(packPath)) {
+                fprintf(stderr, "Failed to open %s for writing.\n", packPathStr.c_str());
+                return 1;
+            }
+        }
+        else if (!mz_zip_writer_init_file_v2(&zipArchive, packPathStr.c_str(), 0, MZ_ZIP_FLAG_WRITE_ZIP64)) {
             fprintf(stderr, "Failed to open %s for writing.\n", packPathStr.c_str());
             return 1;
         }
 
+        RT64::FileSystemIndexedPack::Compression indexedCompression = RT64::FileSystemIndexedPack::Compression::None;
+        if (useCompression) {
+            indexedCompression = useZstd ? RT64::FileSystemIndexedPack::Compression::Zstd : RT64::FileSystemIndexedPack::Compression::Deflate;
+        }
+
         uint32_t outputQueueTotal = 0;
-        auto addToQueue = [&](const std::string &file) {
+        auto addToQueue = [&](const std::string &file, bool allowDictionary) {
             CompressionInput input;
             input.filePath = searchDirectory / std::filesystem::u8path(file);
             input.zipPath = file;
+            input.allowDictionary = allowDictionary;
             inputQueue.emplace(input);
             outputQueueTotal++;
         };
 
+        // Train the dictionary for the small files and add it to the queue. The dictionary itself is compressed without it.
+        if (useZstd && !args.hasOption("no-dictionary", "n")) {
+            std::vector<uint8_t> dictionaryBytes;
+            if (trainDictionary(searchDirectory, resolvedPathSet, dictionaryBytes)) {
+                const std::filesystem::path dictionaryPath = searchDirectory / std::filesystem::u8path(RT64::ZstdDecompressor::DictionaryFilename);
+                std::ofstream dictionaryStream(dictionaryPath, std::ios::binary);
+                dictionaryStream.write(reinterpret_cast<const char *>(dictionaryBytes.data()), dictionaryBytes.size());
+                dictionaryStream.close();
+
+                compressionDictionary = ZSTD_createCDict(dictionaryBytes.data(), dictionaryBytes.size(), ZSTD_maxCLevel());
+                if (dictionaryStream.bad() || (compressionDictionary == nullptr)) {
+                    fprintf(stderr, "Failed to create the zstd dictionary.\n");
+                    compressionFailed = true;
+                }
+                else {
+                    fprintf(stdout, "Trained a zstd dictionary of %zu bytes for the small files.\n", dictionaryBytes.size());
+                }
+
+                addToQueue(RT64::ZstdDecompressor::DictionaryFilename, false);
+            }
+        }
+
         // Add all resolved files to queue.
         for (auto it : resolvedPathSet) {
-            addToQueue(it);
+            addToQueue(it, true);
         }
 
         // Add database file to queue.
-        addToQueue(RT64::ReplacementDatabaseFilename);
+        addToQueue(RT64::ReplacementDatabaseFilename, false);
+
+        // Compile the database next to the JSON and add it to the queue as well.
+        if (!createDatabaseBinary(searchDirectory, database)) {
+            compressionFailed = true;
+        }
+
+        addToQueue(RT64::ReplacementDatabaseBinaryFilename, false);
 
         // Add low mip cache if it exists. Warn user that the file does not exist.
         if (std::filesystem::exists(searchDirectory / std::filesystem::u8path(RT64::ReplacementLowMipCacheFilename))) {
-            addToQueue(RT64::ReplacementLowMipCacheFilename);
+            addToQueue(RT64::ReplacementLowMipCacheFilename, false);
         }
         else {
             fprintf(stderr, "Unable to find %s. Make sure to generate this file using --create-low-mip-cache before creating the texture pack so DDS files can have proper streaming.\n", RT64::ReplacementLowMipCacheFilename.c_str());
@@ -497,7 +1354,13 @@ int main(int argc, char *argv[]) {
 
                 if (!output.zipPath.empty()) {
                     mz_uint flags = useCompression ? MZ_ZIP_FLAG_COMPRESSED_DATA : 0;
-                    if (!mz_zip_writer_add_mem_ex_v2(&zipArchive, output.zipPath.c_str(), output.fileData.data(), output.fileData.size(), nullptr, 0, flags, useCompression ? output.uncompressedSize : 0, output.checksum, nullptr, nullptr, 0, nullptr, 0, compressionMethod)) {
+                    if (createIndexed) {
+                        if (!indexedPackWriter.addFile(output.zipPath, output.fileData.data(), output.fileData.size(), output.uncompressedSize, indexedCompression, output.checksum)) {
+                            fprintf(stderr, "Failed to add %s to pack.\n", output.zipPath.c_str());
+                            compressionFailed = true;
+                        }
+                    }
+                    else if (!mz_zip_writer_add_mem_ex_v2(&zipArchive, output.zipPath.c_str(), output.fileData.data(), output.fileData.size(), nullptr, 0, flags, useCompression ? output.uncompressedSize : 0, output.checksum, nullptr, nullptr, 0, nullptr, 0, compressionMethod)) {
                         fprintf(stderr, "Failed to add %s to pack.\n", output.zipPath.c_str());
                         compressionFailed = true;
                     }
@@ -515,16 +1378,29 @@ int main(int argc, char *argv[]) {
             }
         }
 
-        if (!compressionFailed) {
-            if (!mz_zip_writer_finalize_archive(&zipArchive)) {
-                fprintf(stderr, "Failed to finalize archive %s.\n", packPathStr.c_str());
+        ZSTD_freeCDict(compressionDictionary);
+        compressionDictionary = nullptr;
+
+        if (createIndexed) {
+            if (!compressionFailed && !indexedPackWriter.finalize(resolvedPathMap, database.config.hashVersion)) {
+                fprintf(stderr, "Failed to finalize indexed pack %s.\n", packPathStr.c_str());
                 compressionFailed = true;
             }
+
+            indexedPackWriter.stream.close();
         }
+        else {
+            if (!compressionFailed) {
+                if (!mz_zip_writer_finalize_archive(&zipArchive)) {
+                    fprintf(stderr, "Failed to finalize archive %s.\n", packPathStr.c_str());
+                    compressionFailed = true;
+                }
+            }
 
-        if (!mz_zip_writer_end(&zipArchive)) {
-            fprintf(stderr, "Failed to close %s for writing.\n", packPathStr.c_str());
-            compressionFailed = true;
+            if (!mz_zip_writer_end(&zipArchive)) {
+                fprintf(stderr, "Failed to close %s for writing.\n", packPathStr.c_str());
+                compressionFailed = true;
+            }
         }
 
         if (compressionFailed) {
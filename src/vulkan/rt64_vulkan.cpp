@@ -1137,6 +1137,119 @@ namespace RT64 {
         }
     }
 
+    // VulkanPipelineCache
+
+    VulkanPipelineCache::VulkanPipelineCache(VulkanDevice *device, const void *data, uint64_t size) {
+        assert(device != nullptr);
+
+        this->device = device;
+
+        // The driver validates the header of the initial data and ignores it if it was created by a different device or driver.
+        VkPipelineCacheCreateInfo cacheInfo = {};
+        cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        cacheInfo.pInitialData = data;
+        cacheInfo.initialDataSize = (data != nullptr) ? size_t(size) : 0;
+
+        VkResult res = vkCreatePipelineCache(device->vk, &cacheInfo, nullptr, &vk);
+        if ((res != VK_SUCCESS) && (cacheInfo.initialDataSize > 0)) {
+            // Retry with an empty cache if the initial data was rejected.
+            cacheInfo.pInitialData = nullptr;
+            cacheInfo.initialDataSize = 0;
+            res = vkCreatePipelineCache(device->vk, &cacheInfo, nullptr, &vk);
+        }
+
+        if (res != VK_SUCCESS) {
+            fprintf(stderr, "vkCreatePipelineCache failed with error code 0x%X.\n", res);
+            return;
+        }
+    }
+
+    VulkanPipelineCache::~VulkanPipelineCache() {
+        if (vk != VK_NULL_HANDLE) {
+            vkDestroyPipelineCache(device->vk, vk, nullptr);
+        }
+    }
+
+    bool VulkanPipelineCache::getData(std::vector<uint8_t> &data) {
+        if (vk == VK_NULL_HANDLE) {
+            return false;
+        }
+
+        size_t dataSize = 0;
+        VkResult res = vkGetPipelineCacheData(device->vk, vk, &dataSize, nullptr);
+        if (res != VK_SUCCESS) {
+            fprintf(stderr, "vkGetPipelineCacheData failed with error code 0x%X.\n", res);
+            return false;
+        }
+
+        data.resize(dataSize);
+        res = vkGetPipelineCacheData(device->vk, vk, &dataSize, data.data());
+        if ((res != VK_SUCCESS) && (res != VK_INCOMPLETE)) {
+            fprintf(stderr, "vkGetPipelineCacheData failed with error code 0x%X.\n", res);
+            return false;
+        }
+
+        data.resize(dataSize);
+        return true;
+    }
+
+    // VulkanQueryPool
+
+    VulkanQueryPool::VulkanQueryPool(VulkanDevice *device, uint32_t queryCount) {
+        assert(device != nullptr);
+        assert(queryCount > 0);
+
+        this->device = device;
+
+        VkQueryPoolCreateInfo queryPoolInfo = {};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolInfo.queryCount = queryCount;
+
+        VkResult res = vkCreateQueryPool(device->vk, &queryPoolInfo, nullptr, &vk);
+        if (res != VK_SUCCESS) {
+            fprintf(stderr, "vkCreateQueryPool failed with error code 0x%X.\n", res);
+            return;
+        }
+
+        results.resize(queryCount, 0);
+    }
+
+    VulkanQueryPool::~VulkanQueryPool() {
+        if (vk != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(device->vk, vk, nullptr);
+        }
+    }
+
+    void VulkanQueryPool::queryResults() {
+        if (vk == VK_NULL_HANDLE) {
+            return;
+        }
+
+        // Queries that were never written are left with a value of zero instead of waiting for them.
+        thread_local std::vector<uint64_t> resultsWithAvailability;
+        resultsWithAvailability.resize(results.size() * 2);
+        VkResult res = vkGetQueryPoolResults(device->vk, vk, 0, uint32_t(results.size()), resultsWithAvailability.size() * sizeof(uint64_t), resultsWithAvailability.data(), sizeof(uint64_t) * 2, VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        if ((res != VK_SUCCESS) && (res != VK_NOT_READY)) {
+            fprintf(stderr, "vkGetQueryPoolResults failed with error code 0x%X.\n", res);
+            return;
+        }
+
+        const double timestampPeriod = double(device->physicalDeviceProperties.limits.timestampPeriod);
+        for (size_t i = 0; i < results.size(); i++) {
+            const bool available = (resultsWithAvailability[i * 2 + 1] != 0);
+            results[i] = available ? uint64_t(double(resultsWithAvailability[i * 2]) * timestampPeriod) : 0;
+        }
+    }
+
+    const uint64_t *VulkanQueryPool::getResults() const {
+        return results.data();
+    }
+
+    uint32_t VulkanQueryPool::getCount() const {
+        return uint32_t(results.size());
+    }
+
     // VulkanShader
 
     VulkanShader::VulkanShader(VulkanDevice *device, const void *data, uint64_t size, const char *entryPointName, RenderShaderFormat format) {
@@ -1459,7 +1572,10 @@ namespace RT64 {
         pipelineInfo.layout = pipelineLayout->vk;
         pipelineInfo.renderPass = renderPass;
 
-        VkResult res = vkCreateGraphicsPipelines(device->vk, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &vk);
+        // Vulkan pipeline caches are keyed by the contents of the description, so the key isn't required.
+        const VulkanPipelineCache *pipelineCache = static_cast<const VulkanPipelineCache *>(desc.pipelineCache);
+        VkPipelineCache vkPipelineCache = (pipelineCache != nullptr) ? pipelineCache->vk : VK_NULL_HANDLE;
+        VkResult res = vkCreateGraphicsPipelines(device->vk, vkPipelineCache, 1, &pipelineInfo, nullptr, &vk);
         if (res != VK_SUCCESS) {
             fprintf(stderr, "vkCreateGraphicsPipelines failed with error code 0x%X.\n", res);
             return;
@@ -3018,6 +3134,23 @@ namespace RT64 {
         vkCmdBuildAccelerationStructuresKHR(vk, 1, &buildGeometryInfo, &buildRangeInfoPtr);
     }
 
+    void VulkanCommandList::resetQueryPool(const RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) {
+        assert(queryPool != nullptr);
+
+        // Query pools can't be reset inside a render pass.
+        endActiveRenderPass();
+
+        const VulkanQueryPool *interfaceQueryPool = static_cast<const VulkanQueryPool *>(queryPool);
+        vkCmdResetQueryPool(vk, interfaceQueryPool->vk, queryFirstIndex, queryCount);
+    }
+
+    void VulkanCommandList::writeTimestamp(const RenderQueryPool *queryPool, uint32_t queryIndex) {
+        assert(queryPool != nullptr);
+
+        const VulkanQueryPool *interfaceQueryPool = static_cast<const VulkanQueryPool *>(queryPool);
+        vkCmdWriteTimestamp(vk, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, interfaceQueryPool->vk, queryIndex);
+    }
+
     void VulkanCommandList::checkActiveRenderPass() {
         assert(targetFramebuffer != nullptr);
         
@@ -3320,6 +3453,8 @@ namespace RT64 {
             if (preferOption) {
                 physicalDevice = physicalDevices[i];
                 description.name = std::string(deviceProperties.deviceName);
+                description.vendorId = deviceProperties.vendorID;
+                description.deviceId = deviceProperties.deviceID;
                 description.driverVersion = deviceProperties.driverVersion;
                 currentDeviceTypeScore = deviceTypeScore;
             }
@@ -3602,6 +3737,7 @@ namespace RT64 {
         capabilities.presentWait = presentWait;
         capabilities.displayTiming = supportedOptionalExtensions.find(VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME) != supportedOptionalExtensions.end();
         capabilities.preferHDR = memoryHeapSize > (512 * 1024 * 1024);
+        capabilities.timestampQueries = physicalDeviceProperties.limits.timestampComputeAndGraphics && (physicalDeviceProperties.limits.timestampPeriod > 0.0f);
 
         // Fill Vulkan-only capabilities.
         loadStoreOpNoneSupported = supportedOptionalExtensions.find(VK_EXT_LOAD_STORE_OP_NONE_EXTENSION_NAME) != supportedOptionalExtensions.end();
@@ -3675,6 +3811,14 @@ namespace RT64 {
         return std::make_unique<VulkanFramebuffer>(this, desc);
     }
 
+    std::unique_ptr<RenderPipelineCache> VulkanDevice::createPipelineCache(const void *data, uint64_t size) {
+        return std::make_unique<VulkanPipelineCache>(this, data, size);
+    }
+
+    std::unique_ptr<RenderQueryPool> VulkanDevice::createQueryPool(uint32_t queryCount) {
+        return std::make_unique<VulkanQueryPool>(this, queryCount);
+    }
+
     void VulkanDevice::setBottomLevelASBuildInfo(RenderBottomLevelASBuildInfo &buildInfo, const RenderBottomLevelASMesh *meshes, uint32_t meshCount, bool preferFastBuild, bool preferFastTrace) {
         assert(meshes != nullptr);
         assert(meshCount > 0);
@@ -118,6 +118,27 @@ namespace RT64 {
         ~VulkanPipelineLayout() override;
     };
 
+    struct VulkanPipelineCache : RenderPipelineCache {
+        VkPipelineCache vk = VK_NULL_HANDLE;
+        VulkanDevice *device = nullptr;
+
+        VulkanPipelineCache(VulkanDevice *device, const void *data, uint64_t size);
+        ~VulkanPipelineCache() override;
+        bool getData(std::vector<uint8_t> &data) override;
+    };
+
+    struct VulkanQueryPool : RenderQueryPool {
+        VkQueryPool vk = VK_NULL_HANDLE;
+        VulkanDevice *device = nullptr;
+        std::vector<uint64_t> results;
+
+        VulkanQueryPool(VulkanDevice *device, uint32_t queryCount);
+        ~VulkanQueryPool() override;
+        void queryResults() override;
+        const uint64_t *getResults() const override;
+        uint32_t getCount() const override;
+    };
+
     struct VulkanShader : RenderShader {
         VkShaderModule vk = VK_NULL_HANDLE;
         std::string entryPointName;
@@ -292,6 +313,8 @@ namespace RT64 {
         void resolveTextureRegion(const RenderTexture *dstTexture, uint32_t dstX, uint32_t dstY, const RenderTexture *srcTexture, const RenderRect *srcRect) override;
         void buildBottomLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, const RenderBottomLevelASBuildInfo &buildInfo) override;
         void buildTopLevelAS(const RenderAccelerationStructure *dstAccelerationStructure, RenderBufferReference scratchBuffer, RenderBufferReference instancesBuffer, const RenderTopLevelASBuildInfo &buildInfo) override;
+        void resetQueryPool(const RenderQueryPool *queryPool, uint32_t queryFirstIndex, uint32_t queryCount) override;
+        void writeTimestamp(const RenderQueryPool *queryPool, uint32_t queryIndex) override;
         void checkActiveRenderPass();
         void endActiveRenderPass();
         void setDescriptorSet(VkPipelineBindPoint bindPoint, const VulkanPipelineLayout *pipelineLayout, const RenderDescriptorSet *descriptorSet, uint32_t setIndex);
@@ -382,6 +405,8 @@ namespace RT64 {
         std::unique_ptr<RenderCommandFence> createCommandFence() override;
         std::unique_ptr<RenderCommandSemaphore> createCommandSemaphore() override;
         std::unique_ptr<RenderFramebuffer> createFramebuffer(const RenderFramebufferDesc &desc) override;
+        std::unique_ptr<RenderPipelineCache> createPipelineCache(const void *data, uint64_t size) override;
+        std::unique_ptr<RenderQueryPool> createQueryPool(uint32_t queryCount) override;
         void setBottomLevelASBuildInfo(RenderBottomLevelASBuildInfo &buildInfo, const RenderBottomLevelASMesh *meshes, uint32_t meshCount, bool preferFastBuild, bool preferFastTrace) override;
         void setTopLevelASBuildInfo(RenderTopLevelASBuildInfo &buildInfo, const RenderTopLevelASInstance *instances, uint32_t instanceCount, bool preferFastBuild, bool preferFastTrace) override;
         void setShaderBindingTableInfo(RenderShaderBindingTableInfo &tableInfo, const RenderShaderBindingGroups &groups, const RenderPipeline *pipeline, RenderDescriptorSet **descriptorSets, uint32_t descriptorSetCount) override;